@@ -101,6 +101,8 @@ macro(configure_unix_libs)
     message(FATAL_ERROR "Missing unistd.h")
   endif()
 
+  check_include_files(sys/eventfd.h HAVE_SYS_EVENTFD_H)
+  check_include_files(sys/epoll.h HAVE_SYS_EPOLL_H)
   check_function_exists(sigwait HAVE_POSIX_SIGWAIT)
   check_function_exists(inet_aton HAVE_INET_ATON)
 
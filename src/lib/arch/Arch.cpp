@@ -58,5 +58,5 @@ double Arch::time()
 {
   auto sinceEpoch = std::chrono::steady_clock::now().time_since_epoch();
   auto uSecSinceEpoch = std::chrono::duration_cast<std::chrono::microseconds>(sinceEpoch).count();
-  return double(uSecSinceEpoch / 1000000);
+  return static_cast<double>(uSecSinceEpoch) / 1000000.0;
 }
@@ -9,6 +9,7 @@
 #pragma once
 
 #include <cstdint>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -44,6 +45,20 @@ An opaque type representing a network address.
 */
 using ArchNetAddress = ArchNetAddressImpl *;
 
+/*!
+\class ArchPollSetImpl
+\brief Internal poll set data.
+An architecture dependent type holding the necessary data for a poll set.
+*/
+class ArchPollSetImpl;
+
+/*!
+\var ArchPollSet
+\brief Opaque poll set type.
+An opaque type representing a set of sockets to wait on.
+*/
+using ArchPollSet = ArchPollSetImpl *;
+
 //! Interface for architecture dependent networking
 /*!
 This interface defines the networking operations required by
@@ -98,6 +113,20 @@ public:
     unsigned short m_revents;
   };
 
+  //! A ready socket from \c waitPollSet()
+  class PollResult
+  {
+  public:
+    //! The key the socket was given to \c setPollSetSocket() with
+    void *m_key;
+
+    //! The result events
+    unsigned short m_revents;
+  };
+
+  //! The most buffers \c readSocket() and \c writeSocket() take at once
+  static constexpr size_t kMaxSocketBuffers = 16;
+
   //! @name manipulators
   //@{
 
@@ -193,6 +222,58 @@ public:
   */
   virtual void unblockPollSocket(ArchThread thread) = 0;
 
+  //! Create a poll set
+  /*!
+  A poll set remembers its sockets and the events to wait for on each of
+  them between calls to \c waitPollSet().  Unlike \c pollSocket(), where
+  the platform allows it the cost of a wait depends on the number of ready
+  sockets rather than on the number of sockets in the set.  The poll set
+  is an opaque data type.
+  */
+  virtual ArchPollSet newPollSet() = 0;
+
+  //! Destroy a poll set
+  /*!
+  Deletes the poll set \c set.  The sockets in it are not closed.
+  */
+  virtual void closePollSet(ArchPollSet set) = 0;
+
+  //! Add or change a socket in a poll set
+  /*!
+  Makes \c set wait for \c events, any combination of PollEventMask::In
+  and PollEventMask::Out, on socket \c s, replacing any events it was
+  already waiting for on \c s.  Results for \c s carry \c key.  \c s must
+  be removed from the set before it's closed.
+  */
+  virtual void setPollSetSocket(ArchPollSet set, ArchSocket s, unsigned short events, void *key) = 0;
+
+  //! Remove a socket from a poll set
+  /*!
+  Stops \c set waiting on socket \c s.  Does nothing if \c s is not in
+  \c set.
+  */
+  virtual void removePollSetSocket(ArchPollSet set, ArchSocket s) = 0;
+
+  //! Wait on a poll set
+  /*!
+  Waits up to \c timeout seconds (or indefinitely if \c timeout < 0) for
+  sockets in \c set to become ready.  Fills in up to \c num \c results,
+  one for each ready socket, and returns how many it filled in.  Returns
+  0 if the wait timed out or was unblocked.  Only one thread may wait on
+  a set at a time but other threads may change the set meanwhile, which
+  may end the wait early.
+
+  (Cancellation point)
+  */
+  virtual int waitPollSet(ArchPollSet set, PollResult results[], int num, double timeout) = 0;
+
+  //! Unblock thread in waitPollSet()
+  /*!
+  Cause a thread that's in a waitPollSet() call on \c set to return.
+  This call may return before the thread is unblocked.
+  */
+  virtual void unblockPollSet(ArchPollSet set) = 0;
+
   //! Read data from socket
   /*!
   Read up to \c len bytes from socket \c s in \c buf and return the
@@ -211,6 +292,35 @@ public:
   */
   virtual size_t writeSocket(ArchSocket s, const void *buf, size_t len) = 0;
 
+  //! Read data from socket into several buffers
+  /*!
+  Like \c readSocket() but fills each of \c bufs in turn, in a single
+  call to the system.  No more than \c kMaxSocketBuffers are allowed.
+  */
+  virtual size_t readSocket(ArchSocket s, std::span<const std::span<uint8_t>> bufs) = 0;
+
+  //! Write data to socket from several buffers
+  /*!
+  Like \c writeSocket() but writes each of \c bufs in turn, in a single
+  call to the system.  No more than \c kMaxSocketBuffers are allowed.
+  */
+  virtual size_t writeSocket(ArchSocket s, std::span<const std::span<const uint8_t>> bufs) = 0;
+
+  //! Read a datagram from socket
+  /*!
+  Like \c readSocket() but for a datagram socket that isn't connected.
+  Sets \c addr to the address the datagram came from, which the caller
+  must close with \c closeAddr(), or to nullptr if there's no datagram.
+  */
+  virtual size_t readSocketFrom(ArchSocket s, void *buf, size_t len, ArchNetAddress *addr) = 0;
+
+  //! Write a datagram to socket
+  /*!
+  Like \c writeSocket() but for a datagram socket that isn't connected,
+  sending the datagram to \c addr.
+  */
+  virtual size_t writeSocketTo(ArchSocket s, const void *buf, size_t len, ArchNetAddress addr) = 0;
+
   //! Check error on socket
   /*!
   If the socket \c s is in an error state then throws an appropriate
@@ -225,6 +335,14 @@ public:
   */
   virtual bool setNoDelayOnSocket(ArchSocket, bool noDelay) = 0;
 
+  //! Limit unsent data on socket
+  /*!
+  Set socket to only poll writable once fewer than \c bytes written to it
+  are still waiting to be sent, so little is queued in the kernel ahead of
+  the next write.  Returns false if the platform doesn't support it.
+  */
+  virtual bool setNotSentLowWaterOnSocket(ArchSocket, uint32_t bytes) = 0;
+
   //! Turn address reuse on or off on socket
   /*!
   Allows the address this socket is bound to to be reused while in the
@@ -13,13 +13,21 @@
 #include "arch/unix/XArchUnix.h"
 #include "common/Common.h"
 
+#include <algorithm>
+#include <array>
 #include <arpa/inet.h>
 #include <cstring>
 #include <errno.h>
 #include <fcntl.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <sys/uio.h>
 #include <unistd.h>
+#include <vector>
+
+#if HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
 
 #if !defined(TCP_NODELAY)
 #include <netinet/tcp.h>
@@ -58,6 +66,30 @@ static in_addr_t inet_aton(const char *cp, struct in_addr *inp)
 }
 #endif
 
+//
+// ArchPollSetImpl
+//
+
+class ArchPollSetImpl
+{
+public:
+  int m_wakePipe[2] = {-1, -1};
+#if HAVE_SYS_EPOLL_H
+  // the kernel keeps the sockets and their events between waits
+  int m_epollFd = -1;
+  std::vector<struct epoll_event> m_ready;
+#else
+  // poll() takes every socket on every wait so they're copied out from
+  // under the mutex, letting other threads change the set during a wait
+  std::mutex m_mutex;
+  bool m_waiting = false;
+  std::vector<struct pollfd> m_fds;
+  std::vector<void *> m_keys;
+  std::vector<struct pollfd> m_polledFds;
+  std::vector<void *> m_polledKeys;
+#endif
+};
+
 //
 // ArchNetworkBSD::Deps
 //
@@ -354,6 +386,242 @@ void ArchNetworkBSD::unblockPollSocket(ArchThread thread)
   }
 }
 
+ArchPollSet ArchNetworkBSD::newPollSet()
+{
+  auto *set = new ArchPollSetImpl;
+  try {
+    if (pipe(set->m_wakePipe) == -1) {
+      throwError(errno);
+    }
+    setBlockingOnSocket(set->m_wakePipe[0], false);
+    setBlockingOnSocket(set->m_wakePipe[1], false);
+
+#if HAVE_SYS_EPOLL_H
+    set->m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (set->m_epollFd == -1) {
+      throwError(errno);
+    }
+
+    // the wake pipe is told apart from the sockets by carrying the set
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.ptr = set;
+    if (epoll_ctl(set->m_epollFd, EPOLL_CTL_ADD, set->m_wakePipe[0], &event) == -1) {
+      throwError(errno);
+    }
+#endif
+  } catch (...) {
+    closePollSet(set);
+    throw;
+  }
+  return set;
+}
+
+void ArchNetworkBSD::closePollSet(ArchPollSet set)
+{
+  assert(set != nullptr);
+
+#if HAVE_SYS_EPOLL_H
+  if (set->m_epollFd != -1) {
+    close(set->m_epollFd);
+  }
+#endif
+  for (const int fd : set->m_wakePipe) {
+    if (fd != -1) {
+      close(fd);
+    }
+  }
+  delete set;
+}
+
+void ArchNetworkBSD::setPollSetSocket(ArchPollSet set, ArchSocket s, unsigned short events, void *key)
+{
+  assert(set != nullptr);
+  assert(s != nullptr);
+
+#if HAVE_SYS_EPOLL_H
+  struct epoll_event event = {};
+  if ((events & PollEventMask::In) != 0) {
+    event.events |= EPOLLIN;
+  }
+  if ((events & PollEventMask::Out) != 0) {
+    event.events |= EPOLLOUT;
+  }
+  event.data.ptr = key;
+
+  // changing events is far more common than adding a socket
+  if (epoll_ctl(set->m_epollFd, EPOLL_CTL_MOD, s->m_fd, &event) == -1) {
+    if (errno != ENOENT || epoll_ctl(set->m_epollFd, EPOLL_CTL_ADD, s->m_fd, &event) == -1) {
+      throwError(errno);
+    }
+  }
+#else
+  struct pollfd pfd = {};
+  pfd.fd = s->m_fd;
+  if ((events & PollEventMask::In) != 0) {
+    pfd.events |= POLLIN;
+  }
+  if ((events & PollEventMask::Out) != 0) {
+    pfd.events |= POLLOUT;
+  }
+
+  std::scoped_lock lock{set->m_mutex};
+  auto i = std::ranges::find(set->m_fds, s->m_fd, &pollfd::fd);
+  if (i == set->m_fds.end()) {
+    set->m_fds.push_back(pfd);
+    set->m_keys.push_back(key);
+  } else {
+    *i = pfd;
+    set->m_keys[i - set->m_fds.begin()] = key;
+  }
+  if (set->m_waiting) {
+    unblockPollSet(set);
+  }
+#endif
+}
+
+void ArchNetworkBSD::removePollSetSocket(ArchPollSet set, ArchSocket s)
+{
+  assert(set != nullptr);
+  assert(s != nullptr);
+
+#if HAVE_SYS_EPOLL_H
+  // fails only if the socket isn't in the set
+  std::ignore = epoll_ctl(set->m_epollFd, EPOLL_CTL_DEL, s->m_fd, nullptr);
+#else
+  std::scoped_lock lock{set->m_mutex};
+  auto i = std::ranges::find(set->m_fds, s->m_fd, &pollfd::fd);
+  if (i == set->m_fds.end()) {
+    return;
+  }
+
+  // order doesn't matter so fill the hole with the last socket
+  const auto index = i - set->m_fds.begin();
+  set->m_fds[index] = set->m_fds.back();
+  set->m_fds.pop_back();
+  set->m_keys[index] = set->m_keys.back();
+  set->m_keys.pop_back();
+  if (set->m_waiting) {
+    unblockPollSet(set);
+  }
+#endif
+}
+
+int ArchNetworkBSD::waitPollSet(ArchPollSet set, PollResult results[], int num, double timeout)
+{
+  assert(set != nullptr);
+  assert(results != nullptr && num > 0);
+
+  // prepare timeout
+  int t = (timeout < 0.0) ? -1 : static_cast<int>(1000.0 * timeout);
+
+#if HAVE_SYS_EPOLL_H
+  // only grows so the buffer is allocated once
+  if (set->m_ready.size() < static_cast<size_t>(num)) {
+    set->m_ready.resize(num);
+  }
+
+  int n = epoll_wait(set->m_epollFd, set->m_ready.data(), num, t);
+  if (n == -1) {
+    if (errno == EINTR) {
+      // interrupted system call
+      m_pDeps->testCancelThread();
+      return 0;
+    }
+    throwError(errno);
+  }
+
+  int count = 0;
+  for (int i = 0; i < n; ++i) {
+    const struct epoll_event &ready = set->m_ready[i];
+    if (ready.data.ptr == set) {
+      drainPollSetWakePipe(set);
+      continue;
+    }
+
+    PollResult &result = results[count++];
+    result.m_key = ready.data.ptr;
+    result.m_revents = 0;
+    if ((ready.events & EPOLLIN) != 0) {
+      result.m_revents |= PollEventMask::In;
+    }
+    if ((ready.events & EPOLLOUT) != 0) {
+      result.m_revents |= PollEventMask::Out;
+    }
+    if ((ready.events & EPOLLERR) != 0) {
+      result.m_revents |= PollEventMask::Error;
+    }
+  }
+  return count;
+#else
+  {
+    std::scoped_lock lock{set->m_mutex};
+    set->m_polledFds.assign(set->m_fds.begin(), set->m_fds.end());
+    set->m_polledKeys.assign(set->m_keys.begin(), set->m_keys.end());
+    set->m_waiting = true;
+  }
+
+  // add the wake pipe
+  struct pollfd wake = {};
+  wake.fd = set->m_wakePipe[0];
+  wake.events = POLLIN;
+  set->m_polledFds.push_back(wake);
+
+  int n = m_pDeps->poll(set->m_polledFds.data(), set->m_polledFds.size(), t);
+
+  {
+    std::scoped_lock lock{set->m_mutex};
+    set->m_waiting = false;
+  }
+
+  if (n == -1) {
+    if (errno == EINTR) {
+      // interrupted system call
+      m_pDeps->testCancelThread();
+      return 0;
+    }
+    throwError(errno);
+  }
+
+  if ((set->m_polledFds.back().revents & POLLIN) != 0) {
+    drainPollSetWakePipe(set);
+  }
+
+  int count = 0;
+  for (size_t i = 0; i + 1 < set->m_polledFds.size() && count < num; ++i) {
+    const struct pollfd &ready = set->m_polledFds[i];
+    if (ready.revents == 0) {
+      continue;
+    }
+
+    PollResult &result = results[count++];
+    result.m_key = set->m_polledKeys[i];
+    result.m_revents = 0;
+    if ((ready.revents & POLLIN) != 0) {
+      result.m_revents |= PollEventMask::In;
+    }
+    if ((ready.revents & POLLOUT) != 0) {
+      result.m_revents |= PollEventMask::Out;
+    }
+    if ((ready.revents & POLLERR) != 0) {
+      result.m_revents |= PollEventMask::Error;
+    }
+    if ((ready.revents & POLLNVAL) != 0) {
+      result.m_revents |= PollEventMask::Invalid;
+    }
+  }
+  return count;
+#endif
+}
+
+void ArchNetworkBSD::unblockPollSet(ArchPollSet set)
+{
+  assert(set != nullptr);
+
+  char dummy = 0;
+  std::ignore = write(set->m_wakePipe[1], &dummy, 1);
+}
+
 size_t ArchNetworkBSD::readSocket(ArchSocket s, void *buf, size_t len)
 {
   assert(s != nullptr);
@@ -382,6 +650,83 @@ size_t ArchNetworkBSD::writeSocket(ArchSocket s, const void *buf, size_t len)
   return n;
 }
 
+size_t ArchNetworkBSD::readSocket(ArchSocket s, std::span<const std::span<uint8_t>> bufs)
+{
+  assert(s != nullptr);
+  assert(bufs.size() <= kMaxSocketBuffers);
+
+  std::array<iovec, kMaxSocketBuffers> iov;
+  for (size_t i = 0; i < bufs.size(); ++i) {
+    iov[i].iov_base = bufs[i].data();
+    iov[i].iov_len = bufs[i].size();
+  }
+
+  ssize_t n = readv(s->m_fd, iov.data(), static_cast<int>(bufs.size()));
+  if (n == -1) {
+    if (errno == EINTR || errno == EAGAIN) {
+      return 0;
+    }
+    throwError(errno);
+  }
+  return n;
+}
+
+size_t ArchNetworkBSD::writeSocket(ArchSocket s, std::span<const std::span<const uint8_t>> bufs)
+{
+  assert(s != nullptr);
+  assert(bufs.size() <= kMaxSocketBuffers);
+
+  std::array<iovec, kMaxSocketBuffers> iov;
+  for (size_t i = 0; i < bufs.size(); ++i) {
+    iov[i].iov_base = const_cast<uint8_t *>(bufs[i].data());
+    iov[i].iov_len = bufs[i].size();
+  }
+
+  ssize_t n = writev(s->m_fd, iov.data(), static_cast<int>(bufs.size()));
+  if (n == -1) {
+    if (errno == EINTR || errno == EAGAIN) {
+      return 0;
+    }
+    throwError(errno);
+  }
+  return n;
+}
+
+size_t ArchNetworkBSD::readSocketFrom(ArchSocket s, void *buf, size_t len, ArchNetAddress *addr)
+{
+  assert(s != nullptr);
+  assert(addr != nullptr);
+
+  auto *from = new ArchNetAddressImpl;
+  ssize_t n = recvfrom(s->m_fd, buf, len, 0, TYPED_ADDR(struct sockaddr, from), &from->m_len);
+  if (n == -1) {
+    int err = errno;
+    delete from;
+    *addr = nullptr;
+    if (err == EINTR || err == EAGAIN) {
+      return 0;
+    }
+    throwError(err);
+  }
+  *addr = from;
+  return n;
+}
+
+size_t ArchNetworkBSD::writeSocketTo(ArchSocket s, const void *buf, size_t len, ArchNetAddress addr)
+{
+  assert(s != nullptr);
+  assert(addr != nullptr);
+
+  ssize_t n = sendto(s->m_fd, buf, len, 0, TYPED_ADDR(struct sockaddr, addr), addr->m_len);
+  if (n == -1) {
+    if (errno == EINTR || errno == EAGAIN) {
+      return 0;
+    }
+    throwError(errno);
+  }
+  return n;
+}
+
 void ArchNetworkBSD::throwErrorOnSocket(ArchSocket s)
 {
   assert(s != nullptr);
@@ -399,6 +744,14 @@ void ArchNetworkBSD::throwErrorOnSocket(ArchSocket s)
   }
 }
 
+void ArchNetworkBSD::drainPollSetWakePipe(ArchPollSet set) const
+{
+  char dummy[100];
+  while (m_pDeps->read(set->m_wakePipe[0], dummy, sizeof(dummy)) > 0) {
+    // keep reading
+  }
+}
+
 void ArchNetworkBSD::setBlockingOnSocket(int fd, bool blocking) const
 {
   assert(fd != -1);
@@ -437,6 +790,19 @@ bool ArchNetworkBSD::setNoDelayOnSocket(ArchSocket s, bool noDelay)
   return (oflag != 0);
 }
 
+bool ArchNetworkBSD::setNotSentLowWaterOnSocket(ArchSocket s, uint32_t bytes)
+{
+  assert(s != nullptr);
+
+#if defined(TCP_NOTSENT_LOWAT)
+  auto lowWater = static_cast<int>(bytes);
+  auto size = static_cast<socklen_t>(sizeof(lowWater));
+  return (setsockopt(s->m_fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT, reinterpret_cast<optval_t *>(&lowWater), size) == 0);
+#else
+  return false;
+#endif
+}
+
 bool ArchNetworkBSD::setReuseAddrOnSocket(ArchSocket s, bool reuse)
 {
   assert(s != nullptr);
@@ -82,10 +82,21 @@ public:
   bool connectSocket(ArchSocket s, ArchNetAddress name) override;
   int pollSocket(PollEntry[], int num, double timeout) override;
   void unblockPollSocket(ArchThread thread) override;
+  ArchPollSet newPollSet() override;
+  void closePollSet(ArchPollSet set) override;
+  void setPollSetSocket(ArchPollSet set, ArchSocket s, unsigned short events, void *key) override;
+  void removePollSetSocket(ArchPollSet set, ArchSocket s) override;
+  int waitPollSet(ArchPollSet set, PollResult results[], int num, double timeout) override;
+  void unblockPollSet(ArchPollSet set) override;
   size_t readSocket(ArchSocket s, void *buf, size_t len) override;
   size_t writeSocket(ArchSocket s, const void *buf, size_t len) override;
+  size_t readSocket(ArchSocket s, std::span<const std::span<uint8_t>> bufs) override;
+  size_t writeSocket(ArchSocket s, std::span<const std::span<const uint8_t>> bufs) override;
+  size_t readSocketFrom(ArchSocket s, void *buf, size_t len, ArchNetAddress *addr) override;
+  size_t writeSocketTo(ArchSocket s, const void *buf, size_t len, ArchNetAddress addr) override;
   void throwErrorOnSocket(ArchSocket) override;
   bool setNoDelayOnSocket(ArchSocket, bool noDelay) override;
+  bool setNotSentLowWaterOnSocket(ArchSocket, uint32_t bytes) override;
   bool setReuseAddrOnSocket(ArchSocket, bool reuse) override;
   ArchNetAddress newAnyAddr(AddressFamily) override;
   ArchNetAddress copyAddr(ArchNetAddress) override;
@@ -102,6 +113,7 @@ public:
 private:
   const int *getUnblockPipe();
   const int *getUnblockPipeForThread(ArchThread);
+  void drainPollSetWakePipe(ArchPollSet set) const;
   void setBlockingOnSocket(int fd, bool blocking) const;
   [[noreturn]] void throwError(int) const override;
   [[noreturn]] void throwNameError(int) const override;
@@ -12,7 +12,28 @@
 #include "arch/win32/ArchMultithreadWindows.h"
 #include "arch/win32/XArchWindows.h"
 
+#include <algorithm>
+#include <array>
 #include <malloc.h>
+#include <vector>
+
+//
+// ArchPollSetImpl
+//
+
+// winsock has nothing like epoll so a poll set is a list of entries for
+// pollSocket().  it's copied out from under the mutex for each wait,
+// letting other threads change the set during a wait.
+class ArchPollSetImpl
+{
+public:
+  std::mutex m_mutex;
+  std::vector<IArchNetwork::PollEntry> m_entries;
+  std::vector<void *> m_keys;
+  std::vector<IArchNetwork::PollEntry> m_polled;
+  std::vector<void *> m_polledKeys;
+  ArchThread m_waiter = nullptr;
+};
 
 static const int s_family[] = {
     PF_UNSPEC,
@@ -35,10 +56,16 @@ static int(PASCAL FAR *ioctl_winsock)(SOCKET s, int cmd, void FAR *data);
 static int(PASCAL FAR *listen_winsock)(SOCKET s, int backlog);
 static u_short(PASCAL FAR *ntohs_winsock)(u_short v);
 static int(PASCAL FAR *recv_winsock)(SOCKET s, void FAR *buf, int len, int flags);
+static int(PASCAL FAR *recvfrom_winsock)(
+    SOCKET s, void FAR *buf, int len, int flags, struct sockaddr FAR *from, int FAR *fromlen
+);
 static int(PASCAL FAR *select_winsock)(
     int nfds, fd_set FAR *readfds, fd_set FAR *writefds, fd_set FAR *exceptfds, const struct timeval FAR *timeout
 );
 static int(PASCAL FAR *send_winsock)(SOCKET s, const void FAR *buf, int len, int flags);
+static int(PASCAL FAR *sendto_winsock)(
+    SOCKET s, const void FAR *buf, int len, int flags, const struct sockaddr FAR *to, int tolen
+);
 static int(PASCAL FAR *setsockopt_winsock)(SOCKET s, int level, int optname, const void FAR *optval, int optlen);
 static int(PASCAL FAR *shutdown_winsock)(SOCKET s, int how);
 static SOCKET(PASCAL FAR *socket_winsock)(int af, int type, int protocol);
@@ -53,6 +80,12 @@ static BOOL(PASCAL FAR *WSAResetEvent_winsock)(WSAEVENT);
 static int(PASCAL FAR *WSAEventSelect_winsock)(SOCKET, WSAEVENT, long);
 static DWORD(PASCAL FAR *WSAWaitForMultipleEvents_winsock)(DWORD, const WSAEVENT FAR *, BOOL, DWORD, BOOL);
 static int(PASCAL FAR *WSAEnumNetworkEvents_winsock)(SOCKET, WSAEVENT, LPWSANETWORKEVENTS);
+static int(PASCAL FAR *WSARecv_winsock)(
+    SOCKET, LPWSABUF, DWORD, LPDWORD, LPDWORD, LPWSAOVERLAPPED, LPWSAOVERLAPPED_COMPLETION_ROUTINE
+);
+static int(PASCAL FAR *WSASend_winsock)(
+    SOCKET, LPWSABUF, DWORD, LPDWORD, DWORD, LPWSAOVERLAPPED, LPWSAOVERLAPPED_COMPLETION_ROUTINE
+);
 
 #undef FD_ISSET
 #define FD_ISSET(fd, set) WSAFDIsSet_winsock((SOCKET)(fd), (fd_set FAR *)(set))
@@ -159,6 +192,10 @@ void ArchNetworkWinsock::initModule(HMODULE module)
   setfunc(listen_winsock, listen, int(PASCAL FAR *)(SOCKET s, int backlog));
   setfunc(ntohs_winsock, ntohs, u_short(PASCAL FAR *)(u_short v));
   setfunc(recv_winsock, recv, int(PASCAL FAR *)(SOCKET s, void FAR *buf, int len, int flags));
+  setfunc(
+      recvfrom_winsock, recvfrom,
+      int(PASCAL FAR *)(SOCKET s, void FAR *buf, int len, int flags, struct sockaddr FAR *from, int FAR *fromlen)
+  );
   setfunc(
       select_winsock, select,
       int(PASCAL FAR *)(
@@ -166,6 +203,10 @@ void ArchNetworkWinsock::initModule(HMODULE module)
       )
   );
   setfunc(send_winsock, send, int(PASCAL FAR *)(SOCKET s, const void FAR *buf, int len, int flags));
+  setfunc(
+      sendto_winsock, sendto,
+      int(PASCAL FAR *)(SOCKET s, const void FAR *buf, int len, int flags, const struct sockaddr FAR *to, int tolen)
+  );
   setfunc(
       setsockopt_winsock, setsockopt,
       int(PASCAL FAR *)(SOCKET s, int level, int optname, const void FAR *optval, int optlen)
@@ -188,6 +229,14 @@ void ArchNetworkWinsock::initModule(HMODULE module)
       DWORD(PASCAL FAR *)(DWORD, const WSAEVENT FAR *, BOOL, DWORD, BOOL)
   );
   setfunc(WSAEnumNetworkEvents_winsock, WSAEnumNetworkEvents, int(PASCAL FAR *)(SOCKET, WSAEVENT, LPWSANETWORKEVENTS));
+  setfunc(
+      WSARecv_winsock, WSARecv,
+      int(PASCAL FAR *)(SOCKET, LPWSABUF, DWORD, LPDWORD, LPDWORD, LPWSAOVERLAPPED, LPWSAOVERLAPPED_COMPLETION_ROUTINE)
+  );
+  setfunc(
+      WSASend_winsock, WSASend,
+      int(PASCAL FAR *)(SOCKET, LPWSABUF, DWORD, LPDWORD, DWORD, LPWSAOVERLAPPED, LPWSAOVERLAPPED_COMPLETION_ROUTINE)
+  );
 
   s_networkModule = module;
 }
@@ -419,16 +468,7 @@ int ArchNetworkWinsock::pollSocket(PollEntry pe[], int num, double timeout)
   }
 
   // add the unblock event
-  ArchMultithreadWindows *mt = ArchMultithreadWindows::getInstance();
-  ArchThread thread = mt->newCurrentThread();
-  WSAEVENT *unblockEvent = (WSAEVENT *)mt->getNetworkDataForThread(thread);
-  ARCH->closeThread(thread);
-  if (unblockEvent == nullptr) {
-    unblockEvent = new WSAEVENT;
-    m_unblockEvents.push_back(unblockEvent);
-    *unblockEvent = WSACreateEvent_winsock();
-    mt->setNetworkDataForCurrentThread(unblockEvent);
-  }
+  WSAEVENT *unblockEvent = getUnblockEvent();
   events[n++] = *unblockEvent;
 
   // prepare timeout
@@ -522,6 +562,119 @@ void ArchNetworkWinsock::unblockPollSocket(ArchThread thread)
   }
 }
 
+ArchPollSet ArchNetworkWinsock::newPollSet()
+{
+  return new ArchPollSetImpl;
+}
+
+void ArchNetworkWinsock::closePollSet(ArchPollSet set)
+{
+  assert(set != nullptr);
+  assert(set->m_waiter == nullptr);
+
+  delete set;
+}
+
+void ArchNetworkWinsock::setPollSetSocket(ArchPollSet set, ArchSocket s, unsigned short events, void *key)
+{
+  assert(set != nullptr);
+  assert(s != nullptr);
+
+  std::scoped_lock lock{set->m_mutex};
+  auto i = std::ranges::find(set->m_entries, s, &PollEntry::m_socket);
+  if (i == set->m_entries.end()) {
+    set->m_entries.push_back(PollEntry{s, events, 0});
+    set->m_keys.push_back(key);
+  } else {
+    i->m_events = events;
+    set->m_keys[i - set->m_entries.begin()] = key;
+  }
+  if (set->m_waiter != nullptr) {
+    unblockPollSocket(set->m_waiter);
+  }
+}
+
+void ArchNetworkWinsock::removePollSetSocket(ArchPollSet set, ArchSocket s)
+{
+  assert(set != nullptr);
+  assert(s != nullptr);
+
+  std::scoped_lock lock{set->m_mutex};
+  auto i = std::ranges::find(set->m_entries, s, &PollEntry::m_socket);
+  if (i == set->m_entries.end()) {
+    return;
+  }
+
+  // order doesn't matter so fill the hole with the last socket
+  const auto index = i - set->m_entries.begin();
+  set->m_entries[index] = set->m_entries.back();
+  set->m_entries.pop_back();
+  set->m_keys[index] = set->m_keys.back();
+  set->m_keys.pop_back();
+  if (set->m_waiter != nullptr) {
+    unblockPollSocket(set->m_waiter);
+  }
+}
+
+int ArchNetworkWinsock::waitPollSet(ArchPollSet set, PollResult results[], int num, double timeout)
+{
+  assert(set != nullptr);
+  assert(results != nullptr && num > 0);
+
+  {
+    std::scoped_lock lock{set->m_mutex};
+    set->m_polled.assign(set->m_entries.begin(), set->m_entries.end());
+    set->m_polledKeys.assign(set->m_keys.begin(), set->m_keys.end());
+    set->m_waiter = ARCH->newCurrentThread();
+  }
+
+  int n = 0;
+  try {
+    if (set->m_polled.empty()) {
+      // pollSocket() returns at once without sockets so wait to be
+      // unblocked by a change to the set instead
+      WSAEVENT *unblockEvent = getUnblockEvent();
+      DWORD t = (timeout < 0.0) ? INFINITE : (DWORD)(1000.0 * timeout);
+      WSAWaitForMultipleEvents_winsock(1, unblockEvent, FALSE, t, FALSE);
+      WSAResetEvent_winsock(*unblockEvent);
+    } else {
+      n = pollSocket(set->m_polled.data(), static_cast<int>(set->m_polled.size()), timeout);
+    }
+  } catch (...) {
+    std::scoped_lock lock{set->m_mutex};
+    ARCH->closeThread(set->m_waiter);
+    set->m_waiter = nullptr;
+    throw;
+  }
+
+  {
+    std::scoped_lock lock{set->m_mutex};
+    ARCH->closeThread(set->m_waiter);
+    set->m_waiter = nullptr;
+  }
+  ARCH->testCancelThread();
+
+  int count = 0;
+  for (size_t i = 0; i < set->m_polled.size() && n > 0 && count < num; ++i) {
+    if (set->m_polled[i].m_revents != 0) {
+      results[count].m_key = set->m_polledKeys[i];
+      results[count].m_revents = set->m_polled[i].m_revents;
+      ++count;
+    }
+  }
+  return count;
+}
+
+void ArchNetworkWinsock::unblockPollSet(ArchPollSet set)
+{
+  assert(set != nullptr);
+
+  std::scoped_lock lock{set->m_mutex};
+  if (set->m_waiter != nullptr) {
+    unblockPollSocket(set->m_waiter);
+  }
+}
+
 size_t ArchNetworkWinsock::readSocket(ArchSocket s, void *buf, size_t len)
 {
   assert(s != nullptr);
@@ -556,6 +709,99 @@ size_t ArchNetworkWinsock::writeSocket(ArchSocket s, const void *buf, size_t len
   return static_cast<size_t>(n);
 }
 
+size_t ArchNetworkWinsock::readSocket(ArchSocket s, std::span<const std::span<uint8_t>> bufs)
+{
+  assert(s != nullptr);
+  assert(bufs.size() <= kMaxSocketBuffers);
+
+  std::array<WSABUF, kMaxSocketBuffers> wsaBufs;
+  for (size_t i = 0; i < bufs.size(); ++i) {
+    wsaBufs[i].buf = reinterpret_cast<char *>(bufs[i].data());
+    wsaBufs[i].len = static_cast<ULONG>(bufs[i].size());
+  }
+
+  DWORD n = 0;
+  DWORD flags = 0;
+  if (WSARecv_winsock(s->m_socket, wsaBufs.data(), static_cast<DWORD>(bufs.size()), &n, &flags, nullptr, nullptr) ==
+      SOCKET_ERROR) {
+    int err = getsockerror_winsock();
+    if (err == WSAEINTR || err == WSAEWOULDBLOCK) {
+      return 0;
+    }
+    throwError(err);
+  }
+  return static_cast<size_t>(n);
+}
+
+size_t ArchNetworkWinsock::writeSocket(ArchSocket s, std::span<const std::span<const uint8_t>> bufs)
+{
+  assert(s != nullptr);
+  assert(bufs.size() <= kMaxSocketBuffers);
+
+  std::array<WSABUF, kMaxSocketBuffers> wsaBufs;
+  for (size_t i = 0; i < bufs.size(); ++i) {
+    wsaBufs[i].buf = reinterpret_cast<char *>(const_cast<uint8_t *>(bufs[i].data()));
+    wsaBufs[i].len = static_cast<ULONG>(bufs[i].size());
+  }
+
+  DWORD n = 0;
+  if (WSASend_winsock(s->m_socket, wsaBufs.data(), static_cast<DWORD>(bufs.size()), &n, 0, nullptr, nullptr) ==
+      SOCKET_ERROR) {
+    int err = getsockerror_winsock();
+    if (err == WSAEINTR) {
+      return 0;
+    }
+    if (err == WSAEWOULDBLOCK) {
+      s->m_pollWrite = true;
+      return 0;
+    }
+    throwError(err);
+  }
+  return static_cast<size_t>(n);
+}
+
+size_t ArchNetworkWinsock::readSocketFrom(ArchSocket s, void *buf, size_t len, ArchNetAddress *addr)
+{
+  assert(s != nullptr);
+  assert(addr != nullptr);
+
+  ArchNetAddress from = ArchNetAddressImpl::alloc(sizeof(struct sockaddr_in6));
+  int n = recvfrom_winsock(s->m_socket, buf, (int)len, 0, TYPED_ADDR(struct sockaddr, from), &from->m_len);
+  if (n == SOCKET_ERROR) {
+    int err = getsockerror_winsock();
+    free(from);
+    *addr = nullptr;
+
+    // a datagram that couldn't be delivered earlier is reported as a reset
+    if (err == WSAEINTR || err == WSAEWOULDBLOCK || err == WSAECONNRESET) {
+      return 0;
+    }
+    throwError(err);
+  }
+  *addr = from;
+  return static_cast<size_t>(n);
+}
+
+size_t ArchNetworkWinsock::writeSocketTo(ArchSocket s, const void *buf, size_t len, ArchNetAddress addr)
+{
+  assert(s != nullptr);
+  assert(addr != nullptr);
+
+  int n = sendto_winsock(s->m_socket, buf, (int)len, 0, TYPED_ADDR(struct sockaddr, addr), addr->m_len);
+  if (n == SOCKET_ERROR) {
+    int err = getsockerror_winsock();
+    if (err == WSAEINTR) {
+      return 0;
+    }
+    if (err == WSAEWOULDBLOCK) {
+      s->m_pollWrite = true;
+      return 0;
+    }
+    throwError(err);
+  }
+  return static_cast<size_t>(n);
+}
+
 void ArchNetworkWinsock::throwErrorOnSocket(ArchSocket s)
 {
   assert(s != nullptr);
@@ -573,6 +819,21 @@ void ArchNetworkWinsock::throwErrorOnSocket(ArchSocket s)
   }
 }
 
+WSAEVENT *ArchNetworkWinsock::getUnblockEvent()
+{
+  ArchMultithreadWindows *mt = ArchMultithreadWindows::getInstance();
+  ArchThread thread = mt->newCurrentThread();
+  WSAEVENT *unblockEvent = (WSAEVENT *)mt->getNetworkDataForThread(thread);
+  ARCH->closeThread(thread);
+  if (unblockEvent == nullptr) {
+    unblockEvent = new WSAEVENT;
+    m_unblockEvents.push_back(unblockEvent);
+    *unblockEvent = WSACreateEvent_winsock();
+    mt->setNetworkDataForCurrentThread(unblockEvent);
+  }
+  return unblockEvent;
+}
+
 void ArchNetworkWinsock::setBlockingOnSocket(SOCKET s, bool blocking)
 {
   assert(s != 0);
@@ -604,6 +865,14 @@ bool ArchNetworkWinsock::setNoDelayOnSocket(ArchSocket s, bool noDelay)
   return (oflag != 0);
 }
 
+bool ArchNetworkWinsock::setNotSentLowWaterOnSocket(ArchSocket s, uint32_t)
+{
+  assert(s != nullptr);
+
+  // winsock has no equivalent of TCP_NOTSENT_LOWAT
+  return false;
+}
+
 bool ArchNetworkWinsock::setReuseAddrOnSocket(ArchSocket s, bool reuse)
 {
   assert(s != nullptr);
@@ -42,6 +42,9 @@ void *Event::getTarget() const
 
 void *Event::getData() const
 {
+  if (m_hasInlineData) {
+    return const_cast<std::byte *>(m_inlineData.data());
+  }
   return m_data;
 }
 
@@ -67,7 +70,7 @@ void Event::deleteData(const Event &event)
 
   default:
     if ((event.getFlags() & EventFlags::DontFreeData) == 0) {
-      free(event.getData());
+      free(event.m_data);
       delete event.getDataObject();
     }
     break;
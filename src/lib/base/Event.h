@@ -9,6 +9,11 @@
 
 #include "EventTypes.h"
 
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
 using deskflow::EventTypes;
 
 class EventData
@@ -18,6 +23,14 @@ public:
   virtual ~EventData() = default;
 };
 
+//! Largest data that an \c Event can hold inline
+inline constexpr size_t kInlineEventDataSize = 48;
+
+//! Data that an \c Event can hold inline
+template <class T>
+concept InlineEventData = std::is_class_v<T> && std::is_trivially_copyable_v<T> && sizeof(T) <= kInlineEventDataSize &&
+                          alignof(T) <= alignof(std::max_align_t);
+
 //! Event
 /*!
 A \c Event holds an event type and a pointer to event data.
@@ -54,6 +67,24 @@ public:
   */
   explicit Event(EventTypes type, void *target, EventData *dataObject);
 
+  //! Create \c Event with inline data
+  /*!
+  Copies \p data into the event itself, so there's nothing to allocate
+  or free.  \p data must be a trivially copyable struct that doesn't
+  point into itself, because it's copied along with the event.
+  \c getData() returns a pointer to the copy held by that \c Event,
+  which is only valid for as long as that \c Event is.
+  */
+  template <InlineEventData T>
+  explicit Event(EventTypes type, void *target, const T &data, Flags flags = EventFlags::NoFlags)
+      : m_type(type),
+        m_target(target),
+        m_flags(flags),
+        m_hasInlineData(true)
+  {
+    std::memcpy(m_inlineData.data(), &data, sizeof(T));
+  }
+
   //! @name manipulators
   //@{
 
@@ -88,7 +119,7 @@ public:
 
   //! Get the event data (POD).
   /*!
-  Returns the event data (POD).
+  Returns the event data (POD), which may be held inline.
   */
   void *getData() const;
 
@@ -114,4 +145,6 @@ private:
   void *m_data = nullptr;
   Flags m_flags = EventFlags::NoFlags;
   EventData *m_dataObject = nullptr;
+  bool m_hasInlineData = false;
+  alignas(std::max_align_t) std::array<std::byte, kInlineEventDataSize> m_inlineData{};
 };
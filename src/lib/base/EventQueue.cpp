@@ -9,11 +9,13 @@
 #include "base/EventQueue.h"
 
 #include "arch/Arch.h"
+#include "base/FinalAction.h"
 #include "base/Log.h"
 #include "base/SimpleEventQueueBuffer.h"
 #include "mt/Lock.h"
 #include "mt/Mutex.h"
 
+#include <algorithm>
 #include <stdexcept>
 
 // interrupt handler.  this just adds a quit event to the queue.
@@ -23,15 +25,29 @@ static void interrupt(Arch::ThreadSignal, void *data)
   events->addEvent(Event(EventTypes::Quit));
 }
 
+// user signal handler.  this asks the queue to log its statistics.
+static void dumpStats(Arch::ThreadSignal, void *data)
+{
+  auto *events = static_cast<EventQueue *>(data);
+  events->addEvent(Event(EventTypes::EventQueueDumpStats, events->getSystemTarget()));
+}
+
 //
 // EventQueue
 //
 
-EventQueue::EventQueue() : m_readyMutex(new Mutex), m_readyCondVar(new CondVar<bool>(m_readyMutex, false))
+EventQueue::EventQueue()
+    : m_handlerTable(std::make_unique<HandlerTable>()),
+      m_readyMutex(new Mutex),
+      m_readyCondVar(new CondVar<bool>(m_readyMutex, false))
 {
+  m_handlers = m_handlerTable.get();
   ARCH->setSignalHandler(Arch::ThreadSignal::Interrupt, &interrupt, this);
   ARCH->setSignalHandler(Arch::ThreadSignal::Terminate, &interrupt, this);
+  ARCH->setSignalHandler(Arch::ThreadSignal::User, &dumpStats, this);
   m_buffer = std::make_unique<SimpleEventQueueBuffer>();
+
+  addHandler(EventTypes::EventQueueDumpStats, getSystemTarget(), [this](const auto &) { m_stats.log(); });
 }
 
 EventQueue::~EventQueue()
@@ -41,6 +57,7 @@ EventQueue::~EventQueue()
 
   ARCH->setSignalHandler(Arch::ThreadSignal::Interrupt, nullptr, nullptr);
   ARCH->setSignalHandler(Arch::ThreadSignal::Terminate, nullptr, nullptr);
+  ARCH->setSignalHandler(Arch::ThreadSignal::User, nullptr, nullptr);
 }
 
 void EventQueue::loop()
@@ -70,23 +87,32 @@ void EventQueue::loop()
 
 void EventQueue::adoptBuffer(IEventQueueBuffer *buffer)
 {
-  std::scoped_lock lock{m_mutex};
+  std::scoped_lock lock{m_bufferMutex, m_coalesceMutex, m_mutex};
 
   LOG_DEBUG("adopting new buffer");
 
-  if (m_events.size() != 0) {
-    // this can come as a nasty surprise to programmers expecting
-    // their events to be raised, only to have them deleted.
-    LOG_DEBUG("discarding %d event(s)", m_events.size());
-  }
-
   // discard old buffer and old events
   m_buffer.reset();
+  auto discarded = static_cast<int>(m_events.size());
   for (auto i = m_events.begin(); i != m_events.end(); ++i) {
-    Event::deleteData(i->second);
+    Event::deleteData(i->second.m_event);
   }
   m_events.clear();
   m_oldEventIDs.clear();
+  m_ring.takeAll([&discarded](const SavedEvent &saved) {
+    Event::deleteData(saved.m_event);
+    ++discarded;
+  });
+  m_stats.eventDiscarded(discarded);
+  for (auto &[target, coalescing] : m_coalescing) {
+    coalescing.m_open = false;
+  }
+
+  if (discarded != 0) {
+    // this can come as a nasty surprise to programmers expecting
+    // their events to be raised, only to have them deleted.
+    LOG_DEBUG("discarded %d event(s)", discarded);
+  }
 
   // use new buffer
   m_buffer.reset(buffer);
@@ -140,8 +166,11 @@ bool EventQueue::processEvent(Event &event, double timeout, Stopwatch &timer)
     return true;
 
   case User: {
-    std::scoped_lock lock{m_mutex};
-    event = removeEvent(dataID);
+    const SavedEvent saved = removeEvent(dataID);
+    event = saved.m_event;
+    if (event.getType() != EventTypes::Unknown) {
+      m_stats.eventUnqueued(event.getType(), Arch::time() - saved.m_time);
+    }
     return true;
   }
 
@@ -159,16 +188,29 @@ bool EventQueue::getEvent(Event &event, double timeout)
 
 bool EventQueue::dispatchEvent(const Event &event)
 {
+  // count ourself as a reader before picking up the snapshot so that it
+  // can't be freed under us, even if the handler changes the handlers.
+  m_handlerReaders.fetch_add(1);
+  auto leave = deskflow::finally([this] {
+    if (m_handlerReaders.fetch_sub(1) == 1 && m_hasRetiredHandlers.load()) {
+      reclaimHandlers();
+    }
+  });
+
+  const HandlerTable &handlers = *m_handlers.load();
   void *target = event.getTarget();
-  if (const auto *type_handler = getHandler(event.getType(), target); type_handler) {
-    (*type_handler)(event);
-    return true;
-  }
-  if (const auto *any_handler = getHandler(EventTypes::Unknown, target); any_handler) {
-    (*any_handler)(event);
-    return true;
+  const auto *handler = getHandler(handlers, event.getType(), target);
+  if (handler == nullptr) {
+    handler = getHandler(handlers, EventTypes::Unknown, target);
+    if (handler == nullptr) {
+      return false;
+    }
   }
-  return false;
+
+  const double start = Arch::time();
+  (*handler)(event);
+  m_stats.eventDispatched(event.getType(), Arch::time() - start);
+  return true;
 }
 
 void EventQueue::addEvent(const Event &event)
@@ -184,6 +226,7 @@ void EventQueue::addEvent(const Event &event)
     break;
   }
 
+  m_stats.eventAdded(event.getType());
   if ((event.getFlags() & Event::EventFlags::DeliverImmediately) != 0) {
     dispatchEvent(event);
     Event::deleteData(event);
@@ -196,93 +239,170 @@ void EventQueue::addEvent(const Event &event)
 
 void EventQueue::addEventToBuffer(const Event &event)
 {
-  std::scoped_lock lock{m_mutex};
+  std::shared_lock lock{m_bufferMutex};
 
-  // store the event's data locally
-  auto eventID = saveEvent(event);
+  // store the event's data locally, unless it was merged into one that
+  // is already waiting.  count it as waiting first so the count can't
+  // drop below zero if it's taken out straight away.
+  uint32_t eventID;
+  if (m_coalescerCount.load() == 0) {
+    eventID = saveEvent(event);
+  } else if (!saveCoalescingEvent(event, eventID)) {
+    return;
+  }
+  m_stats.eventQueued();
 
   // add it
   if (!m_buffer->addEvent(eventID)) {
     // failed to send event
     removeEvent(eventID);
+    m_stats.eventDiscarded();
     Event::deleteData(event);
   }
 }
 
 EventQueueTimer *EventQueue::newTimer(double duration, void *target)
 {
-  assert(duration > 0.0);
-
-  EventQueueTimer *timer = m_buffer->newTimer(duration, false);
-  if (target == nullptr) {
-    target = timer;
-  }
-  std::scoped_lock lock{m_mutex};
-  m_timers.insert(timer);
-  // initial duration is requested duration plus whatever's on
-  // the clock currently because the latter will be subtracted
-  // the next time we check for timers.
-  m_timerQueue.push(Timer(timer, duration, duration + m_time.getTime(), target, false));
-  return timer;
+  return addTimer(duration, target, false);
 }
 
 EventQueueTimer *EventQueue::newOneShotTimer(double duration, void *target)
+{
+  return addTimer(duration, target, true);
+}
+
+EventQueueTimer *EventQueue::addTimer(double duration, void *target, bool oneShot)
 {
   assert(duration > 0.0);
 
-  EventQueueTimer *timer = m_buffer->newTimer(duration, true);
+  EventQueueTimer *timer = m_buffer->newTimer(duration, oneShot);
   if (target == nullptr) {
     target = timer;
   }
   std::scoped_lock lock{m_mutex};
-  m_timers.insert(timer);
-  // initial duration is requested duration plus whatever's on
-  // the clock currently because the latter will be subtracted
-  // the next time we check for timers.
-  m_timerQueue.push(Timer(timer, duration, duration + m_time.getTime(), target, true));
+  auto [index, inserted] = m_timers.try_emplace(timer, timer, duration, m_time.getTime() + duration, target, oneShot);
+  assert(inserted);
+  scheduleTimer(&index->second);
   return timer;
 }
 
 void EventQueue::deleteTimer(EventQueueTimer *timer)
 {
   std::scoped_lock lock{m_mutex};
-  for (auto index = m_timerQueue.begin(); index != m_timerQueue.end(); ++index) {
-    if (index->getTimer() == timer) {
-      m_timerQueue.erase(index);
-      break;
-    }
-  }
   if (Timers::iterator index = m_timers.find(timer); index != m_timers.end()) {
+    unscheduleTimer(&index->second);
     m_timers.erase(index);
   }
   m_buffer->deleteTimer(timer);
 }
 
-void EventQueue::addHandler(EventTypes type, void *target, const EventHandler &handler)
+void EventQueue::resetTimer(EventQueueTimer *timer, double duration)
 {
+  assert(duration > 0.0);
+
   std::scoped_lock lock{m_mutex};
-  m_handlers[target][type] = handler;
+  Timers::iterator index = m_timers.find(timer);
+  if (index == m_timers.end()) {
+    return;
+  }
+
+  // move the deadline and restore heap order from the timer's own slot.
+  // a one-shot that already fired is simply put back into the queue.
+  Timer &entry = index->second;
+  entry.reset(m_time.getTime(), duration);
+  if (entry.getQueueIndex() == kUnscheduled) {
+    scheduleTimer(&entry);
+  } else {
+    siftTimerUp(entry.getQueueIndex());
+    siftTimerDown(entry.getQueueIndex());
+  }
+}
+
+void EventQueue::addHandler(EventTypes type, void *target, const EventHandler &handler)
+{
+  std::scoped_lock lock{m_handlerMutex};
+  auto handlers = std::make_unique<HandlerTable>(*m_handlerTable);
+  auto &typeHandlers = (*handlers)[target];
+  auto table = typeHandlers ? std::make_shared<TypeHandlerTable>(*typeHandlers) : std::make_shared<TypeHandlerTable>();
+  (*table)[static_cast<uint32_t>(type)] = std::make_shared<const EventHandler>(handler);
+  typeHandlers = std::move(table);
+  publishHandlers(std::move(handlers));
 }
 
 void EventQueue::removeHandler(EventTypes type, void *target)
 {
-  std::scoped_lock lock{m_mutex};
-  HandlerTable::iterator index = m_handlers.find(target);
-  if (index != m_handlers.end()) {
-    TypeHandlerTable &typeHandlers = index->second;
-    TypeHandlerTable::iterator index2 = typeHandlers.find(type);
-    if (index2 != typeHandlers.end()) {
-      typeHandlers.erase(index2);
-    }
+  std::scoped_lock lock{m_handlerMutex};
+  HandlerTable::const_iterator index = m_handlerTable->find(target);
+  if (index == m_handlerTable->end() || (*index->second)[static_cast<uint32_t>(type)] == nullptr) {
+    return;
+  }
+
+  auto handlers = std::make_unique<HandlerTable>(*m_handlerTable);
+  auto table = std::make_shared<TypeHandlerTable>(*index->second);
+  (*table)[static_cast<uint32_t>(type)] = nullptr;
+  if (std::ranges::all_of(*table, [](const auto &handler) { return handler == nullptr; })) {
+    handlers->erase(target);
+  } else {
+    (*handlers)[target] = std::move(table);
   }
+  publishHandlers(std::move(handlers));
 }
 
 void EventQueue::removeHandlers(void *target)
 {
-  std::scoped_lock lock{m_mutex};
-  HandlerTable::iterator index = m_handlers.find(target);
-  if (index != m_handlers.end()) {
-    index->second.clear();
+  std::scoped_lock lock{m_handlerMutex};
+  if (!m_handlerTable->contains(target)) {
+    return;
+  }
+
+  auto handlers = std::make_unique<HandlerTable>(*m_handlerTable);
+  handlers->erase(target);
+  publishHandlers(std::move(handlers));
+}
+
+void EventQueue::setCoalescer(EventTypes type, const EventCoalescer &coalescer)
+{
+  std::scoped_lock lock{m_coalesceMutex};
+  auto &entry = m_coalescers[static_cast<uint32_t>(type)];
+  if (entry && !coalescer) {
+    // events of this type that are waiting can't be merged into anymore
+    for (auto &[target, coalescing] : m_coalescing) {
+      if (coalescing.m_type == type) {
+        coalescing.m_open = false;
+      }
+    }
+    m_coalescerCount.fetch_sub(1);
+  } else if (!entry && coalescer) {
+    m_coalescerCount.fetch_add(1);
+  }
+  entry = coalescer;
+}
+
+void EventQueue::publishHandlers(std::unique_ptr<HandlerTable> handlers)
+{
+  // note -- must have m_handlerMutex locked on entry
+
+  // swap in the new snapshot.  any reader that started before this may
+  // still be using the old one so retire it rather than freeing it.
+  m_handlers.store(handlers.get());
+  m_retiredHandlers.push_back(std::move(m_handlerTable));
+  m_handlerTable = std::move(handlers);
+  m_hasRetiredHandlers.store(true);
+
+  if (m_handlerReaders.load() == 0) {
+    m_retiredHandlers.clear();
+    m_hasRetiredHandlers.store(false);
+  }
+}
+
+void EventQueue::reclaimHandlers()
+{
+  // a reader that arrives after the check below can only pick up the
+  // current snapshot, which is never retired while we hold the mutex.
+  std::scoped_lock lock{m_handlerMutex};
+  if (m_handlerReaders.load() == 0) {
+    m_retiredHandlers.clear();
+    m_hasRetiredHandlers.store(false);
   }
 }
 
@@ -291,53 +411,131 @@ bool EventQueue::isEmpty() const
   return (m_buffer->isEmpty() && getNextTimerTimeout() != 0.0);
 }
 
-const EventQueue::EventHandler *EventQueue::getHandler(EventTypes type, void *target) const
+const EventQueue::EventHandler *EventQueue::getHandler(const HandlerTable &handlers, EventTypes type, void *target)
 {
-  std::scoped_lock lock{m_mutex};
-  if (HandlerTable::const_iterator index = m_handlers.find(target); index != m_handlers.end()) {
-    const TypeHandlerTable &typeHandlers = index->second;
-    TypeHandlerTable::const_iterator index2 = typeHandlers.find(type);
-    if (index2 != typeHandlers.end()) {
-      return &index2->second;
-    }
+  if (HandlerTable::const_iterator index = handlers.find(target); index != handlers.end()) {
+    return (*index->second)[static_cast<uint32_t>(type)].get();
   }
   return nullptr;
 }
 
 uint32_t EventQueue::saveEvent(const Event &event)
 {
-  // choose id
+  // the ring's ticket doubles as the id
+  const SavedEvent saved{event, Arch::time()};
   uint32_t id;
+  if (m_ring.push(saved, &id)) {
+    return id;
+  }
+
+  // ring is full so fall back to the table
+  std::scoped_lock lock{m_mutex};
+
+  // choose id
   if (!m_oldEventIDs.empty()) {
     // reuse an id
     id = m_oldEventIDs.back();
     m_oldEventIDs.pop_back();
   } else {
     // make a new id
-    id = static_cast<uint32_t>(m_events.size());
+    id = static_cast<uint32_t>(m_events.size()) | kOverflowEventID;
   }
 
   // save data
-  m_events[id] = event;
+  m_events[id] = saved;
   return id;
 }
 
-Event EventQueue::removeEvent(uint32_t eventID)
+EventQueue::SavedEvent EventQueue::removeEvent(uint32_t eventID)
 {
+  if (m_coalescerCount.load() == 0) {
+    return takeEvent(eventID);
+  }
+
+  // once it's out of the queue nothing can be merged into the event
+  std::scoped_lock lock{m_coalesceMutex};
+  SavedEvent saved = takeEvent(eventID);
+  auto index = m_coalescing.find(saved.m_event.getTarget());
+  if (index != m_coalescing.end() && index->second.m_eventID == eventID) {
+    index->second.m_open = false;
+  }
+  return saved;
+}
+
+EventQueue::SavedEvent EventQueue::takeEvent(uint32_t eventID)
+{
+  if ((eventID & kOverflowEventID) == 0) {
+    SavedEvent saved;
+    m_ring.take(eventID, saved);
+    return saved;
+  }
+
+  std::scoped_lock lock{m_mutex};
+
   // look up id
   EventTable::iterator index = m_events.find(eventID);
   if (index == m_events.end()) {
-    return Event();
+    return SavedEvent();
   }
 
   // get data
-  Event event = index->second;
+  SavedEvent saved = index->second;
   m_events.erase(index);
 
   // save old id for reuse
   m_oldEventIDs.push_back(eventID);
 
-  return event;
+  return saved;
+}
+
+bool EventQueue::saveCoalescingEvent(const Event &event, uint32_t &eventID)
+{
+  std::scoped_lock lock{m_coalesceMutex};
+  const auto type = event.getType();
+  const auto &coalescer = m_coalescers[static_cast<uint32_t>(type)];
+
+  // merge into the last event for the target if that's still possible
+  auto index = m_coalescing.find(event.getTarget());
+  if (index != m_coalescing.end() && index->second.m_open && index->second.m_type == type &&
+      mergeEvent(index->second.m_eventID, event)) {
+    Event::deleteData(event);
+    m_stats.eventCoalesced(type);
+    return false;
+  }
+
+  eventID = saveEvent(event);
+
+  // this is now the last event for the target.  only targets that have
+  // had an event that coalesces are tracked.
+  if (coalescer) {
+    m_coalescing.insert_or_assign(event.getTarget(), CoalescingEvent{type, eventID, true});
+  } else if (index != m_coalescing.end()) {
+    index->second.m_open = false;
+  }
+  return true;
+}
+
+bool EventQueue::mergeEvent(uint32_t eventID, const Event &event)
+{
+  // note -- must have m_coalesceMutex locked on entry.  that keeps the
+  // waiting event from being removed while it's being changed.
+  const auto &coalescer = m_coalescers[static_cast<uint32_t>(event.getType())];
+  if ((eventID & kOverflowEventID) == 0) {
+    SavedEvent *saved = m_ring.find(eventID);
+    if (saved == nullptr) {
+      return false;
+    }
+    coalescer(saved->m_event, event);
+    return true;
+  }
+
+  std::scoped_lock lock{m_mutex};
+  EventTable::iterator index = m_events.find(eventID);
+  if (index == m_events.end()) {
+    return false;
+  }
+  coalescer(index->second.m_event, event);
+  return true;
 }
 
 bool EventQueue::hasTimerExpired(Event &event)
@@ -345,36 +543,29 @@ bool EventQueue::hasTimerExpired(Event &event)
   // return true if there's a timer in the timer priority queue that
   // has expired.  if returning true then fill in event appropriately
   // and reset and reinsert the timer.
+  std::scoped_lock lock{m_mutex};
   if (m_timerQueue.empty()) {
     return false;
   }
 
-  // get time elapsed since last check
-  const double time = m_time.getTime();
-  m_time.reset();
-
-  // countdown elapsed time
-  for (auto index = m_timerQueue.begin(); index != m_timerQueue.end(); ++index) {
-    (*index) -= time;
-  }
-
   // done if no timers are expired
-  if (m_timerQueue.top() > 0.0) {
+  const double now = m_time.getTime();
+  Timer *timer = m_timerQueue.front();
+  if (timer->getDeadline() > now) {
     return false;
   }
 
-  // remove timer from queue
-  Timer timer = m_timerQueue.top();
-  m_timerQueue.pop();
-
-  // prepare event and reset the timer's clock
-  timer.fillEvent(m_timerEvent);
-  event = Event(EventTypes::Timer, timer.getTarget(), &m_timerEvent);
-  timer.reset();
+  // prepare event
+  timer->fillEvent(m_timerEvent, now);
+  event = Event(EventTypes::Timer, timer->getTarget(), &m_timerEvent);
 
-  // reinsert timer into queue if it's not a one-shot
-  if (!timer.isOneShot()) {
-    m_timerQueue.push(timer);
+  // a one-shot leaves the queue (it stays known until deleted so it can
+  // be rearmed) while a recurring timer counts down again from now
+  if (timer->isOneShot()) {
+    unscheduleTimer(timer);
+  } else {
+    timer->reset(now);
+    siftTimerDown(0);
   }
 
   return true;
@@ -385,13 +576,89 @@ double EventQueue::getNextTimerTimeout() const
   // return -1 if no timers, 0 if the top timer has expired, otherwise
   // the time until the top timer in the timer priority queue will
   // expire.
+  std::scoped_lock lock{m_mutex};
   if (m_timerQueue.empty()) {
     return -1.0;
   }
-  if (m_timerQueue.top() <= 0.0) {
+  const double timeLeft = m_timerQueue.front()->getDeadline() - m_time.getTime();
+  if (timeLeft <= 0.0) {
     return 0.0;
   }
-  return m_timerQueue.top();
+  return timeLeft;
+}
+
+void EventQueue::scheduleTimer(Timer *timer)
+{
+  // note -- must have m_mutex locked on entry
+  assert(timer->getQueueIndex() == kUnscheduled);
+  m_timerQueue.push_back(timer);
+  placeTimer(timer, m_timerQueue.size() - 1);
+  siftTimerUp(timer->getQueueIndex());
+}
+
+void EventQueue::unscheduleTimer(Timer *timer)
+{
+  // note -- must have m_mutex locked on entry
+  const std::size_t index = timer->getQueueIndex();
+  if (index == kUnscheduled) {
+    return;
+  }
+
+  // move the last timer into the vacated slot and restore heap order
+  Timer *last = m_timerQueue.back();
+  m_timerQueue.pop_back();
+  timer->setQueueIndex(kUnscheduled);
+  if (last != timer) {
+    placeTimer(last, index);
+    siftTimerUp(index);
+    siftTimerDown(last->getQueueIndex());
+  }
+}
+
+void EventQueue::siftTimerUp(std::size_t index)
+{
+  Timer *timer = m_timerQueue[index];
+  while (index > 0) {
+    const std::size_t parent = (index - 1) / 2;
+    if (m_timerQueue[parent]->getDeadline() <= timer->getDeadline()) {
+      break;
+    }
+    placeTimer(m_timerQueue[parent], index);
+    index = parent;
+  }
+  placeTimer(timer, index);
+}
+
+void EventQueue::siftTimerDown(std::size_t index)
+{
+  const std::size_t size = m_timerQueue.size();
+  Timer *timer = m_timerQueue[index];
+  for (;;) {
+    std::size_t child = 2 * index + 1;
+    if (child >= size) {
+      break;
+    }
+    if (child + 1 < size && m_timerQueue[child + 1]->getDeadline() < m_timerQueue[child]->getDeadline()) {
+      ++child;
+    }
+    if (timer->getDeadline() <= m_timerQueue[child]->getDeadline()) {
+      break;
+    }
+    placeTimer(m_timerQueue[child], index);
+    index = child;
+  }
+  placeTimer(timer, index);
+}
+
+void EventQueue::placeTimer(Timer *timer, std::size_t index)
+{
+  m_timerQueue[index] = timer;
+  timer->setQueueIndex(index);
+}
+
+const EventQueueStats &EventQueue::getStats() const
+{
+  return m_stats;
 }
 
 void *EventQueue::getSystemTarget()
@@ -405,8 +672,8 @@ void EventQueue::waitForReady() const
   double timeout = Arch::time() + 10;
   Lock lock(m_readyMutex);
 
-  while (!m_readyCondVar->wait()) {
-    if (Arch::time() > timeout) {
+  while (!*m_readyCondVar) {
+    if (!m_readyCondVar->wait(timeout - Arch::time()) && Arch::time() > timeout) {
       throw std::runtime_error("event queue is not ready within 5 sec");
     }
   }
@@ -416,30 +683,31 @@ void EventQueue::waitForReady() const
 // EventQueue::Timer
 //
 
-EventQueue::Timer::Timer(EventQueueTimer *timer, double timeout, double initialTime, void *target, bool oneShot)
+EventQueue::Timer::Timer(EventQueueTimer *timer, double timeout, double deadline, void *target, bool oneShot)
     : m_timer(timer),
       m_timeout(timeout),
       m_target(target),
       m_oneShot(oneShot),
-      m_time(initialTime)
+      m_deadline(deadline)
 {
   assert(m_timeout > 0.0);
 }
 
-void EventQueue::Timer::reset()
+void EventQueue::Timer::reset(double now)
 {
-  m_time = m_timeout;
+  m_deadline = now + m_timeout;
 }
 
-EventQueue::Timer &EventQueue::Timer::operator-=(double dt)
+void EventQueue::Timer::reset(double now, double timeout)
 {
-  m_time -= dt;
-  return *this;
+  assert(timeout > 0.0);
+  m_timeout = timeout;
+  m_deadline = now + timeout;
 }
 
-EventQueue::Timer::operator double() const
+void EventQueue::Timer::setQueueIndex(std::size_t index)
 {
-  return m_time;
+  m_queueIndex = index;
 }
 
 bool EventQueue::Timer::isOneShot() const
@@ -447,6 +715,16 @@ bool EventQueue::Timer::isOneShot() const
   return m_oneShot;
 }
 
+double EventQueue::Timer::getDeadline() const
+{
+  return m_deadline;
+}
+
+std::size_t EventQueue::Timer::getQueueIndex() const
+{
+  return m_queueIndex;
+}
+
 EventQueueTimer *EventQueue::Timer::getTimer() const
 {
   return m_timer;
@@ -457,11 +735,11 @@ void *EventQueue::Timer::getTarget() const
   return m_target;
 }
 
-void EventQueue::Timer::fillEvent(TimerEvent &event) const
+void EventQueue::Timer::fillEvent(TimerEvent &event, double now) const
 {
   event.m_timer = m_timer;
   event.m_count = 0;
-  if (m_time <= 0.0) {
-    event.m_count = static_cast<uint32_t>((m_timeout - m_time) / m_timeout);
+  if (m_deadline <= now) {
+    event.m_count = static_cast<uint32_t>((m_timeout + now - m_deadline) / m_timeout);
   }
 }
@@ -8,17 +8,22 @@
 
 #pragma once
 
+#include "base/EventQueueStats.h"
 #include "base/EventTypes.h"
 #include "base/IEventQueue.h"
-#include "base/PriorityQueue.h"
+#include "base/MpscRing.h"
 #include "base/Stopwatch.h"
 #include "mt/CondVar.h"
 
+#include <array>
+#include <atomic>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <queue>
-#include <set>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
 
 //! Event queue
 /*!
@@ -44,19 +49,44 @@ public:
   EventQueueTimer *newTimer(double duration, void *target) override;
   EventQueueTimer *newOneShotTimer(double duration, void *target) override;
   void deleteTimer(EventQueueTimer *) override;
+  void resetTimer(EventQueueTimer *, double duration) override;
   void addHandler(EventTypes type, void *target, const EventHandler &handler) override;
   void removeHandler(EventTypes type, void *target) override;
   void removeHandlers(void *target) override;
+  void setCoalescer(EventTypes type, const EventCoalescer &coalescer) override;
   bool isEmpty() const override;
   void *getSystemTarget() override;
   void waitForReady() const override;
 
+  //! @name accessors
+  //@{
+
+  //! Get the queue's statistics
+  /*!
+  The statistics are also written to the log when a
+  \c EventQueueDumpStats event reaches the system target, which the
+  queue sends itself on the user signal (SIGUSR2).
+  */
+  const EventQueueStats &getStats() const;
+
+  //@}
+
 private:
-  const EventHandler *getHandler(EventTypes type, void *target) const;
+  // an event waiting in the queue and the time it was added
+  struct SavedEvent
+  {
+    Event m_event;
+    double m_time = 0.0;
+  };
+
   uint32_t saveEvent(const Event &event);
-  Event removeEvent(uint32_t eventID);
+  bool saveCoalescingEvent(const Event &event, uint32_t &eventID);
+  bool mergeEvent(uint32_t eventID, const Event &event);
+  SavedEvent removeEvent(uint32_t eventID);
+  SavedEvent takeEvent(uint32_t eventID);
   bool hasTimerExpired(Event &event);
   double getNextTimerTimeout() const;
+  EventQueueTimer *addTimer(double duration, void *target, bool oneShot);
   void addEventToBuffer(const Event &event);
 
   //!
@@ -69,56 +99,116 @@ private:
   bool processEvent(Event &event, double timeout, Stopwatch &timer);
 
 private:
+  static constexpr std::size_t kUnscheduled = static_cast<std::size_t>(-1);
+
   class Timer
   {
   public:
-    Timer(EventQueueTimer *, double timeout, double initialTime, void *target, bool oneShot);
+    Timer(EventQueueTimer *, double timeout, double deadline, void *target, bool oneShot);
     ~Timer() = default;
 
-    void reset();
-
-    Timer &operator-=(double);
+    void reset(double now);
+    void reset(double now, double timeout);
 
-    operator double() const;
+    void setQueueIndex(std::size_t);
 
     bool isOneShot() const;
+    double getDeadline() const;
+    std::size_t getQueueIndex() const;
     EventQueueTimer *getTimer() const;
     void *getTarget() const;
-    void fillEvent(TimerEvent &) const;
+    void fillEvent(TimerEvent &, double now) const;
 
   private:
     EventQueueTimer *m_timer;
     double m_timeout;
     void *m_target;
     bool m_oneShot;
-    double m_time;
+    double m_deadline;
+    std::size_t m_queueIndex = kUnscheduled;
   };
 
-  using Timers = std::set<EventQueueTimer *>;
-  using TimerQueue = PriorityQueue<Timer>;
-  using EventTable = std::map<uint32_t, Event>;
+  // timer queue.  a binary min-heap ordered on absolute deadlines where
+  // each timer knows its own slot, so that removing or rearming a timer
+  // is a sift from that slot instead of a scan and rebuild of the heap.
+  void scheduleTimer(Timer *);
+  void unscheduleTimer(Timer *);
+  void siftTimerUp(std::size_t index);
+  void siftTimerDown(std::size_t index);
+  void placeTimer(Timer *, std::size_t index);
+
+  using Timers = std::map<EventQueueTimer *, Timer>;
+  using TimerQueue = std::vector<Timer *>;
+  using EventTable = std::map<uint32_t, SavedEvent>;
   using EventIDList = std::vector<uint32_t>;
-  using TypeHandlerTable = std::map<EventTypes, EventHandler>;
-  using HandlerTable = std::map<void *, TypeHandlerTable>;
+
+  // handlers for one target, indexed by event type
+  using TypeHandlerTable = std::array<std::shared_ptr<const EventHandler>, deskflow::kEventTypeCount>;
+
+  // an immutable snapshot of all handlers.  a change copies the snapshot
+  // (sharing the per-target tables that didn't change) and publishes the
+  // copy, so dispatching never has to lock.
+  using HandlerTable = std::unordered_map<void *, std::shared_ptr<const TypeHandlerTable>>;
+
+  static const EventHandler *getHandler(const HandlerTable &handlers, EventTypes type, void *target);
+  void publishHandlers(std::unique_ptr<HandlerTable> handlers);
+  void reclaimHandlers();
 
   int m_systemTarget = 0;
   mutable std::mutex m_mutex;
 
-  // buffer of events
+  // buffer of events.  adding events holds m_bufferMutex shared so the
+  // buffer can't be swapped out underneath, adoptBuffer() holds it
+  // exclusively.
+  std::shared_mutex m_bufferMutex;
   std::unique_ptr<IEventQueueBuffer> m_buffer;
 
-  // saved events
+  // saved events.  they normally live in m_ring, which needs no locking.
+  // only when it's full do they spill into m_events, under m_mutex, with
+  // kOverflowEventID set in their id.
+  static constexpr uint32_t kEventRingSize = 1024;
+  static constexpr uint32_t kOverflowEventID = 0x80000000;
+  MpscRing<SavedEvent> m_ring{kEventRingSize};
   EventTable m_events;
   EventIDList m_oldEventIDs;
 
-  // timers
+  // timers.  deadlines are absolute times on m_time, which is never
+  // reset, so nothing needs adjusting as time passes.
   Stopwatch m_time;
   Timers m_timers;
   TimerQueue m_timerQueue;
   TimerEvent m_timerEvent;
 
-  // event handlers
-  HandlerTable m_handlers;
+  // event handlers.  readers count themselves in m_handlerReaders while
+  // using the snapshot in m_handlers.  replaced snapshots are retired and
+  // only freed once no reader is left that could still be using them.
+  std::mutex m_handlerMutex;
+  std::unique_ptr<HandlerTable> m_handlerTable;
+  std::atomic<const HandlerTable *> m_handlers = nullptr;
+  std::atomic<uint32_t> m_handlerReaders = 0;
+  std::atomic<bool> m_hasRetiredHandlers = false;
+  std::vector<std::unique_ptr<HandlerTable>> m_retiredHandlers;
+
+  // coalescing.  m_coalescers holds the merge function of each event
+  // type that coalesces.  m_coalescing holds, for each target, the last
+  // event added for it, which is open to merging if it's of such a type
+  // and still waiting.  entries are closed rather than erased so that
+  // adding events doesn't allocate.  m_coalescerCount lets adding and
+  // removing events skip all this while nothing coalesces.
+  class CoalescingEvent
+  {
+  public:
+    EventTypes m_type;
+    uint32_t m_eventID;
+    bool m_open;
+  };
+
+  std::mutex m_coalesceMutex;
+  std::array<EventCoalescer, deskflow::kEventTypeCount> m_coalescers;
+  std::unordered_map<void *, CoalescingEvent> m_coalescing;
+  std::atomic<uint32_t> m_coalescerCount = 0;
+
+  EventQueueStats m_stats;
 
   Mutex *m_readyMutex = nullptr;
   CondVar<bool> *m_readyCondVar = nullptr;
@@ -0,0 +1,142 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include "base/EventQueueStats.h"
+
+#include "base/Log.h"
+
+#include <algorithm>
+#include <bit>
+
+using deskflow::EventTypes;
+
+//
+// EventQueueStats
+//
+
+void EventQueueStats::eventAdded(EventTypes type)
+{
+  getAtomicTypeStats(type).m_added.fetch_add(1, std::memory_order_relaxed);
+}
+
+void EventQueueStats::eventQueued()
+{
+  const size_t pending = m_pending.fetch_add(1, std::memory_order_relaxed) + 1;
+  size_t highWaterMark = m_pendingHighWaterMark.load(std::memory_order_relaxed);
+  while (pending > highWaterMark &&
+         !m_pendingHighWaterMark.compare_exchange_weak(highWaterMark, pending, std::memory_order_relaxed)) {
+    // highWaterMark was reloaded, try again
+  }
+}
+
+void EventQueueStats::eventUnqueued(EventTypes type, double waited)
+{
+  m_pending.fetch_sub(1, std::memory_order_relaxed);
+  record(getAtomicTypeStats(type).m_queueTime, waited);
+}
+
+void EventQueueStats::eventDiscarded(size_t count)
+{
+  m_pending.fetch_sub(count, std::memory_order_relaxed);
+}
+
+void EventQueueStats::eventCoalesced(EventTypes type)
+{
+  getAtomicTypeStats(type).m_coalesced.fetch_add(1, std::memory_order_relaxed);
+}
+
+void EventQueueStats::eventDispatched(EventTypes type, double duration)
+{
+  // the dispatch count is the total of the histogram
+  record(getAtomicTypeStats(type).m_handlerTime, duration);
+}
+
+EventQueueStats::TypeStats EventQueueStats::getTypeStats(EventTypes type) const
+{
+  const AtomicTypeStats &stats = m_types[static_cast<uint32_t>(type)];
+  TypeStats copy;
+  copy.m_added = stats.m_added.load(std::memory_order_relaxed);
+  copy.m_coalesced = stats.m_coalesced.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < kHistogramBuckets; ++i) {
+    copy.m_queueTime[i] = stats.m_queueTime[i].load(std::memory_order_relaxed);
+    copy.m_handlerTime[i] = stats.m_handlerTime[i].load(std::memory_order_relaxed);
+    copy.m_dispatched += copy.m_handlerTime[i];
+  }
+  return copy;
+}
+
+size_t EventQueueStats::getPending() const
+{
+  return m_pending.load(std::memory_order_relaxed);
+}
+
+size_t EventQueueStats::getPendingHighWaterMark() const
+{
+  return m_pendingHighWaterMark.load(std::memory_order_relaxed);
+}
+
+void EventQueueStats::log() const
+{
+  LOG_NOTE(
+      "event queue: %llu pending, high-water mark %llu", static_cast<unsigned long long>(getPending()),
+      static_cast<unsigned long long>(getPendingHighWaterMark())
+  );
+
+  // event types have no names so they're logged by number
+  for (uint32_t i = 0; i < deskflow::kEventTypeCount; ++i) {
+    const TypeStats stats = getTypeStats(static_cast<EventTypes>(i));
+    if (stats.m_added == 0 && stats.m_dispatched == 0) {
+      continue;
+    }
+    LOG_NOTE(
+        "event type %u: added %llu, coalesced %llu, dispatched %llu, queue time p50/p99/max %llu/%llu/%lluus, "
+        "handler time p50/p99/max %llu/%llu/%lluus",
+        i, static_cast<unsigned long long>(stats.m_added), static_cast<unsigned long long>(stats.m_coalesced),
+        static_cast<unsigned long long>(stats.m_dispatched),
+        static_cast<unsigned long long>(getPercentile(stats.m_queueTime, 0.5)),
+        static_cast<unsigned long long>(getPercentile(stats.m_queueTime, 0.99)),
+        static_cast<unsigned long long>(getPercentile(stats.m_queueTime, 1.0)),
+        static_cast<unsigned long long>(getPercentile(stats.m_handlerTime, 0.5)),
+        static_cast<unsigned long long>(getPercentile(stats.m_handlerTime, 0.99)),
+        static_cast<unsigned long long>(getPercentile(stats.m_handlerTime, 1.0))
+    );
+  }
+}
+
+uint64_t EventQueueStats::getPercentile(const Histogram &histogram, double fraction)
+{
+  uint64_t total = 0;
+  for (const auto count : histogram) {
+    total += count;
+  }
+  if (total == 0) {
+    return 0;
+  }
+
+  // the rank of the wanted duration, counting from 1
+  const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(fraction * static_cast<double>(total) + 0.5));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kHistogramBuckets; ++i) {
+    seen += histogram[i];
+    if (seen >= rank) {
+      return uint64_t(1) << i;
+    }
+  }
+  return uint64_t(1) << (kHistogramBuckets - 1);
+}
+
+void EventQueueStats::record(AtomicHistogram &histogram, double duration)
+{
+  // bucket by the number of bits in the whole microseconds
+  const auto micros = static_cast<uint64_t>(std::max(duration, 0.0) * 1000000.0);
+  const auto bucket = std::min<size_t>(std::bit_width(micros), kHistogramBuckets - 1);
+  histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+EventQueueStats::AtomicTypeStats &EventQueueStats::getAtomicTypeStats(EventTypes type)
+{
+  return m_types[static_cast<uint32_t>(type)];
+}
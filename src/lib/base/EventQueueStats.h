@@ -0,0 +1,124 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#pragma once
+
+#include "base/EventTypes.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+//! Event queue statistics
+/*!
+Keeps per event type counts of events added and dispatched, histograms
+of how long events waited in the queue and how long their handler ran,
+and the largest number of events that were ever waiting at once.
+
+Recording is a handful of relaxed atomic increments so it is always on.
+Any thread may record or read.  A reader racing with a recording thread
+may see counts that are slightly out of step with each other.
+*/
+class EventQueueStats
+{
+public:
+  //! Number of histogram buckets
+  /*!
+  Bucket 0 counts durations under 1us and bucket \c i those from 2^(i-1)
+  up to 2^i us.  The last bucket, from about 4s, also counts anything longer.
+  */
+  static constexpr size_t kHistogramBuckets = 24;
+
+  using Histogram = std::array<uint64_t, kHistogramBuckets>;
+
+  //! Statistics for one event type
+  struct TypeStats
+  {
+    uint64_t m_added = 0;
+    uint64_t m_dispatched = 0;
+    uint64_t m_coalesced = 0;
+    Histogram m_queueTime{};
+    Histogram m_handlerTime{};
+  };
+
+  EventQueueStats() = default;
+  EventQueueStats(EventQueueStats const &) = delete;
+  EventQueueStats(EventQueueStats &&) = delete;
+  ~EventQueueStats() = default;
+
+  EventQueueStats &operator=(EventQueueStats const &) = delete;
+  EventQueueStats &operator=(EventQueueStats &&) = delete;
+
+  //! @name manipulators
+  //@{
+
+  //! Count an event of type \p type passed to the queue
+  void eventAdded(deskflow::EventTypes type);
+
+  //! Count an event that is now waiting in the queue
+  void eventQueued();
+
+  //! Count an event of type \p type that left the queue after \p waited seconds
+  void eventUnqueued(deskflow::EventTypes type, double waited);
+
+  //! Count \p count events that were thrown away while waiting in the queue
+  void eventDiscarded(size_t count = 1);
+
+  //! Count an event of type \p type merged into one already waiting in the queue
+  void eventCoalesced(deskflow::EventTypes type);
+
+  //! Count an event of type \p type whose handler ran for \p duration seconds
+  void eventDispatched(deskflow::EventTypes type, double duration);
+
+  //@}
+  //! @name accessors
+  //@{
+
+  //! Get a copy of the statistics for events of type \p type
+  TypeStats getTypeStats(deskflow::EventTypes type) const;
+
+  //! Get the number of events waiting in the queue
+  size_t getPending() const;
+
+  //! Get the largest number of events that were ever waiting in the queue
+  size_t getPendingHighWaterMark() const;
+
+  //! Write the statistics to the log
+  /*!
+  Logs one line for the queue and one for each event type that has been
+  added or dispatched at least once.
+  */
+  void log() const;
+
+  //! Get a percentile of a histogram
+  /*!
+  Returns the upper bound in microseconds of the bucket holding the
+  \p fraction (0 to 1) point of the durations counted by \p histogram,
+  or 0 if it's empty.
+  */
+  static uint64_t getPercentile(const Histogram &histogram, double fraction);
+
+  //@}
+
+private:
+  using AtomicHistogram = std::array<std::atomic<uint64_t>, kHistogramBuckets>;
+
+  struct AtomicTypeStats
+  {
+    std::atomic<uint64_t> m_added = 0;
+    std::atomic<uint64_t> m_coalesced = 0;
+    AtomicHistogram m_queueTime{};
+    AtomicHistogram m_handlerTime{};
+  };
+
+  static void record(AtomicHistogram &histogram, double duration);
+  AtomicTypeStats &getAtomicTypeStats(deskflow::EventTypes type);
+
+  std::array<AtomicTypeStats, deskflow::kEventTypeCount> m_types{};
+  std::atomic<size_t> m_pending = 0;
+  std::atomic<size_t> m_pendingHighWaterMark = 0;
+};
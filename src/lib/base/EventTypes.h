@@ -25,6 +25,11 @@ enum class EventTypes : uint32_t
   /// This event is sent when a timer event occurs. The data is pointer to TimerInfo.
   Timer,
 
+  /** This event is sent to the system target to write the event queue's statistics to the log.
+      The queue sends it itself on the user signal.
+  */
+  EventQueueDumpStats,
+
   /// This event is sent when the client has successfully connected to the server.
   ClientConnected,
 
@@ -81,6 +86,9 @@ enum class EventTypes : uint32_t
   /// A socket sends this event when a remote connection is waiting to be accepted.
   ListenSocketConnecting,
 
+  /// A datagram socket sends this event when \c receive() will return a datagram.
+  DatagramSocketReady,
+
   /** A socket sends this event when the remote side of the socket has disconnected or
       shutdown both input and output.
   */
@@ -104,6 +112,11 @@ enum class EventTypes : uint32_t
   */
   ClientProxyDisconnected,
 
+  /** This event is sent by a client proxy to itself to send the mouse motion batched since it
+      was sent.  The target is the client proxy.
+  */
+  ClientProxyMotionReady,
+
   /** This event is sent when the client has correctly responded to the hello message.
       The target is this.
   */
@@ -227,9 +240,19 @@ enum class EventTypes : uint32_t
   /// This event is sent whenever a clipboard chunk is transferred.
   ClipboardSending,
 
+  /** This event is sent when something asks for the data of an offered
+      clipboard, which hasn't arrived yet.  The data is a pointer to a
+      ClipboardInfo.
+  */
+  ClipboardRequested,
+
   /// Start libEI
   EIConnected,
   /// Stop libEi
   EISessionClosed
 };
+
+//! Number of event types, the last type above must be used here
+inline constexpr auto kEventTypeCount = static_cast<uint32_t>(EventTypes::EISessionClosed) + 1;
+
 } // namespace deskflow
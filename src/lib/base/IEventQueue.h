@@ -31,6 +31,7 @@ class IEventQueue
 {
 public:
   using EventHandler = std::function<void(const Event &)>;
+  using EventCoalescer = std::function<void(Event &waiting, const Event &added)>;
 
   virtual ~IEventQueue() = default;
   class TimerEvent
@@ -118,6 +119,16 @@ public:
   */
   virtual void deleteTimer(EventQueueTimer *) = 0;
 
+  //! Rearm a timer
+  /*!
+  Restarts the countdown of a timer previously returned by \c newTimer()
+  or \c newOneShotTimer() so that it next expires \p duration seconds
+  from now.  A one-shot timer that has already expired is rearmed.  This
+  is the cheap way to push back a deadline (e.g. a heartbeat alarm) as it
+  neither allocates nor recreates the timer.
+  */
+  virtual void resetTimer(EventQueueTimer *, double duration) = 0;
+
   //! Register an event handler for an event type
   /*!
   Registers an event handler for \p type and \p target.  The \p handler
@@ -141,6 +152,17 @@ public:
   */
   virtual void removeHandlers(void *target) = 0;
 
+  //! Merge events of a type while they wait in the queue
+  /*!
+  Makes events of \p type coalesce.  An event added for a target while an
+  event of the same type for that target is still waiting in the queue,
+  with nothing else added for that target since, is not queued.  Instead
+  \p coalescer is called to fold its data into the waiting event.  Any
+  previous coalescer for \p type is replaced.  An empty \p coalescer
+  stops events of \p type from coalescing.
+  */
+  virtual void setCoalescer(EventTypes type, const EventCoalescer &coalescer) = 0;
+
   //! Wait for event queue to become ready
   /*!
   Blocks on the current thread until the event queue is ready for events to
@@ -0,0 +1,183 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#pragma once
+
+#include <assert.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+//! Bounded lock-free multi-producer, single-consumer ring
+/*!
+Any number of threads can push values while one thread removes them.
+Each side costs a couple of atomic operations, with no locking and no
+allocation.  A push claims the next slot and returns a ticket for it.
+A push fails when that slot is still in use, in which case the caller
+has to keep the value some other way.
+
+The consumer either pops values in the order their slots were claimed
+or takes them by ticket in any order.  A ring must only be used in one
+of those two ways.  The capacity must be a power of two of at least 2.
+*/
+template <class T> class MpscRing
+{
+public:
+  //! Tickets always fit in these bits
+  static constexpr uint32_t kTicketMask = 0x7fffffff;
+
+  explicit MpscRing(uint32_t capacity) : m_capacity(capacity), m_mask(capacity - 1), m_slots(new Slot[capacity])
+  {
+    assert(capacity >= 2 && (capacity & m_mask) == 0 && capacity <= kTicketMask);
+    for (uint32_t i = 0; i < capacity; ++i) {
+      m_slots[i].m_sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MpscRing(MpscRing const &) = delete;
+  MpscRing(MpscRing &&) = delete;
+  ~MpscRing() = default;
+
+  MpscRing &operator=(MpscRing const &) = delete;
+  MpscRing &operator=(MpscRing &&) = delete;
+
+  //! @name manipulators
+  //@{
+
+  //! Add a value
+  /*!
+  Copies \p value into the next slot and returns true, filling in
+  \p ticket if it isn't nullptr.  Returns false if the ring is full.
+  May be called from any thread.
+  */
+  bool push(const T &value, uint32_t *ticket = nullptr)
+  {
+    uint64_t position = m_tail.load(std::memory_order_relaxed);
+    Slot *slot;
+    for (;;) {
+      slot = &m_slots[position & m_mask];
+      const uint64_t sequence = slot->m_sequence.load(std::memory_order_acquire);
+      if (sequence == position) {
+        // slot is free for this lap, try to claim it
+        if (m_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (sequence < position) {
+        // slot still holds a value from the previous lap
+        return false;
+      } else {
+        // another producer claimed the slot first
+        position = m_tail.load(std::memory_order_relaxed);
+      }
+    }
+
+    slot->m_value = value;
+    slot->m_sequence.store(position + 1, std::memory_order_release);
+    if (ticket != nullptr) {
+      *ticket = static_cast<uint32_t>(position) & kTicketMask;
+    }
+    return true;
+  }
+
+  //! Remove the oldest value
+  /*!
+  Moves the value in the oldest claimed slot into \p value and returns
+  true.  Returns false if the ring is empty or the producer of the
+  oldest slot hasn't finished writing it yet.  Consumer only.
+  */
+  bool pop(T &value)
+  {
+    Slot &slot = m_slots[m_head & m_mask];
+    if (slot.m_sequence.load(std::memory_order_acquire) != m_head + 1) {
+      return false;
+    }
+    value = std::move(slot.m_value);
+    slot.m_value = T();
+    slot.m_sequence.store(m_head + m_capacity, std::memory_order_release);
+    ++m_head;
+    return true;
+  }
+
+  //! Remove a value by ticket
+  /*!
+  Moves the value pushed with \p ticket into \p value and returns true.
+  Returns false if no such value is stored.  Consumer only, or the
+  producer that was handed \p ticket if it never passed it on.
+  */
+  bool take(uint32_t ticket, T &value)
+  {
+    Slot &slot = m_slots[ticket & m_mask];
+    const uint64_t sequence = slot.m_sequence.load(std::memory_order_acquire);
+    if ((static_cast<uint32_t>(sequence - 1) & kTicketMask) != ticket) {
+      return false;
+    }
+    value = std::move(slot.m_value);
+    slot.m_value = T();
+    slot.m_sequence.store(sequence - 1 + m_capacity, std::memory_order_release);
+    return true;
+  }
+
+  //! Look up a value by ticket
+  /*!
+  Returns the value pushed with \p ticket, or nullptr if no such value
+  is stored.  The caller must make sure the value isn't removed while
+  it's using it.
+  */
+  T *find(uint32_t ticket)
+  {
+    Slot &slot = m_slots[ticket & m_mask];
+    const uint64_t sequence = slot.m_sequence.load(std::memory_order_acquire);
+    if ((static_cast<uint32_t>(sequence - 1) & kTicketMask) != ticket) {
+      return nullptr;
+    }
+    return &slot.m_value;
+  }
+
+  //! Remove every stored value
+  /*!
+  Calls \p function with each value that has been fully pushed and not
+  yet removed, then frees its slot.  For rings used by ticket only.
+  */
+  template <class Function> void takeAll(Function function)
+  {
+    for (uint32_t i = 0; i < m_capacity; ++i) {
+      const uint64_t sequence = m_slots[i].m_sequence.load(std::memory_order_acquire);
+      if (T value; ((sequence - 1) & m_mask) == i && take(static_cast<uint32_t>(sequence - 1) & kTicketMask, value)) {
+        function(value);
+      }
+    }
+  }
+
+  //@}
+  //! @name accessors
+  //@{
+
+  //! Check for a value to pop
+  /*!
+  Returns true if pop() would fail.  Consumer only.
+  */
+  bool empty() const
+  {
+    return m_slots[m_head & m_mask].m_sequence.load(std::memory_order_acquire) != m_head + 1;
+  }
+
+  //@}
+
+private:
+  struct Slot
+  {
+    std::atomic<uint64_t> m_sequence;
+    T m_value;
+  };
+
+  const uint32_t m_capacity;
+  const uint64_t m_mask;
+  std::unique_ptr<Slot[]> m_slots;
+
+  // producers and the consumer each get their own cache line
+  alignas(64) std::atomic<uint64_t> m_tail = 0;
+  alignas(64) uint64_t m_head = 0;
+};
@@ -7,6 +7,7 @@
 
 #include "base/SimpleEventQueueBuffer.h"
 #include "arch/Arch.h"
+#include "base/FinalAction.h"
 #include "base/Stopwatch.h"
 
 class EventQueueTimer
@@ -31,9 +32,20 @@ SimpleEventQueueBuffer::~SimpleEventQueueBuffer()
 
 void SimpleEventQueueBuffer::waitForEvent(double timeout)
 {
+  if (!isEmpty()) {
+    return;
+  }
+
   ArchMutexLock lock(m_queueMutex);
   Stopwatch timer(true);
-  while (!m_queueReady) {
+
+  // announce that we're about to sleep, then check again.  a writer
+  // either sees the flag and signals us, or we see its event.
+  m_waiting = true;
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  auto done = deskflow::finally([this] { m_waiting = false; });
+
+  while (isEmpty()) {
     double timeLeft = timeout;
     if (timeLeft >= 0.0) {
       timeLeft -= timer.getTime();
@@ -47,22 +59,35 @@ void SimpleEventQueueBuffer::waitForEvent(double timeout)
 
 IEventQueueBuffer::Type SimpleEventQueueBuffer::getEvent(Event &, uint32_t &dataID)
 {
+  if (m_queue.pop(dataID)) {
+    return IEventQueueBuffer::Type::User;
+  }
+  if (!m_overflowing) {
+    return IEventQueueBuffer::Type::Unknown;
+  }
+
   ArchMutexLock lock(m_queueMutex);
-  if (!m_queueReady) {
+  if (m_overflow.empty()) {
     return IEventQueueBuffer::Type::Unknown;
   }
-  dataID = m_queue.back();
-  m_queue.pop_back();
-  m_queueReady = !m_queue.empty();
+  dataID = m_overflow.front();
+  m_overflow.pop_front();
+  m_overflowing = !m_overflow.empty();
   return IEventQueueBuffer::Type::User;
 }
 
 bool SimpleEventQueueBuffer::addEvent(uint32_t dataID)
 {
+  // keep to the overflow while it has ids in it so the order is kept
+  if (!m_overflowing && m_queue.push(dataID)) {
+    wakeReader();
+    return true;
+  }
+
   ArchMutexLock lock(m_queueMutex);
-  m_queue.push_front(dataID);
-  if (!m_queueReady) {
-    m_queueReady = true;
+  m_overflow.push_back(dataID);
+  m_overflowing = true;
+  if (m_waiting) {
     ARCH->broadcastCondVar(m_queueReadyCond);
   }
   return true;
@@ -70,8 +95,17 @@ bool SimpleEventQueueBuffer::addEvent(uint32_t dataID)
 
 bool SimpleEventQueueBuffer::isEmpty() const
 {
-  ArchMutexLock lock(m_queueMutex);
-  return !m_queueReady;
+  return m_queue.empty() && !m_overflowing;
+}
+
+void SimpleEventQueueBuffer::wakeReader()
+{
+  // pairs with the fence in waitForEvent()
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (m_waiting) {
+    ArchMutexLock lock(m_queueMutex);
+    ARCH->broadcastCondVar(m_queueReadyCond);
+  }
 }
 
 EventQueueTimer *SimpleEventQueueBuffer::newTimer(double, bool) const
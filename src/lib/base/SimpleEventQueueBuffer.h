@@ -9,11 +9,15 @@
 
 #include "arch/IArchMultithread.h"
 #include "base/IEventQueueBuffer.h"
+#include "base/MpscRing.h"
 
+#include <atomic>
 #include <deque>
 //! In-memory event queue buffer
 /*!
 An event queue buffer provides a queue of events for an IEventQueue.
+Adding an event doesn't lock unless the reader is asleep or the queue
+has overflowed.
 */
 class SimpleEventQueueBuffer : public IEventQueueBuffer
 {
@@ -41,8 +45,19 @@ public:
 private:
   using EventDeque = std::deque<uint32_t>;
 
+  void wakeReader();
+
+  static constexpr uint32_t kQueueSize = 1024;
+
+  // ids normally go through m_queue.  once it fills up they go into
+  // m_overflow, under m_queueMutex, until the reader has emptied that.
+  MpscRing<uint32_t> m_queue{kQueueSize};
+  EventDeque m_overflow;
+  std::atomic<bool> m_overflowing = false;
+
+  // the reader sets m_waiting, under m_queueMutex, before it sleeps on
+  // m_queueReadyCond.  writers only lock and signal if it's set.
   ArchMutex m_queueMutex;
   ArchCond m_queueReadyCond;
-  bool m_queueReady = false;
-  EventDeque m_queue;
+  std::atomic<bool> m_waiting = false;
 };
@@ -14,6 +14,7 @@
 #include "base/TMethodJob.h"
 #include "client/ServerProxy.h"
 #include "deskflow/AppUtil.h"
+#include "deskflow/ClipboardOffer.h"
 #include "deskflow/DeskflowException.h"
 #include "deskflow/IPlatformScreen.h"
 #include "deskflow/PacketStreamFilter.h"
@@ -23,6 +24,7 @@
 #include "deskflow/StreamChunker.h"
 #include "mt/Thread.h"
 #include "net/IDataSocket.h"
+#include "net/IDatagramSocket.h"
 #include "net/ISocketFactory.h"
 #include "net/SecureSocket.h"
 #include "net/TCPSocket.h"
@@ -233,6 +235,7 @@ void Client::setClipboard(ClipboardID id, const IClipboard *clipboard)
   m_screen->setClipboard(id, clipboard);
   m_ownClipboard[id] = false;
   m_sentClipboard[id] = false;
+  m_offeredClipboard[id] = false;
 }
 
 void Client::grabClipboard(ClipboardID id)
@@ -240,6 +243,19 @@ void Client::grabClipboard(ClipboardID id)
   m_screen->grabClipboard(id);
   m_ownClipboard[id] = false;
   m_sentClipboard[id] = false;
+  m_offeredClipboard[id] = false;
+}
+
+void Client::offerClipboard(ClipboardID id, const ClipboardOffer &offer)
+{
+  m_ownClipboard[id] = false;
+  m_sentClipboard[id] = false;
+
+  // the data is only fetched when it's pasted, if the screen can wait
+  m_offeredClipboard[id] = m_screen->offerClipboard(id, offer.getFormats());
+  if (!m_offeredClipboard[id]) {
+    m_server->requestClipboard(id);
+  }
 }
 
 void Client::setClipboardDirty(ClipboardID, bool)
@@ -431,12 +447,32 @@ void Client::setupScreen()
 
   m_ready = false;
   m_server = new ServerProxy(this, m_stream, m_events);
+  m_server->setSmoothMotion(m_args.m_smoothMotion);
+  if (m_args.m_fastMotion) {
+    setupFastChannel();
+  }
   m_events->addHandler(EventTypes::ScreenShapeChanged, getEventTarget(), [this](const auto &) {
     handleShapeChanged();
   });
   m_events->addHandler(EventTypes::ClipboardGrabbed, getEventTarget(), [this](const auto &e) {
     handleClipboardGrabbed(e);
   });
+  m_events->addHandler(EventTypes::ClipboardRequested, getEventTarget(), [this](const auto &e) {
+    handleClipboardRequested(e);
+  });
+}
+
+void Client::setupFastChannel()
+{
+  // a UDP socket to the server's port, for the fast channel it may offer
+  try {
+    const auto family = ARCH->getAddrFamily(m_serverAddress.getAddress());
+    std::unique_ptr<IDatagramSocket> socket(m_socketFactory->createDatagram(family));
+    socket->connect(m_serverAddress);
+    m_server->setFastChannel(socket.release());
+  } catch (BaseException &e) {
+    LOG_WARN("cannot open fast channel: %s", e.what());
+  }
 }
 
 void Client::setupTimer()
@@ -480,12 +516,21 @@ void Client::cleanupConnection()
 void Client::cleanupScreen()
 {
   if (m_server != nullptr) {
+    // the data of offered clipboards won't come now, so don't keep
+    // anything waiting for it
+    for (ClipboardID id = 0; id < kClipboardEnd; ++id) {
+      if (m_offeredClipboard[id]) {
+        Clipboard clipboard;
+        setClipboard(id, &clipboard);
+      }
+    }
     if (m_ready) {
       m_screen->disable();
       m_ready = false;
     }
     m_events->removeHandler(EventTypes::ScreenShapeChanged, getEventTarget());
     m_events->removeHandler(EventTypes::ClipboardGrabbed, getEventTarget());
+    m_events->removeHandler(EventTypes::ClipboardRequested, getEventTarget());
     delete m_server;
     m_server = nullptr;
   }
@@ -580,6 +625,7 @@ void Client::handleClipboardGrabbed(const Event &event)
   // we now own the clipboard and it has not been sent to the server
   m_ownClipboard[info->m_id] = true;
   m_sentClipboard[info->m_id] = false;
+  m_offeredClipboard[info->m_id] = false;
   m_timeClipboard[info->m_id] = 0;
 
   // if we're not the active screen then send the clipboard now,
@@ -589,6 +635,14 @@ void Client::handleClipboardGrabbed(const Event &event)
   }
 }
 
+void Client::handleClipboardRequested(const Event &event)
+{
+  const auto *info = static_cast<const IScreen::ClipboardInfo *>(event.getData());
+  if (m_offeredClipboard[info->m_id]) {
+    m_server->requestClipboard(info->m_id);
+  }
+}
+
 void Client::handleHello()
 {
   m_pHelloBack->handleHello(m_stream, m_name);
@@ -20,6 +20,7 @@
 #include <climits>
 #include <memory>
 
+class ClipboardOffer;
 class EventQueueTimer;
 namespace deskflow {
 class Screen;
@@ -98,6 +99,14 @@ public:
   */
   virtual void handshakeComplete();
 
+  //! Offer clipboard
+  /*!
+  Takes ownership of clipboard \p id with the formats of \p offer and
+  fetches the data when it's asked for, or straight away if the screen
+  can't wait for it.  The data arrives with setClipboard().
+  */
+  void offerClipboard(ClipboardID id, const ClipboardOffer &offer);
+
   //@}
   //! @name accessors
   //@{
@@ -128,6 +137,16 @@ public:
     return m_resolvedAddressesCount;
   }
 
+  //! Get the maximum clipboard size
+  /*!
+  Returns the size in bytes of the largest clipboard that's shared, as
+  set by the server.
+  */
+  size_t getMaximumClipboardSize() const
+  {
+    return m_maximumClipboardSize * 1024;
+  }
+
   //@}
 
   // IScreen overrides
@@ -162,6 +181,7 @@ private:
   void setupConnecting();
   void setupConnection();
   void setupScreen();
+  void setupFastChannel();
   void setupTimer();
   void cleanup();
   void cleanupConnecting();
@@ -176,6 +196,7 @@ private:
   void handleDisconnected();
   void handleShapeChanged();
   void handleClipboardGrabbed(const Event &event);
+  void handleClipboardRequested(const Event &event);
   void handleHello();
   void handleSuspend();
   void handleResume();
@@ -196,6 +217,7 @@ private:
   bool m_connectOnResume = false;
   bool m_ownClipboard[kClipboardEnd];
   bool m_sentClipboard[kClipboardEnd];
+  bool m_offeredClipboard[kClipboardEnd] = {};
   IClipboard::Time m_timeClipboard[kClipboardEnd];
   std::string m_dataClipboard[kClipboardEnd];
   IEventQueue *m_events = nullptr;
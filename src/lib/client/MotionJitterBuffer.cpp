@@ -0,0 +1,93 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include "client/MotionJitterBuffer.h"
+
+#include <algorithm>
+#include <cmath>
+
+// how quickly the jitter follows what's measured, as in RFC 3550
+static const double s_jitterGain = 1.0 / 16.0;
+
+// delay added for each unit of jitter, and the most that's ever added
+static const double s_delayPerJitter = 3.0;
+static const double s_maxDelay = 0.05;
+
+// how quickly the least transit time follows transit times above it
+static const double s_baseTransitGain = 1.0 / 256.0;
+
+// how quickly the average time held follows each sample's
+static const double s_heldGain = 1.0 / 16.0;
+
+//
+// MotionJitterBuffer
+//
+
+void MotionJitterBuffer::add(const MotionBatch::Sample &sample, double now)
+{
+  // measure how long the sample took to arrive, against when the samples
+  // before it did.  only differences count, so the clocks needn't agree.
+  m_taken += m_started ? sample.m_offset / 1000000.0 : 0.0;
+  const double transit = now - m_taken;
+  if (!m_started) {
+    m_started = true;
+    m_transit = transit;
+    m_baseTransit = transit;
+  }
+  m_stats.m_jitter += (std::abs(transit - m_transit) - m_stats.m_jitter) * s_jitterGain;
+  m_transit = transit;
+  if (transit < m_baseTransit) {
+    m_baseTransit = transit;
+  } else {
+    m_baseTransit += (transit - m_baseTransit) * s_baseTransitGain;
+  }
+
+  // due when it would have arrived on the quickest link, plus the delay,
+  // and never before a sample taken before it
+  m_stats.m_delay = std::min(m_stats.m_jitter * s_delayPerJitter, s_maxDelay);
+  double due = m_taken + m_baseTransit + m_stats.m_delay;
+  if (!m_samples.empty()) {
+    due = std::max(due, m_samples.back().m_due);
+  }
+  m_samples.push_back({sample, now, due});
+
+  ++m_stats.m_samples;
+  m_stats.m_depth = static_cast<uint32_t>(m_samples.size());
+  m_stats.m_maxDepth = std::max(m_stats.m_maxDepth, m_stats.m_depth);
+}
+
+bool MotionJitterBuffer::popDue(double now, MotionBatch::Sample &sample)
+{
+  if (m_samples.empty() || m_samples.front().m_due > now) {
+    return false;
+  }
+  pop(now, sample);
+  return true;
+}
+
+bool MotionJitterBuffer::popNext(double now, MotionBatch::Sample &sample)
+{
+  if (m_samples.empty()) {
+    return false;
+  }
+  pop(now, sample);
+  return true;
+}
+
+void MotionJitterBuffer::clear()
+{
+  m_samples.clear();
+  m_stats.m_depth = 0;
+}
+
+void MotionJitterBuffer::pop(double now, MotionBatch::Sample &sample)
+{
+  const Entry &entry = m_samples.front();
+  sample = entry.m_sample;
+  m_stats.m_held += (std::max(now - entry.m_arrived, 0.0) - m_stats.m_held) * s_heldGain;
+  m_samples.pop_front();
+  m_stats.m_depth = static_cast<uint32_t>(m_samples.size());
+}
@@ -0,0 +1,127 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#pragma once
+
+#include "deskflow/MotionBatch.h"
+
+#include <cstdint>
+#include <deque>
+
+//! Jitter buffer for mouse motion
+/*!
+Evens out mouse motion that arrives in bursts, as it can over Wi-Fi.
+Each sample is held until the time it was taken on the server, from the
+offsets in a \c kMsgDMouseMotion batch, plus a delay, so samples are
+released as evenly as they were taken.  The delay follows the measured
+jitter in how long samples take to arrive, so a steady link adds little
+and a bursty one adds enough to hide the bursts.
+
+Times are in seconds, from any clock that doesn't go backwards.
+*/
+class MotionJitterBuffer
+{
+public:
+  //! Buffer statistics
+  struct Stats
+  {
+    //! Delay added to the time samples were taken, see MotionJitterBuffer
+    double m_delay = 0.0;
+
+    //! Measured jitter in how long samples take to arrive
+    double m_jitter = 0.0;
+
+    //! Average time samples are held for
+    double m_held = 0.0;
+
+    //! Samples held now
+    uint32_t m_depth = 0;
+
+    //! Most samples held at once
+    uint32_t m_maxDepth = 0;
+
+    //! Samples added
+    uint64_t m_samples = 0;
+  };
+
+  //! @name manipulators
+  //@{
+
+  //! Add a sample
+  /*!
+  Adds \p sample, which arrived at \p now.
+  */
+  void add(const MotionBatch::Sample &sample, double now);
+
+  //! Take a sample that's due
+  /*!
+  Removes the oldest sample into \p sample, if it's due at \p now.
+  Returns false if there's no sample due.
+  */
+  bool popDue(double now, MotionBatch::Sample &sample);
+
+  //! Take a sample
+  /*!
+  Removes the oldest sample into \p sample, whether or not it's due.
+  Returns false if there are no samples.
+  */
+  bool popNext(double now, MotionBatch::Sample &sample);
+
+  //! Remove all samples
+  /*!
+  Drops the samples held, but keeps what's been measured.
+  */
+  void clear();
+
+  //@}
+  //! @name accessors
+  //@{
+
+  //! Test if samples are held
+  bool isEmpty() const
+  {
+    return m_samples.empty();
+  }
+
+  //! Get the time the oldest sample is due
+  /*!
+  Must not be called when isEmpty().
+  */
+  double getNextTime() const
+  {
+    return m_samples.front().m_due;
+  }
+
+  //! Get statistics
+  const Stats &getStats() const
+  {
+    return m_stats;
+  }
+
+  //@}
+
+private:
+  struct Entry
+  {
+    MotionBatch::Sample m_sample;
+    double m_arrived;
+    double m_due;
+  };
+
+  void pop(double now, MotionBatch::Sample &sample);
+
+  std::deque<Entry> m_samples;
+  Stats m_stats;
+
+  // when the last sample was taken, on the server's clock from its first
+  bool m_started = false;
+  double m_taken = 0.0;
+
+  // how much later than it was taken the last sample arrived, and the
+  // least that any has, followed slowly upwards in case the clocks drift
+  double m_transit = 0.0;
+  double m_baseTransit = 0.0;
+};
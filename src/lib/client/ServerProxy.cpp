@@ -8,6 +8,7 @@
 
 #include "client/ServerProxy.h"
 
+#include "arch/Arch.h"
 #include "base/BaseException.h"
 #include "base/IEventQueue.h"
 #include "base/Log.h"
@@ -15,16 +16,62 @@
 #include "deskflow/AppUtil.h"
 #include "deskflow/Clipboard.h"
 #include "deskflow/ClipboardChunk.h"
+#include "deskflow/ClipboardOffer.h"
 #include "deskflow/DeskflowException.h"
 #include "deskflow/OptionTypes.h"
+#include "deskflow/ProtocolMessages.h"
 #include "deskflow/ProtocolTypes.h"
 #include "deskflow/ProtocolUtil.h"
 #include "deskflow/StreamChunker.h"
 #include "io/IStream.h"
+#include "io/StreamCork.h"
+#include "net/IDatagramSocket.h"
 
 #include <algorithm>
+#include <array>
 #include <cstring>
+#include <functional>
 #include <memory>
+#include <tuple>
+
+static const uint32_t s_packetBurst = 64;
+
+// how often to say hello on the fast channel, and how many times
+static const double s_fastHelloInterval = 0.5;
+static const uint32_t s_fastHelloTries = 10;
+
+// how long to wait for offered clipboard data, plus the time to send it
+// at the slowest rate we'll put up with
+static const double s_clipboardTimeout = 5.0;
+static const double s_clipboardBytesPerSecond = 1024.0 * 1024.0;
+
+namespace {
+
+// reads message Msg from the stream and calls handler with its fields,
+// unless the stream ends first
+template <typename Msg, typename Handler> void receive(deskflow::IStream *stream, Handler handler)
+{
+  const auto read = [stream](auto &...fields) { return Msg::read(stream, fields...); };
+  typename Msg::Values values;
+  if (std::apply(read, values)) {
+    std::apply(handler, values);
+  }
+}
+
+// decodes message Msg from a whole packet and calls handler with its fields
+template <typename Msg, typename Handler> void receive(std::span<const uint8_t> packet, Handler handler)
+{
+  const auto decode = [&packet](auto &...fields) {
+    return Msg::decode(packet.data() + 4, static_cast<uint32_t>(packet.size() - 4), fields...);
+  };
+  typename Msg::Values values;
+  if (!std::apply(decode, values)) {
+    throw BadClientException("Incomplete message received");
+  }
+  std::apply(handler, values);
+}
+
+} // namespace
 
 //
 // ServerProxy
@@ -56,12 +103,31 @@ ServerProxy::ServerProxy(Client *client, deskflow::IStream *stream, IEventQueue
 
 ServerProxy::~ServerProxy()
 {
+  if (m_motionTimer != nullptr) {
+    m_events->removeHandler(EventTypes::Timer, m_motionTimer);
+    m_events->deleteTimer(m_motionTimer);
+  }
+  if (m_fastHelloTimer != nullptr) {
+    m_events->removeHandler(EventTypes::Timer, m_fastHelloTimer);
+    m_events->deleteTimer(m_fastHelloTimer);
+  }
+  if (m_fastSocket != nullptr) {
+    m_events->removeHandler(EventTypes::DatagramSocketReady, m_fastSocket->getEventTarget());
+  }
+  for (ClipboardID id = 0; id < kClipboardEnd; ++id) {
+    dropClipboardOffer(id);
+  }
   setKeepAliveRate(-1.0);
   m_events->removeHandler(EventTypes::StreamInputReady, m_stream->getEventTarget());
 }
 
 void ServerProxy::resetKeepAliveAlarm()
 {
+  // rearm the existing alarm in place, this happens for every message
+  if (m_keepAliveAlarmTimer != nullptr && m_keepAliveAlarm > 0.0) {
+    m_events->resetTimer(m_keepAliveAlarmTimer, m_keepAliveAlarm);
+    return;
+  }
   if (m_keepAliveAlarmTimer != nullptr) {
     m_events->removeHandler(EventTypes::Timer, m_keepAliveAlarmTimer);
     m_events->deleteTimer(m_keepAliveAlarmTimer);
@@ -79,22 +145,61 @@ void ServerProxy::setKeepAliveRate(double rate)
   resetKeepAliveAlarm();
 }
 
+void ServerProxy::setSmoothMotion(bool enabled)
+{
+  if (enabled == (m_motionBuffer != nullptr)) {
+    return;
+  }
+  if (enabled) {
+    m_motionBuffer = std::make_unique<MotionJitterBuffer>();
+    return;
+  }
+
+  // the timer is left to find nothing due
+  flushMotion();
+  m_motionBuffer.reset();
+}
+
+void ServerProxy::setFastChannel(IDatagramSocket *socket)
+{
+  assert(m_fastSocket == nullptr);
+  m_fastSocket.reset(socket);
+  m_events->addHandler(EventTypes::DatagramSocketReady, m_fastSocket->getEventTarget(), [this](const auto &) {
+    handleFastData();
+  });
+}
+
+const MotionJitterBuffer::Stats *ServerProxy::getMotionStats() const
+{
+  return m_motionBuffer != nullptr ? &m_motionBuffer->getStats() : nullptr;
+}
+
 void ServerProxy::handleData()
 {
-  // handle messages until there are no more.  first read message code.
-  uint8_t code[4];
-  uint32_t n = m_stream->read(code, 4);
-  while (n != 0) {
-    // verify we got an entire code
-    if (n != 4) {
-      LOG_ERR("incomplete message from server: %d bytes", n);
-      m_client->disconnect("incomplete message from server");
-      return;
-    }
+  // handle messages until there are no more
+  try {
+    for (;;) {
+      // handle what input can be in place
+      if (m_parser == &ServerProxy::parseMessage) {
+        handlePackets();
+      }
 
-    // parse message
-    LOG_DEBUG2("msg from server: %c%c%c%c", code[0], code[1], code[2], code[3]);
-    try {
+      // then read the next message code
+      uint8_t code[4];
+      const uint32_t n = m_stream->read(code, 4);
+      if (n == 0) {
+        break;
+      }
+
+      // verify we got an entire code
+      if (n != 4) {
+        LOG_ERR("incomplete message from server: %d bytes", n);
+        m_client->disconnect("incomplete message from server");
+        return;
+      }
+
+      // parse message
+      LOG_DEBUG2("msg from server: %c%c%c%c", code[0], code[1], code[2], code[3]);
       switch ((this->*m_parser)(code)) {
         using enum ConnectionResult;
       case Okay:
@@ -111,63 +216,142 @@ void ServerProxy::handleData()
       case Disconnect:
         return;
       }
-    } catch (const BadClientException &e) {
-      LOG_ERR("protocol error from server: %s", e.what());
-      ProtocolUtil::writef(m_stream, kMsgEBad);
-      m_client->disconnect("invalid message from server");
-      return;
     }
-
-    // next message
-    n = m_stream->read(code, 4);
+  } catch (const BadClientException &e) {
+    LOG_ERR("protocol error from server: %s", e.what());
+    ProtocolUtil::writef(m_stream, kMsgEBad);
+    m_client->disconnect("invalid message from server");
+    return;
   }
 
   flushCompressedMouse();
 }
 
+void ServerProxy::handlePackets()
+{
+  // decode input straight from the stream's buffer, a burst of whole
+  // messages at a time, up to the first message that isn't input.  any
+  // keep alive replies go out with the reply to the burst.
+  StreamCork cork(m_stream);
+  std::array<std::span<const uint8_t>, s_packetBurst> packets;
+  uint32_t handled = 0;
+  do {
+    const uint32_t count = m_stream->peekPackets(packets);
+    for (handled = 0; handled < count; ++handled) {
+      const auto packet = packets[handled];
+      if (packet.size() < 4 || !parseInput(packet.data(), packet)) {
+        break;
+      }
+    }
+    m_stream->popPackets(handled);
+
+    // one reply for the burst, see parseMessage()
+    if (handled > 0) {
+      MsgCNoop::write(m_stream);
+    }
+  } while (handled == packets.size());
+}
+
+template <typename Input> bool ServerProxy::parseInput(const uint8_t *code, Input input)
+{
+  switch (messageKey(code)) {
+  case MsgDMouseMove::kKey:
+    receive<MsgDMouseMove>(input, std::bind_front(&ServerProxy::mouseMove, this));
+    break;
+
+  case MsgDMouseRelMove::kKey:
+    receive<MsgDMouseRelMove>(input, std::bind_front(&ServerProxy::mouseRelativeMove, this));
+    break;
+
+  case MsgDMouseMotion::kKey:
+    receive<MsgDMouseMotion>(input, std::bind_front(&ServerProxy::mouseMotion, this));
+    break;
+
+  case MsgDMouseWheel::kKey:
+    receive<MsgDMouseWheel>(input, std::bind_front(&ServerProxy::mouseWheel, this));
+    break;
+
+  case MsgDKeyDown::kKey:
+    receive<MsgDKeyDown>(input, [this](uint16_t id, uint16_t mask, uint16_t button) {
+      keyDown(id, mask, button, "");
+    });
+    break;
+
+  case MsgDKeyDownLang::kKey:
+    receive<MsgDKeyDownLang>(input, std::bind_front(&ServerProxy::keyDown, this));
+    break;
+
+  case MsgDKeyUp::kKey:
+    receive<MsgDKeyUp>(input, std::bind_front(&ServerProxy::keyUp, this));
+    break;
+
+  case MsgDMouseDown::kKey:
+    receive<MsgDMouseDown>(input, std::bind_front(&ServerProxy::mouseDown, this));
+    break;
+
+  case MsgDMouseUp::kKey:
+    receive<MsgDMouseUp>(input, std::bind_front(&ServerProxy::mouseUp, this));
+    break;
+
+  case MsgDKeyRepeat::kKey:
+    receive<MsgDKeyRepeat>(input, std::bind_front(&ServerProxy::keyRepeat, this));
+    break;
+
+  case MsgCKeepAlive::kKey:
+    keepAlive();
+    break;
+
+  case MsgCNoop::kKey:
+    // accept and discard no-op
+    break;
+
+  default:
+    return false;
+  }
+  return true;
+}
+
 ServerProxy::ConnectionResult ServerProxy::parseHandshakeMessage(const uint8_t *code)
 {
   using enum ConnectionResult;
 
-  if (memcmp(code, kMsgQInfo, 4) == 0) {
+  switch (messageKey(code)) {
+  case MsgQInfo::kKey:
     queryInfo();
-  }
+    break;
 
-  else if (memcmp(code, kMsgCInfoAck, 4) == 0) {
+  case MsgCInfoAck::kKey:
     infoAcknowledgment();
-  }
+    break;
 
-  else if (memcmp(code, kMsgDSetOptions, 4) == 0) {
+  case MsgDSetOptions::kKey:
     setOptions();
 
     // handshake is complete
     m_parser = &ServerProxy::parseMessage;
     checkMissedLanguages();
     m_client->handshakeComplete();
-  }
+    break;
 
-  else if (memcmp(code, kMsgCResetOptions, 4) == 0) {
+  case MsgCResetOptions::kKey:
     resetOptions();
-  }
+    break;
 
-  else if (memcmp(code, kMsgCKeepAlive, 4) == 0) {
-    // echo keep alives and reset alarm
-    ProtocolUtil::writef(m_stream, kMsgCKeepAlive);
-    resetKeepAliveAlarm();
-  }
+  case MsgCKeepAlive::kKey:
+    keepAlive();
+    break;
 
-  else if (memcmp(code, kMsgCNoop, 4) == 0) {
+  case MsgCNoop::kKey:
     // accept and discard no-op
-  }
+    break;
 
-  else if (memcmp(code, kMsgCClose, 4) == 0) {
+  case MsgCClose::kKey:
     // server wants us to hangup
     LOG_DEBUG1("recv close");
     m_client->disconnect(nullptr);
     return Disconnect;
-  }
 
-  else if (memcmp(code, kMsgEIncompatible, 4) == 0) {
+  case MsgEIncompatible::kKey: {
     int32_t major;
     int32_t minor;
     ProtocolUtil::readf(m_stream, kMsgEIncompatible + 4, &major, &minor);
@@ -176,25 +360,30 @@ ServerProxy::ConnectionResult ServerProxy::parseHandshakeMessage(const uint8_t *
     return Disconnect;
   }
 
-  else if (memcmp(code, kMsgEBusy, 4) == 0) {
+  case MsgEBusy::kKey:
     LOG_ERR("server already has a connected client with name \"%s\"", m_client->getName().c_str());
     m_client->refuseConnection("server already has a connected client with our name");
     return Disconnect;
-  }
 
-  else if (memcmp(code, kMsgEUnknown, 4) == 0) {
+  case MsgEUnknown::kKey:
     LOG_ERR("server refused client with name \"%s\"", m_client->getName().c_str());
     m_client->refuseConnection("server refused client with our name");
     return Disconnect;
-  }
 
-  else if (memcmp(code, kMsgEBad, 4) == 0) {
+  case MsgEBad::kKey:
     LOG_ERR("server disconnected due to a protocol error");
     m_client->refuseConnection("server reported a protocol error");
     return Disconnect;
-  } else if (memcmp(code, kMsgDLanguageSynchronisation, 4) == 0) {
+
+  case MsgDLanguageSynchronisation::kKey:
     setServerLanguages();
-  } else {
+    break;
+
+  case MsgCFastChannel::kKey:
+    receive<MsgCFastChannel>(m_stream, std::bind_front(&ServerProxy::fastChannel, this));
+    break;
+
+  default:
     return Unknown;
   }
 
@@ -205,117 +394,76 @@ ServerProxy::ConnectionResult ServerProxy::parseMessage(const uint8_t *code)
 {
   using enum ConnectionResult;
 
-  if (memcmp(code, kMsgDMouseMove, 4) == 0) {
-    mouseMove();
-  }
-
-  else if (memcmp(code, kMsgDMouseRelMove, 4) == 0) {
-    mouseRelativeMove();
-  }
-
-  else if (memcmp(code, kMsgDMouseWheel, 4) == 0) {
-    mouseWheel();
-  }
-
-  else if (memcmp(code, kMsgDKeyDown, 4) == 0) {
-    uint16_t id = 0;
-    uint16_t mask = 0;
-    uint16_t button = 0;
-    ProtocolUtil::readf(m_stream, kMsgDKeyDown + 4, &id, &mask, &button);
-    LOG_DEBUG1("recv key down id=0x%08x, mask=0x%04x, button=0x%04x", id, mask, button);
-
-    keyDown(id, mask, button, "");
-  }
-
-  else if (memcmp(code, kMsgDKeyDownLang, 4) == 0) {
-    std::string lang;
-    uint16_t id = 0;
-    uint16_t mask = 0;
-    uint16_t button = 0;
-
-    ProtocolUtil::readf(m_stream, kMsgDKeyDownLang + 4, &id, &mask, &button, &lang);
-    LOG_DEBUG1("recv key down id=0x%08x, mask=0x%04x, button=0x%04x, lang=\"%s\"", id, mask, button, lang.c_str());
-
-    keyDown(id, mask, button, lang);
-  }
-
-  else if (memcmp(code, kMsgDKeyUp, 4) == 0) {
-    keyUp();
-  }
-
-  else if (memcmp(code, kMsgDMouseDown, 4) == 0) {
-    mouseDown();
-  }
-
-  else if (memcmp(code, kMsgDMouseUp, 4) == 0) {
-    mouseUp();
-  }
-
-  else if (memcmp(code, kMsgDKeyRepeat, 4) == 0) {
-    keyRepeat();
-  }
-
-  else if (memcmp(code, kMsgCKeepAlive, 4) == 0) {
-    // echo keep alives and reset alarm
-    ProtocolUtil::writef(m_stream, kMsgCKeepAlive);
-    resetKeepAliveAlarm();
-  }
-
-  else if (memcmp(code, kMsgCNoop, 4) == 0) {
-    // accept and discard no-op
-  }
-
-  else if (memcmp(code, kMsgCEnter, 4) == 0) {
+  switch (messageKey(code)) {
+  case MsgCEnter::kKey:
     enter();
-  }
+    break;
 
-  else if (memcmp(code, kMsgCLeave, 4) == 0) {
+  case MsgCLeave::kKey:
     leave();
-  }
+    break;
 
-  else if (memcmp(code, kMsgCClipboard, 4) == 0) {
+  case MsgCClipboard::kKey:
     grabClipboard();
-  }
+    break;
 
-  else if (memcmp(code, kMsgCScreenSaver, 4) == 0) {
+  case MsgCScreenSaver::kKey:
     screensaver();
-  }
+    break;
 
-  else if (memcmp(code, kMsgQInfo, 4) == 0) {
+  case MsgQInfo::kKey:
     queryInfo();
-  }
+    break;
 
-  else if (memcmp(code, kMsgCInfoAck, 4) == 0) {
+  case MsgCInfoAck::kKey:
     infoAcknowledgment();
-  }
+    break;
 
-  else if (memcmp(code, kMsgDClipboard, 4) == 0) {
+  case MsgDClipboard::kKey:
     setClipboard();
-  }
+    break;
 
-  else if (memcmp(code, kMsgCResetOptions, 4) == 0) {
+  case MsgDClipboardOffer::kKey:
+    receive<MsgDClipboardOffer>(
+        m_stream,
+        [this](uint8_t id, uint32_t seq, uint32_t d0, uint32_t d1, uint32_t d2, uint32_t d3, const auto &formats) {
+          offerClipboard(id, seq, {d0, d1, d2, d3}, formats);
+        }
+    );
+    break;
+
+  case MsgCResetOptions::kKey:
     resetOptions();
-  }
+    break;
 
-  else if (memcmp(code, kMsgDSetOptions, 4) == 0) {
+  case MsgDSetOptions::kKey:
     setOptions();
-  }
+    break;
 
-  else if (memcmp(code, kMsgDSecureInputNotification, 4) == 0) {
+  case MsgDSecureInputNotification::kKey:
     secureInputNotification();
-  }
+    break;
 
-  else if (memcmp(code, kMsgCClose, 4) == 0) {
+  case MsgCFastChannel::kKey:
+    receive<MsgCFastChannel>(m_stream, std::bind_front(&ServerProxy::fastChannel, this));
+    break;
+
+  case MsgCClose::kKey:
     // server wants us to hangup
     LOG_DEBUG1("recv close");
     m_client->disconnect(nullptr);
     return Disconnect;
-  } else if (memcmp(code, kMsgEBad, 4) == 0) {
+
+  case MsgEBad::kKey:
     LOG_ERR("server disconnected due to a protocol error");
     m_client->disconnect("server reported a protocol error");
     return Disconnect;
-  } else {
-    return Unknown;
+
+  default:
+    if (!parseInput(code, m_stream)) {
+      return Unknown;
+    }
+    break;
   }
 
   // send a reply.  this is intended to work around a delay when
@@ -348,6 +496,7 @@ void ServerProxy::onInfoChanged()
 
 bool ServerProxy::onGrabClipboard(ClipboardID id)
 {
+  dropClipboardOffer(id);
   LOG_DEBUG1("sending clipboard %d changed", id);
   ProtocolUtil::writef(m_stream, kMsgCClipboard, id, m_seqNum);
   return true;
@@ -355,10 +504,47 @@ bool ServerProxy::onGrabClipboard(ClipboardID id)
 
 void ServerProxy::onClipboardChanged(ClipboardID id, const IClipboard *clipboard)
 {
-  std::string data = IClipboard::marshall(clipboard);
+  m_clipboardData[id] = IClipboard::marshall(clipboard);
+  const auto &data = m_clipboardData[id];
   LOG_DEBUG("sending clipboard %d seqnum=%d", id, m_seqNum);
 
-  StreamChunker::sendClipboard(data, data.size(), id, m_seqNum, m_events, this);
+  StreamChunker::sendClipboard(data, data.size(), id, m_seqNum, m_events, this, m_compressClipboard);
+}
+
+void ServerProxy::requestClipboard(ClipboardID id)
+{
+  auto &fetch = m_clipboardFetch[id];
+  if (!fetch.m_waiting || fetch.m_timer != nullptr) {
+    return;
+  }
+
+  LOG_DEBUG("requesting clipboard %d seqnum=%d size=%d", id, fetch.m_sequence, fetch.m_size);
+  MsgQClipboard::write(m_stream, id, fetch.m_sequence);
+
+  const double timeout = s_clipboardTimeout + static_cast<double>(fetch.m_size) / s_clipboardBytesPerSecond;
+  fetch.m_timer = m_events->newOneShotTimer(timeout, nullptr);
+  m_events->addHandler(EventTypes::Timer, fetch.m_timer, [this, id](const auto &) { handleClipboardTimeout(id); });
+}
+
+void ServerProxy::handleClipboardTimeout(ClipboardID id)
+{
+  LOG_WARN("clipboard %d didn't arrive in time, emptying it", id);
+  dropClipboardOffer(id);
+
+  // whatever is waiting to paste gets nothing rather than waiting on
+  Clipboard clipboard;
+  m_client->setClipboard(id, &clipboard);
+}
+
+void ServerProxy::dropClipboardOffer(ClipboardID id)
+{
+  auto &fetch = m_clipboardFetch[id];
+  fetch.m_waiting = false;
+  if (fetch.m_timer != nullptr) {
+    m_events->removeHandler(EventTypes::Timer, fetch.m_timer);
+    m_events->deleteTimer(fetch.m_timer);
+    fetch.m_timer = nullptr;
+  }
 }
 
 void ServerProxy::flushCompressedMouse()
@@ -375,6 +561,119 @@ void ServerProxy::flushCompressedMouse()
   }
 }
 
+void ServerProxy::flushMotion()
+{
+  if (m_motionBuffer != nullptr) {
+    MotionBatch::Sample sample;
+    while (m_motionBuffer->popNext(Arch::time(), sample)) {
+      applyMotion(sample);
+    }
+  }
+  flushCompressedMouse();
+}
+
+void ServerProxy::applyMotion(const MotionBatch::Sample &sample)
+{
+  if (sample.m_relative) {
+    m_client->mouseRelativeMove(sample.m_x, sample.m_y);
+  } else {
+    m_client->mouseMove(sample.m_x, sample.m_y);
+  }
+}
+
+void ServerProxy::applyDueMotion()
+{
+  const double now = Arch::time();
+  MotionBatch::Sample sample;
+  while (m_motionBuffer->popDue(now, sample)) {
+    applyMotion(sample);
+  }
+  if (m_motionBuffer->isEmpty()) {
+    return;
+  }
+
+  // wake when the next sample is due
+  const double delay = std::max(m_motionBuffer->getNextTime() - now, 0.0);
+  if (m_motionTimer != nullptr) {
+    m_events->resetTimer(m_motionTimer, delay);
+  } else {
+    m_motionTimer = m_events->newOneShotTimer(delay, nullptr);
+    m_events->addHandler(EventTypes::Timer, m_motionTimer, [this](const auto &) { handleMotionTimer(); });
+  }
+}
+
+void ServerProxy::handleMotionTimer()
+{
+  if (m_motionBuffer != nullptr && !m_motionBuffer->isEmpty()) {
+    applyDueMotion();
+  }
+}
+
+void ServerProxy::handleFastData()
+{
+  const auto capacity = static_cast<uint32_t>(m_datagram.size());
+  while (const uint32_t size = m_fastSocket->receive(m_datagram.data(), capacity, nullptr)) {
+    const std::span<const uint8_t> datagram(m_datagram.data(), size);
+    if (!m_fastChannel) {
+      continue;
+    }
+
+    // the server's answer to our hello
+    uint32_t token;
+    uint32_t sequence;
+    if (FastChannel::isHello(datagram) && FastChannel::parseHeader(datagram, token, sequence) &&
+        token == m_fastChannel->getToken()) {
+      if (!m_fastUp) {
+        LOG_NOTE("fast channel is up");
+        m_fastUp = true;
+      }
+      continue;
+    }
+
+    // take only motion, and drop a bad message rather than the
+    // connection, since anyone can send a datagram
+    std::span<const uint8_t> message;
+    if (!m_fastChannel->accept(datagram, message) || !m_entered || message.size() < 4) {
+      continue;
+    }
+    const uint32_t key = messageKey(message.data());
+    if (key != MsgDMouseMotion::kKey) {
+      LOG_DEBUG1("ignoring message on fast channel: %c%c%c%c", message[0], message[1], message[2], message[3]);
+      continue;
+    }
+    try {
+      parseInput(message.data(), message);
+    } catch (const BadClientException &e) {
+      LOG_DEBUG1("ignoring bad message on fast channel: %s", e.what());
+    }
+  }
+}
+
+void ServerProxy::handleFastHelloTimer()
+{
+  if (!m_fastUp) {
+    sendFastHello();
+  }
+}
+
+void ServerProxy::sendFastHello()
+{
+  if (m_fastHellos == s_fastHelloTries) {
+    LOG_WARN("no answer on fast channel, taking motion on the connection");
+    return;
+  }
+  ++m_fastHellos;
+
+  const auto hello = FastChannel::hello(m_fastChannel->getToken());
+  m_fastSocket->send(hello.data(), static_cast<uint32_t>(hello.size()));
+  if (m_fastHelloTimer != nullptr) {
+    m_events->resetTimer(m_fastHelloTimer, s_fastHelloInterval);
+  } else {
+    m_fastHelloTimer = m_events->newOneShotTimer(s_fastHelloInterval, nullptr);
+    m_events->addHandler(EventTypes::Timer, m_fastHelloTimer, [this](const auto &) { handleFastHelloTimer(); });
+  }
+}
+
 void ServerProxy::sendInfo(const ClientInfo &info)
 {
   LOG_DEBUG1("sending info shape=%d,%d %dx%d", info.m_x, info.m_y, info.m_w, info.m_h);
@@ -497,11 +796,15 @@ void ServerProxy::enter()
   LOG_DEBUG1("recv enter, %d,%d %d %04x", x, y, seqNum, mask);
 
   // discard old compressed mouse motion, if any
+  if (m_motionBuffer != nullptr) {
+    m_motionBuffer->clear();
+  }
   m_compressMouse = false;
   m_compressMouseRelative = false;
   m_dxMouse = 0;
   m_dyMouse = 0;
   m_seqNum = seqNum;
+  m_entered = true;
   m_serverLanguage = "";
   m_isUserNotifiedAboutLanguageSyncError = false;
 
@@ -515,36 +818,99 @@ void ServerProxy::leave()
   LOG_DEBUG1("recv leave");
 
   // send last mouse motion
-  flushCompressedMouse();
+  flushMotion();
+  m_entered = false;
+  if (const auto *stats = getMotionStats(); stats != nullptr) {
+    LOG_DEBUG(
+        "smoothed %llu mouse moves, delay=%.1fms jitter=%.1fms held=%.1fms max depth=%u",
+        static_cast<unsigned long long>(stats->m_samples), stats->m_delay * 1000.0, stats->m_jitter * 1000.0,
+        stats->m_held * 1000.0, stats->m_maxDepth
+    );
+  }
 
   // forward
   m_client->leave();
 }
 
+void ServerProxy::fastChannel(uint32_t token)
+{
+  LOG_DEBUG1("recv fast channel offer");
+  if (m_fastSocket == nullptr) {
+    return;
+  }
+  m_fastChannel.emplace(token);
+  m_fastHellos = 0;
+  m_fastUp = false;
+  sendFastHello();
+}
+
 void ServerProxy::setClipboard()
 {
   // parse
-  static std::string dataCached;
   ClipboardID id;
   uint32_t seq;
 
-  auto r = ClipboardChunk::assemble(m_stream, dataCached, id, seq);
+  auto r = ClipboardChunk::assemble(m_stream, m_clipboardReceiving, id, seq, m_client->getMaximumClipboardSize());
 
   if (r == TransferState::Started) {
-    size_t size = ClipboardChunk::getExpectedSize();
-    LOG_DEBUG("receiving clipboard %d size=%d", id, size);
+    LOG_DEBUG("receiving clipboard %d size=%d", id, m_clipboardReceiving.m_expectedSize);
   } else if (r == TransferState::Finished) {
-    LOG_DEBUG("received clipboard %d size=%d", id, dataCached.size());
+    LOG_DEBUG("received clipboard %d size=%d", id, m_clipboardReceiving.m_data.size());
+
+    // once the server offers clipboards, only take the one asked for
+    auto &fetch = m_clipboardFetch[id];
+    if (fetch.m_sequence != 0 && (!fetch.m_waiting || seq != fetch.m_sequence)) {
+      LOG_DEBUG("ignoring old clipboard %d seqnum=%d", id, seq);
+      m_clipboardReceiving.m_data.clear();
+      return;
+    }
+    dropClipboardOffer(id);
+    m_clipboardData[id] = std::move(m_clipboardReceiving.m_data);
+    m_clipboardReceiving.m_data.clear();
 
     // forward
     Clipboard clipboard;
-    clipboard.unmarshall(dataCached, 0);
+    clipboard.unmarshall(m_clipboardData[id], 0);
     m_client->setClipboard(id, &clipboard);
 
     LOG_INFO("clipboard was updated");
   }
 }
 
+void ServerProxy::offerClipboard(
+    uint8_t id, uint32_t seq, const ClipboardOffer::Digest &digest, const std::vector<uint32_t> &formats
+)
+{
+  ClipboardOffer offer;
+  if (id >= kClipboardEnd || !ClipboardOffer::decode(digest, formats, offer)) {
+    LOG_ERR("invalid clipboard offer");
+    return;
+  }
+  LOG_DEBUG("recv clipboard %d offer seqnum=%d size=%d", id, seq, offer.getSize());
+
+  dropClipboardOffer(id);
+  auto &fetch = m_clipboardFetch[id];
+  fetch.m_sequence = seq;
+  fetch.m_size = offer.getSize();
+
+  // nothing to fetch if it's what was sent or received last
+  if (offer.matches(m_clipboardData[id])) {
+    LOG_DEBUG("clipboard %d is unchanged", id);
+    Clipboard clipboard;
+    clipboard.unmarshall(m_clipboardData[id], 0);
+    m_client->setClipboard(id, &clipboard);
+    return;
+  }
+
+  if (offer.getSize() > m_client->getMaximumClipboardSize()) {
+    LOG_WARN("clipboard %d of %d bytes is over the size limit, not fetching it", id, offer.getSize());
+    return;
+  }
+
+  fetch.m_waiting = true;
+  m_client->offerClipboard(id, offer);
+}
+
 void ServerProxy::grabClipboard()
 {
   // parse
@@ -559,13 +925,15 @@ void ServerProxy::grabClipboard()
   }
 
   // forward
+  dropClipboardOffer(id);
   m_client->grabClipboard(id);
 }
 
 void ServerProxy::keyDown(uint16_t id, uint16_t mask, uint16_t button, const std::string &lang)
 {
   // get mouse up to date
-  flushCompressedMouse();
+  flushMotion();
+  LOG_DEBUG1("recv key down id=0x%08x, mask=0x%04x, button=0x%04x, lang=\"%s\"", id, mask, button, lang.c_str());
   setActiveServerLanguage(lang);
 
   // translate
@@ -578,18 +946,10 @@ void ServerProxy::keyDown(uint16_t id, uint16_t mask, uint16_t button, const std
   m_client->keyDown(id2, mask2, button, lang);
 }
 
-void ServerProxy::keyRepeat()
+void ServerProxy::keyRepeat(uint16_t id, uint16_t mask, uint16_t count, uint16_t button, const std::string &lang)
 {
   // get mouse up to date
-  flushCompressedMouse();
-
-  // parse
-  uint16_t id;
-  uint16_t mask;
-  uint16_t count;
-  uint16_t button;
-  std::string lang;
-  ProtocolUtil::readf(m_stream, kMsgDKeyRepeat + 4, &id, &mask, &count, &button, &lang);
+  flushMotion();
   LOG(
       (CLOG_DEBUG1 "recv key repeat id=0x%08x, mask=0x%04x, count=%d, "
                    "button=0x%04x, lang=\"%s\"",
@@ -606,16 +966,10 @@ void ServerProxy::keyRepeat()
   m_client->keyRepeat(id2, mask2, count, button, lang);
 }
 
-void ServerProxy::keyUp()
+void ServerProxy::keyUp(uint16_t id, uint16_t mask, uint16_t button)
 {
   // get mouse up to date
-  flushCompressedMouse();
-
-  // parse
-  uint16_t id;
-  uint16_t mask;
-  uint16_t button;
-  ProtocolUtil::readf(m_stream, kMsgDKeyUp + 4, &id, &mask, &button);
+  flushMotion();
   LOG_DEBUG1("recv key up id=0x%08x, mask=0x%04x, button=0x%04x", id, mask, button);
 
   // translate
@@ -628,46 +982,35 @@ void ServerProxy::keyUp()
   m_client->keyUp(id2, mask2, button);
 }
 
-void ServerProxy::mouseDown()
+void ServerProxy::mouseDown(int8_t id)
 {
   // get mouse up to date
-  flushCompressedMouse();
-
-  // parse
-  int8_t id;
-  ProtocolUtil::readf(m_stream, kMsgDMouseDown + 4, &id);
+  flushMotion();
   LOG_DEBUG1("recv mouse down id=%d", id);
 
   // forward
   m_client->mouseDown(static_cast<ButtonID>(id));
 }
 
-void ServerProxy::mouseUp()
+void ServerProxy::mouseUp(int8_t id)
 {
   // get mouse up to date
-  flushCompressedMouse();
-
-  // parse
-  int8_t id;
-  ProtocolUtil::readf(m_stream, kMsgDMouseUp + 4, &id);
+  flushMotion();
   LOG_DEBUG1("recv mouse up id=%d", id);
 
   // forward
   m_client->mouseUp(static_cast<ButtonID>(id));
 }
 
-void ServerProxy::mouseMove()
+void ServerProxy::mouseMove(int16_t x, int16_t y)
 {
-  // parse
   bool ignore;
-  int16_t x;
-  int16_t y;
-  ProtocolUtil::readf(m_stream, kMsgDMouseMove + 4, &x, &y);
 
   // note if we should ignore the move
   ignore = m_ignoreMouse;
 
-  // compress mouse motion events if more input follows
+  // compress mouse motion events if more input follows.  that includes
+  // the message itself when it's handled in place, see handlePackets().
   if (!ignore && !m_compressMouse && m_stream->isReady()) {
     m_compressMouse = true;
   }
@@ -689,18 +1032,15 @@ void ServerProxy::mouseMove()
   }
 }
 
-void ServerProxy::mouseRelativeMove()
+void ServerProxy::mouseRelativeMove(int16_t dx, int16_t dy)
 {
-  // parse
   bool ignore;
-  int16_t dx;
-  int16_t dy;
-  ProtocolUtil::readf(m_stream, kMsgDMouseRelMove + 4, &dx, &dy);
 
   // note if we should ignore the move
   ignore = m_ignoreMouse;
 
-  // compress mouse motion events if more input follows
+  // compress mouse motion events if more input follows.  that includes
+  // the message itself when it's handled in place, see handlePackets().
   if (!ignore && !m_compressMouseRelative && m_stream->isReady()) {
     m_compressMouseRelative = true;
   }
@@ -719,21 +1059,51 @@ void ServerProxy::mouseRelativeMove()
   }
 }
 
-void ServerProxy::mouseWheel()
+void ServerProxy::mouseMotion(const std::string &samples)
 {
-  // get mouse up to date
+  m_motion.clear();
+  if (!MotionBatch::decode(samples, m_motion)) {
+    throw BadClientException("Bad mouse motion received");
+  }
+  LOG_DEBUG2("recv %d mouse moves", static_cast<int>(m_motion.size()));
+
+  if (m_ignoreMouse) {
+    return;
+  }
+
+  // apply every sample in order, after any motion compressed from earlier
+  // messages, so the cursor takes the same path it did on the server
   flushCompressedMouse();
+  if (m_motionBuffer != nullptr) {
+    const double now = Arch::time();
+    for (const auto &sample : m_motion) {
+      m_motionBuffer->add(sample, now);
+    }
+    applyDueMotion();
+    return;
+  }
+  for (const auto &sample : m_motion) {
+    applyMotion(sample);
+  }
+}
 
-  // parse
-  int16_t xDelta;
-  int16_t yDelta;
-  ProtocolUtil::readf(m_stream, kMsgDMouseWheel + 4, &xDelta, &yDelta);
+void ServerProxy::mouseWheel(int16_t xDelta, int16_t yDelta)
+{
+  // get mouse up to date
+  flushMotion();
   LOG_DEBUG2("recv mouse wheel %+d,%+d", xDelta, yDelta);
 
   // forward
   m_client->mouseWheel(xDelta, yDelta);
 }
 
+void ServerProxy::keepAlive()
+{
+  // echo keep alives and reset alarm
+  MsgCKeepAlive::write(m_stream);
+  resetKeepAliveAlarm();
+}
+
 void ServerProxy::screensaver()
 {
   // parse
@@ -752,6 +1122,7 @@ void ServerProxy::resetOptions()
 
   // forward
   m_client->resetOptions();
+  m_compressClipboard = false;
 
   // reset keep alive
   setKeepAliveRate(kKeepAliveRate);
@@ -790,6 +1161,8 @@ void ServerProxy::setOptions()
     } else if (options[i] == kOptionHeartbeat) {
       // update keep alive
       setKeepAliveRate(1.0e-3 * static_cast<double>(options[i + 1]));
+    } else if (options[i] == kOptionClipboardCompression) {
+      m_compressClipboard = (options[i + 1] == ClipboardCompression::Zlib);
     }
 
     if (id != kKeyModifierIDNull) {
@@ -9,14 +9,27 @@
 #pragma once
 
 #include "base/Event.h"
+#include "client/MotionJitterBuffer.h"
+#include "deskflow/ClipboardChunk.h"
+#include "deskflow/ClipboardOffer.h"
 #include "deskflow/ClipboardTypes.h"
+#include "deskflow/FastChannel.h"
 #include "deskflow/KeyTypes.h"
+#include "deskflow/MotionBatch.h"
 #include "deskflow/languages/LanguageManager.h"
 
+#include <array>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
 class Client;
 class ClientInfo;
 class EventQueueTimer;
 class IClipboard;
+class IDatagramSocket;
 namespace deskflow {
 class IStream;
 }
@@ -49,6 +62,42 @@ public:
   bool onGrabClipboard(ClipboardID);
   void onClipboardChanged(ClipboardID, const IClipboard *);
 
+  //! Fetch an offered clipboard
+  /*!
+  Asks the server for the data of the clipboard it last offered with
+  \c kMsgDClipboardOffer, which is passed to Client::setClipboard() when
+  it arrives.  If it doesn't arrive in time, the clipboard is emptied
+  instead.  Does nothing if there's no offer waiting or it's already
+  been asked for.
+  */
+  void requestClipboard(ClipboardID);
+
+  //! Smooth mouse motion
+  /*!
+  If \p enabled, mouse motion batches from the server are held in a
+  MotionJitterBuffer and the cursor is moved at the pace it moved on
+  the server, rather than as each batch arrives.
+  */
+  void setSmoothMotion(bool enabled);
+
+  //! Take motion over a fast channel
+  /*!
+  Adopts \p socket, which must be connected to the server's address, and
+  takes the fast channel on it if the server offers one.  See
+  \c kMsgCFastChannel.
+  */
+  void setFastChannel(IDatagramSocket *socket);
+
+  //@}
+  //! @name accessors
+  //@{
+
+  //! Get mouse motion smoothing statistics
+  /*!
+  Returns nullptr if motion isn't being smoothed.
+  */
+  const MotionJitterBuffer::Stats *getMotionStats() const;
+
   //@}
 
 protected:
@@ -65,6 +114,15 @@ private:
   // if compressing mouse motion then send the last motion now
   void flushCompressedMouse();
 
+  // send all the motion held back now, smoothed or compressed
+  void flushMotion();
+
+  // move the cursor by a motion sample
+  void applyMotion(const MotionBatch::Sample &sample);
+
+  // apply the smoothed motion that's due and wait for the rest
+  void applyDueMotion();
+
   void sendInfo(const ClientInfo &);
 
   void resetKeepAliveAlarm();
@@ -77,20 +135,43 @@ private:
   // event handlers
   void handleData();
   void handleKeepAliveAlarm();
+  void handleMotionTimer();
+  void handleFastData();
+  void handleFastHelloTimer();
+  void handleClipboardTimeout(ClipboardID id);
+
+  // stop waiting for the data of an offered clipboard
+  void dropClipboardOffer(ClipboardID id);
+
+  // say hello on the fast channel until the server answers
+  void sendFastHello();
+
+  // handle the whole messages that can be in place
+  void handlePackets();
+
+  // handle an input message, reading its fields from \p input, which is
+  // the stream or the whole message.  returns false if it isn't input.
+  template <typename Input> bool parseInput(const uint8_t *code, Input input);
 
   // message handlers
   void enter();
   void leave();
+  void fastChannel(uint32_t token);
   void setClipboard();
+  void offerClipboard(
+      uint8_t id, uint32_t seq, const ClipboardOffer::Digest &digest, const std::vector<uint32_t> &formats
+  );
   void grabClipboard();
+  void keepAlive();
   void keyDown(uint16_t id, uint16_t mask, uint16_t button, const std::string &lang);
-  void keyRepeat();
-  void keyUp();
-  void mouseDown();
-  void mouseUp();
-  void mouseMove();
-  void mouseRelativeMove();
-  void mouseWheel();
+  void keyRepeat(uint16_t id, uint16_t mask, uint16_t count, uint16_t button, const std::string &lang);
+  void keyUp(uint16_t id, uint16_t mask, uint16_t button);
+  void mouseDown(int8_t id);
+  void mouseUp(int8_t id);
+  void mouseMove(int16_t x, int16_t y);
+  void mouseRelativeMove(int16_t dx, int16_t dy);
+  void mouseMotion(const std::string &samples);
+  void mouseWheel(int16_t xDelta, int16_t yDelta);
   void screensaver();
   void resetOptions();
   void setOptions();
@@ -118,6 +199,44 @@ private:
 
   bool m_ignoreMouse = false;
 
+  // true if the server has said clipboard data may be compressed
+  bool m_compressClipboard = false;
+
+  // a clipboard the server has offered.  once there's been an offer,
+  // only the data asked for is taken, as data from before an offer can
+  // still be on its way.
+  struct ClipboardFetch
+  {
+    uint32_t m_sequence = 0;
+    size_t m_size = 0;
+    bool m_waiting = false;
+    EventQueueTimer *m_timer = nullptr;
+  };
+  ClipboardFetch m_clipboardFetch[kClipboardEnd];
+
+  // the clipboard data being received, and the last data received or
+  // sent, so an offer of the same data needn't be fetched
+  ClipboardTransfer m_clipboardReceiving;
+  std::string m_clipboardData[kClipboardEnd];
+
+  // the samples of the last batch of mouse motion
+  std::vector<MotionBatch::Sample> m_motion;
+
+  // motion held back to smooth it, if enabled, and when it's next due
+  std::unique_ptr<MotionJitterBuffer> m_motionBuffer;
+  EventQueueTimer *m_motionTimer = nullptr;
+
+  // the fast channel, if the server's offered one and we can take it
+  std::unique_ptr<IDatagramSocket> m_fastSocket;
+  std::optional<FastChannel> m_fastChannel;
+  EventQueueTimer *m_fastHelloTimer = nullptr;
+  uint32_t m_fastHellos = 0;
+  bool m_fastUp = false;
+  std::array<uint8_t, FastChannel::kMaxDatagramSize> m_datagram;
+
+  // true between enter and leave, when motion can be applied
+  bool m_entered = false;
+
   KeyModifierID m_modifierTranslationTable[kKeyModifierIDLast];
 
   double m_keepAliveAlarm = 0.0;
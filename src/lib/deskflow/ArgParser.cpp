@@ -40,6 +40,8 @@ bool ArgParser::parseServerArgs(deskflow::ServerArgs &args, int argc, const char
       args.m_configFile = argv[++i];
     } else if (isArg(i, argc, argv, nullptr, "--disable-client-cert-check")) {
       args.m_chkPeerCert = false;
+    } else if (isArg(i, argc, argv, nullptr, "--fast-motion")) {
+      args.m_fastMotion = true;
     } else {
       LOG_CRIT("%s: unrecognized option `%s'" BYE, args.m_pname, argv[i], args.m_pname);
       return false;
@@ -74,6 +76,10 @@ bool ArgParser::parseClientArgs(deskflow::ClientArgs &args, int argc, const char
       args.m_enableLangSync = true;
     } else if (isArg(i, argc, argv, nullptr, "--invert-scroll")) {
       args.m_clientScrollDirection = deskflow::ClientScrollDirection::Inverted;
+    } else if (isArg(i, argc, argv, nullptr, "--smooth-motion")) {
+      args.m_smoothMotion = true;
+    } else if (isArg(i, argc, argv, nullptr, "--fast-motion")) {
+      args.m_fastMotion = true;
     } else {
       if (i + 1 == argc) {
         args.m_serverAddress = argv[i];
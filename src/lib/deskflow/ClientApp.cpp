@@ -106,6 +106,8 @@ void ClientApp::help()
        << " [--yscroll <delta>]"
        << " [--sync-language]"
        << " [--invert-scroll]"
+       << " [--smooth-motion]"
+       << " [--fast-motion]"
 #ifdef WINAPI_XWINDOWS
        << " [--display <display>]"
 #endif
@@ -119,6 +121,10 @@ void ClientApp::help()
        << "      --sync-language      enable language synchronization.\n"
        << "      --invert-scroll      invert scroll direction on this\n"
        << "                             computer.\n"
+       << "      --smooth-motion      buffer mouse motion from the server and\n"
+       << "                             move the cursor at an even pace.\n"
+       << "      --fast-motion        take mouse motion from the server over\n"
+       << "                             UDP, unencrypted, if it's offered.\n"
 #if WINAPI_XWINDOWS
        << "      --display <display>  when in X mode, connect to the X server\n"
        << "                             at <display>.\n"
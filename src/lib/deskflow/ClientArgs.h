@@ -34,6 +34,20 @@ public:
    */
   ClientScrollDirection m_clientScrollDirection = ClientScrollDirection::Normal;
 
+  /**
+   * @brief m_smoothMotion
+   * Hold mouse motion from the server in a jitter buffer and move the
+   * cursor at the pace it moved on the server.
+   */
+  bool m_smoothMotion = false;
+
+  /**
+   * @brief m_fastMotion
+   * Take mouse motion from the server over UDP, when it offers a fast
+   * channel.  It isn't encrypted.
+   */
+  bool m_fastMotion = false;
+
   /**
    * @brief m_serverAddress stores deskflow server address
    */
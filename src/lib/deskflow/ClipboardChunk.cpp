@@ -11,9 +11,44 @@
 #include "deskflow/ProtocolTypes.h"
 #include "deskflow/ProtocolUtil.h"
 #include "io/IStream.h"
+
+#include <QByteArray>
+
+#include <algorithm>
 #include <cstring>
 
-size_t ClipboardChunk::s_expectedSize = 0;
+// data is sent in messages no bigger than this, so that the messages
+// written while a large clipboard is going out don't wait long behind it
+static const size_t s_maxMessageDataSize = 16 * 1024; // 16kb
+
+// appends the data of a compressed chunk to \p out, unless it would be
+// more than \p maxSize bytes.  the size is checked before decompressing and
+// again after, and as only blocks that shrank are sent compressed, a chunk
+// bigger than a block can't be genuine and isn't decompressed at all.
+static bool decompress(const std::string &data, size_t maxSize, std::string &out)
+{
+  if (data.size() < 4 || data.size() >= s_clipboardCompressBlockSize) {
+    return false;
+  }
+
+  const auto *bytes = reinterpret_cast<const uint8_t *>(data.data());
+  const size_t size = (static_cast<size_t>(bytes[0]) << 24) | (static_cast<size_t>(bytes[1]) << 16) |
+                      (static_cast<size_t>(bytes[2]) << 8) | static_cast<size_t>(bytes[3]);
+  if (size > maxSize || size > s_clipboardCompressBlockSize) {
+    return false;
+  }
+
+  const QByteArray block = qUncompress(bytes, static_cast<qsizetype>(data.size()));
+  if (static_cast<size_t>(block.size()) != size) {
+    return false;
+  }
+  out.append(block.constData(), size);
+  return true;
+}
+
+//
+// ClipboardChunk
+//
 
 ClipboardChunk::ClipboardChunk(size_t size) : Chunk(size)
 {
@@ -62,8 +97,27 @@ ClipboardChunk *ClipboardChunk::end(ClipboardID id, uint32_t sequence)
   return end;
 }
 
-TransferState
-ClipboardChunk::assemble(deskflow::IStream *stream, std::string &dataCached, ClipboardID &id, uint32_t &sequence)
+ClipboardChunk *ClipboardChunk::compressed(ClipboardID id, uint32_t sequence, const std::string &data)
+{
+  ClipboardChunk *chunk = ClipboardChunk::data(id, sequence, data);
+  chunk->m_chunk[5] = ChunkType::DataCompressedChunk;
+  return chunk;
+}
+
+bool ClipboardChunk::compress(std::string_view data, std::string &compressed)
+{
+  const QByteArray block =
+      qCompress(reinterpret_cast<const uchar *>(data.data()), static_cast<qsizetype>(data.size()));
+  if (static_cast<size_t>(block.size()) >= data.size()) {
+    return false;
+  }
+  compressed.assign(block.constData(), block.size());
+  return true;
+}
+
+TransferState ClipboardChunk::assemble(
+    deskflow::IStream *stream, ClipboardTransfer &transfer, ClipboardID &id, uint32_t &sequence, size_t maxSize
+)
 {
   using enum TransferState;
   uint8_t mark;
@@ -73,20 +127,48 @@ ClipboardChunk::assemble(deskflow::IStream *stream, std::string &dataCached, Cli
     return Error;
   }
 
+  std::string &dataCached = transfer.m_data;
   if (mark == ChunkType::DataStart) {
-    s_expectedSize = deskflow::string::stringToSizeType(data);
-    LOG_DEBUG("start receiving clipboard data");
+    transfer.m_expectedSize = deskflow::string::stringToSizeType(data);
     dataCached.clear();
+    transfer.m_dropping = transfer.m_expectedSize > maxSize;
+    if (transfer.m_dropping) {
+      LOG_WARN("ignoring clipboard data, size=%d is over the limit of %d", transfer.m_expectedSize, maxSize);
+      return Error;
+    }
+    LOG_DEBUG("start receiving clipboard data");
     return Started;
-  } else if (mark == ChunkType::DataChunk) {
-    dataCached.append(data);
-    return TransferState::InProgress;
+  } else if (transfer.m_dropping) {
+    return Error;
+  }
+
+  // never take more than the transfer said it would send
+  const size_t remaining = transfer.m_expectedSize - std::min(transfer.m_expectedSize, dataCached.size());
+  if (mark == ChunkType::DataChunk) {
+    if (data.size() <= remaining) {
+      dataCached.append(data);
+      return InProgress;
+    }
+    LOG_ERR("corrupted clipboard data, expected size=%d", transfer.m_expectedSize);
+    dataCached.clear();
+    transfer.m_dropping = true;
+    return Error;
+  } else if (mark == ChunkType::DataCompressedChunk) {
+    if (decompress(data, remaining, dataCached)) {
+      return InProgress;
+    }
+    LOG_ERR("corrupted compressed clipboard data, expected size=%d", transfer.m_expectedSize);
+    dataCached.clear();
+    transfer.m_dropping = true;
+    return Error;
   } else if (mark == ChunkType::DataEnd) {
     // validate
     if (id >= kClipboardEnd) {
       return Error;
-    } else if (s_expectedSize != dataCached.size()) {
-      LOG_ERR("corrupted clipboard data, expected size=%d actual size=%d", s_expectedSize, dataCached.size());
+    } else if (transfer.m_expectedSize != dataCached.size()) {
+      LOG_ERR(
+          "corrupted clipboard data, expected size=%d actual size=%d", transfer.m_expectedSize, dataCached.size()
+      );
       return Error;
     }
     return Finished;
@@ -114,8 +196,24 @@ void ClipboardChunk::send(deskflow::IStream *stream, void *data)
     LOG_DEBUG2("sending clipboard chunk start: size=%s", dataChunk.c_str());
     break;
 
-  case ChunkType::DataChunk:
+  case ChunkType::DataChunk: {
     LOG_DEBUG2("sending clipboard chunk data: size=%i", dataChunk.size());
+
+    // slice the chunk into several data messages, which the receiver
+    // appends one after the other just the same.  the last slice is
+    // sent below.
+    size_t offset = 0;
+    for (; dataChunk.size() - offset > s_maxMessageDataSize; offset += s_maxMessageDataSize) {
+      std::string slice = dataChunk.substr(offset, s_maxMessageDataSize);
+      ProtocolUtil::writefBulk(stream, kMsgDClipboard, id, sequence, mark, &slice);
+    }
+    dataChunk.erase(0, offset);
+    break;
+  }
+
+  case ChunkType::DataCompressedChunk:
+    // compressed from one block, so it's small enough to send whole
+    LOG_DEBUG2("sending clipboard chunk compressed: size=%i", dataChunk.size());
     break;
 
   case ChunkType::DataEnd:
@@ -126,5 +224,5 @@ void ClipboardChunk::send(deskflow::IStream *stream, void *data)
     break;
   }
 
-  ProtocolUtil::writef(stream, kMsgDClipboard, id, sequence, mark, &dataChunk);
+  ProtocolUtil::writefBulk(stream, kMsgDClipboard, id, sequence, mark, &dataChunk);
 }
@@ -10,14 +10,33 @@
 #include "deskflow/ClipboardTypes.h"
 #include "deskflow/ProtocolTypes.h"
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 constexpr static auto s_clipboardChunkMetaSize = 7;
 
+// clipboard data is compressed in blocks no bigger than this, so that each
+// compressed chunk is sent in one message and is cheap to check on arrival
+constexpr static size_t s_clipboardCompressBlockSize = 16 * 1024; // 16kb
+
 namespace deskflow {
 class IStream;
 };
 
+//! A clipboard transfer being received
+struct ClipboardTransfer
+{
+  // the data received so far
+  std::string m_data;
+
+  // the size the transfer's first chunk said it would be
+  size_t m_expectedSize = 0;
+
+  // true if the rest of the transfer's messages are being dropped
+  bool m_dropping = false;
+};
+
 class ClipboardChunk : public Chunk
 {
 public:
@@ -27,16 +46,32 @@ public:
   static ClipboardChunk *data(ClipboardID id, uint32_t sequence, const std::string &data);
   static ClipboardChunk *end(ClipboardID id, uint32_t sequence);
 
-  static TransferState
-  assemble(deskflow::IStream *stream, std::string &dataCached, ClipboardID &id, uint32_t &sequence);
+  //! Create a compressed data chunk
+  /*!
+  \p data must be a block compressed by compress().
+  */
+  static ClipboardChunk *compressed(ClipboardID id, uint32_t sequence, const std::string &data);
 
-  static void send(deskflow::IStream *stream, void *data);
+  //! Compress a block of clipboard data
+  /*!
+  Compresses \p data, no bigger than \c s_clipboardCompressBlockSize, into
+  \p compressed in the form a \c DataCompressedChunk carries.  Returns false,
+  leaving \p compressed alone, if compressing wouldn't make it smaller.
+  */
+  static bool compress(std::string_view data, std::string &compressed);
 
-  static size_t getExpectedSize()
-  {
-    return s_expectedSize;
-  }
+  //! Read a clipboard message
+  /*!
+  Reads a \c kMsgDClipboard message and adds its data to \p transfer.
+  Compressed chunks are decompressed.  A transfer of more than \p maxSize
+  bytes, or with a chunk that would take it past the size its first chunk
+  said, is dropped and the rest of its messages return
+  \c TransferState::Error.
+  */
+  static TransferState assemble(
+      deskflow::IStream *stream, ClipboardTransfer &transfer, ClipboardID &id, uint32_t &sequence,
+      size_t maxSize = SIZE_MAX
+  );
 
-private:
-  static size_t s_expectedSize;
+  static void send(deskflow::IStream *stream, void *data);
 };
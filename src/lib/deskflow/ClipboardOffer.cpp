@@ -0,0 +1,105 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include "deskflow/ClipboardOffer.h"
+
+#include <QCryptographicHash>
+
+static uint32_t readUInt32(const char *buf)
+{
+  const auto *ubuf = reinterpret_cast<const unsigned char *>(buf);
+  return (static_cast<uint32_t>(ubuf[0]) << 24) | (static_cast<uint32_t>(ubuf[1]) << 16) |
+         (static_cast<uint32_t>(ubuf[2]) << 8) | static_cast<uint32_t>(ubuf[3]);
+}
+
+//
+// ClipboardOffer
+//
+
+ClipboardOffer ClipboardOffer::fromData(std::string_view data)
+{
+  ClipboardOffer offer;
+  offer.m_digest = hash(data);
+  offer.m_size = data.size();
+
+  // the number of formats, then each format and its size ahead of its
+  // data.  see IClipboard::marshall().
+  if (data.size() < 4) {
+    return offer;
+  }
+  const uint32_t count = readUInt32(data.data());
+  size_t index = 4;
+  for (uint32_t i = 0; i < count && data.size() - index >= 8; ++i) {
+    Item item;
+    item.m_format = static_cast<IClipboard::Format>(readUInt32(data.data() + index));
+    item.m_size = readUInt32(data.data() + index + 4);
+    offer.m_items.push_back(item);
+    index += 8 + item.m_size;
+    if (index > data.size()) {
+      break;
+    }
+  }
+  return offer;
+}
+
+bool ClipboardOffer::decode(const Digest &digest, const std::vector<uint32_t> &items, ClipboardOffer &offer)
+{
+  if (items.size() % 2 != 0) {
+    return false;
+  }
+
+  offer.m_items.clear();
+  offer.m_digest = digest;
+  offer.m_size = 4;
+  for (size_t i = 0; i < items.size(); i += 2) {
+    offer.m_size += 8 + static_cast<size_t>(items[i + 1]);
+
+    // a newer peer may have formats we don't
+    if (items[i] < static_cast<uint32_t>(IClipboard::Format::TotalFormats)) {
+      offer.m_items.push_back({static_cast<IClipboard::Format>(items[i]), items[i + 1]});
+    }
+  }
+  return true;
+}
+
+std::vector<uint32_t> ClipboardOffer::encode() const
+{
+  std::vector<uint32_t> items;
+  items.reserve(m_items.size() * 2);
+  for (const auto &item : m_items) {
+    items.push_back(static_cast<uint32_t>(item.m_format));
+    items.push_back(item.m_size);
+  }
+  return items;
+}
+
+bool ClipboardOffer::matches(std::string_view data) const
+{
+  return data.size() == m_size && hash(data) == m_digest;
+}
+
+std::vector<IClipboard::Format> ClipboardOffer::getFormats() const
+{
+  std::vector<IClipboard::Format> formats;
+  formats.reserve(m_items.size());
+  for (const auto &item : m_items) {
+    formats.push_back(item.m_format);
+  }
+  return formats;
+}
+
+ClipboardOffer::Digest ClipboardOffer::hash(std::string_view data)
+{
+  // truncated, as it only has to tell one clipboard from another
+  const auto sha256 = QCryptographicHash::hash(
+      QByteArray::fromRawData(data.data(), static_cast<qsizetype>(data.size())), QCryptographicHash::Sha256
+  );
+  Digest digest;
+  for (size_t i = 0; i < digest.size(); ++i) {
+    digest[i] = readUInt32(sha256.constData() + i * 4);
+  }
+  return digest;
+}
@@ -0,0 +1,104 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#pragma once
+
+#include "deskflow/IClipboard.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//! What's offered of a clipboard
+/*!
+Describes a marshalled clipboard without its data, as a
+\c kMsgDClipboardOffer message carries it:  the formats it has, the size
+of each, and a digest of the marshalled data.  The receiver can take
+ownership of the formats and only fetch the data when it's pasted, or
+skip fetching it if it already has data that matches.
+*/
+class ClipboardOffer
+{
+public:
+  //! The first 128 bits of the SHA-256 of marshalled data
+  using Digest = std::array<uint32_t, 4>;
+
+  //! A format on offer
+  struct Item
+  {
+    IClipboard::Format m_format = IClipboard::Format::Text;
+    uint32_t m_size = 0;
+  };
+
+  //! @name accessors
+  //@{
+
+  //! Describe marshalled clipboard data
+  /*!
+  Returns the offer for \p data, as returned by IClipboard::marshall().
+  */
+  static ClipboardOffer fromData(std::string_view data);
+
+  //! Decode an offer
+  /*!
+  Sets \p offer from the \p digest and \p items of a
+  \c kMsgDClipboardOffer message.  Formats this version doesn't know are
+  left out, but still count towards the size.  Returns false if \p items
+  isn't whole format and size pairs.
+  */
+  static bool decode(const Digest &digest, const std::vector<uint32_t> &items, ClipboardOffer &offer);
+
+  //! Encode the formats
+  /*!
+  Returns the format and size pairs of a \c kMsgDClipboardOffer message.
+  */
+  std::vector<uint32_t> encode() const;
+
+  //! Test if data is what's offered
+  /*!
+  Returns true if marshalled \p data has the size and digest of the offer.
+  */
+  bool matches(std::string_view data) const;
+
+  //! Get the formats on offer
+  std::vector<IClipboard::Format> getFormats() const;
+
+  //! Get the format and size pairs
+  const std::vector<Item> &getItems() const
+  {
+    return m_items;
+  }
+
+  //! Get the digest of the marshalled data
+  const Digest &getDigest() const
+  {
+    return m_digest;
+  }
+
+  //! Get the size of the marshalled data
+  /*!
+  Returns the size of all the formats offered, including any left out.
+  */
+  size_t getSize() const
+  {
+    return m_size;
+  }
+
+  //! Hash marshalled clipboard data
+  /*!
+  Returns the digest of \p data.
+  */
+  static Digest hash(std::string_view data);
+
+  //@}
+
+private:
+  std::vector<Item> m_items;
+  Digest m_digest = {};
+  size_t m_size = 0;
+};
@@ -0,0 +1,74 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include "deskflow/FastChannel.h"
+
+static void appendUInt32(std::string &out, uint32_t value)
+{
+  out.push_back(static_cast<char>(value >> 24));
+  out.push_back(static_cast<char>(value >> 16));
+  out.push_back(static_cast<char>(value >> 8));
+  out.push_back(static_cast<char>(value));
+}
+
+static uint32_t readUInt32(const uint8_t *in)
+{
+  return (static_cast<uint32_t>(in[0]) << 24) | (static_cast<uint32_t>(in[1]) << 16) |
+         (static_cast<uint32_t>(in[2]) << 8) | static_cast<uint32_t>(in[3]);
+}
+
+//
+// FastChannel
+//
+
+const std::string &FastChannel::frame(std::span<const uint8_t> message)
+{
+  // 0 is for hellos
+  if (++m_sequence == 0) {
+    ++m_sequence;
+  }
+  m_datagram.clear();
+  appendUInt32(m_datagram, m_token);
+  appendUInt32(m_datagram, m_sequence);
+  m_datagram.append(reinterpret_cast<const char *>(message.data()), message.size());
+  return m_datagram;
+}
+
+bool FastChannel::accept(std::span<const uint8_t> datagram, std::span<const uint8_t> &message)
+{
+  uint32_t token;
+  uint32_t sequence;
+  if (!parseHeader(datagram, token, sequence) || token != m_token || isHello(datagram)) {
+    return false;
+  }
+
+  // sequence numbers wrap, so newer is anything up to half way round
+  if (static_cast<int32_t>(sequence - m_sequence) <= 0) {
+    ++m_dropped;
+    return false;
+  }
+  m_sequence = sequence;
+  message = datagram.subspan(kHeaderSize);
+  return true;
+}
+
+std::string FastChannel::hello(uint32_t token)
+{
+  std::string datagram;
+  appendUInt32(datagram, token);
+  appendUInt32(datagram, 0);
+  return datagram;
+}
+
+bool FastChannel::parseHeader(std::span<const uint8_t> datagram, uint32_t &token, uint32_t &sequence)
+{
+  if (datagram.size() < kHeaderSize) {
+    return false;
+  }
+  token = readUInt32(datagram.data());
+  sequence = readUInt32(datagram.data() + 4);
+  return true;
+}
@@ -0,0 +1,91 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+
+//! One end of a fast channel
+/*!
+Frames messages into the datagrams of a \c kMsgCFastChannel channel and
+unframes them again.  The sending end numbers each datagram.  The
+receiving end only accepts a datagram newer than every one it's accepted
+before, so a late datagram never undoes a newer one.
+*/
+class FastChannel
+{
+public:
+  //! Size of the header on every datagram
+  static constexpr uint32_t kHeaderSize = 8;
+
+  //! Largest datagram sent, which fits unfragmented on any link
+  static constexpr uint32_t kMaxDatagramSize = 1200;
+
+  explicit FastChannel(uint32_t token) : m_token(token)
+  {
+    // do nothing
+  }
+
+  //! @name manipulators
+  //@{
+
+  //! Frame a message
+  /*!
+  Returns a datagram carrying \p message with the next sequence number.
+  It's valid until the next call.
+  */
+  const std::string &frame(std::span<const uint8_t> message);
+
+  //! Accept a datagram
+  /*!
+  Returns true and sets \p message to the message \p datagram carries if
+  it's for this channel and newer than any accepted before.  Returns false
+  for hellos, datagrams for other channels and older datagrams, counting
+  the older ones as dropped.
+  */
+  bool accept(std::span<const uint8_t> datagram, std::span<const uint8_t> &message);
+
+  //@}
+  //! @name accessors
+  //@{
+
+  //! Get the token
+  uint32_t getToken() const
+  {
+    return m_token;
+  }
+
+  //! Get the number of datagrams dropped for being older
+  uint32_t getDropped() const
+  {
+    return m_dropped;
+  }
+
+  //! Make a hello
+  static std::string hello(uint32_t token);
+
+  //! Read the header of a datagram
+  /*!
+  Returns false if \p datagram is too short to have one.
+  */
+  static bool parseHeader(std::span<const uint8_t> datagram, uint32_t &token, uint32_t &sequence);
+
+  //! Test if a datagram is a hello
+  static bool isHello(std::span<const uint8_t> datagram)
+  {
+    return datagram.size() == kHeaderSize;
+  }
+
+  //@}
+
+private:
+  uint32_t m_token;
+  uint32_t m_sequence = 0;
+  uint32_t m_dropped = 0;
+  std::string m_datagram;
+};
@@ -6,6 +6,11 @@
 
 #include "deskflow/IPlatformScreen.h"
 
+bool IPlatformScreen::offerClipboard(ClipboardID, const std::vector<IClipboard::Format> &)
+{
+  return false;
+}
+
 bool IPlatformScreen::fakeMediaKey(KeyID id)
 {
   return false;
@@ -9,13 +9,14 @@
 #pragma once
 
 #include "deskflow/ClipboardTypes.h"
+#include "deskflow/IClipboard.h"
 #include "deskflow/IKeyState.h"
 #include "deskflow/IPrimaryScreen.h"
 #include "deskflow/IScreen.h"
 #include "deskflow/ISecondaryScreen.h"
 #include "deskflow/OptionTypes.h"
 
-class IClipboard;
+#include <vector>
 
 //! Screen interface
 /*!
@@ -77,6 +78,16 @@ public:
   */
   virtual bool setClipboard(ClipboardID id, const IClipboard *) = 0;
 
+  //! Offer clipboard
+  /*!
+  Takes ownership of the system clipboard indicated by \c id with
+  \p formats but without their data, which is set by setClipboard()
+  later.  While waiting for it, a \c ClipboardRequested event is sent
+  when something asks for the data.  Returns false if the screen can't
+  wait for the data, in which case nothing has changed.
+  */
+  virtual bool offerClipboard(ClipboardID id, const std::vector<IClipboard::Format> &formats);
+
   //! Check clipboard owner
   /*!
   Check ownership of all clipboards and post grab events for any that
@@ -35,41 +35,6 @@ bool IPrimaryScreen::ButtonInfo::equal(const ButtonInfo *a, const ButtonInfo *b)
   return (a->m_button == b->m_button && a->m_mask == b->m_mask);
 }
 
-//
-// IPrimaryScreen::MotionInfo
-//
-
-IPrimaryScreen::MotionInfo *IPrimaryScreen::MotionInfo::alloc(int32_t x, int32_t y)
-{
-  auto *info = (MotionInfo *)malloc(sizeof(MotionInfo));
-  info->m_x = x;
-  info->m_y = y;
-  return info;
-}
-
-//
-// IPrimaryScreen::WheelInfo
-//
-
-IPrimaryScreen::WheelInfo *IPrimaryScreen::WheelInfo::alloc(int32_t xDelta, int32_t yDelta)
-{
-  auto *info = (WheelInfo *)malloc(sizeof(WheelInfo));
-  info->m_xDelta = xDelta;
-  info->m_yDelta = yDelta;
-  return info;
-}
-
-//
-// IPrimaryScreen::HotKeyInfo
-//
-
-IPrimaryScreen::HotKeyInfo *IPrimaryScreen::HotKeyInfo::alloc(uint32_t id)
-{
-  auto *info = (HotKeyInfo *)malloc(sizeof(HotKeyInfo));
-  info->m_id = id;
-  return info;
-}
-
 //
 // IPrimaryScreen::EiConnectInfo
 //
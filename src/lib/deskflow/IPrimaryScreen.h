@@ -38,9 +38,6 @@ public:
   //! Motion event data
   class MotionInfo
   {
-  public:
-    static MotionInfo *alloc(int32_t x, int32_t y);
-
   public:
     int32_t m_x;
     int32_t m_y;
@@ -48,9 +45,6 @@ public:
   //! Wheel motion event data
   class WheelInfo
   {
-  public:
-    static WheelInfo *alloc(int32_t xDelta, int32_t yDelta);
-
   public:
     int32_t m_xDelta;
     int32_t m_yDelta;
@@ -58,9 +52,6 @@ public:
   //! Hot key event data
   class HotKeyInfo
   {
-  public:
-    static HotKeyInfo *alloc(uint32_t id);
-
   public:
     uint32_t m_id;
   };
@@ -709,20 +709,22 @@ void KeyState::sendKeyEvent(
 )
 {
   using enum EventTypes;
+  KeyInfo info{key, mask, button, 1, nullptr, {}};
   if (m_keyMap.isHalfDuplex(key, button)) {
     if (isAutoRepeat) {
       // ignore auto-repeat on half-duplex keys
     } else {
-      m_events->addEvent(Event(KeyStateKeyDown, target, KeyInfo::alloc(key, mask, button, 1)));
-      m_events->addEvent(Event(KeyStateKeyUp, target, KeyInfo::alloc(key, mask, button, 1)));
+      m_events->addEvent(Event(KeyStateKeyDown, target, info));
+      m_events->addEvent(Event(KeyStateKeyUp, target, info));
     }
   } else {
     if (isAutoRepeat) {
-      m_events->addEvent(Event(KeyStateKeyRepeat, target, KeyInfo::alloc(key, mask, button, count)));
+      info.m_count = count;
+      m_events->addEvent(Event(KeyStateKeyRepeat, target, info));
     } else if (press) {
-      m_events->addEvent(Event(KeyStateKeyDown, target, KeyInfo::alloc(key, mask, button, 1)));
+      m_events->addEvent(Event(KeyStateKeyDown, target, info));
     } else {
-      m_events->addEvent(Event(KeyStateKeyUp, target, KeyInfo::alloc(key, mask, button, 1)));
+      m_events->addEvent(Event(KeyStateKeyUp, target, info));
     }
   }
 }
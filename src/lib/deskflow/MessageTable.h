@@ -0,0 +1,138 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#pragma once
+
+#include "deskflow/ProtocolMessages.h"
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+
+//! Message handler table
+/*!
+Maps message codes to handlers in constant time.  Each code has a slot of
+its own, picked by a multiplicative hash whose multiplier is found at
+compile time so that no two protocol messages share a slot, so a lookup
+is a multiply and a compare.  Setting a handler for a code that already
+has one replaces it, so a newer protocol version can take over a message
+from the version it extends.
+*/
+template <typename Handler> class MessageTable
+{
+public:
+  //! @name manipulators
+  //@{
+
+  //! Set a handler
+  /*!
+  Makes \p handler handle messages whose code has the key \p key, see
+  Message::kKey.
+  */
+  void set(uint32_t key, Handler handler)
+  {
+    auto &entry = m_entries[slot(key)];
+    assert(entry.m_handler == nullptr || entry.m_key == key);
+    entry.m_key = key;
+    entry.m_handler = handler;
+  }
+
+  //@}
+  //! @name accessors
+  //@{
+
+  //! Find a handler
+  /*!
+  Returns the handler for the 4 byte code at \p code, or nullptr if there
+  isn't one.
+  */
+  Handler find(const uint8_t *code) const
+  {
+    const uint32_t key = messageKey(code);
+    const auto &entry = m_entries[slot(key)];
+    return entry.m_key == key ? entry.m_handler : nullptr;
+  }
+
+  //@}
+
+private:
+  struct Entry
+  {
+    uint32_t m_key = 0;
+    Handler m_handler = nullptr;
+  };
+
+  static constexpr uint32_t s_bits = 7;
+
+  // the codes of all protocol messages
+  static constexpr std::array s_keys{
+      MsgCNoop::kKey,
+      MsgCClose::kKey,
+      MsgCEnter::kKey,
+      MsgCLeave::kKey,
+      MsgCClipboard::kKey,
+      MsgCScreenSaver::kKey,
+      MsgCResetOptions::kKey,
+      MsgCInfoAck::kKey,
+      MsgCKeepAlive::kKey,
+      MsgCFastChannel::kKey,
+      MsgDKeyDownLang::kKey,
+      MsgDKeyDown::kKey,
+      MsgDKeyRepeat::kKey,
+      MsgDKeyUp::kKey,
+      MsgDMouseDown::kKey,
+      MsgDMouseUp::kKey,
+      MsgDMouseMove::kKey,
+      MsgDMouseRelMove::kKey,
+      MsgDMouseMotion::kKey,
+      MsgDMouseWheel::kKey,
+      MsgDClipboard::kKey,
+      MsgDClipboardOffer::kKey,
+      MsgDInfo::kKey,
+      MsgDSetOptions::kKey,
+      MsgDFileTransfer::kKey,
+      MsgDDragInfo::kKey,
+      MsgDSecureInputNotification::kKey,
+      MsgDLanguageSynchronisation::kKey,
+      MsgQInfo::kKey,
+      MsgQClipboard::kKey,
+      MsgEIncompatible::kKey,
+      MsgEBusy::kKey,
+      MsgEUnknown::kKey,
+      MsgEBad::kKey,
+  };
+
+  static constexpr uint32_t slot(uint32_t key, uint32_t multiplier)
+  {
+    return (key * multiplier) >> (32 - s_bits);
+  }
+
+  // the first odd multiplier that gives every protocol message a slot of its own
+  static consteval uint32_t findMultiplier()
+  {
+    for (uint32_t multiplier = 0x9e3779b1;; multiplier += 2) {
+      std::array<bool, 1 << s_bits> used{};
+      bool unique = true;
+      for (const auto key : s_keys) {
+        const auto index = slot(key, multiplier);
+        unique = unique && !used[index];
+        used[index] = true;
+      }
+      if (unique) {
+        return multiplier;
+      }
+    }
+  }
+
+  static constexpr uint32_t s_multiplier = findMultiplier();
+
+  static constexpr uint32_t slot(uint32_t key)
+  {
+    return slot(key, s_multiplier);
+  }
+
+  std::array<Entry, 1 << s_bits> m_entries{};
+};
@@ -0,0 +1,110 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include "deskflow/MotionBatch.h"
+
+#include <utility>
+
+static void encodeVarint(std::string &out, uint64_t value)
+{
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+static bool decodeVarint(std::string_view &in, uint64_t &value)
+{
+  value = 0;
+  for (uint32_t shift = 0; shift < 64 && !in.empty(); shift += 7) {
+    const auto byte = static_cast<uint8_t>(in.front());
+    in.remove_prefix(1);
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static uint64_t zigzag(int64_t value)
+{
+  return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+static int64_t unzigzag(uint64_t value)
+{
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+//
+// MotionBatch
+//
+
+void MotionBatch::add(const Sample &sample)
+{
+  encodeVarint(m_data, (static_cast<uint64_t>(sample.m_offset) << 1) | (sample.m_relative ? 1 : 0));
+  if (sample.m_relative) {
+    encodeVarint(m_data, zigzag(sample.m_x));
+    encodeVarint(m_data, zigzag(sample.m_y));
+  } else {
+    encodeVarint(m_data, zigzag(static_cast<int64_t>(sample.m_x) - m_x));
+    encodeVarint(m_data, zigzag(static_cast<int64_t>(sample.m_y) - m_y));
+    m_x = sample.m_x;
+    m_y = sample.m_y;
+  }
+  ++m_count;
+}
+
+void MotionBatch::clear()
+{
+  m_data.clear();
+  m_count = 0;
+  m_x = 0;
+  m_y = 0;
+}
+
+bool MotionBatch::decode(std::string_view data, std::vector<Sample> &samples)
+{
+  int64_t x = 0;
+  int64_t y = 0;
+  while (!data.empty()) {
+    uint64_t header;
+    uint64_t xBits;
+    uint64_t yBits;
+    if (!decodeVarint(data, header) || !decodeVarint(data, xBits) || !decodeVarint(data, yBits)) {
+      return false;
+    }
+
+    // a difference between two 32 bit positions fits in 34 zigzag bits
+    if (!std::in_range<uint32_t>(header >> 1) || (xBits >> 34) != 0 || (yBits >> 34) != 0) {
+      return false;
+    }
+
+    Sample sample;
+    sample.m_relative = (header & 1) != 0;
+    sample.m_offset = static_cast<uint32_t>(header >> 1);
+
+    int64_t xNew = unzigzag(xBits);
+    int64_t yNew = unzigzag(yBits);
+    if (!sample.m_relative) {
+      xNew += x;
+      yNew += y;
+    }
+    if (!std::in_range<int32_t>(xNew) || !std::in_range<int32_t>(yNew)) {
+      return false;
+    }
+    sample.m_x = static_cast<int32_t>(xNew);
+    sample.m_y = static_cast<int32_t>(yNew);
+    if (!sample.m_relative) {
+      x = xNew;
+      y = yNew;
+    }
+    samples.push_back(sample);
+  }
+  return true;
+}
@@ -0,0 +1,79 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//! Batch of mouse motion samples
+/*!
+Packs mouse motion samples, absolute and relative, into the payload of a
+\c kMsgDMouseMotion message and unpacks them again.  Each sample is three
+varints:  its time offset in microseconds shifted up one bit with the low
+bit set for relative motion, then x and y zigzag encoded.  An absolute
+sample's x and y are the difference from the last absolute sample in the
+batch, or from 0,0 for the first, so a smooth path takes 3 or 4 bytes a
+sample.
+*/
+class MotionBatch
+{
+public:
+  //! Motion sample
+  struct Sample
+  {
+    //! Microseconds since the sample before
+    uint32_t m_offset = 0;
+
+    //! True if \c m_x and \c m_y are a relative move
+    bool m_relative = false;
+
+    int32_t m_x = 0;
+    int32_t m_y = 0;
+  };
+
+  //! @name manipulators
+  //@{
+
+  //! Add a sample
+  void add(const Sample &sample);
+
+  //! Remove all samples
+  void clear();
+
+  //@}
+  //! @name accessors
+  //@{
+
+  //! Get the encoded samples
+  const std::string &getData() const
+  {
+    return m_data;
+  }
+
+  //! Get the number of samples
+  uint32_t getCount() const
+  {
+    return m_count;
+  }
+
+  //! Decode samples
+  /*!
+  Appends the samples encoded in \p data to \p samples.  Returns false if
+  \p data isn't whole samples.
+  */
+  static bool decode(std::string_view data, std::vector<Sample> &samples);
+
+  //@}
+
+private:
+  std::string m_data;
+  uint32_t m_count = 0;
+  int32_t m_x = 0;
+  int32_t m_y = 0;
+};
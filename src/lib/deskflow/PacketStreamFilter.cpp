@@ -9,8 +9,45 @@
 #include "base/IEventQueue.h"
 #include "deskflow/ProtocolTypes.h"
 
+#include <array>
 #include <cstring>
 #include <memory>
+#include <vector>
+
+static const uint32_t s_readSize = 4096;
+static const uint32_t s_bulkSendSize = 16 * 1024;
+static const uint32_t s_stackPacketSize = 256;
+
+static void packSize(uint8_t *length, uint32_t count)
+{
+  length[0] = (uint8_t)((count >> 24) & 0xff);
+  length[1] = (uint8_t)((count >> 16) & 0xff);
+  length[2] = (uint8_t)((count >> 8) & 0xff);
+  length[3] = (uint8_t)(count & 0xff);
+}
+
+// passes the length and payload to send as one packet, so it's one write
+template <typename Send> static auto sendPacket(const void *buffer, uint32_t count, Send send)
+{
+  const uint32_t size = 4 + count;
+  std::array<uint8_t, s_stackPacketSize> small;
+  std::vector<uint8_t> large;
+  uint8_t *packet = small.data();
+  if (size > small.size()) {
+    large.resize(size);
+    packet = large.data();
+  }
+  packSize(packet, count);
+  if (count > 0) {
+    memcpy(packet + 4, buffer, count);
+  }
+  return send(packet, size);
+}
+
+static uint32_t unpackSize(const uint8_t *length)
+{
+  return ((uint32_t)length[0] << 24) | ((uint32_t)length[1] << 16) | ((uint32_t)length[2] << 8) | (uint32_t)length[3];
+}
 
 //
 // PacketStreamFilter
@@ -28,6 +65,8 @@ void PacketStreamFilter::close()
   std::scoped_lock lock{m_mutex};
   m_size = 0;
   m_buffer.pop(m_buffer.getSize());
+  m_bulk.pop(m_bulk.getSize());
+  m_bulkPending = false;
   StreamFilter::close();
 }
 
@@ -51,9 +90,10 @@ uint32_t PacketStreamFilter::read(void *buffer, uint32_t n)
 
   // read it
   if (buffer != nullptr) {
-    memcpy(buffer, m_buffer.peek(n), n);
+    m_buffer.read(buffer, n);
+  } else {
+    m_buffer.pop(n);
   }
-  m_buffer.pop(n);
   m_size -= n;
 
   // get next packet's size if we've finished with this packet and
@@ -67,18 +107,85 @@ uint32_t PacketStreamFilter::read(void *buffer, uint32_t n)
   return n;
 }
 
+uint32_t PacketStreamFilter::peekPackets(std::span<std::span<const uint8_t>> packets)
+{
+  std::scoped_lock lock{m_mutex};
+
+  if (packets.empty() || !isReadyNoLock()) {
+    return 0;
+  }
+
+  // the packet being read is first, its size already taken off the
+  // buffer.  making it contiguous may move the bytes so do it first.
+  const auto *data = static_cast<const uint8_t *>(m_buffer.peek(m_size));
+  packets[0] = std::span<const uint8_t>(data, m_size);
+  uint32_t count = 1;
+
+  // then whole packets up to the end of the ring.  one that wraps around
+  // it waits until it's first.
+  const auto run = m_buffer.getReadViews()[0];
+  uint32_t offset = m_size;
+  while (count < packets.size() && offset + 4 <= run.size()) {
+    const uint32_t size = unpackSize(run.data() + offset);
+    if (size == 0 || size > PROTOCOL_MAX_MESSAGE_LENGTH || offset + 4 + size > run.size()) {
+      break;
+    }
+    packets[count++] = run.subspan(offset + 4, size);
+    offset += 4 + size;
+  }
+  return count;
+}
+
+void PacketStreamFilter::popPackets(uint32_t n)
+{
+  std::scoped_lock lock{m_mutex};
+
+  for (; n > 0 && isReadyNoLock(); --n) {
+    m_buffer.pop(m_size);
+    m_size = 0;
+    readPacketSize();
+  }
+
+  if (m_inputShutdown && m_size == 0) {
+    m_events->addEvent(Event(EventTypes::StreamInputShutdown, getEventTarget()));
+  }
+}
+
 void PacketStreamFilter::write(const void *buffer, uint32_t count)
 {
-  // write the length of the payload
+  sendPacket(buffer, count, [this](const uint8_t *packet, uint32_t size) {
+    std::scoped_lock lock{m_mutex};
+    getStream()->write(packet, size);
+  });
+}
+
+void PacketStreamFilter::writeBulk(const void *buffer, uint32_t count)
+{
+  std::scoped_lock lock{m_mutex};
+
+  // queue the whole packet in the bulk lane
   uint8_t length[4];
-  length[0] = (uint8_t)((count >> 24) & 0xff);
-  length[1] = (uint8_t)((count >> 16) & 0xff);
-  length[2] = (uint8_t)((count >> 8) & 0xff);
-  length[3] = (uint8_t)(count & 0xff);
-  getStream()->write(length, sizeof(length));
+  packSize(length, count);
+  m_bulk.write(length, sizeof(length));
+  m_bulk.write(buffer, count);
+
+  sendBulk();
+}
+
+void PacketStreamFilter::writeLatest(const void *buffer, uint32_t count)
+{
+  sendPacket(buffer, count, [this](const uint8_t *packet, uint32_t size) {
+    std::scoped_lock lock{m_mutex};
+    getStream()->writeLatest(packet, size);
+  });
+}
 
-  // write the payload
-  getStream()->write(buffer, count);
+bool PacketStreamFilter::replaceLatest(const void *buffer, uint32_t count)
+{
+  return sendPacket(buffer, count, [this](const uint8_t *packet, uint32_t size) {
+    std::scoped_lock lock{m_mutex};
+    return getStream()->replaceLatest(packet, size);
+  });
 }
 
 void PacketStreamFilter::shutdownInput()
@@ -89,6 +196,14 @@ void PacketStreamFilter::shutdownInput()
   StreamFilter::shutdownInput();
 }
 
+void PacketStreamFilter::shutdownOutput()
+{
+  std::scoped_lock lock{m_mutex};
+  m_bulk.pop(m_bulk.getSize());
+  m_bulkPending = false;
+  StreamFilter::shutdownOutput();
+}
+
 bool PacketStreamFilter::isReady() const
 {
   std::scoped_lock lock{m_mutex};
@@ -112,10 +227,8 @@ bool PacketStreamFilter::readPacketSize()
 
   if (m_size == 0 && m_buffer.getSize() >= 4) {
     uint8_t buffer[4];
-    memcpy(buffer, m_buffer.peek(sizeof(buffer)), sizeof(buffer));
-    m_buffer.pop(sizeof(buffer));
-    m_size =
-        ((uint32_t)buffer[0] << 24) | ((uint32_t)buffer[1] << 16) | ((uint32_t)buffer[2] << 8) | (uint32_t)buffer[3];
+    m_buffer.read(buffer, sizeof(buffer));
+    m_size = unpackSize(buffer);
     if (m_size > PROTOCOL_MAX_MESSAGE_LENGTH) {
       m_events->addEvent(Event(EventTypes::StreamInputFormatError, getEventTarget()));
       return false;
@@ -129,11 +242,11 @@ bool PacketStreamFilter::readMore()
   // note if we have whole packet
   bool wasReady = isReadyNoLock();
 
-  // read more data
-  char buffer[4096];
-  uint32_t n = getStream()->read(buffer, sizeof(buffer));
+  // read more data straight into the buffer's free space
+  auto view = m_buffer.reserve(s_readSize)[0];
+  uint32_t n = getStream()->read(view.data(), static_cast<uint32_t>(view.size()));
   while (n > 0) {
-    m_buffer.write(buffer, n);
+    m_buffer.commit(n);
 
     // if we don't yet have the next packet size then get it, if possible.
     // Note that we can't wait for whole pending data to arrive because it may be huge in
@@ -142,7 +255,8 @@ bool PacketStreamFilter::readMore()
       break;
     }
 
-    n = getStream()->read(buffer, sizeof(buffer));
+    view = m_buffer.reserve(s_readSize)[0];
+    n = getStream()->read(view.data(), static_cast<uint32_t>(view.size()));
   }
 
   // note if we now have a whole packet
@@ -153,9 +267,34 @@ bool PacketStreamFilter::readMore()
   return (wasReady != isReady);
 }
 
+void PacketStreamFilter::sendBulk()
+{
+  // note -- m_mutex must be locked on entry
+
+  // wait until the stream has flushed the last lot
+  if (m_bulkPending) {
+    return;
+  }
+
+  // hand down whole packets until there's enough to keep it busy
+  uint32_t sent = 0;
+  while (sent < s_bulkSendSize && m_bulk.getSize() > 0) {
+    const uint32_t size = 4 + unpackSize(static_cast<const uint8_t *>(m_bulk.peek(4)));
+    getStream()->writeBulk(m_bulk.peek(size), size);
+    m_bulk.pop(size);
+    sent += size;
+  }
+  m_bulkPending = (sent > 0);
+}
+
 void PacketStreamFilter::filterEvent(const Event &event)
 {
-  if (event.getType() == EventTypes::StreamInputReady) {
+  if (event.getType() == EventTypes::StreamOutputFlushed) {
+    // the stream is ready for more bulk data
+    std::scoped_lock lock{m_mutex};
+    m_bulkPending = false;
+    sendBulk();
+  } else if (event.getType() == EventTypes::StreamInputReady) {
     std::scoped_lock lock{m_mutex};
     if (!readMore()) {
       return;
@@ -17,6 +17,17 @@ class IEventQueue;
 //! Packetizing stream filter
 /*!
 Filters a stream to read and write packets.
+
+Packets written with \c writeBulk() wait in a lane of their own and are
+handed down a few at a time, each time the stream below has flushed what
+it was given, so packets written with \c write() only ever queue behind
+a little bulk data.  \c flush() doesn't wait for the bulk lane.
+
+A packet written with \c writeLatest() goes down as one write, length
+and payload together, so \c replaceLatest() can overwrite it whole.
+
+\c peekPackets() returns whole packets where they are in the input
+buffer, so a burst of them can be handled without a read per field.
 */
 class PacketStreamFilter : public StreamFilter
 {
@@ -27,8 +38,14 @@ public:
   // IStream overrides
   void close() override;
   uint32_t read(void *buffer, uint32_t n) override;
+  uint32_t peekPackets(std::span<std::span<const uint8_t>> packets) override;
+  void popPackets(uint32_t n) override;
   void write(const void *buffer, uint32_t n) override;
+  void writeBulk(const void *buffer, uint32_t n) override;
+  void writeLatest(const void *buffer, uint32_t n) override;
+  bool replaceLatest(const void *buffer, uint32_t n) override;
   void shutdownInput() override;
+  void shutdownOutput() override;
   bool isReady() const override;
   uint32_t getSize() const override;
 
@@ -40,11 +57,14 @@ private:
   bool isReadyNoLock() const;
   bool readPacketSize();
   bool readMore();
+  void sendBulk();
 
 private:
   mutable std::mutex m_mutex;
   uint32_t m_size = 0;
   StreamBuffer m_buffer;
   bool m_inputShutdown = false;
+  StreamBuffer m_bulk;
+  bool m_bulkPending = false;
   IEventQueue *m_events = nullptr;
 };
@@ -0,0 +1,371 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#pragma once
+
+#include "deskflow/DeskflowException.h"
+#include "deskflow/ProtocolTypes.h"
+#include "io/IStream.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+//! Message code
+/*!
+The 4 character code a message starts with, usable as a template
+argument.
+*/
+struct MessageCode
+{
+  consteval MessageCode(const char (&code)[5])
+  {
+    std::copy_n(code, 4, m_code);
+  }
+
+  char m_code[4];
+};
+
+//! Get a message code as a number
+/*!
+The 4 bytes at \p code as a big-endian number, to switch on.
+*/
+inline uint32_t messageKey(const uint8_t *code)
+{
+  return (static_cast<uint32_t>(code[0]) << 24) | (static_cast<uint32_t>(code[1]) << 16) |
+         (static_cast<uint32_t>(code[2]) << 8) | static_cast<uint32_t>(code[3]);
+}
+
+//! Typed protocol message
+/*!
+Encodes and decodes a message whose layout is known at compile time:
+the 4 character \p Code followed by \p Fields in order.  An integer field
+is sent big-endian in as many bytes as its type.  A \c std::string or a
+\c std::vector of integers, which must be the last field, is sent as a 4
+byte count and then its bytes or elements.  That's the wire format of
+ProtocolUtil::writef() and readf() with the matching format string,
+without parsing the format or allocating per message.
+*/
+template <MessageCode Code, typename... Fields> class Message
+{
+  template <typename T> struct IsList : std::false_type
+  {
+  };
+  template <typename T> struct IsList<std::vector<T>> : std::true_type
+  {
+  };
+
+  template <typename T> static constexpr bool s_isString = std::is_same_v<T, std::string>;
+  template <typename T> static constexpr bool s_isList = IsList<T>::value;
+  template <typename T> static constexpr bool s_isVariable = s_isString<T> || s_isList<T>;
+
+  template <typename T> static constexpr bool isInteger()
+  {
+    return std::is_integral_v<T> && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4);
+  }
+
+  template <typename T> static constexpr uint32_t fieldSize()
+  {
+    if constexpr (s_isList<T>) {
+      static_assert(isInteger<typename T::value_type>());
+      return 4;
+    } else {
+      static_assert(s_isString<T> || isInteger<T>());
+      return s_isString<T> ? 4 : sizeof(T);
+    }
+  }
+
+  static constexpr bool variableIsLast()
+  {
+    bool afterVariable = false;
+    bool ok = true;
+    ((ok = ok && !afterVariable, afterVariable = s_isVariable<Fields>), ...);
+    return ok;
+  }
+
+public:
+  //! True if the last field is a string or a list
+  static constexpr bool kHasVariable = (s_isVariable<Fields> || ...);
+
+  //! Size of the code and all fields, counting only the count of a string or list
+  static constexpr uint32_t kFixedSize = 4 + (fieldSize<Fields>() + ... + 0);
+
+  //! The code as a number, see messageKey()
+  static constexpr uint32_t kKey = (static_cast<uint32_t>(static_cast<uint8_t>(Code.m_code[0])) << 24) |
+                                   (static_cast<uint32_t>(static_cast<uint8_t>(Code.m_code[1])) << 16) |
+                                   (static_cast<uint32_t>(static_cast<uint8_t>(Code.m_code[2])) << 8) |
+                                   static_cast<uint32_t>(static_cast<uint8_t>(Code.m_code[3]));
+
+  //! The field types, to decode into with std::apply()
+  using Values = std::tuple<Fields...>;
+
+  static_assert(variableIsLast(), "a string or a list must be the last field");
+
+  //! @name accessors
+  //@{
+
+  //! Get the code
+  static constexpr const char *getCode()
+  {
+    return s_code.data();
+  }
+
+  //! Check a code
+  /*!
+  Returns true if the 4 bytes at \p code are this message's code.
+  */
+  static bool isCode(const uint8_t *code)
+  {
+    return memcmp(code, s_code.data(), 4) == 0;
+  }
+
+  //! Get the encoded size
+  static uint32_t getSize(const Fields &...values)
+  {
+    uint32_t size = kFixedSize;
+    ((size += variableSize(values)), ...);
+    return size;
+  }
+
+  //@}
+  //! @name manipulators
+  //@{
+
+  //! Encode a message
+  /*!
+  Writes the message, code and all, to \p out, which must have room for
+  getSize() bytes.  Returns the end of what was written.
+  */
+  static uint8_t *encode(uint8_t *out, const Fields &...values)
+  {
+    out = std::copy_n(s_code.begin(), 4, out);
+    ((out = encodeField(out, values)), ...);
+    return out;
+  }
+
+  //! Encode a message without a string or list
+  static std::array<uint8_t, kFixedSize> encode(const Fields &...values)
+    requires(!kHasVariable)
+  {
+    std::array<uint8_t, kFixedSize> message;
+    encode(message.data(), values...);
+    return message;
+  }
+
+  //! Write a message
+  /*!
+  Encodes the message on the stack and writes it to \p stream in one
+  write.
+  */
+  static void write(deskflow::IStream *stream, const Fields &...values)
+  {
+    if constexpr (!kHasVariable) {
+      const auto message = encode(values...);
+      stream->write(message.data(), kFixedSize);
+    } else {
+      // a short string, like a keyboard language, fits on the stack
+      std::array<uint8_t, kFixedSize + 64> small;
+      std::vector<uint8_t> large;
+      const uint32_t size = getSize(values...);
+      uint8_t *message = small.data();
+      if (size > small.size()) {
+        large.resize(size);
+        message = large.data();
+      }
+      encode(message, values...);
+      stream->write(message, size);
+    }
+  }
+
+  //! Decode a message
+  /*!
+  Parses the fields from the \p size bytes at \p data, which follow the
+  code.  Returns false if there aren't enough bytes.  Throws
+  BadClientException if a string or list is longer than the protocol
+  allows.
+  */
+  static bool decode(const uint8_t *data, uint32_t size, Fields &...values)
+  {
+    if (size < kFixedSize - 4) {
+      return false;
+    }
+    const uint8_t *in = data;
+    ((in = decodeField(in, values)), ...);
+
+    if constexpr (kHasVariable) {
+      auto &last = std::get<sizeof...(Fields) - 1>(std::tie(values...));
+      if (size - (kFixedSize - 4) < variableSize(last)) {
+        return false;
+      }
+      decodeElements(in, last);
+    }
+    return true;
+  }
+
+  //! Read a message
+  /*!
+  Reads the fields that follow the code from \p stream, the fixed size
+  ones in a single read.  Returns false if the stream ends first.  Throws
+  BadClientException if a string or list is longer than the protocol
+  allows.
+  */
+  static bool read(deskflow::IStream *stream, Fields &...values)
+  {
+    std::array<uint8_t, kFixedSize - 4> fixed;
+    if (!readAll(stream, fixed.data(), static_cast<uint32_t>(fixed.size()))) {
+      return false;
+    }
+    const uint8_t *in = fixed.data();
+    ((in = decodeField(in, values)), ...);
+
+    if constexpr (kHasVariable) {
+      auto &last = std::get<sizeof...(Fields) - 1>(std::tie(values...));
+      if constexpr (s_isString<std::remove_reference_t<decltype(last)>>) {
+        return readAll(stream, last.data(), variableSize(last));
+      } else {
+        std::vector<uint8_t> elements(variableSize(last));
+        if (!readAll(stream, elements.data(), variableSize(last))) {
+          return false;
+        }
+        decodeElements(elements.data(), last);
+      }
+    }
+    return true;
+  }
+
+  //@}
+
+private:
+  static constexpr std::array<char, 5> s_code{Code.m_code[0], Code.m_code[1], Code.m_code[2], Code.m_code[3], '\0'};
+
+  template <typename T> static uint32_t variableSize(const T &value)
+  {
+    if constexpr (s_isVariable<T>) {
+      return static_cast<uint32_t>(value.size() * sizeof(typename T::value_type));
+    } else {
+      return 0;
+    }
+  }
+
+  template <typename T> static uint8_t *encodeField(uint8_t *out, const T &value)
+  {
+    if constexpr (s_isString<T>) {
+      out = encodeField(out, static_cast<uint32_t>(value.size()));
+      return std::copy(value.begin(), value.end(), out);
+    } else if constexpr (s_isList<T>) {
+      out = encodeField(out, static_cast<uint32_t>(value.size()));
+      for (const auto &element : value) {
+        out = encodeField(out, element);
+      }
+      return out;
+    } else {
+      const auto bits = static_cast<std::make_unsigned_t<T>>(value);
+      for (uint32_t i = sizeof(T); i > 0; --i) {
+        *out++ = static_cast<uint8_t>(bits >> (8 * (i - 1)));
+      }
+      return out;
+    }
+  }
+
+  template <typename T> static const uint8_t *decodeField(const uint8_t *in, T &value)
+  {
+    if constexpr (s_isVariable<T>) {
+      // only the count, the caller fills in the bytes or elements
+      uint32_t count;
+      in = decodeField(in, count);
+      if (count > (s_isString<T> ? PROTOCOL_MAX_STRING_LENGTH : PROTOCOL_MAX_LIST_LENGTH)) {
+        throw BadClientException("Too long message received");
+      }
+      value.resize(count);
+      return in;
+    } else {
+      std::make_unsigned_t<T> bits = 0;
+      for (uint32_t i = 0; i < sizeof(T); ++i) {
+        bits = static_cast<std::make_unsigned_t<T>>((bits << 8) | in[i]);
+      }
+      value = static_cast<T>(bits);
+      return in + sizeof(T);
+    }
+  }
+
+  template <typename T> static void decodeElements(const uint8_t *in, T &value)
+  {
+    if constexpr (s_isString<T>) {
+      std::copy_n(in, value.size(), value.begin());
+    } else {
+      for (auto &element : value) {
+        in = decodeField(in, element);
+      }
+    }
+  }
+
+  static bool readAll(deskflow::IStream *stream, void *buffer, uint32_t n)
+  {
+    auto *bytes = static_cast<uint8_t *>(buffer);
+    while (n > 0) {
+      const uint32_t got = stream->read(bytes, n);
+      if (got == 0) {
+        return false;
+      }
+      bytes += got;
+      n -= got;
+    }
+    return true;
+  }
+};
+
+//! @name Protocol messages
+/*!
+Typed equivalents of the kMsg format strings in ProtocolTypes.h, apart
+from the hello messages, which don't start with a code.  See those for
+what each field means.
+*/
+//@{
+using MsgCNoop = Message<"CNOP">;
+using MsgCClose = Message<"CBYE">;
+using MsgCEnter = Message<"CINN", int16_t, int16_t, uint32_t, uint16_t>;
+using MsgCLeave = Message<"COUT">;
+using MsgCClipboard = Message<"CCLP", uint8_t, uint32_t>;
+using MsgCScreenSaver = Message<"CSEC", int8_t>;
+using MsgCResetOptions = Message<"CROP">;
+using MsgCInfoAck = Message<"CIAK">;
+using MsgCKeepAlive = Message<"CALV">;
+using MsgCFastChannel = Message<"CUDP", uint32_t>;
+using MsgDKeyDownLang = Message<"DKDL", uint16_t, uint16_t, uint16_t, std::string>;
+using MsgDKeyDown = Message<"DKDN", uint16_t, uint16_t, uint16_t>;
+using MsgDKeyDown1_0 = Message<"DKDN", uint16_t, uint16_t>;
+using MsgDKeyRepeat = Message<"DKRP", uint16_t, uint16_t, uint16_t, uint16_t, std::string>;
+using MsgDKeyRepeat1_0 = Message<"DKRP", uint16_t, uint16_t, uint16_t>;
+using MsgDKeyUp = Message<"DKUP", uint16_t, uint16_t, uint16_t>;
+using MsgDKeyUp1_0 = Message<"DKUP", uint16_t, uint16_t>;
+using MsgDMouseDown = Message<"DMDN", int8_t>;
+using MsgDMouseUp = Message<"DMUP", int8_t>;
+using MsgDMouseMove = Message<"DMMV", int16_t, int16_t>;
+using MsgDMouseRelMove = Message<"DMRM", int16_t, int16_t>;
+using MsgDMouseMotion = Message<"DMMB", std::string>;
+using MsgDMouseWheel = Message<"DMWM", int16_t, int16_t>;
+using MsgDMouseWheel1_0 = Message<"DMWM", int16_t>;
+using MsgDClipboard = Message<"DCLP", uint8_t, uint32_t, uint8_t, std::string>;
+using MsgDClipboardOffer =
+    Message<"DCLO", uint8_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, std::vector<uint32_t>>;
+using MsgDInfo = Message<"DINF", int16_t, int16_t, int16_t, int16_t, int16_t, int16_t, int16_t>;
+using MsgDSetOptions = Message<"DSOP", std::vector<uint32_t>>;
+using MsgDFileTransfer = Message<"DFTR", uint8_t, std::string>;
+using MsgDDragInfo = Message<"DDRG", uint16_t, std::string>;
+using MsgDSecureInputNotification = Message<"SECN", std::string>;
+using MsgDLanguageSynchronisation = Message<"LSYN", std::string>;
+using MsgQInfo = Message<"QINF">;
+using MsgQClipboard = Message<"QCLP", uint8_t, uint32_t>;
+using MsgEIncompatible = Message<"EICV", int16_t, int16_t>;
+using MsgEBusy = Message<"EBSY">;
+using MsgEUnknown = Message<"EUNK">;
+using MsgEBad = Message<"EBAD">;
+//@}
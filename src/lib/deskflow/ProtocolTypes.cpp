@@ -27,6 +27,7 @@ const char *const kMsgCScreenSaver = "CSEC%1i";
 const char *const kMsgCResetOptions = "CROP";
 const char *const kMsgCInfoAck = "CIAK";
 const char *const kMsgCKeepAlive = "CALV";
+const char *const kMsgCFastChannel = "CUDP%4i";
 const char *const kMsgDKeyDownLang = "DKDL%2i%2i%2i%s";
 const char *const kMsgDKeyDown = "DKDN%2i%2i%2i";
 const char *const kMsgDKeyDown1_0 = "DKDN%2i%2i";
@@ -38,9 +39,11 @@ const char *const kMsgDMouseDown = "DMDN%1i";
 const char *const kMsgDMouseUp = "DMUP%1i";
 const char *const kMsgDMouseMove = "DMMV%2i%2i";
 const char *const kMsgDMouseRelMove = "DMRM%2i%2i";
+const char *const kMsgDMouseMotion = "DMMB%s";
 const char *const kMsgDMouseWheel = "DMWM%2i%2i";
 const char *const kMsgDMouseWheel1_0 = "DMWM%2i";
 const char *const kMsgDClipboard = "DCLP%1i%4i%1i%s";
+const char *const kMsgDClipboardOffer = "DCLO%1i%4i%4i%4i%4i%4i%4I";
 const char *const kMsgDInfo = "DINF%2i%2i%2i%2i%2i%2i%2i";
 const char *const kMsgDSetOptions = "DSOP%4I";
 const char *const kMsgDFileTransfer = "DFTR%1i%s";
@@ -48,6 +51,7 @@ const char *const kMsgDDragInfo = "DDRG%2i%s";
 const char *const kMsgDSecureInputNotification = "SECN%s";
 const char *const kMsgDLanguageSynchronisation = "LSYN%s";
 const char *const kMsgQInfo = "QINF";
+const char *const kMsgQClipboard = "QCLP%1i%4i";
 const char *const kMsgEIncompatible = "EICV%2i%2i";
 const char *const kMsgEBusy = "EBSY";
 const char *const kMsgEUnknown = "EUNK";
@@ -47,7 +47,7 @@ static const int16_t kProtocolMajorVersion = 1;
  * @note When incrementing the minor version, the Deskflow application version should also increment
  * @since Protocol version 1.0
  */
-static const int16_t kProtocolMinorVersion = 8;
+static const int16_t kProtocolMinorVersion = 9;
 
 /**
  * @brief Default TCP port for Deskflow connections
@@ -162,6 +162,24 @@ struct ChunkType
   inline static const auto DataStart = 1; ///< Start of transfer (contains file size)
   inline static const auto DataChunk = 2; ///< Data chunk (contains file content)
   inline static const auto DataEnd = 3;   ///< End of transfer (transfer complete)
+
+  /// Compressed data chunk (see ClipboardCompression), since protocol version 1.9
+  inline static const auto DataCompressedChunk = 4;
+};
+
+/**
+ * @brief Clipboard compression codecs
+ *
+ * Value of the kOptionClipboardCompression option, which a primary sends
+ * to say which codec it and the secondary may use for clipboard data.
+ * Either side still sends chunks that don't shrink uncompressed.
+ *
+ * @since Protocol version 1.9
+ */
+struct ClipboardCompression
+{
+  inline static const auto None = 0; ///< Clipboard data is never compressed
+  inline static const auto Zlib = 1; ///< Chunks may be compressed with zlib
 };
 
 /**
@@ -511,6 +529,44 @@ extern const char *const kMsgCInfoAck;
  */
 extern const char *const kMsgCKeepAlive;
 
+/**
+ * @brief Offer a fast channel
+ *
+ * **Message Code**: `"CUDP"`
+ * **Direction**: Primary → Secondary
+ * **Format**: `"CUDP%4i"`
+ * **Parameters**:
+ * - `$1`: Token (4 bytes, unsigned) - Names the channel
+ *
+ * Offers a channel of UDP datagrams beside the TCP connection, on the
+ * same port, for mouse motion.  A lost datagram only
+ * loses itself, where a lost TCP segment holds up everything after it.
+ *
+ * Every datagram starts with the token then a sequence number, both
+ * 4 bytes, followed by one @ref kMsgDMouseMotion message as it would be
+ * sent on the connection.  A datagram that's just
+ * the header is a hello.
+ *
+ * **Behavior**:
+ * - A secondary that wants the channel sends hellos to the primary, from
+ *   the socket it'll receive on, until the primary sends a hello back
+ * - The primary only answers hellos from the host the connection is from
+ * - Once it has a hello, the primary sends absolute motion as datagrams,
+ *   numbered from 1, and everything else on the connection
+ * - The primary resends the last position on the connection before a
+ *   click, a scroll, a relative move or leaving, and once the pointer has
+ *   been still for 50ms, in case its datagram was lost
+ * - The secondary ignores any datagram older than one it has applied
+ * - The primary goes back to the connection if datagrams can't be sent
+ * - A secondary that ignores the offer gets everything on the connection
+ *
+ * Datagrams aren't encrypted, so a primary whose connection is encrypted
+ * doesn't offer the channel.
+ *
+ * @since Protocol version 1.9
+ */
+extern const char *const kMsgCFastChannel;
+
 /** @} */ // end of protocol_commands group
 
 /**
@@ -826,6 +882,43 @@ extern const char *const kMsgDMouseMove;
  */
 extern const char *const kMsgDMouseRelMove;
 
+/**
+ * @brief Batch of mouse movements
+ *
+ * **Message Code**: `"DMMB"`
+ * **Direction**: Primary → Secondary
+ * **Format**: `"DMMB%s"`
+ * **Parameters**:
+ * - `$1`: Samples (string) - Encoded motion samples, oldest first
+ *
+ * Each sample is three LEB128 varints:
+ * - Time since the previous sample in microseconds, shifted left one bit,
+ *   with the low bit set for a relative move
+ * - X, zigzag encoded
+ * - Y, zigzag encoded
+ *
+ * For a relative move X and Y are the deltas.  For an absolute move they
+ * are the difference from the previous absolute move in the same batch,
+ * or from (0, 0) for the first.
+ *
+ * **Example**:
+ *
+ * Move to (400, 300) then, 1 ms later, to (401, 302)
+ * ```
+ * "DMMB\x00\x00\x00\x09\x00\xA0\x06\xD8\x04\xD0\x0F\x02\x04"
+ * ```
+ *
+ * Replaces @ref kMsgDMouseMove and @ref kMsgDMouseRelMove.  The primary
+ * sends all the motion it gets in one pass of its event loop together,
+ * so a high rate mouse doesn't need a message per sample.  The secondary
+ * applies every sample in order.
+ *
+ * @see kMsgDMouseMove
+ * @see kMsgDMouseRelMove
+ * @since Protocol version 1.9
+ */
+extern const char *const kMsgDMouseMotion;
+
 /**
  * @brief Mouse wheel scroll event
  *
@@ -927,11 +1020,54 @@ extern const char *const kMsgDMouseWheel1_0;
  * - `2`: Middle chunk
  * - `3`: Final chunk
  *
+ * **Compression (v1.9+)**:
+ * When the primary has offered kOptionClipboardCompression, either side
+ * may send a chunk compressed with mark `4` instead of `2`.  Its data is
+ * the uncompressed size as 4 bytes big endian, followed by a zlib stream,
+ * and it's never bigger than 16 KiB uncompressed.  The size in the first
+ * chunk, and any size limit, is always of the uncompressed data.
+ *
  * @see kMsgCClipboard
  * @since Protocol version 1.0
  */
 extern const char *const kMsgDClipboard;
 
+/**
+ * @brief Clipboard offer
+ *
+ * **Message Code**: `"DCLO"`
+ * **Direction**: Primary → Secondary
+ * **Format**: `"DCLO%1i%4i%4i%4i%4i%4i%4I"`
+ * **Parameters**:
+ * - `$1`: Clipboard identifier (1 byte)
+ * - `$2`: Offer sequence number (4 bytes)
+ * - `$3`-`$6`: Digest of the clipboard data (16 bytes)
+ * - `$7`: Format and size pairs (4-byte integer list)
+ *
+ * **Example**:
+ *
+ * Primary clipboard, offer 3, 11 bytes of text
+ * ```
+ * "DCLO\x00\x00\x00\x00\x03"
+ * "\x3C\xEF\x63\x06\x1C\xF0\x07\xC7\x6F\x5E\x2E\xEE\xFA\xD4\x19\x80"
+ * "\x00\x00\x00\x02\x00\x00\x00\x00\x00\x00\x00\x0B"
+ * ```
+ *
+ * Sent instead of kMsgDClipboard when the clipboard changes: it says what
+ * the clipboard has without sending it.  The secondary takes ownership of
+ * its clipboard with those formats and sends kMsgQClipboard when
+ * something is pasted, or straight away if its screen can't wait.
+ *
+ * The digest is the first 16 bytes of the SHA-256 of the clipboard data as
+ * kMsgDClipboard would carry it, so a secondary that already has the same
+ * data can use it without fetching it again.  Formats it doesn't know are
+ * ignored, but still count towards the size of the data.
+ *
+ * @see kMsgQClipboard, kMsgDClipboard
+ * @since Protocol version 1.9
+ */
+extern const char *const kMsgDClipboardOffer;
+
 /** @} */ // end of protocol_clipboard group
 
 /**
@@ -1181,6 +1317,26 @@ extern const char *const kMsgDLanguageSynchronisation;
  */
 extern const char *const kMsgQInfo;
 
+/**
+ * @brief Query offered clipboard data
+ *
+ * **Message Code**: `"QCLP"`
+ * **Direction**: Secondary → Primary
+ * **Format**: `"QCLP%1i%4i"`
+ * **Parameters**:
+ * - `$1`: Clipboard identifier (1 byte)
+ * - `$2`: Offer sequence number (4 bytes)
+ *
+ * Asks for the data of the kMsgDClipboardOffer with that sequence number.
+ * The primary replies with kMsgDClipboard messages of that sequence
+ * number, or nothing if the clipboard has changed since, in which case
+ * the secondary already has a newer offer.
+ *
+ * @see kMsgDClipboardOffer, kMsgDClipboard
+ * @since Protocol version 1.9
+ */
+extern const char *const kMsgQClipboard;
+
 /** @} */ // end of protocol_queries group
 
 /**
@@ -78,7 +78,22 @@ void ProtocolUtil::writef(deskflow::IStream *stream, const char *fmt, ...)
   auto size = getLength(fmt, args);
   va_end(args);
   va_start(args, fmt);
-  vwritef(stream, fmt, size, args);
+  vwritef(stream, fmt, size, false, args);
+  va_end(args);
+}
+
+void ProtocolUtil::writefBulk(deskflow::IStream *stream, const char *fmt, ...)
+{
+  assert(stream != nullptr);
+  assert(fmt != nullptr);
+  LOG_DEBUG2("writefBulk(%s)", fmt);
+
+  va_list args;
+  va_start(args, fmt);
+  auto size = getLength(fmt, args);
+  va_end(args);
+  va_start(args, fmt);
+  vwritef(stream, fmt, size, true, args);
   va_end(args);
 }
 
@@ -104,7 +119,7 @@ bool ProtocolUtil::readf(deskflow::IStream *stream, const char *fmt, ...)
   return result;
 }
 
-void ProtocolUtil::vwritef(deskflow::IStream *stream, const char *fmt, uint32_t size, va_list args)
+void ProtocolUtil::vwritef(deskflow::IStream *stream, const char *fmt, uint32_t size, bool bulk, va_list args)
 {
   assert(stream != nullptr);
   assert(fmt != nullptr);
@@ -120,7 +135,11 @@ void ProtocolUtil::vwritef(deskflow::IStream *stream, const char *fmt, uint32_t
 
   try {
     // write buffer
-    stream->write(Buffer.data(), size);
+    if (bulk) {
+      stream->writeBulk(Buffer.data(), size);
+    } else {
+      stream->write(Buffer.data(), size);
+    }
     LOG_DEBUG2("wrote %d bytes", size);
   } catch (const BaseException &exception) {
     LOG_DEBUG2("exception <%s> during wrote %d bytes into stream", exception.what(), size);
@@ -45,6 +45,13 @@ public:
   */
   static void writef(deskflow::IStream *, const char *fmt, ...);
 
+  //! Write formatted bulk data
+  /*!
+  Like \c writef() but writes the message with \c IStream::writeBulk(),
+  so it may be sent after messages written later with \c writef().
+  */
+  static void writefBulk(deskflow::IStream *, const char *fmt, ...);
+
   //! Read formatted data
   /*!
   Read formatted binary data from a buffer.  This performs the
@@ -64,7 +71,7 @@ public:
   static bool readf(deskflow::IStream *, const char *fmt, ...);
 
 private:
-  static void vwritef(deskflow::IStream *, const char *fmt, uint32_t size, va_list);
+  static void vwritef(deskflow::IStream *, const char *fmt, uint32_t size, bool bulk, va_list);
   static void vreadf(deskflow::IStream *, const char *fmt, va_list);
 
   static uint32_t getLength(const char *fmt, va_list);
@@ -169,6 +169,11 @@ void Screen::setClipboard(ClipboardID id, const IClipboard *clipboard)
   m_screen->setClipboard(id, clipboard);
 }
 
+bool Screen::offerClipboard(ClipboardID id, const std::vector<IClipboard::Format> &formats)
+{
+  return m_screen->offerClipboard(id, formats);
+}
+
 void Screen::grabClipboard(ClipboardID id)
 {
   m_screen->setClipboard(id, nullptr);
@@ -8,14 +8,15 @@
 #pragma once
 
 #include "deskflow/ClipboardTypes.h"
+#include "deskflow/IClipboard.h"
 #include "deskflow/IScreen.h"
 #include "deskflow/KeyTypes.h"
 #include "deskflow/MouseTypes.h"
 #include "deskflow/OptionTypes.h"
 
 #include <string>
+#include <vector>
 
-class IClipboard;
 class IPlatformScreen;
 class IEventQueue;
 
@@ -91,6 +92,14 @@ public:
   */
   void setClipboard(ClipboardID, const IClipboard *);
 
+  //! Offer clipboard
+  /*!
+  Takes ownership of the system clipboard with \p formats, whose data
+  follows with setClipboard() when it's asked for.  Returns false if the
+  platform can't wait for the data.  See IPlatformScreen::offerClipboard().
+  */
+  bool offerClipboard(ClipboardID, const std::vector<IClipboard::Format> &formats);
+
   //! Grab clipboard
   /*!
   Grabs (i.e. take ownership of) the system clipboard.
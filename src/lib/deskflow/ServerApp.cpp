@@ -105,6 +105,7 @@ void ServerApp::help()
        << "Usage: " << kAppId << "-core server"
        << " --config <pathname>"
        << " [--address <address>]"
+       << " [--fast-motion]"
 
 #if WINAPI_XWINDOWS
        << " [--display <display>]"
@@ -113,6 +114,8 @@ void ServerApp::help()
        << s_helpSysArgs << s_helpCommonArgs << "\n"
        << "  -a, --address <address>  listen for clients on the given address.\n"
        << "  -c, --config <pathname>  path of the configuration file\n"
+       << "      --fast-motion        offer clients mouse motion over UDP,\n"
+       << "                             unencrypted.  not offered with TLS.\n"
        << s_helpGeneralArgs
        << "      --disable-client-cert-check disable client SSL certificate \n"
           "                                     checking (deprecated)\n"
@@ -532,7 +535,9 @@ ClientListener *ServerApp::openClientListener(const NetworkAddress &address)
     }
   }
 
-  auto *listen = new ClientListener(getAddress(address), getSocketFactory(), getEvents(), securityLevel);
+  auto *listen = new ClientListener(
+      getAddress(address), getSocketFactory(), getEvents(), securityLevel, args().m_fastMotion
+  );
 
   getEvents()->addHandler(EventTypes::ClientListenerAccepted, listen, [this, listen](const auto &e) {
     handleClientConnected(e, listen);
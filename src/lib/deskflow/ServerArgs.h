@@ -30,6 +30,13 @@ public:
   std::string m_configFile = "";
   std::shared_ptr<Config> m_config;
   bool m_chkPeerCert = true;
+
+  /**
+   * @brief m_fastMotion
+   * Offer clients a fast channel to take mouse motion over UDP.  It isn't
+   * encrypted, so it's never offered when TLS is enabled.
+   */
+  bool m_fastMotion = false;
 };
 
 } // namespace deskflow
@@ -21,8 +21,12 @@ using namespace std;
 
 static const size_t g_chunkSize = 512 * 1024; // 512kb
 
+// clipboard data smaller than this isn't worth compressing
+static const size_t g_compressThreshold = 1024; // 1kb
+
 void StreamChunker::sendClipboard(
-    const std::string_view &data, size_t size, ClipboardID id, uint32_t sequence, IEventQueue *events, void *eventTarget
+    const std::string_view &data, size_t size, ClipboardID id, uint32_t sequence, IEventQueue *events,
+    void *eventTarget, bool compress
 )
 {
   // send first message (data size)
@@ -31,6 +35,11 @@ void StreamChunker::sendClipboard(
 
   events->addEvent(Event(EventTypes::ClipboardSending, eventTarget, sizeMessage));
 
+  if (compress && size >= g_compressThreshold) {
+    sendCompressedClipboard(data.substr(0, size), id, sequence, events, eventTarget);
+    return;
+  }
+
   // send clipboard chunk with a fixed size
   size_t sentLength = 0;
   size_t chunkSize = g_chunkSize;
@@ -59,3 +68,31 @@ void StreamChunker::sendClipboard(
 
   LOG_DEBUG("sent clipboard size=%d", sentLength);
 }
+
+void StreamChunker::sendCompressedClipboard(
+    std::string_view data, ClipboardID id, uint32_t sequence, IEventQueue *events, void *eventTarget
+)
+{
+  // each block is compressed on its own, so the receiver can check and
+  // decompress each chunk as it arrives.  blocks that don't shrink, such
+  // as images that are already compressed, are sent as they are.
+  size_t wireSize = 0;
+  std::string compressed;
+  for (size_t offset = 0; offset < data.size(); offset += s_clipboardCompressBlockSize) {
+    const std::string_view block = data.substr(offset, s_clipboardCompressBlockSize);
+    ClipboardChunk *chunk = nullptr;
+    if (ClipboardChunk::compress(block, compressed)) {
+      chunk = ClipboardChunk::compressed(id, sequence, compressed);
+      wireSize += compressed.size();
+    } else {
+      chunk = ClipboardChunk::data(id, sequence, std::string(block));
+      wireSize += block.size();
+    }
+    events->addEvent(Event(EventTypes::ClipboardSending, eventTarget, chunk));
+  }
+
+  ClipboardChunk *end = ClipboardChunk::end(id, sequence);
+  events->addEvent(Event(EventTypes::ClipboardSending, eventTarget, end));
+
+  LOG_DEBUG("sent clipboard size=%d compressed=%d", data.size(), wireSize);
+}
@@ -9,14 +9,26 @@
 #include "deskflow/ClipboardTypes.h"
 
 #include <string>
+#include <string_view>
 
 class IEventQueue;
 
 class StreamChunker
 {
 public:
+  //! Send clipboard data
+  /*!
+  Posts the chunks of \p data as \c ClipboardSending events to
+  \p eventTarget.  If \p compress is true, which the other side must have
+  agreed to, blocks of data that shrink are sent compressed.
+  */
   static void sendClipboard(
       const std::string_view &data, size_t size, ClipboardID id, uint32_t sequence, IEventQueue *events,
-      void *eventTarget
+      void *eventTarget, bool compress = false
+  );
+
+private:
+  static void sendCompressedClipboard(
+      std::string_view data, ClipboardID id, uint32_t sequence, IEventQueue *events, void *eventTarget
   );
 };
@@ -12,6 +12,9 @@
 #include "base/EventTypes.h"
 #include "base/IEventQueue.h"
 
+#include <cstdint>
+#include <span>
+
 class IEventQueue;
 
 namespace deskflow {
@@ -46,6 +49,29 @@ public:
   */
   virtual uint32_t read(void *buffer, uint32_t n) = 0;
 
+  //! Get whole packets in place
+  /*!
+  For streams of packets, fills \p packets with views of the whole
+  packets waiting to be read, in order and without copying them, and
+  returns how many it filled.  They aren't removed, see \c popPackets(),
+  and the views are invalidated by any other manipulator.  By default
+  this returns 0.
+  */
+  virtual uint32_t peekPackets(std::span<std::span<const uint8_t>> packets)
+  {
+    return 0;
+  }
+
+  //! Discard whole packets
+  /*!
+  Discards the first \p n packets last returned by \c peekPackets(), once
+  they've been handled.  By default this does nothing.
+  */
+  virtual void popPackets(uint32_t n)
+  {
+    // do nothing
+  }
+
   //! Write to stream
   /*!
   Write \c n bytes from \c buffer to the stream.  If this can't
@@ -55,6 +81,67 @@ public:
   */
   virtual void write(const void *buffer, uint32_t n) = 0;
 
+  //! Write bulk data to stream
+  /*!
+  Like \c write() but for bulk data, such as clipboard contents, that
+  mustn't hold up data written after it.  Streams that can may send it
+  after anything written later with \c write().  Bulk data stays in the
+  order it was written and the \c n bytes of each call are kept together.
+  By default this is the same as \c write().
+  */
+  virtual void writeBulk(const void *buffer, uint32_t n)
+  {
+    write(buffer, n);
+  }
+
+  //! Write data that may be replaced
+  /*!
+  Like \c write() but the data can be replaced by \c replaceLatest()
+  until it's sent or anything else is written.  By default this is the
+  same as \c write().
+  */
+  virtual void writeLatest(const void *buffer, uint32_t n)
+  {
+    write(buffer, n);
+  }
+
+  //! Replace data not yet sent
+  /*!
+  Overwrites the data last written with \c writeLatest() with the \c n
+  bytes from \c buffer, which needn't be the same size, if none of it
+  has been sent and nothing has been written since.  The new data can be
+  replaced in turn.  Returns true if it was replaced, otherwise false and
+  nothing is written.  By default this always returns false.
+  */
+  virtual bool replaceLatest(const void *buffer, uint32_t n)
+  {
+    return false;
+  }
+
+  //! Hold back writes
+  /*!
+  Data written after this is queued but not sent until the matching
+  \c uncork(), so several messages produced together, such as entering a
+  screen and its clipboards, go out together.  Calls nest.  A cork only
+  lasts as long as the code producing the messages, see StreamCork, so
+  a message written on its own is never held.  By default this does
+  nothing.
+  */
+  virtual void cork()
+  {
+    // do nothing
+  }
+
+  //! Send held back writes
+  /*!
+  Ends a \c cork().  Ending the outermost one sends what it held back.
+  By default this does nothing.
+  */
+  virtual void uncork()
+  {
+    // do nothing
+  }
+
   //! Flush the stream
   /*!
   Waits until all buffered data has been written to the stream.
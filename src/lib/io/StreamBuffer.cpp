@@ -7,115 +7,157 @@
 
 #include "io/StreamBuffer.h"
 
+#include <algorithm>
 #include <assert.h>
+#include <bit>
+#include <cstring>
 
 //
 // StreamBuffer
 //
 
-const uint32_t StreamBuffer::kChunkSize = 4096;
+const uint32_t StreamBuffer::kMinCapacity = 4096;
+const uint32_t StreamBuffer::kMaxIdleCapacity = 2 * 1024 * 1024;
 
 const void *StreamBuffer::peek(uint32_t n)
 {
   assert(n <= m_size);
 
   // if requesting no data then return nullptr so we don't try to access
-  // an empty list.
+  // an empty ring.
   if (n == 0) {
     return nullptr;
   }
 
-  // reserve space in first chunk
-  auto head = m_chunks.begin();
-  head->reserve(n + m_headUsed);
-
-  // consolidate chunks into the first chunk until it has n bytes
-  ChunkList::iterator scan = head;
-  ++scan;
-  while (head->size() - m_headUsed < n && scan != m_chunks.end()) {
-    head->insert(head->end(), scan->begin(), scan->end());
-    scan = m_chunks.erase(scan);
+  // if the bytes wrap around the end of the ring then rotate it so they
+  // start at the beginning.  they stay there until it wraps again.
+  if (m_head + n > getCapacity()) {
+    std::rotate(m_ring.begin(), m_ring.begin() + m_head, m_ring.end());
+    m_head = 0;
   }
 
-  return static_cast<const void *>(&(head->begin()[m_headUsed]));
+  return &m_ring[m_head];
+}
+
+void StreamBuffer::read(void *vdata, uint32_t n)
+{
+  assert(n <= m_size);
+
+  auto *data = static_cast<uint8_t *>(vdata);
+  uint32_t remaining = n;
+  for (const auto &view : getReadViews()) {
+    const auto count = std::min(static_cast<uint32_t>(view.size()), remaining);
+    if (count > 0) {
+      memcpy(data, view.data(), count);
+    }
+    data += count;
+    remaining -= count;
+  }
+  pop(n);
 }
 
 void StreamBuffer::pop(uint32_t n)
 {
-  // discard all chunks if n is greater than or equal to m_size
+  // discard everything if n is greater than or equal to m_size
   if (n >= m_size) {
     m_size = 0;
-    m_headUsed = 0;
-    m_chunks.clear();
+    m_head = 0;
+
+    // keep the ring for next time unless it grew for a burst of data,
+    // such as a big clipboard.  fresh memory is slow to fill.
+    if (getCapacity() > kMaxIdleCapacity) {
+      m_ring = std::vector<uint8_t>();
+    }
     return;
   }
 
-  // update size
   m_size -= n;
+  m_head = (m_head + n) & (getCapacity() - 1);
+}
 
-  // discard chunks until more than n bytes would've been discarded
-  auto scan = m_chunks.begin();
-  assert(scan != m_chunks.end());
-  while (scan->size() - m_headUsed <= n) {
-    n -= (uint32_t)scan->size() - m_headUsed;
-    m_headUsed = 0;
-    scan = m_chunks.erase(scan);
-    assert(scan != m_chunks.end());
-  }
-
-  // remove left over bytes from the head chunk
-  if (n > 0) {
-    m_headUsed += n;
-  }
+void StreamBuffer::popBack(uint32_t n)
+{
+  assert(n <= m_size);
+  m_size -= n;
 }
 
 void StreamBuffer::write(const void *vdata, uint32_t n)
 {
   assert(vdata != nullptr);
 
-  // ignore if no data, otherwise update size
+  // ignore if no data
   if (n == 0) {
     return;
   }
-  m_size += n;
 
-  // cast data to bytes
   const auto *data = static_cast<const uint8_t *>(vdata);
-
-  // point to last chunk if it has space, otherwise append an empty chunk
-  auto scan = m_chunks.end();
-  if (scan != m_chunks.begin()) {
-    --scan;
-    if (scan->size() >= kChunkSize) {
-      ++scan;
+  uint32_t remaining = n;
+  for (const auto &view : reserve(n)) {
+    const auto count = std::min(static_cast<uint32_t>(view.size()), remaining);
+    if (count > 0) {
+      memcpy(view.data(), data, count);
     }
+    data += count;
+    remaining -= count;
   }
-  if (scan == m_chunks.end()) {
-    scan = m_chunks.emplace(scan, Chunk());
-  }
+  commit(n);
+}
 
-  // append data in chunks
-  while (n > 0) {
-    // choose number of bytes for next chunk
-    assert(scan->size() <= kChunkSize);
-    uint32_t count = kChunkSize - (uint32_t)scan->size();
-    if (count > n)
-      count = n;
-
-    // transfer data
-    scan->insert(scan->end(), data, data + count);
-    n -= count;
-    data += count;
+StreamBuffer::WriteViews StreamBuffer::reserve(uint32_t n)
+{
+  if (getCapacity() - m_size < n) {
+    grow(n);
+  }
 
-    // append another empty chunk if we're not done yet
-    if (n > 0) {
-      ++scan;
-      scan = m_chunks.emplace(scan, Chunk());
-    }
+  // free space runs from the end of the bytes to the end of the ring
+  // then on from the beginning, up to the head
+  const uint32_t capacity = getCapacity();
+  if (capacity == 0) {
+    return {};
   }
+  const uint32_t tail = (m_head + m_size) & (capacity - 1);
+  const uint32_t free = capacity - m_size;
+  const uint32_t first = std::min(free, capacity - tail);
+  return {std::span<uint8_t>(m_ring.data() + tail, first), std::span<uint8_t>(m_ring.data(), free - first)};
+}
+
+void StreamBuffer::commit(uint32_t n)
+{
+  assert(n <= getCapacity() - m_size);
+  m_size += n;
 }
 
 uint32_t StreamBuffer::getSize() const
 {
   return m_size;
 }
+
+StreamBuffer::ReadViews StreamBuffer::getReadViews() const
+{
+  if (m_size == 0) {
+    return {};
+  }
+  const uint32_t first = std::min(m_size, getCapacity() - m_head);
+  return {
+      std::span<const uint8_t>(m_ring.data() + m_head, first), std::span<const uint8_t>(m_ring.data(), m_size - first)
+  };
+}
+
+uint32_t StreamBuffer::getCapacity() const
+{
+  return static_cast<uint32_t>(m_ring.size());
+}
+
+void StreamBuffer::grow(uint32_t n)
+{
+  // double the ring until it's big enough, copying the bytes to the new
+  // ring's beginning so they're contiguous again
+  assert(m_size + n <= (uint32_t(1) << 31));
+  std::vector<uint8_t> ring(std::bit_ceil(std::max(m_size + n, kMinCapacity)));
+  auto out = ring.begin();
+  for (const auto &view : getReadViews()) {
+    out = std::copy(view.begin(), view.end(), out);
+  }
+  m_ring.swap(ring);
+  m_head = 0;
+}
@@ -7,18 +7,34 @@
 
 #pragma once
 
-#include "base/EventTypes.h"
-
-#include <list>
+#include <array>
+#include <cstdint>
+#include <span>
 #include <vector>
 
 //! FIFO of bytes
 /*!
-This class maintains a FIFO (first-in, last-out) buffer of bytes.
+This class maintains a FIFO (first-in, first-out) buffer of bytes.
+
+The bytes are kept in a ring that grows as needed, so they're in at most
+two contiguous runs.  Those runs can be used in place through the views
+returned by getReadViews() and reserve(), for example with vectored
+socket I/O, and peek() only has to move bytes when the run it's asked
+for wraps around the end of the ring.
 */
 class StreamBuffer
 {
 public:
+  //! Runs of bytes in the buffer, in order
+  /*!
+  The second run is empty unless the bytes wrap around the end of the
+  ring, and both are empty if there are no bytes.
+  */
+  using ReadViews = std::array<std::span<const uint8_t>, 2>;
+
+  //! Runs of free space after the bytes in the buffer, in order
+  using WriteViews = std::array<std::span<uint8_t>, 2>;
+
   StreamBuffer() = default;
   ~StreamBuffer() = default;
 
@@ -29,10 +45,18 @@ public:
   /*!
   Return a pointer to memory with the next \c n bytes in the buffer
   (which must be <= getSize()).  The caller must not modify the returned
-  memory nor delete it.
+  memory nor delete it.  Prefer getReadViews() if the bytes don't have to
+  be contiguous.
   */
   const void *peek(uint32_t n);
 
+  //! Read and discard data
+  /*!
+  Copies the next \c n bytes (which must be <= getSize()) to \c data then
+  discards them.
+  */
+  void read(void *data, uint32_t n);
+
   //! Discard data
   /*!
   Discards the next \c n bytes.  If \c n >= getSize() then the buffer
@@ -40,12 +64,34 @@ public:
   */
   void pop(uint32_t n);
 
+  //! Discard data from the end
+  /*!
+  Discards the last \c n bytes (which must be <= getSize()), as if they
+  had never been written.
+  */
+  void popBack(uint32_t n);
+
   //! Write data to buffer
   /*!
   Appends \c n bytes from \c data to the buffer.
   */
   void write(const void *data, uint32_t n);
 
+  //! Get space to write to
+  /*!
+  Makes room for at least \c n more bytes and returns all of the free
+  space.  Write to the views in order then call commit() with the number
+  of bytes written.  The views are invalidated by any other manipulator.
+  */
+  WriteViews reserve(uint32_t n);
+
+  //! Append written data
+  /*!
+  Appends the first \c n bytes of the views last returned by reserve(),
+  which must be no more than they hold.
+  */
+  void commit(uint32_t n);
+
   //@}
   //! @name accessors
   //@{
@@ -56,15 +102,24 @@ public:
   */
   uint32_t getSize() const;
 
+  //! Get the data in the buffer
+  /*!
+  Returns views of the bytes in the buffer without copying or moving
+  them.  The views are invalidated by any manipulator.
+  */
+  ReadViews getReadViews() const;
+
   //@}
 
 private:
-  static const uint32_t kChunkSize;
+  uint32_t getCapacity() const;
+  void grow(uint32_t n);
 
-  using Chunk = std::vector<uint8_t>;
-  using ChunkList = std::list<Chunk>;
+  static const uint32_t kMinCapacity;
+  static const uint32_t kMaxIdleCapacity;
 
-  ChunkList m_chunks;
+  // the ring.  its size is a power of two, or zero before first use.
+  std::vector<uint8_t> m_ring;
+  uint32_t m_head = 0;
   uint32_t m_size = 0;
-  uint32_t m_headUsed = 0;
 };
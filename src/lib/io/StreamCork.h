@@ -0,0 +1,40 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#pragma once
+
+#include "io/IStream.h"
+
+//! Stream cork scope
+/*!
+Corks a stream for as long as it exists, so the messages written to it
+in the scope go out together when the scope ends.  See IStream::cork().
+The stream may be nullptr, for a screen without one.
+*/
+class StreamCork
+{
+public:
+  explicit StreamCork(deskflow::IStream *stream) : m_stream(stream)
+  {
+    if (m_stream != nullptr) {
+      m_stream->cork();
+    }
+  }
+  StreamCork(StreamCork const &) = delete;
+  StreamCork(StreamCork &&) = delete;
+  ~StreamCork()
+  {
+    if (m_stream != nullptr) {
+      m_stream->uncork();
+    }
+  }
+
+  StreamCork &operator=(StreamCork const &) = delete;
+  StreamCork &operator=(StreamCork &&) = delete;
+
+private:
+  deskflow::IStream *m_stream;
+};
@@ -46,6 +46,31 @@ void StreamFilter::write(const void *buffer, uint32_t n)
   getStream()->write(buffer, n);
 }
 
+void StreamFilter::writeBulk(const void *buffer, uint32_t n)
+{
+  getStream()->writeBulk(buffer, n);
+}
+
+void StreamFilter::writeLatest(const void *buffer, uint32_t n)
+{
+  getStream()->writeLatest(buffer, n);
+}
+
+bool StreamFilter::replaceLatest(const void *buffer, uint32_t n)
+{
+  return getStream()->replaceLatest(buffer, n);
+}
+
+void StreamFilter::cork()
+{
+  getStream()->cork();
+}
+
+void StreamFilter::uncork()
+{
+  getStream()->uncork();
+}
+
 void StreamFilter::flush()
 {
   getStream()->flush();
@@ -38,6 +38,11 @@ public:
   void close() override;
   uint32_t read(void *buffer, uint32_t n) override;
   void write(const void *buffer, uint32_t n) override;
+  void writeBulk(const void *buffer, uint32_t n) override;
+  void writeLatest(const void *buffer, uint32_t n) override;
+  bool replaceLatest(const void *buffer, uint32_t n) override;
+  void cork() override;
+  void uncork() override;
   void flush() override;
   void shutdownInput() override;
   void shutdownOutput() override;
@@ -46,6 +46,17 @@ public:
   */
   virtual void connect(const NetworkAddress &) = 0;
 
+  //@}
+  //! @name accessors
+  //@{
+
+  //! Get peer address
+  /*!
+  Returns the address the socket was accepted from or connected to, or
+  the invalid address if it isn't known.
+  */
+  virtual NetworkAddress getPeerAddress() const = 0;
+
   //@}
 
   // ISocket overrides
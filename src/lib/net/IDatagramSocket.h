@@ -0,0 +1,62 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#pragma once
+
+#include "net/ISocket.h"
+
+#include <cstdint>
+
+//! Datagram socket interface
+/*!
+This interface defines the methods common to all network sockets that
+send and receive datagrams.  Datagrams can be lost, duplicated or
+reordered on the way.  Once bound or connected, a socket sends
+\c EventTypes::DatagramSocketReady when \c receive() will return a
+datagram.
+*/
+class IDatagramSocket : public ISocket
+{
+public:
+  //! @name manipulators
+  //@{
+
+  //! Connect socket
+  /*!
+  Sends datagrams to \c address and only receives datagrams from it.
+  */
+  virtual void connect(const NetworkAddress &address) = 0;
+
+  //! Send datagram
+  /*!
+  Sends \c n bytes from \c buffer as one datagram, to the address the
+  socket is connected to.  Returns false if it couldn't be sent.
+  */
+  virtual bool send(const void *buffer, uint32_t n) = 0;
+
+  //! Send datagram to address
+  /*!
+  Like \c send() but sends the datagram to \c address.
+  */
+  virtual bool sendTo(const void *buffer, uint32_t n, const NetworkAddress &address) = 0;
+
+  //! Receive datagram
+  /*!
+  Reads the next datagram into \c buffer and returns its size, or 0 if
+  there are none.  A datagram of more than \c n bytes is cut short, or
+  on some systems dropped.  If \c from isn't nullptr it's set to where
+  the datagram came from.  \c EventTypes::DatagramSocketReady isn't sent
+  again until this has returned 0.
+  */
+  virtual uint32_t receive(void *buffer, uint32_t n, NetworkAddress *from) = 0;
+
+  //@}
+
+  // ISocket overrides
+  void bind(const NetworkAddress &) override = 0;
+  void close() override = 0;
+  void *getEventTarget() const override = 0;
+};
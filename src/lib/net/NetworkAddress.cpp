@@ -86,6 +86,14 @@ NetworkAddress::NetworkAddress(const std::string &hostname, int port) : m_hostna
   checkPort();
 }
 
+NetworkAddress::NetworkAddress(ArchNetAddress address)
+    : m_address(address),
+      m_hostname(ARCH->addrToString(address)),
+      m_port(ARCH->getAddrPort(address))
+{
+  // do nothing
+}
+
 NetworkAddress::~NetworkAddress()
 {
   if (m_address != nullptr) {
@@ -40,6 +40,12 @@ public:
   */
   explicit NetworkAddress(const std::string &hostname, int port = 0);
 
+  /*!
+  Construct the network address for \c address, which is adopted, as if
+  it had been resolved from its numerical form.
+  */
+  explicit NetworkAddress(ArchNetAddress address);
+
   NetworkAddress(const NetworkAddress &);
 
   ~NetworkAddress();
@@ -0,0 +1,162 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include "net/SecureContext.h"
+
+#include "base/Log.h"
+#include "base/Path.h"
+#include "net/SslLogger.h"
+
+#include <openssl/err.h>
+#include <system_error>
+
+//
+// SecureContext
+//
+
+static const unsigned char s_sessionIdContext[] = "deskflow";
+
+static int verifyIgnoreCertCallback(X509_STORE_CTX *, void *)
+{
+  return 1;
+}
+
+SecureContext::SecureContext(bool server, SecurityLevel securityLevel)
+    : m_securityLevel(securityLevel)
+{
+  OPENSSL_init_ssl(OPENSSL_INIT_LOAD_SSL_STRINGS | OPENSSL_INIT_LOAD_CRYPTO_STRINGS, nullptr);
+  SslLogger::logSecureLibInfo();
+
+  m_context = SSL_CTX_new(server ? TLS_server_method() : TLS_client_method());
+  if (m_context == nullptr) {
+    SslLogger::logError();
+    return;
+  }
+
+  // Prevent the usage of of all version prior to TLSv1.2 as they are known to
+  // be vulnerable
+  SSL_CTX_set_options(m_context, SSL_OP_NO_SSLv2 | SSL_OP_NO_SSLv3 | SSL_OP_NO_TLSv1 | SSL_OP_NO_TLSv1_1);
+
+#ifdef SSL_OP_ENABLE_KTLS
+  // Let the kernel encrypt and decrypt records once the handshake is done,
+  // if it can. Otherwise OpenSSL quietly carries on doing it itself.
+  SSL_CTX_set_options(m_context, SSL_OP_ENABLE_KTLS);
+#endif
+
+  if (m_securityLevel == SecurityLevel::PeerAuth) {
+    // We want to ask for peer certificate, but not verify it. If we don't ask for peer
+    // certificate, e.g. client won't send it.
+    SSL_CTX_set_verify(m_context, SSL_VERIFY_PEER | SSL_VERIFY_FAIL_IF_NO_PEER_CERT, nullptr);
+    SSL_CTX_set_cert_verify_callback(m_context, verifyIgnoreCertCallback, nullptr);
+  }
+
+  if (server) {
+    // the server issues session tickets by default, but won't resume a
+    // session that was verified with a client certificate without this
+    SSL_CTX_set_session_id_context(m_context, s_sessionIdContext, sizeof(s_sessionIdContext) - 1);
+  } else {
+    // keep the newest session ticket from the server to resume with
+    SSL_CTX_set_app_data(m_context, this);
+    SSL_CTX_set_session_cache_mode(m_context, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(m_context, &SecureContext::onNewSession);
+  }
+}
+
+SecureContext::~SecureContext()
+{
+  SSL_SESSION_free(m_session);
+  SSL_CTX_free(m_context);
+}
+
+bool SecureContext::loadCertificates(const std::string &filename)
+{
+  std::scoped_lock lock{m_mutex};
+
+  if (filename.empty()) {
+    SslLogger::logError("tls certificate is not specified");
+    return false;
+  }
+
+  std::error_code error;
+  const auto time = std::filesystem::last_write_time(deskflow::filesystem::path(filename), error);
+  if (error) {
+    std::string errorMsg("tls certificate doesn't exist: ");
+    errorMsg.append(filename);
+    SslLogger::logError(errorMsg.c_str());
+    return false;
+  }
+
+  if (filename == m_certificateFile && time == m_certificateTime) {
+    return true;
+  }
+
+  if (m_context == nullptr) {
+    SslLogger::logError("tls context is not available");
+    return false;
+  }
+
+  m_certificateFile.clear();
+
+  int r = 0;
+  r = SSL_CTX_use_certificate_file(m_context, filename.c_str(), SSL_FILETYPE_PEM);
+  if (r <= 0) {
+    SslLogger::logError("could not use tls certificate");
+    return false;
+  }
+
+  r = SSL_CTX_use_PrivateKey_file(m_context, filename.c_str(), SSL_FILETYPE_PEM);
+  if (r <= 0) {
+    SslLogger::logError("could not use tls private key");
+    return false;
+  }
+
+  r = SSL_CTX_check_private_key(m_context);
+  if (!r) {
+    SslLogger::logError("could not verify tls private key");
+    return false;
+  }
+
+  LOG_DEBUG("loaded tls certificate: %s", filename.c_str());
+  m_certificateFile = filename;
+  m_certificateTime = time;
+  return true;
+}
+
+SSL *SecureContext::newSsl()
+{
+  std::scoped_lock lock{m_mutex};
+
+  if (m_context == nullptr) {
+    return nullptr;
+  }
+
+  SSL *ssl = SSL_new(m_context);
+  if (ssl == nullptr) {
+    SslLogger::logError();
+    return nullptr;
+  }
+
+  // a write that has to be retried is retried from the output buffer,
+  // which isn't the buffer first passed to SSL_write() after a direct write
+  SSL_set_mode(ssl, SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+
+  if (m_session != nullptr && SSL_SESSION_is_resumable(m_session)) {
+    LOG_DEBUG2("offering to resume tls session");
+    SSL_set_session(ssl, m_session);
+  }
+  return ssl;
+}
+
+int SecureContext::onNewSession(SSL *ssl, SSL_SESSION *session)
+{
+  auto *context = static_cast<SecureContext *>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)));
+  std::scoped_lock lock{context->m_mutex};
+
+  // take ownership of the session, replacing the last one
+  SSL_SESSION_free(context->m_session);
+  context->m_session = session;
+  return 1;
+}
@@ -0,0 +1,73 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#pragma once
+
+#include "net/SecurityLevel.h"
+
+#include <filesystem>
+#include <mutex>
+#include <openssl/ssl.h>
+#include <string>
+
+//! Shared TLS context
+/*!
+An SSL context shared by all the secure sockets of a listener or of a
+client, so the certificate is loaded once rather than per connection.
+Sharing it also lets a client that reconnects resume its last session
+with a TLS 1.3 session ticket and skip the full handshake.
+*/
+class SecureContext
+{
+public:
+  SecureContext(bool server, SecurityLevel securityLevel);
+  SecureContext(SecureContext const &) = delete;
+  SecureContext(SecureContext &&) = delete;
+  ~SecureContext();
+
+  SecureContext &operator=(SecureContext const &) = delete;
+  SecureContext &operator=(SecureContext &&) = delete;
+
+  //! @name manipulators
+  //@{
+
+  //! Load certificate and private key
+  /*!
+  Loads the PEM file \p filename, unless it's the file last loaded and it
+  hasn't changed since.  Returns false if it can't be used.
+  */
+  bool loadCertificates(const std::string &filename);
+
+  //! Create a connection
+  /*!
+  Returns a new SSL for a connection, set up to resume the last session
+  if this is a client context and there's one to resume.  The caller
+  frees it.
+  */
+  SSL *newSsl();
+
+  //@}
+  //! @name accessors
+  //@{
+
+  //! Get the security level
+  SecurityLevel getSecurityLevel() const
+  {
+    return m_securityLevel;
+  }
+
+  //@}
+
+private:
+  static int onNewSession(SSL *ssl, SSL_SESSION *session);
+
+  std::mutex m_mutex;
+  SSL_CTX *m_context = nullptr;
+  SSL_SESSION *m_session = nullptr;
+  std::string m_certificateFile;
+  std::filesystem::file_time_type m_certificateTime;
+  const SecurityLevel m_securityLevel;
+};
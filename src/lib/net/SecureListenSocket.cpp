@@ -7,6 +7,7 @@
 
 #include "SecureListenSocket.h"
 
+#include "SecureContext.h"
 #include "SecureSocket.h"
 #include "arch/ArchException.h"
 #include "base/String.h"
@@ -26,7 +27,8 @@ SecureListenSocket::SecureListenSocket(
     SecurityLevel securityLevel
 )
     : TCPListenSocket(events, socketMultiplexer, family),
-      m_securityLevel{securityLevel}
+      m_securityLevel{securityLevel},
+      m_context{std::make_shared<SecureContext>(true, securityLevel)}
 
 {
   // do nothing
@@ -39,8 +41,6 @@ std::unique_ptr<IDataSocket> SecureListenSocket::accept()
     secureSocket = std::make_unique<SecureSocket>(
         events(), socketMultiplexer(), ARCH->acceptSocket(socket(), nullptr), m_securityLevel
     );
-    secureSocket->initSsl(true);
-
     setListeningJob();
 
     // default location of the TLS cert file in users dir
@@ -51,10 +51,11 @@ std::unique_ptr<IDataSocket> SecureListenSocket::accept()
       certificateFilename = ArgParser::argsBase().m_tlsCertFile;
     }
 
-    if (!secureSocket->loadCertificates(certificateFilename)) {
+    if (!m_context->loadCertificates(certificateFilename)) {
       return nullptr;
     }
 
+    secureSocket->initSsl(m_context);
     secureSocket->secureAccept();
 
     return secureSocket;
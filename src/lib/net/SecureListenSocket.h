@@ -10,9 +10,11 @@
 #include "net/SecurityLevel.h"
 #include "net/TCPListenSocket.h"
 
+#include <memory>
 #include <set>
 
 class IEventQueue;
+class SecureContext;
 class SocketMultiplexer;
 class IDataSocket;
 
@@ -29,4 +31,8 @@ public:
 
 private:
   const SecurityLevel m_securityLevel;
+
+  // shared by the sockets we accept, so the certificate is loaded once and
+  // the session tickets we issue can be used to resume
+  std::shared_ptr<SecureContext> m_context;
 };
@@ -6,24 +6,22 @@
  */
 
 #include "SecureSocket.h"
+#include "SecureContext.h"
 #include "SecureUtils.h"
 
 #include "arch/ArchException.h"
 #include "base/Log.h"
-#include "base/Path.h"
 #include "base/String.h"
 #include "common/Settings.h"
-#include "io/Filesystem.h"
 #include "mt/Lock.h"
 #include "net/FingerprintDatabase.h"
+#include "net/SocketMultiplexer.h"
 #include "net/TCPSocket.h"
 #include "net/TSocketMultiplexerMethodJob.h"
 #include <net/SslLogger.h>
 
 #include <cstdlib>
 #include <cstring>
-#include <fstream>
-#include <iterator>
 #include <memory>
 #include <openssl/err.h>
 #include <openssl/ssl.h>
@@ -33,20 +31,14 @@
 // SecureSocket
 //
 static const std::size_t s_maxInputBufferSize = 1024 * 1024;
-
-static const float s_retryDelay = 0.01f;
+static const uint32_t s_readSize = 4096;
 
 struct Ssl
 {
-  SSL_CTX *m_context = nullptr;
+  std::shared_ptr<SecureContext> m_context;
   SSL *m_ssl = nullptr;
 };
 
-static int verifyIgnoreCertCallback(X509_STORE_CTX *, void *)
-{
-  return 1;
-}
-
 SecureSocket::SecureSocket(
     IEventQueue *events, SocketMultiplexer *socketMultiplexer, IArchNetwork::AddressFamily family,
     SecurityLevel securityLevel
@@ -98,50 +90,48 @@ ISocketMultiplexerJob *SecureSocket::newJob()
 
 void SecureSocket::secureConnect()
 {
-  setJob(new TSocketMultiplexerMethodJob<SecureSocket>(
-      this, &SecureSocket::serviceConnect, getSocket(), isReadable(), isWritable()
-  ));
+  // the client speaks first
+  setJob(new TSocketMultiplexerMethodJob<SecureSocket>(this, &SecureSocket::serviceConnect, getSocket(), false, true));
 }
 
 void SecureSocket::secureAccept()
 {
-  setJob(new TSocketMultiplexerMethodJob<SecureSocket>(
-      this, &SecureSocket::serviceAccept, getSocket(), isReadable(), isWritable()
-  ));
+  // wait for the client to speak first
+  setJob(new TSocketMultiplexerMethodJob<SecureSocket>(this, &SecureSocket::serviceAccept, getSocket(), true, false));
 }
 
 TCPSocket::JobResult SecureSocket::doRead()
 {
   using enum JobResult;
-  static uint8_t buffer[4096];
-  static const auto bufferSize = std::size(buffer);
-  memset(buffer, 0, bufferSize);
-  int bytesRead = 0;
+  size_t bytesRead = 0;
   int status = 0;
 
-  if (isSecureReady()) {
-    status = secureRead(buffer, bufferSize, bytesRead);
-    if (status < 0) {
-      return Break;
-    } else if (status == 0) {
-      return New;
-    }
-  } else {
+  if (!isSecureReady()) {
     return Retry;
   }
 
+  // decrypt straight into the input buffer's free space
+  auto view = m_inputBuffer.reserve(s_readSize)[0];
+  status = secureRead(view.data(), view.size(), bytesRead);
+  if (status < 0) {
+    return Break;
+  } else if (status == 0) {
+    return New;
+  }
+
   if (bytesRead > 0) {
     bool wasEmpty = (m_inputBuffer.getSize() == 0);
 
     // slurp up as much as possible
     do {
-      m_inputBuffer.write(buffer, bytesRead);
+      m_inputBuffer.commit(bytesRead);
 
       if (m_inputBuffer.getSize() > s_maxInputBufferSize) {
         break;
       }
 
-      status = secureRead(buffer, bufferSize, bytesRead);
+      view = m_inputBuffer.reserve(s_readSize)[0];
+      status = secureRead(view.data(), view.size(), bytesRead);
       if (status < 0) {
         return Break;
       }
@@ -170,69 +160,68 @@ TCPSocket::JobResult SecureSocket::doRead()
 TCPSocket::JobResult SecureSocket::doWrite()
 {
   using enum JobResult;
-  static bool s_retry = false;
-  static int s_retrySize = 0;
-  static int s_staticBufferSize = 0;
-  static void *s_staticBuffer = nullptr;
-
-  // write data
-  int bufferSize = 0;
-  int bytesWrote = 0;
-  int status = 0;
 
-  if (s_retry) {
-    bufferSize = s_retrySize;
-  } else {
-    bufferSize = m_outputBuffer.getSize();
-    if (bufferSize != 0) {
-      if (bufferSize > s_staticBufferSize) {
-        s_staticBuffer = realloc(s_staticBuffer, bufferSize);
-        s_staticBufferSize = bufferSize;
-      }
-      memcpy(s_staticBuffer, m_outputBuffer.peek(bufferSize), bufferSize);
-    }
-  }
-
-  if (bufferSize == 0) {
+  if (m_outputBuffer.getSize() == 0 || !isSecureReady()) {
     return Retry;
   }
 
-  if (isSecureReady()) {
-    status = secureWrite(s_staticBuffer, bufferSize, bytesWrote);
-    if (status > 0) {
-      s_retry = false;
-      bufferSize = 0;
-    } else if (status < 0) {
+  // encrypt straight from each run of bytes in the output buffer.  the
+  // ssl is in moving write buffer mode, so a write that has to be retried
+  // can be retried with whatever the first run is then, which starts with
+  // the same bytes and never shrinks until the write succeeds.
+  size_t bytesWrote = 0;
+  for (const auto &view : m_outputBuffer.getReadViews()) {
+    if (view.empty()) {
+      break;
+    }
+
+    size_t wrote = 0;
+    if (const int status = secureWrite(view.data(), view.size(), wrote); status < 0) {
       return Break;
     } else if (status == 0) {
-      s_retry = true;
-      s_retrySize = bufferSize;
-      return New;
+      // the retry has to be with the same bytes, so they can't be replaced
+      keepLatest();
+      break;
     }
-  } else {
-    return Retry;
+    bytesWrote += wrote;
   }
 
   if (bytesWrote > 0) {
-    discardWrittenData(bytesWrote);
-    return New;
+    discardWrittenData(static_cast<int>(bytesWrote));
   }
+  return New;
+}
 
+TCPSocket::JobResult SecureSocket::doWriteDirect(const void *buffer, uint32_t n, uint32_t &sent)
+{
+  using enum JobResult;
+  if (!isSecureReady()) {
+    return Retry;
+  }
+
+  // a write that has to be retried is queued and retried by doWrite()
+  size_t bytesWrote = 0;
+  if (const int status = secureWrite(buffer, n, bytesWrote); status < 0) {
+    return Break;
+  } else if (status > 0) {
+    sent = static_cast<uint32_t>(bytesWrote);
+  }
   return Retry;
 }
 
-int SecureSocket::secureRead(void *buffer, int size, int &read)
+int SecureSocket::secureRead(void *buffer, size_t size, size_t &read)
 {
   std::scoped_lock ssl_lock{ssl_mutex_};
 
+  read = 0;
   if (m_ssl->m_ssl != nullptr) {
     LOG_DEBUG2("reading secure socket");
-    read = SSL_read(m_ssl->m_ssl, buffer, size);
+    const int status = SSL_read_ex(m_ssl->m_ssl, buffer, size, &read);
 
-    static int retry;
+    int retry = 0;
 
     // Check result will cleanup the connection in the case of a fatal
-    checkResult(read, retry);
+    checkResult(status, retry);
 
     if (retry) {
       return 0;
@@ -242,25 +231,24 @@ int SecureSocket::secureRead(void *buffer, int size, int &read)
       return -1;
     }
   }
-  // According to SSL spec, the number of bytes read must not be negative and
-  // not have an error code from SSL_get_error(). If this happens, it is
-  // itself an error. Let the parent handle the case
-  return read;
+  // SSL_read_ex() only succeeds once it has read at least one byte
+  return read > 0 ? 1 : 0;
 }
 
-int SecureSocket::secureWrite(const void *buffer, int size, int &wrote)
+int SecureSocket::secureWrite(const void *buffer, size_t size, size_t &wrote)
 {
   std::scoped_lock ssl_lock{ssl_mutex_};
 
+  wrote = 0;
   if (m_ssl->m_ssl != nullptr) {
     LOG_DEBUG2("writing secure socket: %p", this);
 
-    wrote = SSL_write(m_ssl->m_ssl, buffer, size);
+    const int status = SSL_write_ex(m_ssl->m_ssl, buffer, size, &wrote);
 
-    static int retry;
+    int retry = 0;
 
     // Check result will cleanup the connection in the case of a fatal
-    checkResult(wrote, retry);
+    checkResult(status, retry);
 
     if (retry) {
       return 0;
@@ -270,10 +258,8 @@ int SecureSocket::secureWrite(const void *buffer, int size, int &wrote)
       return -1;
     }
   }
-  // According to SSL spec, r must not be negative and not have an error code
-  // from SSL_get_error(). If this happens, it is itself an error. Let the
-  // parent handle the case
-  return wrote;
+  // SSL_write_ex() only succeeds once the whole buffer has been written
+  return wrote > 0 ? 1 : 0;
 }
 
 bool SecureSocket::isSecureReady() const
@@ -281,115 +267,43 @@ bool SecureSocket::isSecureReady() const
   return m_secureReady;
 }
 
-void SecureSocket::initSsl(bool server)
+void SecureSocket::initSsl(std::shared_ptr<SecureContext> context)
 {
   std::scoped_lock ssl_lock{ssl_mutex_};
 
   m_ssl = std::make_unique<Ssl>();
-
-  initContext(server);
-}
-
-bool SecureSocket::loadCertificates(const std::string &filename)
-{
-  std::scoped_lock ssl_lock{ssl_mutex_};
-
-  if (filename.empty()) {
-    SslLogger::logError("tls certificate is not specified");
-    return false;
-  } else {
-    std::ifstream file(deskflow::filesystem::path(filename));
-    bool exist = file.good();
-    file.close();
-
-    if (!exist) {
-      std::string errorMsg("tls certificate doesn't exist: ");
-      errorMsg.append(filename);
-      SslLogger::logError(errorMsg.c_str());
-      return false;
-    }
-  }
-
-  int r = 0;
-  r = SSL_CTX_use_certificate_file(m_ssl->m_context, filename.c_str(), SSL_FILETYPE_PEM);
-  if (r <= 0) {
-    SslLogger::logError("could not use tls certificate");
-    return false;
-  }
-
-  r = SSL_CTX_use_PrivateKey_file(m_ssl->m_context, filename.c_str(), SSL_FILETYPE_PEM);
-  if (r <= 0) {
-    SslLogger::logError("could not use tls private key");
-    return false;
-  }
-
-  r = SSL_CTX_check_private_key(m_ssl->m_context);
-  if (!r) {
-    SslLogger::logError("could not verify tls private key");
-    return false;
-  }
-
-  return true;
-}
-
-void SecureSocket::initContext(bool server)
-{
-  SSL_library_init();
-
-  const SSL_METHOD *method;
-
-  // load & register all cryptos, etc.
-  OpenSSL_add_all_algorithms();
-
-  // load all error messages
-  SSL_load_error_strings();
-  SslLogger::logSecureLibInfo();
-
-  if (server) {
-    method = SSLv23_server_method();
-  } else {
-    method = SSLv23_client_method();
-  }
-
-  // create new context from method
-  const auto *m = const_cast<SSL_METHOD *>(method);
-  m_ssl->m_context = SSL_CTX_new(m);
-
-  // Prevent the usage of of all version prior to TLSv1.2 as they are known to
-  // be vulnerable
-  SSL_CTX_set_options(m_ssl->m_context, SSL_OP_NO_SSLv2 | SSL_OP_NO_SSLv3 | SSL_OP_NO_TLSv1 | SSL_OP_NO_TLSv1_1);
-
-  if (m_ssl->m_context == nullptr) {
-    SslLogger::logError();
-  }
-
-  if (m_securityLevel == SecurityLevel::PeerAuth) {
-    // We want to ask for peer certificate, but not verify it. If we don't ask for peer
-    // certificate, e.g. client won't send it.
-    SSL_CTX_set_verify(m_ssl->m_context, SSL_VERIFY_PEER | SSL_VERIFY_FAIL_IF_NO_PEER_CERT, nullptr);
-    SSL_CTX_set_cert_verify_callback(m_ssl->m_context, verifyIgnoreCertCallback, nullptr);
-  }
+  m_ssl->m_context = std::move(context);
 }
 
-void SecureSocket::createSSL()
+bool SecureSocket::createSSL(int socket)
 {
   // I assume just one instance is needed
   // get new SSL state with context
   if (m_ssl->m_ssl == nullptr) {
     assert(m_ssl->m_context != nullptr);
-    m_ssl->m_ssl = SSL_new(m_ssl->m_context);
+    m_ssl->m_ssl = m_ssl->m_context->newSsl();
+    if (m_ssl->m_ssl == nullptr) {
+      return false;
+    }
+
+    // attach the socket descriptor
+    SSL_set_fd(m_ssl->m_ssl, socket);
   }
+  return true;
 }
 
 void SecureSocket::freeSSL()
 {
-  std::scoped_lock ssl_lock{ssl_mutex_};
-
-  isFatal(true);
   // take socket from multiplexer ASAP otherwise the race condition
   // could cause events to get called on a dead object. TCPSocket
-  // will do this, too, but the double-call is harmless
+  // will do this, too, but the double-call is harmless.  this must
+  // come before locking ssl_mutex_, which is always locked after the
+  // socket's mutex.
   setJob(nullptr);
+
+  std::scoped_lock ssl_lock{ssl_mutex_};
+
+  isFatal(true);
   if (m_ssl) {
     if (m_ssl->m_ssl != nullptr) {
       SSL_shutdown(m_ssl->m_ssl);
@@ -397,10 +311,6 @@ void SecureSocket::freeSSL()
       SSL_free(m_ssl->m_ssl);
       m_ssl->m_ssl = nullptr;
     }
-    if (m_ssl->m_context != nullptr) {
-      SSL_CTX_free(m_ssl->m_context);
-      m_ssl->m_context = nullptr;
-    }
     m_ssl = nullptr;
   }
 }
@@ -409,32 +319,29 @@ int SecureSocket::secureAccept(int socket)
 {
   std::scoped_lock ssl_lock{ssl_mutex_};
 
-  createSSL();
-
-  // set connection socket to SSL state
-  SSL_set_fd(m_ssl->m_ssl, socket);
+  if (!createSSL(socket)) {
+    LOG_ERR("failed to create secure socket");
+    return -1;
+  }
 
   LOG_DEBUG2("accepting secure socket");
   int r = SSL_accept(m_ssl->m_ssl);
 
-  static int retry;
+  int retry = 0;
 
   checkResult(r, retry);
 
   if (isFatal()) {
-    // tell user and sleep so the socket isn't hammered.
+    // tell user
     LOG_ERR("failed to accept secure socket");
     LOG_WARN("client connection may not be secure");
     m_secureReady = false;
-    Arch::sleep(1);
-    retry = 0;
     return -1; // Failed, error out
   }
 
   // If not fatal and no retry, state is good
   if (retry == 0) {
     if (m_securityLevel == SecurityLevel::PeerAuth && !verifyCertFingerprint(Settings::tlsTrustedClientsDb())) {
-      retry = 0;
       disconnect();
       return -1; // Fail
     }
@@ -449,7 +356,6 @@ int SecureSocket::secureAccept(int socket)
   if (retry > 0) {
     LOG_DEBUG2("retry accepting secure socket");
     m_secureReady = false;
-    Arch::sleep(s_retryDelay);
     return 0;
   }
 
@@ -460,22 +366,24 @@ int SecureSocket::secureAccept(int socket)
 
 int SecureSocket::secureConnect(int socket)
 {
+  std::scoped_lock ssl_lock{ssl_mutex_};
 
-  std::string certDir = Settings::value(Settings::Security::Certificate).toString().toStdString();
+  if (m_ssl->m_ssl == nullptr) {
+    // the context only reloads the certificate if it's changed
+    std::string certDir = Settings::value(Settings::Security::Certificate).toString().toStdString();
+    if (!m_ssl->m_context->loadCertificates(certDir)) {
+      LOG_ERR("could not load client certificates");
+      disconnect();
+      return -1;
+    }
+  }
 
-  if (!loadCertificates(certDir)) {
-    LOG_ERR("could not load client certificates");
+  if (!createSSL(socket)) {
+    LOG_ERR("failed to create secure socket");
     disconnect();
     return -1;
   }
 
-  std::scoped_lock ssl_lock{ssl_mutex_};
-
-  createSSL();
-
-  // attach the socket descriptor
-  SSL_set_fd(m_ssl->m_ssl, socket);
-
   LOG_DEBUG2("connecting secure socket");
 
   // TODO: S1-1766, enable hostname verification.
@@ -483,13 +391,12 @@ int SecureSocket::secureConnect(int socket)
   // we'll probably need to find a way of securely transferring the cert.
   int r = SSL_connect(m_ssl->m_ssl);
 
-  static int retry;
+  int retry = 0;
 
   checkResult(r, retry);
 
   if (isFatal()) {
     LOG_ERR("failed to connect secure socket");
-    retry = 0;
     return -1;
   }
 
@@ -497,11 +404,9 @@ int SecureSocket::secureConnect(int socket)
   if (retry > 0) {
     LOG_DEBUG2("retry connect secure socket");
     m_secureReady = false;
-    Arch::sleep(s_retryDelay);
     return 0;
   }
 
-  retry = 0;
   // No error, set ready, process and return ok
   m_secureReady = true;
   if (verifyCertFingerprint(Settings::tlsTrustedServersDb())) {
@@ -664,7 +569,7 @@ bool SecureSocket::verifyCertFingerprint(const QString &FingerprintDatabasePath)
   return true;
 }
 
-ISocketMultiplexerJob *SecureSocket::serviceConnect(ISocketMultiplexerJob *, bool, bool, bool)
+ISocketMultiplexerJob *SecureSocket::serviceConnect(ISocketMultiplexerJob *job, bool, bool, bool)
 {
   Lock lock(&getMutex());
 
@@ -687,12 +592,10 @@ ISocketMultiplexerJob *SecureSocket::serviceConnect(ISocketMultiplexerJob *, boo
   }
 
   // Retry case
-  return new TSocketMultiplexerMethodJob<SecureSocket>(
-      this, &SecureSocket::serviceConnect, getSocket(), isReadable(), isWritable()
-  );
+  return retryHandshake(job);
 }
 
-ISocketMultiplexerJob *SecureSocket::serviceAccept(ISocketMultiplexerJob *, bool, bool, bool)
+ISocketMultiplexerJob *SecureSocket::serviceAccept(ISocketMultiplexerJob *job, bool, bool, bool)
 {
   Lock lock(&getMutex());
 
@@ -714,9 +617,24 @@ ISocketMultiplexerJob *SecureSocket::serviceAccept(ISocketMultiplexerJob *, bool
   }
 
   // Retry case
-  return new TSocketMultiplexerMethodJob<SecureSocket>(
-      this, &SecureSocket::serviceAccept, getSocket(), isReadable(), isWritable()
-  );
+  return retryHandshake(job);
+}
+
+ISocketMultiplexerJob *SecureSocket::retryHandshake(ISocketMultiplexerJob *job)
+{
+  // keep the handshake job, but only run it again once the socket is
+  // ready for whatever the handshake is waiting on
+  bool wantWrite = false;
+  {
+    std::scoped_lock ssl_lock{ssl_mutex_};
+    wantWrite = (m_ssl != nullptr && m_ssl->m_ssl != nullptr && SSL_want_write(m_ssl->m_ssl));
+  }
+
+  if (auto *handshake = static_cast<TSocketMultiplexerMethodJob<SecureSocket> *>(job);
+      handshake->setInterest(!wantWrite, wantWrite)) {
+    getSocketMultiplexer()->updateJob(handshake);
+  }
+  return job;
 }
 
 void SecureSocket::handleTCPConnected(const Event &)
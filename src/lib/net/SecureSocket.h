@@ -15,6 +15,7 @@
 #include <mutex>
 
 class IEventQueue;
+class SecureContext;
 class SocketMultiplexer;
 class ISocketMultiplexerJob;
 class QString;
@@ -61,17 +62,16 @@ public:
   bool isSecureReady() const;
   void secureConnect();
   void secureAccept();
-  int secureRead(void *buffer, int size, int &read);
-  int secureWrite(const void *buffer, int size, int &wrote);
+  int secureRead(void *buffer, size_t size, size_t &read);
+  int secureWrite(const void *buffer, size_t size, size_t &wrote);
   JobResult doRead() override;
   JobResult doWrite() override;
-  void initSsl(bool server);
-  bool loadCertificates(const std::string &CertFile);
+  JobResult doWriteDirect(const void *buffer, uint32_t n, uint32_t &sent) override;
+  void initSsl(std::shared_ptr<SecureContext> context);
 
 private:
   // SSL
-  void initContext(bool server);
-  void createSSL();
+  bool createSSL(int socket);
   void freeSSL();
   int secureAccept(int s);
   int secureConnect(int s);
@@ -84,6 +84,8 @@ private:
 
   ISocketMultiplexerJob *serviceAccept(ISocketMultiplexerJob *, bool, bool, bool);
 
+  ISocketMultiplexerJob *retryHandshake(ISocketMultiplexerJob *);
+
   void handleTCPConnected(const Event &event);
 
 private:
@@ -9,18 +9,20 @@
 
 #include "arch/IArchNetwork.h"
 
-#include <list>
-#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
-template <class T> class CondVar;
-class Mutex;
 class Thread;
 class ISocket;
 class ISocketMultiplexerJob;
 
 //! Socket multiplexer
 /*!
-A socket multiplexer services multiple sockets simultaneously.
+A socket multiplexer services multiple sockets simultaneously.  Each
+socket stays registered with an \c ArchPollSet while it has a job, so a
+wait only costs in proportion to the sockets that are ready and adding,
+removing or changing a job doesn't have to interrupt it.
 */
 class SocketMultiplexer
 {
@@ -40,6 +42,16 @@ public:
 
   void removeSocket(ISocket *);
 
+  //! Apply a change in a job's interest
+  /*!
+  Makes the multiplexer wait for what \p job is now interested in.  This
+  neither allocates nor waits for jobs that are running so it's cheap
+  enough to call whenever a socket's interest flips, from any thread and
+  from within a job.  \p job must be the job of its socket, or have just
+  been returned by the current job's \c run(), until this returns.
+  */
+  void updateJob(ISocketMultiplexerJob *job);
+
   //@}
   //! @name accessors
   //@{
@@ -50,55 +62,31 @@ public:
   //@}
 
 private:
-  // list of jobs.  we use a list so we can safely iterate over it
-  // while other threads modify it.
-  using SocketJobs = std::list<ISocketMultiplexerJob *>;
-  using JobCursor = SocketJobs::iterator;
-  using SocketJobMap = std::map<ISocket *, JobCursor>;
-
-  // service sockets.  the service thread will only access m_sockets
-  // and m_update while m_pollable and m_polling are true.  all other
-  // threads must only modify these when m_pollable and m_polling are
-  // false.  only the service thread sets m_polling.
+  using JobMap = std::unordered_map<ISocket *, ISocketMultiplexerJob *>;
+  using SocketMap = std::unordered_map<ISocketMultiplexerJob *, ISocket *>;
+
+  // service sockets.  jobs are run with m_mutex locked so once
+  // addSocket() or removeSocket() returns the old job is neither
+  // running nor will be run again.
   [[noreturn]] void serviceThread(void *);
 
-  // create, iterate, and destroy a cursor.  a cursor is used to
-  // safely iterate through the job list while other threads modify
-  // the list.  it works by inserting a dummy item in the list and
-  // moving that item through the list.  the dummy item will never
-  // be removed by other edits so an iterator pointing at the item
-  // remains valid until we remove the dummy item in deleteCursor().
-  // nextCursor() finds the next non-dummy item, moves our dummy
-  // item just past it, and returns an iterator for the non-dummy
-  // item.  all cursor calls lock the mutex for their duration.
-  JobCursor newCursor();
-  JobCursor nextCursor(JobCursor);
-  void deleteCursor(JobCursor);
-
-  // lock out locking the job list.  this blocks if another thread
-  // has already locked out locking.  once it returns, only the
-  // calling thread will be able to lock the job list after any
-  // current lock is released.
-  void lockJobListLock();
-
-  // lock the job list.  this blocks if the job list is already
-  // locked.  the calling thread must have called requestJobLock.
-  void lockJobList();
-
-  // unlock the job list and the lock out on locking.
-  void unlockJobList();
+  // replace the job of a socket and register the new one.  a null job
+  // removes the socket.  m_mutex must be locked.
+  void setJob(ISocket *, ISocketMultiplexerJob *);
 
 private:
-  Mutex *m_mutex = nullptr;
+  // recursive since a job may add or remove other sockets' jobs
+  std::recursive_mutex m_mutex;
+  ArchPollSet m_pollSet = nullptr;
   Thread *m_thread = nullptr;
-  bool m_update = false;
-  CondVar<bool> *m_jobsReady = nullptr;
-  CondVar<bool> *m_jobListLock = nullptr;
-  CondVar<bool> *m_jobListLockLocked = nullptr;
-  Thread *m_jobListLocker = nullptr;
-  Thread *m_jobListLockLocker = nullptr;
-
-  SocketJobs m_socketJobs = {};
-  SocketJobMap m_socketJobMap = {};
-  ISocketMultiplexerJob *m_cursorMark = nullptr;
+
+  // jobs are the keys of their poll set registrations.  a result is
+  // only acted on if its job is still in m_sockets.
+  JobMap m_jobs;
+  SocketMap m_sockets;
+
+  // replaced jobs.  the wait in progress may still report them so
+  // they're only deleted by the service thread before its next wait,
+  // otherwise a new job at the same address could get their result.
+  std::vector<ISocketMultiplexerJob *> m_removed;
 };
@@ -116,6 +116,16 @@ void SslLogger::logSecureConnectInfo(const SSL *ssl)
     } else {
       LOG_ERR("could not get secure socket cipher");
     }
+
+    LOG_DEBUG("tls session %s", SSL_session_reused(ssl) ? "resumed" : "negotiated");
+
+#ifdef SSL_OP_ENABLE_KTLS
+    // with kernel tls the socket i/o carries no user space crypto
+    LOG_DEBUG(
+        "kernel tls send: %s, receive: %s", BIO_get_ktls_send(SSL_get_wbio(ssl)) ? "on" : "off",
+        BIO_get_ktls_recv(SSL_get_rbio(ssl)) ? "on" : "off"
+    );
+#endif
   }
 }
 
@@ -91,7 +91,11 @@ std::unique_ptr<IDataSocket> TCPListenSocket::accept()
 {
   std::unique_ptr<IDataSocket> socket;
   try {
-    socket = std::make_unique<TCPSocket>(m_events, m_socketMultiplexer, ARCH->acceptSocket(m_socket, nullptr));
+    ArchNetAddress peer = nullptr;
+    ArchSocket accepted = ARCH->acceptSocket(m_socket, &peer);
+    socket = std::make_unique<TCPSocket>(
+        m_events, m_socketMultiplexer, accepted, peer != nullptr ? NetworkAddress(peer) : NetworkAddress()
+    );
     setListeningJob();
     return socket;
   } catch (ArchNetworkException &) {
@@ -22,6 +22,8 @@
 #include <memory>
 
 static const std::size_t s_maxInputBufferSize = 1024 * 1024;
+static const uint32_t s_readSize = 4096;
+static const uint32_t s_notSentLowWater = 16 * 1024;
 
 //
 // TCPSocket
@@ -44,12 +46,15 @@ TCPSocket::TCPSocket(IEventQueue *events, SocketMultiplexer *socketMultiplexer,
   init();
 }
 
-TCPSocket::TCPSocket(IEventQueue *events, SocketMultiplexer *socketMultiplexer, ArchSocket socket)
+TCPSocket::TCPSocket(
+    IEventQueue *events, SocketMultiplexer *socketMultiplexer, ArchSocket socket, const NetworkAddress &peer
+)
     : IDataSocket(events),
       m_socket(socket),
       m_events(events),
       m_flushed(&m_mutex, true),
-      m_socketMultiplexer(socketMultiplexer)
+      m_socketMultiplexer(socketMultiplexer),
+      m_peer(peer)
 {
   assert(m_socket != nullptr);
 
@@ -58,7 +63,7 @@ TCPSocket::TCPSocket(IEventQueue *events, SocketMultiplexer *socketMultiplexer,
   // socket starts in connected state
   init();
   onConnected();
-  setJob(newJob());
+  refreshJob();
 }
 
 TCPSocket::~TCPSocket()
@@ -122,10 +127,11 @@ uint32_t TCPSocket::read(void *buffer, uint32_t n)
   if (uint32_t size = m_inputBuffer.getSize(); n > size) {
     n = size;
   }
-  if (buffer != nullptr && n != 0) {
-    memcpy(buffer, m_inputBuffer.peek(n), n);
+  if (buffer != nullptr) {
+    m_inputBuffer.read(buffer, n);
+  } else {
+    m_inputBuffer.pop(n);
   }
-  m_inputBuffer.pop(n);
 
   // if no more data and we cannot read or write then send disconnected
   if (n > 0 && m_inputBuffer.getSize() == 0 && !m_readable && !m_writable) {
@@ -138,7 +144,44 @@ uint32_t TCPSocket::read(void *buffer, uint32_t n)
 
 void TCPSocket::write(const void *buffer, uint32_t n)
 {
-  bool wasEmpty;
+  write(buffer, n, true);
+}
+
+void TCPSocket::writeBulk(const void *buffer, uint32_t n)
+{
+  // bulk data only goes out when the multiplexer finds the socket
+  // writable, which is when little of what's already been sent is
+  // still waiting in the kernel.  anything written after it is queued
+  // behind no more than this.
+  write(buffer, n, false);
+}
+
+void TCPSocket::writeLatest(const void *buffer, uint32_t n)
+{
+  write(buffer, n, true, true);
+}
+
+bool TCPSocket::replaceLatest(const void *buffer, uint32_t n)
+{
+  Lock lock(&m_mutex);
+
+  // the output buffer only holds what hasn't been sent, so the latest
+  // data is still whole if it fits in what's left
+  if (n == 0 || m_latestSize == 0 || m_outputBuffer.getSize() < m_latestSize) {
+    return false;
+  }
+
+  m_outputBuffer.popBack(m_latestSize);
+  m_outputBuffer.write(buffer, n);
+  m_latestSize = n;
+  return true;
+}
+
+void TCPSocket::write(const void *buffer, uint32_t n, bool sendNow, bool latest)
+{
+  using enum JobResult;
+  JobResult result = Retry;
+  bool updateJob;
   {
     Lock lock(&m_mutex);
 
@@ -153,17 +196,72 @@ void TCPSocket::write(const void *buffer, uint32_t n)
       return;
     }
 
-    // copy data to the output buffer
-    wasEmpty = (m_outputBuffer.getSize() == 0);
-    m_outputBuffer.write(buffer, n);
+    // anything written goes after the latest data, which can't be
+    // replaced now.  new latest data can only be replaced if it's all
+    // queued without trying to send it.
+    const bool wasEmpty = (m_outputBuffer.getSize() == 0);
+    m_latestSize = (latest && (!wasEmpty || m_corked > 0)) ? n : 0;
+
+    // with nothing queued, send straight away from this thread rather
+    // than waking the multiplexer thread to do it.  only what the socket
+    // won't take is queued.  when corked it's all queued until uncork().
+    if (sendNow && wasEmpty && m_connected && m_corked == 0) {
+      uint32_t sent = 0;
+      result = tryWrite([&] { return doWriteDirect(buffer, n, sent); });
+      if (sent == n) {
+        sendEvent(EventTypes::StreamOutputFlushed);
+      }
+      buffer = static_cast<const uint8_t *>(buffer) + sent;
+      n -= sent;
+    }
+
+    // copy the rest to the output buffer, unless writing failed
+    if (n > 0 && m_writable) {
+      m_outputBuffer.write(buffer, n);
+
+      // there's data to write
+      m_flushed = false;
+    }
+
+    // make sure we're waiting to write
+    updateJob = (wasEmpty && m_outputBuffer.getSize() > 0 && m_corked == 0) || result == New;
+  }
+
+  if (result == Break) {
+    setJob(nullptr);
+  } else if (updateJob) {
+    refreshJob();
+  }
+}
+
+void TCPSocket::cork()
+{
+  Lock lock(&m_mutex);
+  ++m_corked;
+}
+
+void TCPSocket::uncork()
+{
+  using enum JobResult;
+  JobResult result = Retry;
+  {
+    Lock lock(&m_mutex);
+    assert(m_corked > 0);
+    if (--m_corked > 0) {
+      return;
+    }
 
-    // there's data to write
-    m_flushed = false;
+    // send everything held back at once from this thread, like write()
+    // does, and leave the multiplexer to send what the socket won't take
+    if (m_connected && m_outputBuffer.getSize() > 0) {
+      result = tryWrite([this] { return doWrite(); });
+    }
   }
 
-  // make sure we're waiting to write
-  if (wasEmpty) {
-    setJob(newJob());
+  if (result == Break) {
+    setJob(nullptr);
+  } else {
+    refreshJob();
   }
 }
 
@@ -197,7 +295,7 @@ void TCPSocket::shutdownInput()
     }
   }
   if (useNewJob) {
-    setJob(newJob());
+    refreshJob();
   }
 }
 
@@ -223,7 +321,7 @@ void TCPSocket::shutdownOutput()
     }
   }
   if (useNewJob) {
-    setJob(newJob());
+    refreshJob();
   }
 }
 
@@ -257,6 +355,7 @@ void TCPSocket::connect(const NetworkAddress &addr)
       return;
     }
 
+    m_peer = addr;
     try {
       if (ARCH->connectSocket(m_socket, addr.getAddress())) {
         sendEvent(EventTypes::DataSocketConnected);
@@ -269,7 +368,13 @@ void TCPSocket::connect(const NetworkAddress &addr)
       throw SocketConnectException(e.what());
     }
   }
-  setJob(newJob());
+  refreshJob();
+}
+
+NetworkAddress TCPSocket::getPeerAddress() const
+{
+  Lock lock(&m_mutex);
+  return m_peer;
 }
 
 void TCPSocket::init()
@@ -284,6 +389,10 @@ void TCPSocket::init()
     // that should be sent without (much) delay.  for example, the
     // mouse motion messages are much less useful if they're delayed.
     ARCH->setNoDelayOnSocket(m_socket, true);
+
+    // and don't let the kernel queue up much more than is in flight, so
+    // they aren't stuck behind a backlog of bulk data either.
+    ARCH->setNotSentLowWaterOnSocket(m_socket, s_notSentLowWater);
   } catch (const ArchNetworkException &e) {
     try {
       ARCH->closeSocket(m_socket);
@@ -298,24 +407,21 @@ void TCPSocket::init()
 
 TCPSocket::JobResult TCPSocket::doRead()
 {
-  uint8_t buffer[4096];
-  memset(buffer, 0, sizeof(buffer));
-  size_t bytesRead = 0;
-
-  bytesRead = ARCH->readSocket(m_socket, buffer, sizeof(buffer));
+  // read straight into all of the input buffer's free space
+  size_t bytesRead = ARCH->readSocket(m_socket, m_inputBuffer.reserve(s_readSize));
 
   if (bytesRead > 0) {
     bool wasEmpty = (m_inputBuffer.getSize() == 0);
 
     // slurp up as much as possible
     do {
-      m_inputBuffer.write(buffer, static_cast<uint32_t>(bytesRead));
+      m_inputBuffer.commit(static_cast<uint32_t>(bytesRead));
 
       if (m_inputBuffer.getSize() > s_maxInputBufferSize) {
         break;
       }
 
-      bytesRead = ARCH->readSocket(m_socket, buffer, sizeof(buffer));
+      bytesRead = ARCH->readSocket(m_socket, m_inputBuffer.reserve(s_readSize));
     } while (bytesRead > 0);
 
     // send input ready if input buffer was empty
@@ -340,13 +446,8 @@ TCPSocket::JobResult TCPSocket::doRead()
 
 TCPSocket::JobResult TCPSocket::doWrite()
 {
-  // write data
-  uint32_t bufferSize = 0;
-  int bytesWrote = 0;
-
-  bufferSize = m_outputBuffer.getSize();
-  const void *buffer = m_outputBuffer.peek(bufferSize);
-  bytesWrote = (uint32_t)ARCH->writeSocket(m_socket, buffer, bufferSize);
+  // write all of the output buffer, even if it wraps around
+  const auto bytesWrote = static_cast<int>(ARCH->writeSocket(m_socket, m_outputBuffer.getReadViews()));
 
   if (bytesWrote > 0) {
     discardWrittenData(bytesWrote);
@@ -356,9 +457,22 @@ TCPSocket::JobResult TCPSocket::doWrite()
   return JobResult::Retry;
 }
 
+TCPSocket::JobResult TCPSocket::doWriteDirect(const void *buffer, uint32_t n, uint32_t &sent)
+{
+  sent = static_cast<uint32_t>(ARCH->writeSocket(m_socket, buffer, n));
+  return JobResult::Retry;
+}
+
 void TCPSocket::setJob(ISocketMultiplexerJob *job)
 {
-  // multiplexer will delete the old job
+  // multiplexer will delete the old job, including our connected job
+  // if this replaces it
+  {
+    Lock lock(&m_mutex);
+    if (job != m_job) {
+      m_job = nullptr;
+    }
+  }
   if (job == nullptr) {
     m_socketMultiplexer->removeSocket(this);
   } else {
@@ -366,13 +480,33 @@ void TCPSocket::setJob(ISocketMultiplexerJob *job)
   }
 }
 
+void TCPSocket::refreshJob()
+{
+  ISocketMultiplexerJob *job;
+  {
+    Lock lock(&m_mutex);
+    const ISocketMultiplexerJob *oldJob = m_job;
+    job = newJob();
+
+    // the multiplexer already has the job and newJob() passed on any
+    // change in interest, so there's nothing to allocate or lock
+    if (job != nullptr && job == oldJob) {
+      return;
+    }
+  }
+  setJob(job);
+}
+
 ISocketMultiplexerJob *TCPSocket::newJob()
 {
   // note -- must have m_mutex locked on entry
 
   if (m_socket == nullptr) {
+    m_job = nullptr;
     return nullptr;
   } else if (!m_connected) {
+    // the multiplexer deletes the connected job when it's replaced
+    m_job = nullptr;
     assert(!m_readable);
     if (!(m_readable || m_writable)) {
       return nullptr;
@@ -381,12 +515,15 @@ ISocketMultiplexerJob *TCPSocket::newJob()
         this, &TCPSocket::serviceConnecting, m_socket, m_readable, m_writable
     );
   } else {
-    if (!(m_readable || (m_writable && (m_outputBuffer.getSize() > 0)))) {
-      return nullptr;
+    const bool writable = m_writable && (m_outputBuffer.getSize() > 0) && m_corked == 0;
+    if (m_job == nullptr) {
+      m_job = new TSocketMultiplexerMethodJob<TCPSocket>(
+          this, &TCPSocket::serviceConnected, m_socket, m_readable, writable
+      );
+    } else if (m_job->setInterest(m_readable, writable)) {
+      m_socketMultiplexer->updateJob(m_job);
     }
-    return new TSocketMultiplexerMethodJob<TCPSocket>(
-        this, &TCPSocket::serviceConnected, m_socket, m_readable, m_writable && (m_outputBuffer.getSize() > 0)
-    );
+    return m_job;
   }
 }
 
@@ -444,6 +581,36 @@ void TCPSocket::onDisconnected()
   m_connected = false;
 }
 
+template <typename Write> TCPSocket::JobResult TCPSocket::tryWrite(Write write)
+{
+  // note -- must have m_mutex locked on entry
+
+  using enum EventTypes;
+  try {
+    return write();
+  } catch (ArchNetworkShutdownException &) {
+    // remote read end of stream hungup.  our output side
+    // has therefore shutdown.
+    onOutputShutdown();
+    sendEvent(StreamOutputShutdown);
+    if (!m_readable && m_inputBuffer.getSize() == 0) {
+      sendEvent(SocketDisconnected);
+      m_connected = false;
+    }
+  } catch (ArchNetworkDisconnectedException &) {
+    // stream hungup
+    onDisconnected();
+    sendEvent(SocketDisconnected);
+  } catch (ArchNetworkException &e) {
+    // other write error
+    LOG_WARN("error writing socket: %s", e.what());
+    onDisconnected();
+    sendEvent(StreamOutputError);
+    sendEvent(SocketDisconnected);
+  }
+  return JobResult::New;
+}
+
 ISocketMultiplexerJob *TCPSocket::serviceConnecting(ISocketMultiplexerJob *job, bool, bool write, bool error)
 {
   Lock lock(&m_mutex);
@@ -501,31 +668,7 @@ ISocketMultiplexerJob *TCPSocket::serviceConnected(ISocketMultiplexerJob *job, b
   JobResult writeResult = Retry;
 
   if (write) {
-    try {
-      writeResult = doWrite();
-    } catch (ArchNetworkShutdownException &) {
-      // remote read end of stream hungup.  our output side
-      // has therefore shutdown.
-      onOutputShutdown();
-      sendEvent(StreamOutputShutdown);
-      if (!m_readable && m_inputBuffer.getSize() == 0) {
-        sendEvent(SocketDisconnected);
-        m_connected = false;
-      }
-      writeResult = New;
-    } catch (ArchNetworkDisconnectedException &) {
-      // stream hungup
-      onDisconnected();
-      sendEvent(SocketDisconnected);
-      writeResult = New;
-    } catch (ArchNetworkException &e) {
-      // other write error
-      LOG_WARN("error writing socket: %s", e.what());
-      onDisconnected();
-      sendEvent(StreamOutputError);
-      sendEvent(SocketDisconnected);
-      writeResult = New;
-    }
+    writeResult = tryWrite([this] { return doWrite(); });
   }
 
   if (read && m_readable) {
@@ -542,8 +685,10 @@ ISocketMultiplexerJob *TCPSocket::serviceConnected(ISocketMultiplexerJob *job, b
     }
   }
 
-  if (readResult == Break || writeResult == Break)
+  if (readResult == Break || writeResult == Break) {
+    m_job = nullptr;
     return nullptr;
+  }
 
   if (writeResult == New || readResult == New)
     return newJob();
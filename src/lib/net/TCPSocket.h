@@ -12,12 +12,14 @@
 #include "mt/CondVar.h"
 #include "mt/Mutex.h"
 #include "net/IDataSocket.h"
+#include "net/NetworkAddress.h"
 
 class Mutex;
 class Thread;
 class ISocketMultiplexerJob;
 class IEventQueue;
 class SocketMultiplexer;
+template <class T> class TSocketMultiplexerMethodJob;
 
 //! TCP data socket
 /*!
@@ -30,7 +32,10 @@ public:
       IEventQueue *events, SocketMultiplexer *socketMultiplexer,
       IArchNetwork::AddressFamily family = IArchNetwork::AddressFamily::INet
   );
-  TCPSocket(IEventQueue *events, SocketMultiplexer *socketMultiplexer, ArchSocket socket);
+  TCPSocket(
+      IEventQueue *events, SocketMultiplexer *socketMultiplexer, ArchSocket socket,
+      const NetworkAddress &peer = NetworkAddress()
+  );
   TCPSocket(TCPSocket const &) = delete;
   TCPSocket(TCPSocket &&) = delete;
   ~TCPSocket() override;
@@ -46,6 +51,11 @@ public:
   // IStream overrides
   uint32_t read(void *buffer, uint32_t n) override;
   void write(const void *buffer, uint32_t n) override;
+  void writeBulk(const void *buffer, uint32_t n) override;
+  void writeLatest(const void *buffer, uint32_t n) override;
+  bool replaceLatest(const void *buffer, uint32_t n) override;
+  void cork() override;
+  void uncork() override;
   void flush() override;
   void shutdownInput() override;
   void shutdownOutput() override;
@@ -55,6 +65,7 @@ public:
 
   // IDataSocket overrides
   void connect(const NetworkAddress &) override;
+  NetworkAddress getPeerAddress() const override;
 
   virtual ISocketMultiplexerJob *newJob();
 
@@ -74,11 +85,30 @@ protected:
   {
     return m_events;
   }
+  SocketMultiplexer *getSocketMultiplexer()
+  {
+    return m_socketMultiplexer;
+  }
   virtual JobResult doRead();
   virtual JobResult doWrite();
 
+  //! Send from the caller's thread
+  /*!
+  Called with the mutex locked by write() when nothing is queued, to send
+  \p buffer without waiting for the multiplexer thread.  Sets \p sent to
+  the number of bytes the socket took, which may be none, and may throw
+  like doWrite().
+  */
+  virtual JobResult doWriteDirect(const void *buffer, uint32_t n, uint32_t &sent);
+
   void setJob(ISocketMultiplexerJob *);
 
+  //! Bring the multiplexer up to date with the socket's state
+  /*!
+  Must not have the mutex locked.
+  */
+  void refreshJob();
+
   bool isConnected() const
   {
     return m_connected;
@@ -123,17 +153,29 @@ protected:
   void sendEvent(EventTypes);
   void discardWrittenData(int bytesWrote);
 
+  //! Stop the latest data from being replaced
+  /*!
+  Called with the mutex locked by a doWrite() that has to be retried with
+  the same bytes.
+  */
+  void keepLatest()
+  {
+    m_latestSize = 0;
+  }
+
   StreamBuffer m_inputBuffer;
   StreamBuffer m_outputBuffer;
 
 private:
   void init();
 
+  void write(const void *buffer, uint32_t n, bool sendNow, bool latest = false);
   void sendConnectionFailedEvent(const char *);
   void onConnected();
   void onInputShutdown();
   void onOutputShutdown();
   void onDisconnected();
+  template <typename Write> JobResult tryWrite(Write write);
 
   ISocketMultiplexerJob *serviceConnecting(ISocketMultiplexerJob *, bool, bool, bool);
   ISocketMultiplexerJob *serviceConnected(ISocketMultiplexerJob *, bool, bool, bool);
@@ -142,8 +184,22 @@ private:
   bool m_writable;
   bool m_connected;
   Mutex m_mutex;
+
+  // the job of a connected socket, owned by the multiplexer.  it's kept
+  // for as long as the socket is connected and only its interest changes.
+  TSocketMultiplexerMethodJob<TCPSocket> *m_job = nullptr;
   ArchSocket m_socket;
   IEventQueue *m_events;
   CondVar<bool> m_flushed;
   SocketMultiplexer *m_socketMultiplexer;
+  NetworkAddress m_peer;
+
+  // size of the data last written with writeLatest(), or replaced with
+  // replaceLatest(), while it's still at the end of the output buffer
+  // and can be replaced, otherwise 0
+  uint32_t m_latestSize = 0;
+
+  // how many cork() calls haven't been matched by uncork().  while it's
+  // not 0 written data is only queued.
+  uint32_t m_corked = 0;
 };
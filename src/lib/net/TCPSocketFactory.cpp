@@ -9,10 +9,12 @@
 #include "net/TCPSocketFactory.h"
 #include "arch/Arch.h"
 #include "base/Log.h"
+#include "net/SecureContext.h"
 #include "net/SecureListenSocket.h"
 #include "net/SecureSocket.h"
 #include "net/TCPListenSocket.h"
 #include "net/TCPSocket.h"
+#include "net/UDPSocket.h"
 
 //
 // TCPSocketFactory
@@ -28,8 +30,11 @@ TCPSocketFactory::TCPSocketFactory(IEventQueue *events, SocketMultiplexer *socke
 IDataSocket *TCPSocketFactory::create(IArchNetwork::AddressFamily family, SecurityLevel securityLevel) const
 {
   if (securityLevel != SecurityLevel::PlainText) {
+    if (!m_clientContext || m_clientContext->getSecurityLevel() != securityLevel) {
+      m_clientContext = std::make_shared<SecureContext>(false, securityLevel);
+    }
     auto *secureSocket = new SecureSocket(m_events, m_socketMultiplexer, family, securityLevel);
-    secureSocket->initSsl(false);
+    secureSocket->initSsl(m_clientContext);
     return secureSocket;
   } else {
     return new TCPSocket(m_events, m_socketMultiplexer, family);
@@ -47,3 +52,8 @@ IListenSocket *TCPSocketFactory::createListen(IArchNetwork::AddressFamily family
 
   return socket;
 }
+
+IDatagramSocket *TCPSocketFactory::createDatagram(IArchNetwork::AddressFamily family) const
+{
+  return new UDPSocket(m_events, m_socketMultiplexer, family);
+}
@@ -11,7 +11,10 @@
 #include "arch/IArchNetwork.h"
 #include "net/ISocketFactory.h"
 
+#include <memory>
+
 class IEventQueue;
+class SecureContext;
 class SocketMultiplexer;
 
 //! Socket factory for TCP sockets
@@ -30,8 +33,13 @@ public:
       IArchNetwork::AddressFamily family = IArchNetwork::AddressFamily::INet,
       SecurityLevel securityLevel = SecurityLevel::PlainText
   ) const override;
+  IDatagramSocket *createDatagram(IArchNetwork::AddressFamily family) const override;
 
 private:
   IEventQueue *m_events;
   SocketMultiplexer *m_socketMultiplexer;
+
+  // shared by the secure sockets we create, so reconnecting can resume
+  // the last session
+  mutable std::shared_ptr<SecureContext> m_clientContext;
 };
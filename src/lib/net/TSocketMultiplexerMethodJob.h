@@ -10,9 +10,13 @@
 #include "arch/Arch.h"
 #include "net/ISocketMultiplexerJob.h"
 
+#include <atomic>
+
 //! Use a method as a socket multiplexer job
 /*!
-A socket multiplexer job class that invokes a member function.
+A socket multiplexer job class that invokes a member function.  Its
+interest in readability and writability can be changed while it's in
+use so a socket can keep the same job for its lifetime.
 */
 template <class T> class TSocketMultiplexerMethodJob : public ISocketMultiplexerJob
 {
@@ -34,13 +38,19 @@ public:
   bool isReadable() const override;
   bool isWritable() const override;
 
+  //! Change interest in readability and writability
+  /*!
+  Returns true iff either changed, in which case the caller must pass
+  the job to \c SocketMultiplexer::updateJob().  Any thread may call this.
+  */
+  bool setInterest(bool readable, bool writable);
+
 private:
   T *m_object;
   Method m_method;
   ArchSocket m_socket;
-  bool m_readable;
-  bool m_writable;
-  void *m_arg;
+  std::atomic<bool> m_readable;
+  std::atomic<bool> m_writable;
 };
 
 template <class T>
@@ -83,3 +93,10 @@ template <class T> inline bool TSocketMultiplexerMethodJob<T>::isWritable() cons
 {
   return m_writable;
 }
+
+template <class T> inline bool TSocketMultiplexerMethodJob<T>::setInterest(bool readable, bool writable)
+{
+  const bool readableChanged = (m_readable.exchange(readable) != readable);
+  const bool writableChanged = (m_writable.exchange(writable) != writable);
+  return readableChanged || writableChanged;
+}
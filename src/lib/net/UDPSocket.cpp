@@ -0,0 +1,158 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include "net/UDPSocket.h"
+
+#include "arch/Arch.h"
+#include "arch/ArchException.h"
+#include "base/IEventQueue.h"
+#include "base/Log.h"
+#include "io/IOException.h"
+#include "net/NetworkAddress.h"
+#include "net/SocketException.h"
+#include "net/SocketMultiplexer.h"
+#include "net/TSocketMultiplexerMethodJob.h"
+
+//
+// UDPSocket
+//
+
+UDPSocket::UDPSocket(IEventQueue *events, SocketMultiplexer *socketMultiplexer, IArchNetwork::AddressFamily family)
+    : m_events(events),
+      m_socketMultiplexer(socketMultiplexer)
+{
+  try {
+    m_socket = ARCH->newSocket(family, IArchNetwork::SocketType::DataGram);
+  } catch (ArchNetworkException &e) {
+    throw SocketCreateException(e.what());
+  }
+}
+
+UDPSocket::~UDPSocket()
+{
+  try {
+    if (m_socket != nullptr) {
+      m_socketMultiplexer->removeSocket(this);
+      ARCH->closeSocket(m_socket);
+    }
+  } catch (...) {
+    // ignore
+    LOG_WARN("error while closing UDP socket");
+  }
+}
+
+void UDPSocket::bind(const NetworkAddress &addr)
+{
+  try {
+    std::scoped_lock lock{m_mutex};
+    ARCH->bindSocket(m_socket, addr.getAddress());
+    setReadableJob();
+  } catch (ArchNetworkAddressInUseException &e) {
+    throw SocketAddressInUseException(e.what());
+  } catch (ArchNetworkException &e) {
+    throw SocketBindException(e.what());
+  }
+}
+
+void UDPSocket::close()
+{
+  std::scoped_lock lock{m_mutex};
+  if (m_socket == nullptr) {
+    throw IOClosedException();
+  }
+  try {
+    m_socketMultiplexer->removeSocket(this);
+    ARCH->closeSocket(m_socket);
+    m_socket = nullptr;
+  } catch (ArchNetworkException &e) {
+    throw SocketIOCloseException(e.what());
+  }
+}
+
+void *UDPSocket::getEventTarget() const
+{
+  return const_cast<void *>(static_cast<const void *>(this));
+}
+
+void UDPSocket::connect(const NetworkAddress &addr)
+{
+  try {
+    std::scoped_lock lock{m_mutex};
+    ARCH->connectSocket(m_socket, addr.getAddress());
+    setReadableJob();
+  } catch (ArchNetworkException &e) {
+    throw SocketConnectException(e.what());
+  }
+}
+
+bool UDPSocket::send(const void *buffer, uint32_t n)
+{
+  std::scoped_lock lock{m_mutex};
+  try {
+    return m_socket != nullptr && ARCH->writeSocket(m_socket, buffer, n) == n;
+  } catch (ArchNetworkException &e) {
+    LOG_DEBUG1("failed to send datagram: %s", e.what());
+    return false;
+  }
+}
+
+bool UDPSocket::sendTo(const void *buffer, uint32_t n, const NetworkAddress &address)
+{
+  std::scoped_lock lock{m_mutex};
+  try {
+    return m_socket != nullptr && ARCH->writeSocketTo(m_socket, buffer, n, address.getAddress()) == n;
+  } catch (ArchNetworkException &e) {
+    LOG_DEBUG1("failed to send datagram: %s", e.what());
+    return false;
+  }
+}
+
+uint32_t UDPSocket::receive(void *buffer, uint32_t n, NetworkAddress *from)
+{
+  std::scoped_lock lock{m_mutex};
+  if (m_socket == nullptr) {
+    return 0;
+  }
+
+  size_t size = 0;
+  try {
+    if (from != nullptr) {
+      ArchNetAddress address = nullptr;
+      size = ARCH->readSocketFrom(m_socket, buffer, n, &address);
+      if (address != nullptr) {
+        *from = NetworkAddress(address);
+      }
+    } else {
+      size = ARCH->readSocket(m_socket, buffer, n);
+    }
+  } catch (ArchNetworkException &e) {
+    // a datagram sent earlier couldn't be delivered, which isn't fatal
+    LOG_DEBUG1("failed to receive datagram: %s", e.what());
+  }
+
+  // wait for more once they're all read
+  if (size == 0) {
+    setReadableJob();
+  }
+  return static_cast<uint32_t>(size);
+}
+
+void UDPSocket::setReadableJob()
+{
+  m_socketMultiplexer->addSocket(
+      this, new TSocketMultiplexerMethodJob<UDPSocket>(this, &UDPSocket::serviceReadable, m_socket, true, false)
+  );
+}
+
+ISocketMultiplexerJob *UDPSocket::serviceReadable(ISocketMultiplexerJob *job, bool read, bool, bool error)
+{
+  if (read || error) {
+    m_events->addEvent(Event(EventTypes::DatagramSocketReady, this));
+    // stop polling on this socket until the datagrams are read
+    return nullptr;
+  }
+  return job;
+}
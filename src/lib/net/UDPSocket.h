@@ -0,0 +1,54 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#pragma once
+
+#include "arch/IArchNetwork.h"
+#include "net/IDatagramSocket.h"
+
+#include <mutex>
+
+class ISocketMultiplexerJob;
+class IEventQueue;
+class SocketMultiplexer;
+
+//! UDP datagram socket
+/*!
+A datagram socket using UDP.
+*/
+class UDPSocket : public IDatagramSocket
+{
+public:
+  UDPSocket(IEventQueue *events, SocketMultiplexer *socketMultiplexer, IArchNetwork::AddressFamily family);
+  UDPSocket(UDPSocket const &) = delete;
+  UDPSocket(UDPSocket &&) = delete;
+  ~UDPSocket() override;
+
+  UDPSocket &operator=(UDPSocket const &) = delete;
+  UDPSocket &operator=(UDPSocket &&) = delete;
+
+  // ISocket overrides
+  void bind(const NetworkAddress &) override;
+  void close() override;
+  void *getEventTarget() const override;
+
+  // IDatagramSocket overrides
+  void connect(const NetworkAddress &) override;
+  bool send(const void *buffer, uint32_t n) override;
+  bool sendTo(const void *buffer, uint32_t n, const NetworkAddress &address) override;
+  uint32_t receive(void *buffer, uint32_t n, NetworkAddress *from) override;
+
+  ISocketMultiplexerJob *serviceReadable(ISocketMultiplexerJob *, bool, bool, bool);
+
+private:
+  // wait for the next datagram.  must have the mutex locked.
+  void setReadableJob();
+
+  ArchSocket m_socket = nullptr;
+  IEventQueue *m_events;
+  SocketMultiplexer *m_socketMultiplexer;
+  std::mutex m_mutex;
+};
@@ -1174,7 +1174,7 @@ bool MSWindowsScreen::onHotKey(WPARAM wParam, LPARAM lParam)
   }
 
   // generate event
-  m_events->addEvent(Event(type, getEventTarget(), HotKeyInfo::alloc(i->second)));
+  m_events->addEvent(Event(type, getEventTarget(), HotKeyInfo{i->second}));
 
   return true;
 }
@@ -1196,12 +1196,12 @@ bool MSWindowsScreen::onMouseButton(WPARAM wParam, LPARAM lParam)
     if (pressed) {
       LOG_DEBUG1("event: button press button=%d", button);
       if (button != kButtonNone) {
-        sendEvent(EventTypes::PrimaryScreenButtonDown, ButtonInfo::alloc(button, mask));
+        sendEvent(EventTypes::PrimaryScreenButtonDown, ButtonInfo{button, mask});
       }
     } else {
       LOG_DEBUG1("event: button release button=%d", button);
       if (button != kButtonNone) {
-        sendEvent(EventTypes::PrimaryScreenButtonUp, ButtonInfo::alloc(button, mask));
+        sendEvent(EventTypes::PrimaryScreenButtonUp, ButtonInfo{button, mask});
       }
     }
   }
@@ -1239,7 +1239,7 @@ bool MSWindowsScreen::onMouseMove(int32_t mx, int32_t my)
 
   if (m_isOnScreen) {
     // motion on primary screen
-    sendEvent(EventTypes::PrimaryScreenMotionOnPrimary, MotionInfo::alloc(m_xCursor, m_yCursor));
+    sendEvent(EventTypes::PrimaryScreenMotionOnPrimary, MotionInfo{m_xCursor, m_yCursor});
   } else {
     // the motion is on the secondary screen, so we warp mouse back to
     // center on the server screen. if we don't do this, then the mouse
@@ -1260,7 +1260,7 @@ bool MSWindowsScreen::onMouseMove(int32_t mx, int32_t my)
       LOG_DEBUG("dropped bogus delta motion: %+d,%+d", x, y);
     } else {
       // send motion
-      sendEvent(EventTypes::PrimaryScreenMotionOnSecondary, MotionInfo::alloc(x, y));
+      sendEvent(EventTypes::PrimaryScreenMotionOnSecondary, MotionInfo{x, y});
     }
   }
 
@@ -1272,7 +1272,7 @@ bool MSWindowsScreen::onMouseWheel(int32_t xDelta, int32_t yDelta)
   // ignore message if posted prior to last mark change
   if (!ignore()) {
     LOG_DEBUG1("event: button wheel delta=%+d,%+d", xDelta, yDelta);
-    sendEvent(EventTypes::PrimaryScreenWheel, WheelInfo::alloc(xDelta, yDelta));
+    sendEvent(EventTypes::PrimaryScreenWheel, WheelInfo{xDelta, yDelta});
   }
   return true;
 }
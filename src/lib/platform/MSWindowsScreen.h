@@ -148,6 +148,10 @@ private:
   // convenience function to send events
 public: // HACK
   void sendEvent(EventTypes type, void * = nullptr);
+  template <InlineEventData T> void sendEvent(EventTypes type, const T &data)
+  {
+    m_events->addEvent(Event(type, getEventTarget(), data));
+  }
 
 private: // HACK
   void sendClipboardEvent(EventTypes type, ClipboardID id);
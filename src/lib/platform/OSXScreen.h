@@ -112,6 +112,10 @@ private:
 
   // convenience function to send events
   void sendEvent(EventTypes type, void * = nullptr) const;
+  template <InlineEventData T> void sendEvent(EventTypes type, const T &data) const
+  {
+    m_events->addEvent(Event(type, getEventTarget(), data));
+  }
   void sendClipboardEvent(EventTypes type, ClipboardID id) const;
 
   // message handlers
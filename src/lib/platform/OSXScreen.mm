@@ -930,7 +930,7 @@ bool OSXScreen::onMouseMove(CGFloat mx, CGFloat my)
 
   if (m_isOnScreen) {
     // motion on primary screen
-    sendEvent(EventTypes::PrimaryScreenMotionOnPrimary, MotionInfo::alloc(m_xCursor, m_yCursor));
+    sendEvent(EventTypes::PrimaryScreenMotionOnPrimary, MotionInfo{m_xCursor, m_yCursor});
   } else {
     // motion on secondary screen.  warp mouse back to
     // center.
@@ -961,7 +961,7 @@ bool OSXScreen::onMouseMove(CGFloat mx, CGFloat my)
       // And keep only the fractional part
       m_xFractionalMove -= intX;
       m_yFractionalMove -= intY;
-      sendEvent(EventTypes::PrimaryScreenMotionOnSecondary, MotionInfo::alloc(intX, intY));
+      sendEvent(EventTypes::PrimaryScreenMotionOnSecondary, MotionInfo{intX, intY});
     }
   }
 
@@ -977,13 +977,13 @@ bool OSXScreen::onMouseButton(bool pressed, uint16_t macButton)
     LOG_DEBUG1("event: button press button=%d", button);
     if (button != kButtonNone) {
       KeyModifierMask mask = m_keyState->getActiveModifiers();
-      sendEvent(EventTypes::PrimaryScreenButtonDown, ButtonInfo::alloc(button, mask));
+      sendEvent(EventTypes::PrimaryScreenButtonDown, ButtonInfo{button, mask});
     }
   } else {
     LOG_DEBUG1("event: button release button=%d", button);
     if (button != kButtonNone) {
       KeyModifierMask mask = m_keyState->getActiveModifiers();
-      sendEvent(EventTypes::PrimaryScreenButtonUp, ButtonInfo::alloc(button, mask));
+      sendEvent(EventTypes::PrimaryScreenButtonUp, ButtonInfo{button, mask});
     }
   }
 
@@ -993,7 +993,7 @@ bool OSXScreen::onMouseButton(bool pressed, uint16_t macButton)
 bool OSXScreen::onMouseWheel(int32_t xDelta, int32_t yDelta) const
 {
   LOG_DEBUG1("event: button wheel delta=%+d,%+d", xDelta, yDelta);
-  sendEvent(EventTypes::PrimaryScreenWheel, WheelInfo::alloc(xDelta, yDelta));
+  sendEvent(EventTypes::PrimaryScreenWheel, WheelInfo{xDelta, yDelta});
   return true;
 }
 
@@ -1043,7 +1043,7 @@ bool OSXScreen::onKey(CGEventRef event)
         m_activeModifierHotKey = m_modifierHotKeys[newMask];
         m_activeModifierHotKeyMask = newMask;
         m_events->addEvent(
-            Event(EventTypes::PrimaryScreenHotkeyDown, getEventTarget(), HotKeyInfo::alloc(m_activeModifierHotKey))
+            Event(EventTypes::PrimaryScreenHotkeyDown, getEventTarget(), HotKeyInfo{m_activeModifierHotKey})
         );
       }
     }
@@ -1054,7 +1054,7 @@ bool OSXScreen::onKey(CGEventRef event)
       KeyModifierMask mask = (newMask & m_activeModifierHotKeyMask);
       if (mask != m_activeModifierHotKeyMask) {
         m_events->addEvent(
-            Event(EventTypes::PrimaryScreenHotkeyUp, getEventTarget(), HotKeyInfo::alloc(m_activeModifierHotKey))
+            Event(EventTypes::PrimaryScreenHotkeyUp, getEventTarget(), HotKeyInfo{m_activeModifierHotKey})
         );
         m_activeModifierHotKey = 0;
         m_activeModifierHotKeyMask = 0;
@@ -1080,7 +1080,7 @@ bool OSXScreen::onKey(CGEventRef event)
       return false;
     }
 
-    m_events->addEvent(Event(type, getEventTarget(), HotKeyInfo::alloc(id)));
+    m_events->addEvent(Event(type, getEventTarget(), HotKeyInfo{id}));
 
     return true;
   }
@@ -1162,7 +1162,7 @@ bool OSXScreen::onHotKey(EventRef event) const
     return false;
   }
 
-  m_events->addEvent(Event(type, getEventTarget(), HotKeyInfo::alloc(id)));
+  m_events->addEvent(Event(type, getEventTarget(), HotKeyInfo{id}));
 
   return true;
 }
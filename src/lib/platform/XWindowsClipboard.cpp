@@ -83,6 +83,9 @@ void XWindowsClipboard::lost(Time time)
     m_owner = false;
     m_timeLost = time;
     clearCache();
+
+    // offered data that hasn't come won't be asked for now
+    resolveRequests();
   }
 }
 
@@ -141,19 +144,18 @@ bool XWindowsClipboard::addSimpleRequest(Window requestor, Atom target, ::Time t
   } else if (target == m_atomTimestamp) {
     type = getTimestampData(data, &format);
   } else {
+    type = getFormatData(target, data, &format);
+
+    // if the data's been offered but isn't here yet then reply when
+    // it is
     const IXWindowsClipboardConverter *converter = getConverter(target);
-    if (converter != nullptr) {
-      const auto clipboardFormat = static_cast<int>(converter->getFormat());
-      if (m_added[clipboardFormat]) {
-        try {
-          data = converter->fromIClipboard(m_data[clipboardFormat]);
-          format = converter->getDataSize();
-          type = converter->getAtom();
-        } catch (...) {
-          // ignore -- cannot convert
-          LOG_WARN("error while converting clipboard data");
-        }
-      }
+    if (type == None && converter != nullptr && m_offered[static_cast<int>(converter->getFormat())]) {
+      LOG_DEBUG1("clipboard request waiting for data");
+      auto *reply = new Reply(requestor, target, time, property, data, type, format);
+      reply->m_waiting = true;
+      insertReply(reply);
+      m_dataRequested = true;
+      return true;
     }
   }
 
@@ -215,6 +217,53 @@ bool XWindowsClipboard::destroyRequest(Window requestor)
   return true;
 }
 
+void XWindowsClipboard::offer(Format format)
+{
+  assert(m_open);
+  assert(m_owner);
+
+  LOG_DEBUG("offer clipboard %d format: %d", m_id, format);
+  m_offered[static_cast<int>(format)] = true;
+
+  // requests still waiting on an earlier offer wait on this one
+  for (const auto &[requestor, replies] : m_replies) {
+    if (std::ranges::any_of(replies, [](const Reply *reply) { return reply->m_waiting; })) {
+      m_dataRequested = true;
+    }
+  }
+}
+
+bool XWindowsClipboard::takeDataRequest()
+{
+  const bool requested = m_dataRequested;
+  m_dataRequested = false;
+  return requested;
+}
+
+void XWindowsClipboard::resolveRequests()
+{
+  bool resolved = false;
+  for (auto &[requestor, replies] : m_replies) {
+    for (auto *reply : replies) {
+      if (!reply->m_waiting) {
+        continue;
+      }
+      reply->m_waiting = false;
+      resolved = true;
+      reply->m_type = getFormatData(reply->m_target, reply->m_data, &reply->m_format);
+      if (reply->m_type == None) {
+        LOG_DEBUG1("clipboard request failed, data not added");
+        reply->m_property = None;
+      }
+    }
+  }
+  m_dataRequested = false;
+
+  if (resolved) {
+    pushReplies();
+  }
+}
+
 Window XWindowsClipboard::getWindow() const
 {
   return m_window;
@@ -376,6 +425,28 @@ IXWindowsClipboardConverter *XWindowsClipboard::getConverter(Atom target, bool o
   return converter;
 }
 
+Atom XWindowsClipboard::getFormatData(Atom target, std::string &data, int *format) const
+{
+  const IXWindowsClipboardConverter *converter = getConverter(target);
+  if (converter == nullptr) {
+    return None;
+  }
+  const auto clipboardFormat = static_cast<int>(converter->getFormat());
+  if (!m_added[clipboardFormat]) {
+    return None;
+  }
+
+  try {
+    data = converter->fromIClipboard(m_data[clipboardFormat]);
+    *format = converter->getDataSize();
+    return converter->getAtom();
+  } catch (...) {
+    // ignore -- cannot convert
+    LOG_WARN("error while converting clipboard data");
+    return None;
+  }
+}
+
 void XWindowsClipboard::checkCache() const
 {
   if (!m_checkCache) {
@@ -414,6 +485,7 @@ void XWindowsClipboard::doClearCache()
   for (int32_t index = 0; index < static_cast<int>(Format::TotalFormats); ++index) {
     m_data[index] = "";
     m_added[index] = false;
+    m_offered[index] = false;
   }
 }
 
@@ -889,6 +961,11 @@ bool XWindowsClipboard::sendReply(Reply *reply)
 {
   assert(reply != nullptr);
 
+  // nothing to send until the offered data is here
+  if (reply->m_waiting) {
+    return false;
+  }
+
   // bail out immediately if reply is done
   if (reply->m_done) {
     LOG((
@@ -1115,8 +1192,8 @@ Atom XWindowsClipboard::getTargetsData(std::string &data, int *format) const
   for (auto index = m_converters.begin(); index != m_converters.end(); ++index) {
     const IXWindowsClipboardConverter *converter = *index;
 
-    // skip formats we don't have
-    if (m_added[static_cast<int>(converter->getFormat())]) {
+    // skip formats we neither have nor have been offered
+    if (const auto formatID = static_cast<int>(converter->getFormat()); m_added[formatID] || m_offered[formatID]) {
       XWindowsUtil::appendAtomData(data, converter->getAtom());
     }
   }
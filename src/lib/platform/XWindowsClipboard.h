@@ -65,6 +65,27 @@ public:
   */
   bool destroyRequest(Window requestor);
 
+  //! Offer a format
+  /*!
+  Adds \p format to the open clipboard without its data, which is
+  added later.  Until then, requests for the format wait.
+  */
+  void offer(Format format);
+
+  //! Test if offered data was asked for
+  /*!
+  Returns true if a request has waited for offered data since this
+  was last called.
+  */
+  bool takeDataRequest();
+
+  //! Answer waiting requests
+  /*!
+  Sends the data asked for by requests waiting for offered data, or a
+  failure for those whose format hasn't been added.
+  */
+  void resolveRequests();
+
   //! Get window
   /*!
   Returns the clipboard's window (passed the c'tor).
@@ -100,6 +121,10 @@ private:
   // convert target atom to clipboard format
   Format getFormat(Atom target) const;
 
+  // convert the added data of the format for target.  returns the type
+  // of the converted data or None if it can't be converted.
+  Atom getFormatData(Atom target, std::string &data, int *format) const;
+
   // add a non-MULTIPLE request.  does not verify that the selection
   // was owned at the given time.  returns true if the conversion
   // could be performed, false otherwise.  in either case, the
@@ -239,6 +264,9 @@ protected:
     // true iff the reply has sent its last message
     bool m_done = false;
 
+    // true iff the reply is waiting for offered data
+    bool m_waiting = false;
+
     // the data to send and its type and format
     std::string m_data;
     Atom m_type;
@@ -302,6 +330,11 @@ private:
   bool m_added[static_cast<int>(IClipboard::Format::TotalFormats)];
   std::string m_data[static_cast<int>(IClipboard::Format::TotalFormats)];
 
+  // formats offered without their data, and whether a request has
+  // waited for it
+  bool m_offered[static_cast<int>(IClipboard::Format::TotalFormats)];
+  bool m_dataRequested = false;
+
   // conversion request replies
   ReplyMap m_replies;
   ReplyEventMask m_eventMasks;
@@ -7,14 +7,21 @@
 
 #include "platform/XWindowsEventQueueBuffer.h"
 
+#include "Config.h"
 #include "base/Event.h"
 #include "base/IEventQueue.h"
 #include "mt/Thread.h"
 
+#include <array>
+#include <cmath>
 #include <fcntl.h>
 #include <poll.h>
 #include <unistd.h>
 
+#if HAVE_SYS_EVENTFD_H
+#include <sys/eventfd.h>
+#endif
+
 //
 // EventQueueTimer
 //
@@ -27,103 +34,70 @@ class EventQueueTimer
 // XWindowsEventQueueBuffer
 //
 
-XWindowsEventQueueBuffer::XWindowsEventQueueBuffer(Display *display, Window window, IEventQueue *events)
+XWindowsEventQueueBuffer::XWindowsEventQueueBuffer(Display *display, IEventQueue *events)
     : m_display(display),
-      m_window(window),
       m_events(events)
 {
   assert(m_display != nullptr);
-  assert(m_window != None);
 
-  m_userEvent = XInternAtom(m_display, "DESKFLOW_USER_EVENT", False);
-  // set up for pipe hack
-  int result = pipe2(m_pipefd, O_NONBLOCK);
+#if HAVE_SYS_EVENTFD_H
+  m_wakeReadFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  m_wakeWriteFd = m_wakeReadFd;
+  assert(m_wakeReadFd >= 0);
+#else
+  int pipefd[2];
+  int result = pipe2(pipefd, O_NONBLOCK | O_CLOEXEC);
   assert(result == 0);
+  m_wakeReadFd = pipefd[0];
+  m_wakeWriteFd = pipefd[1];
+#endif
 }
 
 XWindowsEventQueueBuffer::~XWindowsEventQueueBuffer()
 {
-  // release pipe hack resources
-  close(m_pipefd[0]);
-  close(m_pipefd[1]);
-}
-
-int XWindowsEventQueueBuffer::getPendingCountLocked()
-{
-  std::scoped_lock lock{m_mutex};
-  return XPending(m_display);
+  close(m_wakeReadFd);
+  if (m_wakeWriteFd != m_wakeReadFd) {
+    close(m_wakeWriteFd);
+  }
 }
 
 void XWindowsEventQueueBuffer::waitForEvent(double dtimeout)
 {
   Thread::testCancel();
 
-  // clear out the pipe in preparation for waiting.
-
-  char buf[16];
-
-  // with linux automake, warnings are treated as errors by default
-  if (ssize_t read_response = read(m_pipefd[0], buf, 15); read_response < 0) {
-    // todo: handle read response
-  }
-
   {
     std::scoped_lock lock{m_mutex};
-    // we're now waiting for events
-    m_waiting = true;
+    if (!m_userEvents.empty()) {
+      return;
+    }
 
-    // push out pending events
-    flush();
-  }
-  // calling flush may have queued up a new event.
-  if (!XWindowsEventQueueBuffer::isEmpty()) {
-    Thread::testCancel();
-    return;
+    // from here on addEvent() signals us
+    m_waiting = true;
   }
 
-  // use poll() to wait for a message from the X server or for timeout.
-  // this is a good deal more efficient than polling and sleeping.
-  struct pollfd pfds[2];
-  pfds[0].fd = ConnectionNumber(m_display);
-  pfds[0].events = POLLIN;
-  pfds[1].fd = m_pipefd[0];
-  pfds[1].events = POLLIN;
-  int timeout = (dtimeout < 0.0) ? -1 : static_cast<int>(1000.0 * dtimeout);
-  int remaining = timeout;
-  int retval = 0;
-
-  // It's possible that the X server has queued events locally
-  // in xlib's event buffer and not pushed on to the fd. Hence we
-  // can't simply monitor the fd as we may never be woken up.
-  // ie addEvent calls flush, XFlush may not send via the fd hence
-  // there is an event waiting to be sent but we must exit the poll
-  // before it can.
-  // Instead we poll for a brief period of time (so if events
-  // queued locally in the xlib buffer can be processed)
-  // and continue doing this until timeout is reached.
-  // The human eye can notice 60hz (ansi) which is 16ms, however
-  // we want to give the cpu a chance s owe up this to 25ms
-  static const int s_timeoutDelay = 25;
-
-  while (((dtimeout < 0.0) || (remaining > 0)) && getPendingCountLocked() == 0 && retval == 0) {
-
-    retval = poll(pfds, 2, s_timeoutDelay); // 16ms = 60hz, but we make it > to
-                                            // play nicely with the cpu
-    if (pfds[1].revents & POLLIN) {
-      ssize_t read_response = read(m_pipefd[0], buf, 15);
-
-      // with linux automake, warnings are treated as errors by default
-      if (read_response < 0) {
-        // todo: handle read response
-      }
-    }
-    remaining -= s_timeoutDelay;
+  // flush our requests and read whatever the server has already sent.
+  // once that finds nothing, every event still to come has to arrive
+  // on the connection, so blocking on it can't miss one that is
+  // sitting in xlib's queue.
+  if (XEventsQueued(m_display, QueuedAfterFlush) == 0) {
+    std::array<pollfd, 2> pfds{};
+    pfds[0].fd = ConnectionNumber(m_display);
+    pfds[0].events = POLLIN;
+    pfds[1].fd = m_wakeReadFd;
+    pfds[1].events = POLLIN;
+    const int timeout = (dtimeout < 0.0) ? -1 : static_cast<int>(std::ceil(1000.0 * dtimeout));
+    poll(pfds.data(), pfds.size(), timeout);
   }
 
+  bool woken;
   {
-    // we're no longer waiting for events
     std::scoped_lock lock{m_mutex};
     m_waiting = false;
+    woken = m_woken;
+    m_woken = false;
+  }
+  if (woken) {
+    drainWakeup();
   }
 
   Thread::testCancel();
@@ -131,53 +105,45 @@ void XWindowsEventQueueBuffer::waitForEvent(double dtimeout)
 
 IEventQueueBuffer::Type XWindowsEventQueueBuffer::getEvent(Event &event, uint32_t &dataID)
 {
-  std::scoped_lock lock{m_mutex};
+  // take turns between user and x events so neither can starve the
+  // other.  only xlib's own queue is checked here, which costs nothing.
+  {
+    std::scoped_lock lock{m_mutex};
+    if (!m_userEvents.empty() && (m_userEventFirst || XQLength(m_display) == 0)) {
+      dataID = m_userEvents.front();
+      m_userEvents.pop_front();
+      m_userEventFirst = false;
+      return IEventQueueBuffer::Type::User;
+    }
+    m_userEventFirst = true;
+  }
 
-  // push out pending events
-  flush();
+  if (XPending(m_display) == 0) {
+    return IEventQueueBuffer::Type::Unknown;
+  }
 
-  // get next event
   XNextEvent(m_display, &m_event);
-
-  // process event
-  if (m_event.xany.type == ClientMessage && m_event.xclient.message_type == m_userEvent) {
-    dataID = static_cast<uint32_t>(m_event.xclient.data.l[0]);
-    return IEventQueueBuffer::Type::User;
-  } else {
-    event = Event(EventTypes::System, m_events->getSystemTarget(), &m_event);
-    return IEventQueueBuffer::Type::System;
-  }
+  event = Event(EventTypes::System, m_events->getSystemTarget(), &m_event);
+  return IEventQueueBuffer::Type::System;
 }
 
 bool XWindowsEventQueueBuffer::addEvent(uint32_t dataID)
 {
-  // prepare a message
-  XEvent xevent;
-  xevent.xclient.type = ClientMessage;
-  xevent.xclient.window = m_window;
-  xevent.xclient.message_type = m_userEvent;
-  xevent.xclient.format = 32;
-  xevent.xclient.data.l[0] = static_cast<long>(dataID);
-
-  // save the message
   std::scoped_lock lock{m_mutex};
-  m_postedEvents.push_back(xevent);
-
-  // if we're currently waiting for an event then send saved events to
-  // the X server now.  if we're not waiting then some other thread
-  // might be using the display connection so we can't safely use it
-  // too.
-  if (m_waiting) {
-    flush();
-    // Send a character through the round-trip pipe to wake a thread
-    // that is waiting for a ConnectionNumber() socket to be readable.
-    // The flush call can read incoming data from the socket and put
-    // it in Xlib's input buffer.  That sneaks it past the other thread.
-    ssize_t write_response = write(m_pipefd[1], "!", 1);
+  m_userEvents.push_back(dataID);
+
+  // only a reader that may be blocked needs waking, and only once
+  if (m_waiting && !m_woken) {
+    m_woken = true;
+#if HAVE_SYS_EVENTFD_H
+    const uint64_t value = 1;
+#else
+    const char value = '!';
+#endif
 
     // with linux automake, warnings are treated as errors by default
-    if (write_response < 0) {
-      // todo: handle read response
+    if (ssize_t write_response = write(m_wakeWriteFd, &value, sizeof(value)); write_response < 0) {
+      // todo: handle write response
     }
   }
 
@@ -186,7 +152,12 @@ bool XWindowsEventQueueBuffer::addEvent(uint32_t dataID)
 
 bool XWindowsEventQueueBuffer::isEmpty() const
 {
-  std::scoped_lock lock{m_mutex};
+  {
+    std::scoped_lock lock{m_mutex};
+    if (!m_userEvents.empty()) {
+      return false;
+    }
+  }
   return (XPending(m_display) == 0);
 }
 
@@ -200,14 +171,11 @@ void XWindowsEventQueueBuffer::deleteTimer(EventQueueTimer *timer) const
   delete timer;
 }
 
-void XWindowsEventQueueBuffer::flush()
+void XWindowsEventQueueBuffer::drainWakeup() const
 {
-  // note -- m_mutex must be locked on entry
-
-  // flush the posted event list to the X server
-  for (auto &event : m_postedEvents) {
-    XSendEvent(m_display, m_window, False, 0, &event);
+  // an eventfd is reset by a single read, a pipe may hold several bytes
+  std::array<char, 16> buffer;
+  while (read(m_wakeReadFd, buffer.data(), buffer.size()) > 0) {
+    // keep reading
   }
-  XFlush(m_display);
-  m_postedEvents.clear();
 }
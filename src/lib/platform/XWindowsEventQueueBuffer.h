@@ -9,18 +9,25 @@
 
 #include "base/IEventQueueBuffer.h"
 
+#include <deque>
 #include <mutex>
-#include <vector>
 
 #include <X11/Xlib.h>
 
 class IEventQueue;
 
 //! Event queue buffer for X11
+/*!
+User events are kept here rather than sent through the X server.  The
+reader blocks on the X connection and a wake-up descriptor that other
+threads signal when they add a user event, so it neither polls nor
+leaves events sitting in Xlib's queue.  Only the reader thread uses the
+display.
+*/
 class XWindowsEventQueueBuffer : public IEventQueueBuffer
 {
 public:
-  XWindowsEventQueueBuffer(Display *, Window, IEventQueue *events);
+  XWindowsEventQueueBuffer(Display *, IEventQueue *events);
   XWindowsEventQueueBuffer(XWindowsEventQueueBuffer const &) = delete;
   XWindowsEventQueueBuffer(XWindowsEventQueueBuffer &&) = delete;
   ~XWindowsEventQueueBuffer() override;
@@ -41,20 +48,21 @@ public:
   void deleteTimer(EventQueueTimer *) const override;
 
 private:
-  void flush();
-
-  int getPendingCountLocked();
+  void drainWakeup() const;
 
 private:
-  using EventList = std::vector<XEvent>;
-
   mutable std::mutex m_mutex;
   Display *m_display;
-  Window m_window;
-  Atom m_userEvent;
   XEvent m_event;
-  EventList m_postedEvents;
+  std::deque<uint32_t> m_userEvents;
+  bool m_userEventFirst = true;
+
+  // wake-up descriptors.  the same eventfd on both ends where there is
+  // one, otherwise the two ends of a pipe.  m_waiting says the reader
+  // may be blocked and m_woken that it has been signalled since.
+  int m_wakeReadFd = -1;
+  int m_wakeWriteFd = -1;
   bool m_waiting = false;
-  int m_pipefd[2];
+  bool m_woken = false;
   IEventQueue *m_events;
 };
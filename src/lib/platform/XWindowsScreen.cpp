@@ -156,7 +156,7 @@ XWindowsScreen::XWindowsScreen(
   });
 
   // install the platform event queue
-  m_events->adoptBuffer(new XWindowsEventQueueBuffer(m_display, m_window, m_events));
+  m_events->adoptBuffer(new XWindowsEventQueueBuffer(m_display, m_events));
 }
 
 XWindowsScreen::~XWindowsScreen()
@@ -352,9 +352,10 @@ bool XWindowsScreen::setClipboard(ClipboardID id, const IClipboard *clipboard)
   // get the actual time.  ICCCM does not allow CurrentTime.
   Time timestamp = XWindowsUtil::getCurrentTime(m_display, m_clipboard[id]->getWindow());
 
+  bool result = true;
   if (clipboard != nullptr) {
     // save clipboard data
-    return Clipboard::copy(m_clipboard[id], clipboard, timestamp);
+    result = Clipboard::copy(m_clipboard[id], clipboard, timestamp);
   } else {
     // assert clipboard ownership
     if (!m_clipboard[id]->open(timestamp)) {
@@ -362,8 +363,38 @@ bool XWindowsScreen::setClipboard(ClipboardID id, const IClipboard *clipboard)
     }
     m_clipboard[id]->empty();
     m_clipboard[id]->close();
-    return true;
   }
+
+  // answer anything that was waiting for offered data
+  m_clipboard[id]->resolveRequests();
+  return result;
+}
+
+bool XWindowsScreen::offerClipboard(ClipboardID id, const std::vector<IClipboard::Format> &formats)
+{
+  // fail if we don't have the requested clipboard
+  if (m_clipboard[id] == nullptr) {
+    return false;
+  }
+
+  // take ownership with the formats and wait for the data until it's
+  // asked for
+  Time timestamp = XWindowsUtil::getCurrentTime(m_display, m_clipboard[id]->getWindow());
+  if (!m_clipboard[id]->open(timestamp)) {
+    return false;
+  }
+  const bool owned = m_clipboard[id]->empty();
+  if (owned) {
+    for (const auto format : formats) {
+      m_clipboard[id]->offer(format);
+    }
+  }
+  m_clipboard[id]->close();
+
+  if (owned && m_clipboard[id]->takeDataRequest()) {
+    sendClipboardEvent(EventTypes::ClipboardRequested, id);
+  }
+  return owned;
 }
 
 void XWindowsScreen::checkClipboards()
@@ -1276,6 +1307,9 @@ void XWindowsScreen::handleSystemEvent(const Event &event)
           xevent->xselectionrequest.owner, xevent->xselectionrequest.requestor, xevent->xselectionrequest.target,
           xevent->xselectionrequest.time, xevent->xselectionrequest.property
       );
+      if (m_clipboard[id]->takeDataRequest()) {
+        sendClipboardEvent(EventTypes::ClipboardRequested, id);
+      }
       return;
     }
   } break;
@@ -1472,7 +1506,7 @@ bool XWindowsScreen::onHotKey(const XKeyEvent &xkey, bool isRepeat)
 
   // generate event (ignore key repeats)
   if (!isRepeat) {
-    m_events->addEvent(Event(type, getEventTarget(), HotKeyInfo::alloc(i->second)));
+    m_events->addEvent(Event(type, getEventTarget(), HotKeyInfo{i->second}));
   }
   return true;
 }
@@ -1483,7 +1517,7 @@ void XWindowsScreen::onMousePress(const XButtonEvent &xbutton)
   ButtonID button = mapButtonFromX(&xbutton);
   KeyModifierMask mask = m_keyState->mapModifiersFromX(xbutton.state);
   if (button != kButtonNone) {
-    sendEvent(EventTypes::PrimaryScreenButtonDown, ButtonInfo::alloc(button, mask));
+    sendEvent(EventTypes::PrimaryScreenButtonDown, ButtonInfo{button, mask});
   }
 }
 
@@ -1494,13 +1528,13 @@ void XWindowsScreen::onMouseRelease(const XButtonEvent &xbutton)
   ButtonID button = mapButtonFromX(&xbutton);
   KeyModifierMask mask = m_keyState->mapModifiersFromX(xbutton.state);
   if (button != kButtonNone) {
-    sendEvent(PrimaryScreenButtonUp, ButtonInfo::alloc(button, mask));
+    sendEvent(PrimaryScreenButtonUp, ButtonInfo{button, mask});
   } else if (xbutton.button == 4) {
     // wheel forward (away from user)
-    sendEvent(PrimaryScreenWheel, WheelInfo::alloc(0, 120));
+    sendEvent(PrimaryScreenWheel, WheelInfo{0, 120});
   } else if (xbutton.button == 5) {
     // wheel backward (toward user)
-    sendEvent(PrimaryScreenWheel, WheelInfo::alloc(0, -120));
+    sendEvent(PrimaryScreenWheel, WheelInfo{0, -120});
   }
   // XXX -- support x-axis scrolling
 }
@@ -1536,7 +1570,7 @@ void XWindowsScreen::onMouseMove(const XMotionEvent &xmotion)
     cntr = 0;
   } else if (m_isOnScreen) {
     // motion on primary screen
-    sendEvent(EventTypes::PrimaryScreenMotionOnPrimary, MotionInfo::alloc(m_xCursor, m_yCursor));
+    sendEvent(EventTypes::PrimaryScreenMotionOnPrimary, MotionInfo{m_xCursor, m_yCursor});
   } else {
     // motion on secondary screen.  warp mouse back to
     // center.
@@ -1563,7 +1597,7 @@ void XWindowsScreen::onMouseMove(const XMotionEvent &xmotion)
     // warping to the primary screen's enter position,
     // effectively overriding it.
     if (x != 0 || y != 0) {
-      sendEvent(EventTypes::PrimaryScreenMotionOnSecondary, MotionInfo::alloc(x, y));
+      sendEvent(EventTypes::PrimaryScreenMotionOnSecondary, MotionInfo{x, y});
     }
   }
 }
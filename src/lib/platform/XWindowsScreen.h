@@ -71,6 +71,7 @@ public:
   bool canLeave() override;
   void leave() override;
   bool setClipboard(ClipboardID, const IClipboard *) override;
+  bool offerClipboard(ClipboardID, const std::vector<IClipboard::Format> &formats) override;
   void checkClipboards() override;
   void openScreensaver(bool notify) override;
   void closeScreensaver() override;
@@ -90,6 +91,10 @@ protected:
 private:
   // event sending
   void sendEvent(EventTypes, void * = nullptr);
+  template <InlineEventData T> void sendEvent(EventTypes type, const T &data)
+  {
+    m_events->addEvent(Event(type, getEventTarget(), data));
+  }
   void sendClipboardEvent(EventTypes, ClipboardID);
 
   // create the transparent cursor
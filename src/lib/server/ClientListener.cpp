@@ -13,11 +13,13 @@
 #include "base/Log.h"
 #include "deskflow/PacketStreamFilter.h"
 #include "net/IDataSocket.h"
+#include "net/IDatagramSocket.h"
 #include "net/IListenSocket.h"
 #include "net/ISocketFactory.h"
 #include "net/SocketException.h"
 #include "server/ClientProxy.h"
 #include "server/ClientProxyUnknown.h"
+#include "server/FastChannelListener.h"
 
 //
 // ClientListener
@@ -25,11 +27,12 @@
 
 ClientListener::ClientListener(
     const NetworkAddress &address, std::unique_ptr<ISocketFactory> socketFactory, IEventQueue *events,
-    SecurityLevel securityLevel
+    SecurityLevel securityLevel, bool fastChannels
 )
     : m_socketFactory{std::move(socketFactory)},
       m_events(events),
       m_securityLevel(securityLevel),
+      m_fastChannelsEnabled(fastChannels),
       m_address(address)
 {
   assert(m_socketFactory != nullptr);
@@ -83,6 +86,30 @@ void ClientListener::start()
   // bind listen address
   LOG_DEBUG1("binding listen socket");
   m_listen->bind(m_address);
+
+  if (m_fastChannelsEnabled) {
+    startFastChannels();
+  }
+}
+
+void ClientListener::startFastChannels()
+{
+  // datagrams would go in the clear beside an encrypted connection
+  if (m_securityLevel != SecurityLevel::PlainText) {
+    LOG_INFO("not offering fast channels, they can't be encrypted");
+    return;
+  }
+
+  // the fast channels share a UDP socket on the same port.  clients just
+  // aren't offered them if it can't be had.
+  try {
+    const auto family = ARCH->getAddrFamily(m_address.getAddress());
+    std::unique_ptr<IDatagramSocket> socket(m_socketFactory->createDatagram(family));
+    socket->bind(m_address);
+    m_fastChannels = std::make_unique<FastChannelListener>(socket.release(), m_events);
+  } catch (BaseException &e) {
+    LOG_WARN("cannot listen for fast channels: %s", e.what());
+  }
 }
 
 void ClientListener::stop()
@@ -107,6 +134,7 @@ void ClientListener::stop()
   }
 
   m_events->removeHandler(ListenSocketConnecting, m_listen);
+  m_fastChannels.reset();
   cleanupListenSocket();
   cleanupClientSockets();
 }
@@ -153,7 +181,8 @@ void ClientListener::handleClientAccepted(IDataSocket *socket)
   assert(m_server != nullptr);
 
   // create proxy for unknown client
-  auto *client = new ClientProxyUnknown(stream, 30.0, m_server, m_events);
+  auto *client =
+      new ClientProxyUnknown(stream, 30.0, m_server, m_events, m_fastChannels.get(), socket->getPeerAddress());
 
   m_newClients.insert(client);
 
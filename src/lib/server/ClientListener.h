@@ -19,6 +19,7 @@
 
 class ClientProxy;
 class ClientProxyUnknown;
+class FastChannelListener;
 class NetworkAddress;
 class IListenSocket;
 class ISocketFactory;
@@ -32,7 +33,7 @@ public:
   // The factories are adopted.
   ClientListener(
       const NetworkAddress &, std::unique_ptr<ISocketFactory> socketFactory, IEventQueue *events,
-      SecurityLevel securityLevel
+      SecurityLevel securityLevel, bool fastChannels
   );
   ClientListener(ClientListener const &) = delete;
   ClientListener(ClientListener &&) = delete;
@@ -73,6 +74,7 @@ private:
   void handleUnknownClient(ClientProxyUnknown *unknownClient);
   void handleClientDisconnected(ClientProxy *client);
 
+  void startFastChannels();
   void cleanupListenSocket();
   void cleanupClientSockets();
   void start();
@@ -85,12 +87,14 @@ private:
   using ClientSockets = std::set<IDataSocket *>;
 
   IListenSocket *m_listen;
+  std::unique_ptr<FastChannelListener> m_fastChannels;
   std::unique_ptr<ISocketFactory> m_socketFactory;
   NewClients m_newClients;
   WaitingClients m_waitingClients;
   Server *m_server = nullptr;
   IEventQueue *m_events;
   SecurityLevel m_securityLevel;
+  bool m_fastChannelsEnabled;
   ClientSockets m_clientSockets;
   NetworkAddress m_address;
 };
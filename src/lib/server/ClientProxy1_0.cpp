@@ -11,10 +11,16 @@
 #include "base/IEventQueue.h"
 #include "base/Log.h"
 #include "deskflow/DeskflowException.h"
+#include "deskflow/ProtocolMessages.h"
 #include "deskflow/ProtocolUtil.h"
 #include "io/IStream.h"
 
+#include <array>
 #include <cstring>
+#include <span>
+#include <utility>
+
+static const uint32_t s_packetBurst = 64;
 
 //
 // ClientProxy1_0
@@ -42,6 +48,12 @@ ClientProxy1_0::ClientProxy1_0(const std::string &name, deskflow::IStream *strea
 
   setHeartbeatRate(kHeartRate, kHeartRate * kHeartBeatsUntilDeath);
 
+  // messages the client may send once it's connected
+  setMessageHandler<MsgDInfo>(&ClientProxy1_0::recvInfoChange);
+  setMessageHandler<MsgCNoop>(&ClientProxy1_0::recvNoop);
+  setMessageHandler<MsgCClipboard>(&ClientProxy1_0::recvGrabClipboard);
+  setMessageHandler<MsgDClipboard>(&ClientProxy1_0::recvClipboard);
+
   LOG_DEBUG1("querying client \"%s\" info", getName().c_str());
   ProtocolUtil::writef(getStream(), kMsgQInfo);
 }
@@ -90,9 +102,15 @@ void ClientProxy1_0::removeHeartbeatTimer()
 
 void ClientProxy1_0::resetHeartbeatTimer()
 {
-  // reset the alarm
-  removeHeartbeatTimer();
-  addHeartbeatTimer();
+  // reset the alarm.  this runs for every batch of incoming data so
+  // rearm the existing timer rather than recreating it.  only the
+  // alarm is touched here, subclasses may keep other timers.
+  if (m_heartbeatTimer != nullptr && m_heartbeatAlarm > 0.0) {
+    m_events->resetTimer(m_heartbeatTimer, m_heartbeatAlarm);
+  } else {
+    ClientProxy1_0::removeHeartbeatTimer();
+    ClientProxy1_0::addHeartbeatTimer();
+  }
 }
 
 void ClientProxy1_0::resetHeartbeatRate()
@@ -107,7 +125,9 @@ void ClientProxy1_0::setHeartbeatRate(double, double alarm)
 
 void ClientProxy1_0::handleData()
 {
-  // handle messages until there are no more.  first read message code.
+  // handle messages until there are no more.  first handle what can be
+  // in place then read message code.
+  handlePackets();
   uint8_t code[4];
   uint32_t n = getStream()->read(code, 4);
   while (n != 0) {
@@ -138,6 +158,7 @@ void ClientProxy1_0::handleData()
     }
 
     // next message
+    handlePackets();
     n = getStream()->read(code, 4);
   }
 
@@ -145,6 +166,33 @@ void ClientProxy1_0::handleData()
   resetHeartbeatTimer();
 }
 
+void ClientProxy1_0::handlePackets()
+{
+  if (m_parser != &ClientProxy1_0::parseMessage) {
+    return;
+  }
+
+  // no-ops and keep alives have no fields to read so they're handled
+  // where they are in the stream's buffer, a burst of whole messages at a
+  // time, up to the first message that has fields
+  std::array<std::span<const uint8_t>, s_packetBurst> packets;
+  uint32_t handled = 0;
+  do {
+    const uint32_t count = getStream()->peekPackets(packets);
+    for (handled = 0; handled < count; ++handled) {
+      const auto *code = packets[handled].data();
+      if (packets[handled].size() != 4 || !(MsgCNoop::isCode(code) || MsgCKeepAlive::isCode(code))) {
+        break;
+      }
+      LOG_DEBUG2("msg from \"%s\": %c%c%c%c", getName().c_str(), code[0], code[1], code[2], code[3]);
+      if (!parseMessage(code)) {
+        LOG_ERR("invalid message from client \"%s\": %c%c%c%c", getName().c_str(), code[0], code[1], code[2], code[3]);
+      }
+    }
+    getStream()->popPackets(handled);
+  } while (handled == packets.size());
+}
+
 bool ClientProxy1_0::parseHandshakeMessage(const uint8_t *code)
 {
   if (memcmp(code, kMsgCNoop, 4) == 0) {
@@ -165,20 +213,9 @@ bool ClientProxy1_0::parseHandshakeMessage(const uint8_t *code)
 
 bool ClientProxy1_0::parseMessage(const uint8_t *code)
 {
-  if (memcmp(code, kMsgDInfo, 4) == 0) {
-    if (recvInfo()) {
-      m_events->addEvent(Event(EventTypes::ScreenShapeChanged, getEventTarget()));
-      return true;
-    }
-    return false;
-  } else if (memcmp(code, kMsgCNoop, 4) == 0) {
-    // discard no-ops
-    LOG_DEBUG2("no-op from", getName().c_str());
-    return true;
-  } else if (memcmp(code, kMsgCClipboard, 4) == 0) {
-    return recvGrabClipboard();
-  } else if (memcmp(code, kMsgDClipboard, 4) == 0) {
-    return recvClipboard();
+  // the same single lookup whatever the protocol version
+  if (const auto handler = m_handlers.find(code); handler != nullptr) {
+    return (this->*handler)();
   }
   return false;
 }
@@ -260,37 +297,37 @@ void ClientProxy1_0::setClipboardDirty(ClipboardID id, bool dirty)
 void ClientProxy1_0::keyDown(KeyID key, KeyModifierMask mask, KeyButton, const std::string &)
 {
   LOG_DEBUG1("send key down to \"%s\" id=%d, mask=0x%04x", getName().c_str(), key, mask);
-  ProtocolUtil::writef(getStream(), kMsgDKeyDown1_0, key, mask);
+  MsgDKeyDown1_0::write(getStream(), key, mask);
 }
 
 void ClientProxy1_0::keyRepeat(KeyID key, KeyModifierMask mask, int32_t count, KeyButton, const std::string &)
 {
   LOG_DEBUG1("send key repeat to \"%s\" id=%d, mask=0x%04x, count=%d", getName().c_str(), key, mask, count);
-  ProtocolUtil::writef(getStream(), kMsgDKeyRepeat1_0, key, mask, count);
+  MsgDKeyRepeat1_0::write(getStream(), key, mask, count);
 }
 
 void ClientProxy1_0::keyUp(KeyID key, KeyModifierMask mask, KeyButton)
 {
   LOG_DEBUG1("send key up to \"%s\" id=%d, mask=0x%04x", getName().c_str(), key, mask);
-  ProtocolUtil::writef(getStream(), kMsgDKeyUp1_0, key, mask);
+  MsgDKeyUp1_0::write(getStream(), key, mask);
 }
 
 void ClientProxy1_0::mouseDown(ButtonID button)
 {
   LOG_DEBUG1("send mouse down to \"%s\" id=%d", getName().c_str(), button);
-  ProtocolUtil::writef(getStream(), kMsgDMouseDown, button);
+  MsgDMouseDown::write(getStream(), button);
 }
 
 void ClientProxy1_0::mouseUp(ButtonID button)
 {
   LOG_DEBUG1("send mouse up to \"%s\" id=%d", getName().c_str(), button);
-  ProtocolUtil::writef(getStream(), kMsgDMouseUp, button);
+  MsgDMouseUp::write(getStream(), button);
 }
 
 void ClientProxy1_0::mouseMove(int32_t xAbs, int32_t yAbs)
 {
   LOG_DEBUG2("send mouse move to \"%s\" %d,%d", getName().c_str(), xAbs, yAbs);
-  ProtocolUtil::writef(getStream(), kMsgDMouseMove, xAbs, yAbs);
+  writeMotion(false, xAbs, yAbs);
 }
 
 void ClientProxy1_0::mouseRelativeMove(int32_t, int32_t)
@@ -302,7 +339,7 @@ void ClientProxy1_0::mouseWheel(int32_t, int32_t yDelta)
 {
   // clients prior to 1.3 only support the y axis
   LOG_DEBUG2("send mouse wheel to \"%s\" %+d", getName().c_str(), yDelta);
-  ProtocolUtil::writef(getStream(), kMsgDMouseWheel1_0, yDelta);
+  MsgDMouseWheel1_0::write(getStream(), yDelta);
 }
 
 void ClientProxy1_0::sendDragInfo(uint32_t fileCount, const char *info, size_t size)
@@ -404,12 +441,60 @@ bool ClientProxy1_0::recvInfo()
   return true;
 }
 
+bool ClientProxy1_0::recvInfoChange()
+{
+  if (recvInfo()) {
+    m_events->addEvent(Event(EventTypes::ScreenShapeChanged, getEventTarget()));
+    return true;
+  }
+  return false;
+}
+
+bool ClientProxy1_0::recvNoop()
+{
+  // discard no-ops
+  LOG_DEBUG2("no-op from", getName().c_str());
+  return true;
+}
+
 bool ClientProxy1_0::recvClipboard()
 {
   // deprecated in protocol 1.0
   return false;
 }
 
+void ClientProxy1_0::writeMotion(bool relative, int32_t x, int32_t y)
+{
+  auto encode = [relative](int32_t x, int32_t y) {
+    return relative ? MsgDMouseRelMove::encode(x, y) : MsgDMouseMove::encode(x, y);
+  };
+
+  // a client that can't keep up only needs to see where the mouse is
+  // now, so rather than queueing another message behind one that hasn't
+  // gone yet, overwrite it.  it's only replaced if nothing was written
+  // after it, so messages are never reordered.
+  if (m_motionSent && m_motionRelative == relative) {
+    const int32_t xNew = relative ? m_xMotion + x : x;
+    const int32_t yNew = relative ? m_yMotion + y : y;
+    if (std::in_range<int16_t>(xNew) && std::in_range<int16_t>(yNew)) {
+      const auto message = encode(xNew, yNew);
+      if (getStream()->replaceLatest(message.data(), static_cast<uint32_t>(message.size()))) {
+        LOG_DEBUG2("replaced queued mouse motion to \"%s\"", getName().c_str());
+        m_xMotion = xNew;
+        m_yMotion = yNew;
+        return;
+      }
+    }
+  }
+
+  const auto message = encode(x, y);
+  getStream()->writeLatest(message.data(), static_cast<uint32_t>(message.size()));
+  m_motionSent = true;
+  m_motionRelative = relative;
+  m_xMotion = x;
+  m_yMotion = y;
+}
+
 bool ClientProxy1_0::recvGrabClipboard()
 {
   // parse message
@@ -9,6 +9,7 @@
 #pragma once
 
 #include "deskflow/Clipboard.h"
+#include "deskflow/MessageTable.h"
 #include "deskflow/ProtocolTypes.h"
 #include "server/ClientProxy.h"
 
@@ -56,8 +57,20 @@ public:
   void secureInputNotification(const std::string &app) const override;
 
 protected:
+  using MessageHandler = bool (ClientProxy1_0::*)();
+
   virtual bool parseHandshakeMessage(const uint8_t *code);
-  virtual bool parseMessage(const uint8_t *code);
+  bool parseMessage(const uint8_t *code);
+
+  //! Set a message handler
+  /*!
+  Makes \p handler handle messages with the code of \p Msg, replacing the
+  handler an older protocol version set for it.
+  */
+  template <typename Msg, typename Proxy> void setMessageHandler(bool (Proxy::*handler)())
+  {
+    m_handlers.set(Msg::kKey, static_cast<MessageHandler>(handler));
+  }
 
   virtual void resetHeartbeatRate();
   virtual void setHeartbeatRate(double rate, double alarm);
@@ -66,16 +79,28 @@ protected:
   virtual void removeHeartbeatTimer();
   virtual bool recvClipboard();
 
+  //! Send a mouse motion message
+  /*!
+  Sends a \c kMsgDMouseMove message, or \c kMsgDMouseRelMove if \p relative.
+  If the last motion message sent is of the same kind and still waiting
+  to be sent, it's overwritten instead:  with the new position, or with
+  the sum of both relative moves.
+  */
+  void writeMotion(bool relative, int32_t x, int32_t y);
+
 private:
   void disconnect();
   void removeHandlers();
 
   void handleData();
+  void handlePackets();
   void handleDisconnect();
   void handleWriteError();
   void handleFlatline();
 
   bool recvInfo();
+  bool recvInfoChange();
+  bool recvNoop();
   bool recvGrabClipboard();
 
 protected:
@@ -99,5 +124,12 @@ private:
   double m_heartbeatAlarm;
   EventQueueTimer *m_heartbeatTimer = nullptr;
   MessageParser m_parser = &ClientProxy1_0::parseHandshakeMessage;
+  MessageTable<MessageHandler> m_handlers;
   IEventQueue *m_events;
+
+  // the last motion message sent, while it may still be replaced
+  bool m_motionSent = false;
+  bool m_motionRelative = false;
+  int32_t m_xMotion = 0;
+  int32_t m_yMotion = 0;
 };
@@ -9,7 +9,7 @@
 #include "deskflow/AppUtil.h"
 
 #include "base/Log.h"
-#include "deskflow/ProtocolUtil.h"
+#include "deskflow/ProtocolMessages.h"
 
 #include <cstring>
 
@@ -26,7 +26,7 @@ ClientProxy1_1::ClientProxy1_1(const std::string &name, deskflow::IStream *strea
 void ClientProxy1_1::keyDown(KeyID key, KeyModifierMask mask, KeyButton button, const std::string &)
 {
   LOG_DEBUG1("send key down to \"%s\" id=%d, mask=0x%04x, button=0x%04x", getName().c_str(), key, mask, button);
-  ProtocolUtil::writef(getStream(), kMsgDKeyDown, key, mask, button);
+  MsgDKeyDown::write(getStream(), key, mask, button);
 }
 
 void ClientProxy1_1::keyRepeat(
@@ -38,11 +38,11 @@ void ClientProxy1_1::keyRepeat(
                    "button=0x%04x, lang=\"%s\"",
        getName().c_str(), key, mask, count, button, lang.c_str())
   );
-  ProtocolUtil::writef(getStream(), kMsgDKeyRepeat, key, mask, count, button, &lang);
+  MsgDKeyRepeat::write(getStream(), key, mask, count, button, lang);
 }
 
 void ClientProxy1_1::keyUp(KeyID key, KeyModifierMask mask, KeyButton button)
 {
   LOG_DEBUG1("send key up to \"%s\" id=%d, mask=0x%04x, button=0x%04x", getName().c_str(), key, mask, button);
-  ProtocolUtil::writef(getStream(), kMsgDKeyUp, key, mask, button);
+  MsgDKeyUp::write(getStream(), key, mask, button);
 }
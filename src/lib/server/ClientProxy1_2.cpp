@@ -8,7 +8,6 @@
 #include "server/ClientProxy1_2.h"
 
 #include "base/Log.h"
-#include "deskflow/ProtocolUtil.h"
 
 //
 // ClientProxy1_1
@@ -23,5 +22,5 @@ ClientProxy1_2::ClientProxy1_2(const std::string &name, deskflow::IStream *strea
 void ClientProxy1_2::mouseRelativeMove(int32_t xRel, int32_t yRel)
 {
   LOG_DEBUG2("send mouse relative move to \"%s\" %d,%d", getName().c_str(), xRel, yRel);
-  ProtocolUtil::writef(getStream(), kMsgDMouseRelMove, xRel, yRel);
+  writeMotion(true, xRel, yRel);
 }
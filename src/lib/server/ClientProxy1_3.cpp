@@ -10,7 +10,7 @@
 
 #include "base/IEventQueue.h"
 #include "base/Log.h"
-#include "deskflow/ProtocolUtil.h"
+#include "deskflow/ProtocolMessages.h"
 
 #include <cstring>
 #include <memory>
@@ -24,6 +24,7 @@ ClientProxy1_3::ClientProxy1_3(const std::string &name, deskflow::IStream *strea
       m_events(events)
 {
   setHeartbeatRate(kKeepAliveRate, kKeepAliveRate * kKeepAlivesUntilDeath);
+  setMessageHandler<MsgCKeepAlive>(&ClientProxy1_3::recvKeepAlive);
 }
 
 ClientProxy1_3::~ClientProxy1_3()
@@ -35,19 +36,14 @@ ClientProxy1_3::~ClientProxy1_3()
 void ClientProxy1_3::mouseWheel(int32_t xDelta, int32_t yDelta)
 {
   LOG_DEBUG2("send mouse wheel to \"%s\" %+d,%+d", getName().c_str(), xDelta, yDelta);
-  ProtocolUtil::writef(getStream(), kMsgDMouseWheel, xDelta, yDelta);
+  MsgDMouseWheel::write(getStream(), xDelta, yDelta);
 }
 
-bool ClientProxy1_3::parseMessage(const uint8_t *code)
+bool ClientProxy1_3::recvKeepAlive()
 {
-  // process message
-  if (memcmp(code, kMsgCKeepAlive, 4) == 0) {
-    // reset alarm
-    resetHeartbeatTimer();
-    return true;
-  } else {
-    return ClientProxy1_2::parseMessage(code);
-  }
+  // reset alarm
+  resetHeartbeatTimer();
+  return true;
 }
 
 void ClientProxy1_3::resetHeartbeatRate()
@@ -61,13 +57,6 @@ void ClientProxy1_3::setHeartbeatRate(double rate, double)
   ClientProxy1_2::setHeartbeatRate(rate, rate * kKeepAlivesUntilDeath);
 }
 
-void ClientProxy1_3::resetHeartbeatTimer()
-{
-  // reset the alarm but not the keep alive timer
-  ClientProxy1_2::removeHeartbeatTimer();
-  ClientProxy1_2::addHeartbeatTimer();
-}
-
 void ClientProxy1_3::addHeartbeatTimer()
 {
   // create and install a timer to periodically send keep alives
@@ -95,5 +84,5 @@ void ClientProxy1_3::removeHeartbeatTimer()
 
 void ClientProxy1_3::keepAlive()
 {
-  ProtocolUtil::writef(getStream(), kMsgCKeepAlive);
+  MsgCKeepAlive::write(getStream());
 }
@@ -27,14 +27,15 @@ public:
 
 protected:
   // ClientProxy overrides
-  bool parseMessage(const uint8_t *code) override;
   void resetHeartbeatRate() override;
   void setHeartbeatRate(double rate, double alarm) override;
-  void resetHeartbeatTimer() override;
   void addHeartbeatTimer() override;
   void removeHeartbeatTimer() override;
   virtual void keepAlive();
 
+private:
+  bool recvKeepAlive();
+
 private:
   double m_keepAliveRate = kKeepAliveRate;
   EventQueueTimer *m_keepAliveTimer = nullptr;
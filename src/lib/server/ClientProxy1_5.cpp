@@ -22,7 +22,8 @@ ClientProxy1_5::ClientProxy1_5(const std::string &name, deskflow::IStream *strea
     : ClientProxy1_4(name, stream, server, events),
       m_events(events)
 {
-  // do nothing
+  setMessageHandler<MsgDFileTransfer>(&ClientProxy1_5::recvFileTransfer);
+  setMessageHandler<MsgDDragInfo>(&ClientProxy1_5::recvDragInfo);
 }
 
 void ClientProxy1_5::sendDragInfo(uint32_t fileCount, const char *info, size_t size)
@@ -35,16 +36,15 @@ void ClientProxy1_5::fileChunkSending(uint8_t mark, char *data, size_t dataSize)
   // do nothing
 }
 
-bool ClientProxy1_5::parseMessage(const uint8_t *code)
+bool ClientProxy1_5::recvFileTransfer()
 {
-  if (memcmp(code, kMsgDFileTransfer, 4) == 0) {
-    fileChunkReceived();
-  } else if (memcmp(code, kMsgDDragInfo, 4) == 0) {
-    dragInfoReceived();
-  } else {
-    return ClientProxy1_4::parseMessage(code);
-  }
+  fileChunkReceived();
+  return true;
+}
 
+bool ClientProxy1_5::recvDragInfo()
+{
+  dragInfoReceived();
   return true;
 }
 
@@ -39,27 +39,27 @@ void ClientProxy1_6::setClipboard(ClipboardID id, const IClipboard *clipboard)
     size_t size = data.size();
     LOG_DEBUG("sending clipboard %d to \"%s\"", id, getName().c_str());
 
-    StreamChunker::sendClipboard(data, size, id, 0, m_events, this);
+    StreamChunker::sendClipboard(data, size, id, 0, m_events, this, m_compressClipboard);
   }
 }
 
 bool ClientProxy1_6::recvClipboard()
 {
   // parse message
-  static std::string dataCached;
   ClipboardID id;
   uint32_t seq;
 
-  if (auto r = ClipboardChunk::assemble(getStream(), dataCached, id, seq); r == TransferState::Started) {
-    size_t size = ClipboardChunk::getExpectedSize();
-    LOG_DEBUG("receiving clipboard %d size=%d", id, size);
+  const size_t maxSize = getServer()->getMaximumClipboardSize();
+  if (auto r = ClipboardChunk::assemble(getStream(), m_clipboardReceiving, id, seq, maxSize);
+      r == TransferState::Started) {
+    LOG_DEBUG("receiving clipboard %d size=%d", id, m_clipboardReceiving.m_expectedSize);
   } else if (r == TransferState::Finished) {
     LOG(
         (CLOG_DEBUG "received client \"%s\" clipboard %d seqnum=%d, size=%d", getName().c_str(), id, seq,
-         dataCached.size())
+         m_clipboardReceiving.m_data.size())
     );
     // save clipboard
-    m_clipboard[id].m_clipboard.unmarshall(dataCached, 0);
+    m_clipboard[id].m_clipboard.unmarshall(m_clipboardReceiving.m_data, 0);
     m_clipboard[id].m_sequenceNumber = seq;
 
     // notify
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include "deskflow/ClipboardChunk.h"
 #include "server/ClientProxy1_5.h"
 
 class Server;
@@ -21,6 +22,13 @@ public:
   void setClipboard(ClipboardID id, const IClipboard *clipboard) override;
   bool recvClipboard() override;
 
+protected:
+  // true once the client has been told it may compress clipboard data
+  bool m_compressClipboard = false;
+
 private:
   IEventQueue *m_events;
+
+  // the clipboard data being received
+  ClipboardTransfer m_clipboardReceiving;
 };
@@ -5,6 +5,7 @@
  */
 
 #include "base/Log.h"
+#include "deskflow/ProtocolMessages.h"
 #include "deskflow/ProtocolUtil.h"
 #include "deskflow/languages/LanguageManager.h"
 
@@ -36,5 +37,5 @@ void ClientProxy1_8::keyDown(KeyID key, KeyModifierMask mask, KeyButton button,
       (CLOG_DEBUG1 "send key down to \"%s\" id=%d, mask=0x%04x, button=0x%04x, language=%s", getName().c_str(), key,
        mask, button, language.c_str())
   );
-  ProtocolUtil::writef(getStream(), kMsgDKeyDownLang, key, mask, button, &language);
+  MsgDKeyDownLang::write(getStream(), key, mask, button, language);
 }
@@ -0,0 +1,324 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include "server/ClientProxy1_9.h"
+
+#include "base/IEventQueue.h"
+#include "base/Log.h"
+#include "deskflow/ClipboardOffer.h"
+#include "deskflow/OptionTypes.h"
+#include "deskflow/ProtocolMessages.h"
+#include "deskflow/StreamChunker.h"
+#include "io/IStream.h"
+#include "server/FastChannelListener.h"
+
+#include <algorithm>
+
+// most samples in one batch, so replacing the batch stays cheap
+static const uint32_t s_motionBatchSize = 64;
+
+// how long the pointer must be still before its position is resent on
+// the connection, in case the datagram with it was lost
+static const double s_positionResendDelay = 0.05;
+
+//
+// ClientProxy1_9
+//
+
+ClientProxy1_9::ClientProxy1_9(
+    const std::string &name, deskflow::IStream *stream, Server *server, IEventQueue *events,
+    FastChannelListener *fastChannels, const NetworkAddress &peer
+)
+    : ClientProxy1_8(name, stream, server, events),
+      m_events(events),
+      m_fastChannels(fastChannels)
+{
+  m_events->addHandler(EventTypes::ClientProxyMotionReady, this, [this](const auto &) { handleMotionReady(); });
+  setMessageHandler<MsgQClipboard>(&ClientProxy1_9::recvClipboardRequest);
+
+  if (m_fastChannels != nullptr) {
+    const uint32_t token =
+        m_fastChannels->open(peer, [this](const NetworkAddress &address) { handleFastHello(address); });
+    m_fastChannel.emplace(token);
+    LOG_DEBUG1("offering fast channel to \"%s\"", getName().c_str());
+    MsgCFastChannel::write(getStream(), token);
+  }
+}
+
+ClientProxy1_9::~ClientProxy1_9()
+{
+  removePositionTimer();
+  if (m_fastChannel) {
+    m_fastChannels->close(m_fastChannel->getToken());
+  }
+  m_events->removeHandler(EventTypes::ClientProxyMotionReady, this);
+}
+
+bool ClientProxy1_9::leave()
+{
+  flushFastMotion();
+  return ClientProxy1_8::leave();
+}
+
+void ClientProxy1_9::mouseDown(ButtonID button)
+{
+  flushFastMotion();
+  ClientProxy1_8::mouseDown(button);
+}
+
+void ClientProxy1_9::mouseUp(ButtonID button)
+{
+  flushFastMotion();
+  ClientProxy1_8::mouseUp(button);
+}
+
+void ClientProxy1_9::mouseMove(int32_t xAbs, int32_t yAbs)
+{
+  LOG_DEBUG2("send mouse move to \"%s\" %d,%d", getName().c_str(), xAbs, yAbs);
+  addMotion(false, xAbs, yAbs);
+}
+
+void ClientProxy1_9::mouseRelativeMove(int32_t xRel, int32_t yRel)
+{
+  LOG_DEBUG2("send mouse relative move to \"%s\" %d,%d", getName().c_str(), xRel, yRel);
+  addMotion(true, xRel, yRel);
+}
+
+void ClientProxy1_9::mouseWheel(int32_t xDelta, int32_t yDelta)
+{
+  // a lost or reordered datagram would lose the scroll, so the wheel
+  // goes on the connection, after the position it scrolls at
+  flushFastMotion();
+  ClientProxy1_8::mouseWheel(xDelta, yDelta);
+}
+
+void ClientProxy1_9::setOptions(const OptionsList &options)
+{
+  // clipboard data can be compressed both ways from here on
+  OptionsList withCompression(options);
+  withCompression.push_back(kOptionClipboardCompression);
+  withCompression.push_back(ClipboardCompression::Zlib);
+  ClientProxy1_8::setOptions(withCompression);
+  m_compressClipboard = true;
+}
+
+void ClientProxy1_9::setClipboard(ClipboardID id, const IClipboard *clipboard)
+{
+  // ignore if this clipboard is already clean
+  if (!m_clipboard[id].m_dirty) {
+    return;
+  }
+  m_clipboard[id].m_dirty = false;
+  Clipboard::copy(&m_clipboard[id].m_clipboard, clipboard);
+
+  // only say what's there.  the data follows if the client asks for it.
+  m_clipboardData[id] = m_clipboard[id].m_clipboard.marshall();
+  ++m_clipboardOffer[id];
+  const auto offer = ClipboardOffer::fromData(m_clipboardData[id]);
+  LOG_DEBUG(
+      "offering clipboard %d to \"%s\" seqnum=%d size=%d", id, getName().c_str(), m_clipboardOffer[id],
+      m_clipboardData[id].size()
+  );
+  const auto &digest = offer.getDigest();
+  MsgDClipboardOffer::write(
+      getStream(), id, m_clipboardOffer[id], digest[0], digest[1], digest[2], digest[3], offer.encode()
+  );
+}
+
+bool ClientProxy1_9::recvClipboardRequest()
+{
+  uint8_t id;
+  uint32_t seq;
+  if (!MsgQClipboard::read(getStream(), id, seq)) {
+    return false;
+  }
+  if (id >= kClipboardEnd) {
+    return false;
+  }
+
+  // the client has a newer offer on the way if this one's been replaced
+  if (seq != m_clipboardOffer[id]) {
+    LOG_DEBUG("ignoring request for old clipboard %d offer from \"%s\" seqnum=%d", id, getName().c_str(), seq);
+    return true;
+  }
+
+  LOG_DEBUG("sending clipboard %d to \"%s\" seqnum=%d", id, getName().c_str(), seq);
+  StreamChunker::sendClipboard(
+      m_clipboardData[id], m_clipboardData[id].size(), id, seq, m_events, this, m_compressClipboard
+  );
+  return true;
+}
+
+void ClientProxy1_9::addMotion(bool relative, int32_t x, int32_t y)
+{
+  const double elapsed = m_motionTime.reset() * 1000000.0;
+  MotionBatch::Sample sample;
+  sample.m_offset = static_cast<uint32_t>(std::clamp(elapsed, 0.0, static_cast<double>(UINT32_MAX)));
+  sample.m_relative = relative;
+  sample.m_x = x;
+  sample.m_y = y;
+
+  // hold back what's written until the event loop has handled the
+  // events already queued, so all the motion they carry goes out in
+  // one message
+  // a lost relative move would leave the pointer short, so relative
+  // motion always goes on the connection, after the position before it
+  if (relative) {
+    flushFastMotion();
+  }
+  if (!m_motionPending) {
+    m_motionPending = true;
+    m_motionFast = m_fastUp && !relative;
+    m_motion.clear();
+    if (!m_motionFast) {
+      getStream()->cork();
+    }
+    m_events->addEvent(Event(EventTypes::ClientProxyMotionReady, this));
+  }
+
+  if (m_motionFast) {
+    if (m_motion.getCount() >= s_motionBatchSize) {
+      sendFastMotion();
+    }
+    m_motion.add(sample);
+    m_positionUnsent = true;
+    m_x = x;
+    m_y = y;
+    return;
+  }
+  if (!relative) {
+    m_positionUnsent = false;
+  }
+
+  // grow the batch that was written last, unless something was written
+  // after it, so messages are never reordered
+  if (m_motion.getCount() > 0 && m_motion.getCount() < s_motionBatchSize) {
+    m_motion.add(sample);
+    if (writeMotion(true)) {
+      return;
+    }
+  }
+
+  m_motion.clear();
+  m_motion.add(sample);
+  writeMotion(false);
+}
+
+bool ClientProxy1_9::writeMotion(bool replace)
+{
+  const auto &samples = m_motion.getData();
+  m_message.resize(MsgDMouseMotion::getSize(samples));
+  MsgDMouseMotion::encode(m_message.data(), samples);
+
+  const auto size = static_cast<uint32_t>(m_message.size());
+  if (replace) {
+    return getStream()->replaceLatest(m_message.data(), size);
+  }
+  getStream()->writeLatest(m_message.data(), size);
+  return true;
+}
+
+void ClientProxy1_9::handleMotionReady()
+{
+  // the event can outlive the batch it was for, and the stream must only
+  // be uncorked once for each cork
+  if (!m_motionPending) {
+    return;
+  }
+  LOG_DEBUG2("sending mouse motion to \"%s\"", getName().c_str());
+  m_motionPending = false;
+  if (m_motionFast) {
+    sendFastMotion();
+    if (m_positionUnsent && m_positionTimer == nullptr) {
+      addPositionTimer(s_positionResendDelay);
+    }
+  } else {
+    getStream()->uncork();
+  }
+}
+
+void ClientProxy1_9::flushFastMotion()
+{
+  if (m_motionPending && m_motionFast) {
+    // what's left of this pass goes on the connection
+    sendFastMotion();
+    m_motionFast = false;
+    getStream()->cork();
+  }
+  if (m_positionUnsent) {
+    m_positionUnsent = false;
+    MotionBatch position;
+    position.add({0, false, m_x, m_y});
+    MsgDMouseMotion::write(getStream(), position.getData());
+  }
+}
+
+void ClientProxy1_9::sendFastMotion()
+{
+  if (m_motion.getCount() == 0) {
+    return;
+  }
+  const auto &samples = m_motion.getData();
+  m_message.resize(MsgDMouseMotion::getSize(samples));
+  MsgDMouseMotion::encode(m_message.data(), samples);
+  m_motion.clear();
+  if (!sendFast(m_message)) {
+    m_positionUnsent = false;
+  }
+}
+
+void ClientProxy1_9::addPositionTimer(double delay)
+{
+  m_positionTimer = m_events->newOneShotTimer(delay, nullptr);
+  m_events->addHandler(EventTypes::Timer, m_positionTimer, [this](const auto &) { handlePositionTimer(); });
+}
+
+void ClientProxy1_9::removePositionTimer()
+{
+  if (m_positionTimer != nullptr) {
+    m_events->removeHandler(EventTypes::Timer, m_positionTimer);
+    m_events->deleteTimer(m_positionTimer);
+    m_positionTimer = nullptr;
+  }
+}
+
+void ClientProxy1_9::handlePositionTimer()
+{
+  // the timer is only restarted once the pointer stops, rather than for
+  // every batch
+  removePositionTimer();
+  if (!m_positionUnsent || m_motionPending) {
+    return;
+  }
+  if (const double still = m_motionTime.getTime(); still < s_positionResendDelay) {
+    addPositionTimer(s_positionResendDelay - still);
+    return;
+  }
+  LOG_DEBUG2("resending mouse position to \"%s\"", getName().c_str());
+  flushFastMotion();
+}
+
+bool ClientProxy1_9::sendFast(std::span<const uint8_t> message)
+{
+  if (m_fastUp && m_fastChannels->send(m_fastChannel->frame(message), m_fastAddress)) {
+    return true;
+  }
+  if (m_fastUp) {
+    LOG_WARN("fast channel to \"%s\" failed, sending motion on the connection", getName().c_str());
+    m_fastUp = false;
+  }
+  getStream()->write(message.data(), static_cast<uint32_t>(message.size()));
+  return false;
+}
+
+void ClientProxy1_9::handleFastHello(const NetworkAddress &address)
+{
+  if (!m_fastUp) {
+    LOG_NOTE("fast channel to \"%s\" is up", getName().c_str());
+  }
+  m_fastAddress = address;
+  m_fastUp = true;
+}
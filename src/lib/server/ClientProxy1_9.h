@@ -0,0 +1,86 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#pragma once
+
+#include "base/Stopwatch.h"
+#include "deskflow/FastChannel.h"
+#include "deskflow/MotionBatch.h"
+#include "net/NetworkAddress.h"
+#include "server/ClientProxy1_8.h"
+
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+class FastChannelListener;
+
+//! Proxy for client implementing protocol version 1.9
+class ClientProxy1_9 : public ClientProxy1_8
+{
+public:
+  ClientProxy1_9(
+      const std::string &name, deskflow::IStream *adoptedStream, Server *server, IEventQueue *events,
+      FastChannelListener *fastChannels = nullptr, const NetworkAddress &peer = NetworkAddress()
+  );
+  ClientProxy1_9(ClientProxy1_9 const &) = delete;
+  ClientProxy1_9(ClientProxy1_9 &&) = delete;
+  ~ClientProxy1_9() override;
+
+  ClientProxy1_9 &operator=(ClientProxy1_9 const &) = delete;
+  ClientProxy1_9 &operator=(ClientProxy1_9 &&) = delete;
+
+  bool leave() override;
+  void mouseDown(ButtonID) override;
+  void mouseUp(ButtonID) override;
+  void mouseMove(int32_t xAbs, int32_t yAbs) override;
+  void mouseRelativeMove(int32_t xRel, int32_t yRel) override;
+  void mouseWheel(int32_t xDelta, int32_t yDelta) override;
+  void setOptions(const OptionsList &options) override;
+  void setClipboard(ClipboardID id, const IClipboard *clipboard) override;
+
+private:
+  bool recvClipboardRequest();
+  void addMotion(bool relative, int32_t x, int32_t y);
+  bool writeMotion(bool replace);
+  void handleMotionReady();
+  void flushFastMotion();
+  void sendFastMotion();
+  void addPositionTimer(double delay);
+  void removePositionTimer();
+  void handlePositionTimer();
+  bool sendFast(std::span<const uint8_t> message);
+  void handleFastHello(const NetworkAddress &address);
+
+  IEventQueue *m_events;
+
+  // the batch last written, while it may still be replaced
+  MotionBatch m_motion;
+  std::vector<uint8_t> m_message;
+  bool m_motionPending = false;
+  Stopwatch m_motionTime;
+
+  // the fast channel, once the client's hello has arrived.  motion
+  // batched for it is only sent when the batch is full or the event loop
+  // is done, and the last absolute position is resent on the connection
+  // before anything that depends on it, in case its datagram was lost,
+  // or once the pointer has stopped.
+  FastChannelListener *m_fastChannels;
+  std::optional<FastChannel> m_fastChannel;
+  NetworkAddress m_fastAddress;
+  bool m_fastUp = false;
+  bool m_motionFast = false;
+  bool m_positionUnsent = false;
+  EventQueueTimer *m_positionTimer = nullptr;
+  int32_t m_x = 0;
+  int32_t m_y = 0;
+
+  // each clipboard as last offered, kept until the client asks for it
+  // or it's offered again
+  std::string m_clipboardData[kClipboardEnd];
+  uint32_t m_clipboardOffer[kClipboardEnd] = {};
+};
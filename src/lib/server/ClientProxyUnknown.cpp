@@ -25,6 +25,7 @@
 #include "server/ClientProxy1_6.h"
 #include "server/ClientProxy1_7.h"
 #include "server/ClientProxy1_8.h"
+#include "server/ClientProxy1_9.h"
 #include "server/Server.h"
 
 #include <iterator>
@@ -34,10 +35,15 @@
 // ClientProxyUnknown
 //
 
-ClientProxyUnknown::ClientProxyUnknown(deskflow::IStream *stream, double timeout, Server *server, IEventQueue *events)
+ClientProxyUnknown::ClientProxyUnknown(
+    deskflow::IStream *stream, double timeout, Server *server, IEventQueue *events, FastChannelListener *fastChannels,
+    const NetworkAddress &peer
+)
     : m_stream(stream),
       m_server(server),
-      m_events(events)
+      m_events(events),
+      m_fastChannels(fastChannels),
+      m_peer(peer)
 {
   assert(m_server != nullptr);
 
@@ -182,6 +188,10 @@ void ClientProxyUnknown::initProxy(const std::string &name, int major, int minor
       m_proxy = new ClientProxy1_8(name, m_stream, m_server, m_events);
       break;
 
+    case 9:
+      m_proxy = new ClientProxy1_9(name, m_stream, m_server, m_events, m_fastChannels, m_peer);
+      break;
+
     default:
       break;
     }
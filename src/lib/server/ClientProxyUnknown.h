@@ -11,11 +11,13 @@
 #include "base/Event.h"
 #include "base/EventTypes.h"
 #include "deskflow/OptionTypes.h"
+#include "net/NetworkAddress.h"
 
 #include <string>
 
 class ClientProxy;
 class EventQueueTimer;
+class FastChannelListener;
 namespace deskflow {
 class IStream;
 }
@@ -25,7 +27,10 @@ class IEventQueue;
 class ClientProxyUnknown
 {
 public:
-  ClientProxyUnknown(deskflow::IStream *stream, double timeout, Server *server, IEventQueue *events);
+  ClientProxyUnknown(
+      deskflow::IStream *stream, double timeout, Server *server, IEventQueue *events,
+      FastChannelListener *fastChannels = nullptr, const NetworkAddress &peer = NetworkAddress()
+  );
   ClientProxyUnknown(ClientProxyUnknown const &) = delete;
   ClientProxyUnknown(ClientProxyUnknown &&) = delete;
   ~ClientProxyUnknown();
@@ -72,4 +77,6 @@ private:
   bool m_ready = false;
   Server *m_server = nullptr;
   IEventQueue *m_events = nullptr;
+  FastChannelListener *m_fastChannels = nullptr;
+  NetworkAddress m_peer;
 };
@@ -0,0 +1,84 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include "server/FastChannelListener.h"
+
+#include "base/IEventQueue.h"
+#include "base/Log.h"
+#include "net/IDatagramSocket.h"
+#include "net/NetworkAddress.h"
+
+#include <random>
+
+//
+// FastChannelListener
+//
+
+FastChannelListener::FastChannelListener(IDatagramSocket *socket, IEventQueue *events)
+    : m_socket(socket),
+      m_events(events)
+{
+  m_events->addHandler(EventTypes::DatagramSocketReady, m_socket->getEventTarget(), [this](const auto &) {
+    handleReady();
+  });
+}
+
+FastChannelListener::~FastChannelListener()
+{
+  m_events->removeHandler(EventTypes::DatagramSocketReady, m_socket->getEventTarget());
+}
+
+uint32_t FastChannelListener::open(const NetworkAddress &peer, const HelloHandler &handler)
+{
+  // the token is all that stops anyone else on the network using the
+  // channel, so it can't be guessed from the ones before
+  std::random_device random;
+  uint32_t token = 0;
+  while (token == 0 || m_channels.contains(token)) {
+    token = random();
+  }
+  m_channels[token] = {peer, handler};
+  return token;
+}
+
+void FastChannelListener::close(uint32_t token)
+{
+  m_channels.erase(token);
+}
+
+bool FastChannelListener::send(const std::string &datagram, const NetworkAddress &address)
+{
+  return m_socket->sendTo(datagram.data(), static_cast<uint32_t>(datagram.size()), address);
+}
+
+void FastChannelListener::handleReady()
+{
+  NetworkAddress from;
+  while (const uint32_t size = m_socket->receive(m_buffer.data(), static_cast<uint32_t>(m_buffer.size()), &from)) {
+    const std::span<const uint8_t> datagram(m_buffer.data(), size);
+    uint32_t token;
+    uint32_t sequence;
+    if (!FastChannel::parseHeader(datagram, token, sequence) || !FastChannel::isHello(datagram)) {
+      continue;
+    }
+
+    // the handler can close the channel, so don't hold on to it
+    const auto channel = m_channels.find(token);
+    if (channel == m_channels.end()) {
+      LOG_DEBUG1("ignoring hello for unknown fast channel from %s", from.getHostname().c_str());
+      continue;
+    }
+
+    // the token goes in the clear, so it's no good from anywhere else
+    if (from.getHostname() != channel->second.m_peer.getHostname()) {
+      LOG_DEBUG1("ignoring hello for fast channel from %s", from.getHostname().c_str());
+      continue;
+    }
+    const auto handler = channel->second.m_handler;
+    m_socket->sendTo(datagram.data(), size, from);
+    handler(from);
+  }
+}
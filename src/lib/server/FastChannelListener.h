@@ -0,0 +1,76 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#pragma once
+
+#include "deskflow/FastChannel.h"
+#include "net/NetworkAddress.h"
+
+#include <array>
+#include <functional>
+#include <map>
+#include <memory>
+
+class IDatagramSocket;
+class IEventQueue;
+
+//! Listener for fast channels
+/*!
+Owns the datagram socket that the fast channels to all clients share, see
+\c kMsgCFastChannel.  A client proxy opens a channel to get the token to
+offer the client, and hears the client's address when its hello arrives.
+A hello is only answered if it's from the host the client connected from.
+*/
+class FastChannelListener
+{
+public:
+  using HelloHandler = std::function<void(const NetworkAddress &)>;
+
+  //! Adopts \p socket, which must be bound
+  FastChannelListener(IDatagramSocket *socket, IEventQueue *events);
+  FastChannelListener(FastChannelListener const &) = delete;
+  FastChannelListener(FastChannelListener &&) = delete;
+  ~FastChannelListener();
+
+  FastChannelListener &operator=(FastChannelListener const &) = delete;
+  FastChannelListener &operator=(FastChannelListener &&) = delete;
+
+  //! @name manipulators
+  //@{
+
+  //! Open a channel
+  /*!
+  Returns the channel's token.  \p handler is called with the address
+  of each hello for the channel from \p peer's host, after the hello is
+  answered.
+  */
+  uint32_t open(const NetworkAddress &peer, const HelloHandler &handler);
+
+  //! Close a channel
+  void close(uint32_t token);
+
+  //! Send a datagram
+  /*!
+  Returns false if it couldn't be sent.
+  */
+  bool send(const std::string &datagram, const NetworkAddress &address);
+
+  //@}
+
+private:
+  struct Channel
+  {
+    NetworkAddress m_peer;
+    HelloHandler m_handler;
+  };
+
+  void handleReady();
+
+  std::unique_ptr<IDatagramSocket> m_socket;
+  IEventQueue *m_events;
+  std::map<uint32_t, Channel> m_channels;
+  std::array<uint8_t, FastChannel::kMaxDatagramSize> m_buffer;
+};
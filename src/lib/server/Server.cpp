@@ -20,6 +20,7 @@
 #include "deskflow/ProtocolTypes.h"
 #include "deskflow/Screen.h"
 #include "deskflow/StreamChunker.h"
+#include "io/StreamCork.h"
 #include "mt/Thread.h"
 #include "net/TCPSocket.h"
 #include "server/ClientListener.h"
@@ -97,6 +98,20 @@ Server::Server(
   m_events->addHandler(EventTypes::PrimaryScreenWheel, m_primaryClient->getEventTarget(), [this](const auto &e) {
     handleWheelEvent(e);
   });
+
+  // if we fall behind, motion events waiting in the queue merge rather
+  // than each costing a switch check and a message.  absolute positions
+  // keep the latest and relative moves add up.
+  m_events->setCoalescer(EventTypes::PrimaryScreenMotionOnPrimary, [](Event &waiting, const Event &added) {
+    *static_cast<IPlatformScreen::MotionInfo *>(waiting.getData()) =
+        *static_cast<const IPlatformScreen::MotionInfo *>(added.getData());
+  });
+  m_events->setCoalescer(EventTypes::PrimaryScreenMotionOnSecondary, [](Event &waiting, const Event &added) {
+    auto *info = static_cast<IPlatformScreen::MotionInfo *>(waiting.getData());
+    const auto *delta = static_cast<const IPlatformScreen::MotionInfo *>(added.getData());
+    info->m_x += delta->m_x;
+    info->m_y += delta->m_y;
+  });
   m_events->addHandler(
       EventTypes::PrimaryScreenSaverActivated, m_primaryClient->getEventTarget(),
       [this](const auto &) { onScreensaver(true); }
@@ -157,6 +172,8 @@ Server::~Server()
   m_events->removeHandler(PrimaryScreenMotionOnPrimary, m_primaryClient->getEventTarget());
   m_events->removeHandler(PrimaryScreenMotionOnSecondary, m_primaryClient->getEventTarget());
   m_events->removeHandler(PrimaryScreenWheel, m_primaryClient->getEventTarget());
+  m_events->setCoalescer(PrimaryScreenMotionOnPrimary, nullptr);
+  m_events->setCoalescer(PrimaryScreenMotionOnSecondary, nullptr);
   m_events->removeHandler(PrimaryScreenSaverActivated, m_primaryClient->getEventTarget());
   m_events->removeHandler(PrimaryScreenSaverDeactivated, m_primaryClient->getEventTarget());
   m_events->removeHandler(PrimaryScreenFakeInputBegin, m_inputFilter);
@@ -458,6 +475,9 @@ void Server::switchScreen(BaseClientProxy *dst, int32_t x, int32_t y, bool forSc
     // cut over
     m_active = dst;
 
+    // send the enter and clipboards together
+    StreamCork cork(m_active->getStream());
+
     // increment enter sequence number
     ++m_seqNum;
 
@@ -1057,6 +1077,7 @@ void Server::sendOptions(BaseClientProxy *client) const
   }
 
   // send the options
+  StreamCork cork(client->getStream());
   client->resetOptions();
   client->setOptions(optionsList);
 }
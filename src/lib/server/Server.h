@@ -186,6 +186,15 @@ public:
   */
   void getClients(std::vector<std::string> &list) const;
 
+  //! Get the maximum clipboard size
+  /*!
+  Returns the size in bytes of the largest clipboard that's shared.
+  */
+  size_t getMaximumClipboardSize() const
+  {
+    return m_maximumClipboardSize * 1024;
+  }
+
   //@}
 
 private:
@@ -0,0 +1,370 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include "EventQueueTests.h"
+
+#include "base/EventQueue.h"
+#include "base/FunctionJob.h"
+#include "mt/Thread.h"
+
+#include <array>
+#include <atomic>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+void EventQueueTests::initTestCase()
+{
+  m_arch.init();
+  m_log.setFilter(LogLevel::Debug2);
+}
+
+void EventQueueTests::resetTimer_pushesDeadline()
+{
+  EventQueue queue;
+  Event event;
+
+  auto timer = queue.newOneShotTimer(0.05, nullptr);
+  queue.resetTimer(timer, 10.0);
+  QVERIFY(!queue.getEvent(event, 0.1));
+
+  queue.resetTimer(timer, 0.01);
+  QVERIFY(queue.getEvent(event, 1.0));
+  QCOMPARE(event.getType(), EventTypes::Timer);
+  QCOMPARE(event.getTarget(), static_cast<void *>(timer));
+
+  queue.deleteTimer(timer);
+}
+
+void EventQueueTests::resetTimer_rearmsExpiredOneShot()
+{
+  EventQueue queue;
+  Event event;
+
+  auto timer = queue.newOneShotTimer(0.01, nullptr);
+  QVERIFY(queue.getEvent(event, 1.0));
+  QVERIFY(!queue.getEvent(event, 0.05));
+
+  queue.resetTimer(timer, 0.01);
+  QVERIFY(queue.getEvent(event, 1.0));
+  QCOMPARE(event.getTarget(), static_cast<void *>(timer));
+
+  queue.deleteTimer(timer);
+}
+
+void EventQueueTests::deleteTimer_keepsDeadlineOrder()
+{
+  EventQueue queue;
+  Event event;
+
+  const std::array durations = {0.05, 0.01, 0.04, 0.02, 0.03};
+  std::array<EventQueueTimer *, durations.size()> timers;
+  for (size_t i = 0; i < durations.size(); ++i) {
+    timers[i] = queue.newOneShotTimer(durations[i], nullptr);
+  }
+  queue.deleteTimer(timers[3]);
+
+  for (const auto expected : {1, 4, 2, 0}) {
+    QVERIFY(queue.getEvent(event, 1.0));
+    QCOMPARE(event.getTarget(), static_cast<void *>(timers[expected]));
+  }
+
+  for (size_t i = 0; i < timers.size(); ++i) {
+    if (i != 3) {
+      queue.deleteTimer(timers[i]);
+    }
+  }
+}
+
+void EventQueueTests::newTimer_repeats()
+{
+  EventQueue queue;
+  Event event;
+
+  auto timer = queue.newTimer(0.01, nullptr);
+  for (int i = 0; i < 3; ++i) {
+    QVERIFY(queue.getEvent(event, 1.0));
+    QCOMPARE(event.getTarget(), static_cast<void *>(timer));
+    const auto *timerEvent = static_cast<IEventQueue::TimerEvent *>(event.getData());
+    QVERIFY(timerEvent->m_count >= 1);
+  }
+
+  queue.deleteTimer(timer);
+}
+
+void EventQueueTests::dispatchEvent_fallsBackToUnknown()
+{
+  EventQueue queue;
+  int target = 0;
+  int typed = 0;
+  int unknown = 0;
+
+  queue.addHandler(EventTypes::StreamInputReady, &target, [&typed](const auto &) { ++typed; });
+  queue.addHandler(EventTypes::Unknown, &target, [&unknown](const auto &) { ++unknown; });
+
+  QVERIFY(queue.dispatchEvent(Event(EventTypes::StreamInputReady, &target)));
+  QVERIFY(queue.dispatchEvent(Event(EventTypes::StreamOutputFlushed, &target)));
+  QCOMPARE(typed, 1);
+  QCOMPARE(unknown, 1);
+
+  queue.removeHandler(EventTypes::Unknown, &target);
+  QVERIFY(!queue.dispatchEvent(Event(EventTypes::StreamOutputFlushed, &target)));
+}
+
+void EventQueueTests::dispatchEvent_handlerRemovesItself()
+{
+  EventQueue queue;
+  int target = 0;
+  int calls = 0;
+
+  queue.addHandler(EventTypes::StreamInputReady, &target, [&queue, &target, &calls](const auto &) {
+    queue.removeHandler(EventTypes::StreamInputReady, &target);
+    queue.addHandler(EventTypes::StreamOutputFlushed, &target, [](const auto &) {});
+    ++calls;
+  });
+
+  QVERIFY(queue.dispatchEvent(Event(EventTypes::StreamInputReady, &target)));
+  QVERIFY(!queue.dispatchEvent(Event(EventTypes::StreamInputReady, &target)));
+  QVERIFY(queue.dispatchEvent(Event(EventTypes::StreamOutputFlushed, &target)));
+  QCOMPARE(calls, 1);
+}
+
+void EventQueueTests::removeHandlers_removesAllTypes()
+{
+  EventQueue queue;
+  int target = 0;
+  int other = 0;
+
+  queue.addHandler(EventTypes::StreamInputReady, &target, [](const auto &) {});
+  queue.addHandler(EventTypes::StreamOutputFlushed, &target, [](const auto &) {});
+  queue.addHandler(EventTypes::StreamInputReady, &other, [](const auto &) {});
+  queue.removeHandlers(&target);
+
+  QVERIFY(!queue.dispatchEvent(Event(EventTypes::StreamInputReady, &target)));
+  QVERIFY(!queue.dispatchEvent(Event(EventTypes::StreamOutputFlushed, &target)));
+  QVERIFY(queue.dispatchEvent(Event(EventTypes::StreamInputReady, &other)));
+}
+
+void EventQueueTests::dispatchEvent_benchmark()
+{
+  EventQueue queue;
+  std::array<int, 64> targets{};
+  int calls = 0;
+  for (auto &target : targets) {
+    queue.addHandler(EventTypes::PrimaryScreenMotionOnPrimary, &target, [&calls](const auto &) { ++calls; });
+    queue.addHandler(EventTypes::StreamInputReady, &target, [&calls](const auto &) { ++calls; });
+  }
+
+  const Event event(EventTypes::PrimaryScreenMotionOnPrimary, &targets[17]);
+  QBENCHMARK {
+    queue.dispatchEvent(event);
+  }
+  QVERIFY(calls > 0);
+}
+
+void EventQueueTests::addEvent_keepsOrder()
+{
+  EventQueue queue;
+  std::vector<uintptr_t> received;
+  queue.addHandler(EventTypes::StreamInputReady, nullptr, [&received](const Event &event) {
+    received.push_back(reinterpret_cast<uintptr_t>(event.getData()));
+  });
+
+  Thread loop(new FunctionJob([](void *queue) { static_cast<EventQueue *>(queue)->loop(); }, &queue));
+  queue.waitForReady();
+
+  // enough to overflow both the event ring and the buffer's queue
+  const uintptr_t count = 3000;
+  for (uintptr_t i = 0; i < count; ++i) {
+    queue.addEvent(
+        Event(EventTypes::StreamInputReady, nullptr, reinterpret_cast<void *>(i), Event::EventFlags::DontFreeData)
+    );
+  }
+  queue.addEvent(Event(EventTypes::Quit));
+  loop.wait();
+
+  QCOMPARE(received.size(), count);
+  for (uintptr_t i = 0; i < count; ++i) {
+    QCOMPARE(received[i], i);
+  }
+}
+
+void EventQueueTests::addEvent_fromManyThreads()
+{
+  EventQueue queue;
+  std::array<int, 4> targets{};
+  std::array<std::vector<uintptr_t>, targets.size()> received;
+  for (size_t i = 0; i < targets.size(); ++i) {
+    queue.addHandler(EventTypes::StreamInputReady, &targets[i], [&received, i](const Event &event) {
+      received[i].push_back(reinterpret_cast<uintptr_t>(event.getData()));
+    });
+  }
+
+  Thread loop(new FunctionJob([](void *queue) { static_cast<EventQueue *>(queue)->loop(); }, &queue));
+  queue.waitForReady();
+
+  const uintptr_t count = 5000;
+  std::vector<std::thread> threads;
+  for (auto &target : targets) {
+    threads.emplace_back([&queue, &target, count] {
+      for (uintptr_t i = 0; i < count; ++i) {
+        queue.addEvent(
+            Event(EventTypes::StreamInputReady, &target, reinterpret_cast<void *>(i), Event::EventFlags::DontFreeData)
+        );
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  queue.addEvent(Event(EventTypes::Quit));
+  loop.wait();
+
+  // each thread's events must arrive complete and in the order it added them
+  for (const auto &values : received) {
+    QCOMPARE(values.size(), count);
+    for (uintptr_t i = 0; i < count; ++i) {
+      QCOMPARE(values[i], i);
+    }
+  }
+}
+
+void EventQueueTests::addEvent_benchmark()
+{
+  EventQueue queue;
+  std::atomic<uint32_t> handled = 0;
+  queue.addHandler(EventTypes::StreamInputReady, nullptr, [&handled](const auto &) { ++handled; });
+
+  Thread loop(new FunctionJob([](void *queue) { static_cast<EventQueue *>(queue)->loop(); }, &queue));
+  queue.waitForReady();
+
+  // time from another thread adding an event to the loop handling it
+  uint32_t added = 0;
+  QBENCHMARK {
+    queue.addEvent(Event(EventTypes::StreamInputReady));
+    ++added;
+    while (handled != added) {
+      std::this_thread::yield();
+    }
+  }
+
+  queue.addEvent(Event(EventTypes::Quit));
+  loop.wait();
+  QCOMPARE(handled.load(), added);
+}
+
+void EventQueueTests::addEvent_coalesces()
+{
+  struct Delta
+  {
+    int m_value;
+  };
+
+  EventQueue queue;
+  std::array<int, 2> targets{};
+  std::vector<std::pair<void *, int>> received;
+  for (auto &target : targets) {
+    queue.addHandler(EventTypes::StreamInputReady, &target, [&received, &target](const Event &event) {
+      received.emplace_back(&target, static_cast<const Delta *>(event.getData())->m_value);
+    });
+    queue.addHandler(EventTypes::StreamOutputFlushed, &target, [&received, &target](const auto &) {
+      received.emplace_back(&target, -1);
+    });
+  }
+  queue.setCoalescer(EventTypes::StreamInputReady, [](Event &waiting, const Event &added) {
+    static_cast<Delta *>(waiting.getData())->m_value += static_cast<const Delta *>(added.getData())->m_value;
+  });
+
+  // hold up the loop so that the events pile up behind this one
+  std::atomic<bool> blocked = true;
+  queue.addHandler(EventTypes::StreamInputShutdown, nullptr, [&blocked](const auto &) {
+    while (blocked) {
+      std::this_thread::yield();
+    }
+  });
+
+  Thread loop(new FunctionJob([](void *queue) { static_cast<EventQueue *>(queue)->loop(); }, &queue));
+  queue.waitForReady();
+  queue.addEvent(Event(EventTypes::StreamInputShutdown));
+
+  const auto addDelta = [&queue](int &target, int value) {
+    queue.addEvent(Event(EventTypes::StreamInputReady, &target, Delta{value}));
+  };
+  addDelta(targets[0], 1);
+  addDelta(targets[0], 2);
+  addDelta(targets[1], 4);
+  addDelta(targets[0], 8);
+  queue.addEvent(Event(EventTypes::StreamOutputFlushed, &targets[0]));
+  addDelta(targets[0], 16);
+  addDelta(targets[0], 32);
+  blocked = false;
+
+  queue.addEvent(Event(EventTypes::Quit));
+  loop.wait();
+
+  // nothing merges across the other event for the same target
+  const std::vector<std::pair<void *, int>> expected = {
+      {&targets[0], 11}, {&targets[1], 4}, {&targets[0], -1}, {&targets[0], 48}
+  };
+  QCOMPARE(received, expected);
+  QCOMPARE(queue.getStats().getTypeStats(EventTypes::StreamInputReady).m_coalesced, uint64_t(3));
+}
+
+void EventQueueTests::stats_countsEvents()
+{
+  EventQueue queue;
+  queue.addHandler(EventTypes::StreamInputReady, nullptr, [](const auto &) {});
+
+  Thread loop(new FunctionJob([](void *queue) { static_cast<EventQueue *>(queue)->loop(); }, &queue));
+  queue.waitForReady();
+
+  const uint64_t count = 100;
+  for (uint64_t i = 0; i < count; ++i) {
+    queue.addEvent(Event(EventTypes::StreamInputReady));
+  }
+  // no handler for these so they're added but never dispatched
+  queue.addEvent(Event(EventTypes::StreamOutputFlushed));
+  queue.addEvent(Event(EventTypes::Quit));
+  loop.wait();
+
+  const auto &stats = queue.getStats();
+  const auto ready = stats.getTypeStats(EventTypes::StreamInputReady);
+  QCOMPARE(ready.m_added, count);
+  QCOMPARE(ready.m_dispatched, count);
+  QCOMPARE(std::accumulate(ready.m_queueTime.begin(), ready.m_queueTime.end(), uint64_t(0)), count);
+  QCOMPARE(std::accumulate(ready.m_handlerTime.begin(), ready.m_handlerTime.end(), uint64_t(0)), count);
+
+  const auto flushed = stats.getTypeStats(EventTypes::StreamOutputFlushed);
+  QCOMPARE(flushed.m_added, uint64_t(1));
+  QCOMPARE(flushed.m_dispatched, uint64_t(0));
+
+  QCOMPARE(stats.getPending(), size_t(0));
+  QVERIFY(stats.getPendingHighWaterMark() >= 1);
+  QVERIFY(stats.getPendingHighWaterMark() <= count + 2);
+}
+
+void EventQueueTests::stats_dumpOnSystemTarget()
+{
+  EventQueue queue;
+  QVERIFY(queue.dispatchEvent(Event(EventTypes::EventQueueDumpStats, queue.getSystemTarget())));
+  QCOMPARE(queue.getStats().getTypeStats(EventTypes::EventQueueDumpStats).m_dispatched, uint64_t(1));
+}
+
+void EventQueueTests::stats_percentile()
+{
+  EventQueueStats::Histogram histogram{};
+  QCOMPARE(EventQueueStats::getPercentile(histogram, 0.5), uint64_t(0));
+
+  // 90 under 1us, 9 from 8us to 16us and 1 from 1ms to 2ms
+  histogram[0] = 90;
+  histogram[4] = 9;
+  histogram[11] = 1;
+  QCOMPARE(EventQueueStats::getPercentile(histogram, 0.5), uint64_t(1));
+  QCOMPARE(EventQueueStats::getPercentile(histogram, 0.99), uint64_t(16));
+  QCOMPARE(EventQueueStats::getPercentile(histogram, 1.0), uint64_t(2048));
+}
+
+QTEST_MAIN(EventQueueTests)
@@ -0,0 +1,36 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include "arch/Arch.h"
+#include "base/Log.h"
+
+#include <QTest>
+
+class EventQueueTests : public QObject
+{
+  Q_OBJECT
+private Q_SLOTS:
+  void initTestCase();
+  void resetTimer_pushesDeadline();
+  void resetTimer_rearmsExpiredOneShot();
+  void deleteTimer_keepsDeadlineOrder();
+  void newTimer_repeats();
+  void dispatchEvent_fallsBackToUnknown();
+  void dispatchEvent_handlerRemovesItself();
+  void removeHandlers_removesAllTypes();
+  void dispatchEvent_benchmark();
+  void addEvent_keepsOrder();
+  void addEvent_fromManyThreads();
+  void addEvent_benchmark();
+  void addEvent_coalesces();
+  void stats_countsEvents();
+  void stats_dumpOnSystemTarget();
+  void stats_percentile();
+
+private:
+  Arch m_arch;
+  Log m_log;
+};
@@ -0,0 +1,129 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include "MotionJitterBufferTests.h"
+
+#include "client/MotionJitterBuffer.h"
+
+#include <cmath>
+#include <vector>
+
+namespace {
+
+MotionBatch::Sample sample(uint32_t offset, int32_t x)
+{
+  MotionBatch::Sample sample;
+  sample.m_offset = offset;
+  sample.m_x = x;
+  sample.m_y = -x;
+  return sample;
+}
+
+// adds samples taken every \p interval, which arrive \p perBurst at a time
+// as the last of them is taken
+void addBursts(MotionJitterBuffer &buffer, int bursts, int perBurst, double interval)
+{
+  int x = 0;
+  for (int burst = 0; burst < bursts; ++burst) {
+    const double arrived = 1.0 + (burst + 1) * perBurst * interval;
+    for (int i = 0; i < perBurst; ++i) {
+      buffer.add(sample(static_cast<uint32_t>(interval * 1000000.0), x++), arrived);
+    }
+  }
+}
+
+} // namespace
+
+void MotionJitterBufferTests::add_steadyIsDueOnArrival()
+{
+  MotionJitterBuffer buffer;
+  MotionBatch::Sample popped;
+
+  for (int i = 0; i < 100; ++i) {
+    const double now = 1.0 + i * 0.01;
+    buffer.add(sample(10000, i), now);
+    QVERIFY(buffer.popDue(now + 1e-9, popped));
+    QCOMPARE(popped.m_x, i);
+    QCOMPARE(popped.m_y, -i);
+  }
+
+  QVERIFY(buffer.isEmpty());
+  QVERIFY(buffer.getStats().m_jitter < 1e-6);
+  QVERIFY(buffer.getStats().m_delay < 1e-6);
+  QCOMPARE(buffer.getStats().m_maxDepth, 1U);
+  QCOMPARE(buffer.getStats().m_samples, uint64_t(100));
+}
+
+void MotionJitterBufferTests::add_burstsArePaced()
+{
+  MotionJitterBuffer buffer;
+  MotionBatch::Sample popped;
+
+  // settle on a delay, then check the last burst is spread out
+  addBursts(buffer, 50, 4, 0.008);
+  while (buffer.getStats().m_depth > 4) {
+    QVERIFY(buffer.popNext(2.0, popped));
+  }
+
+  const auto &stats = buffer.getStats();
+  QVERIFY(stats.m_jitter > 0.005);
+  QVERIFY(stats.m_delay > 0.015);
+  QVERIFY(stats.m_delay <= 0.05);
+
+  std::vector<double> due;
+  while (!buffer.isEmpty()) {
+    due.push_back(buffer.getNextTime());
+    QVERIFY(!buffer.popDue(due.back() - 0.001, popped));
+    QVERIFY(buffer.popDue(due.back(), popped));
+  }
+  QCOMPARE(due.size(), size_t(4));
+  for (size_t i = 1; i < due.size(); ++i) {
+    QVERIFY(std::abs(due[i] - due[i - 1] - 0.008) < 0.002);
+  }
+}
+
+void MotionJitterBufferTests::add_delayIsCapped()
+{
+  MotionJitterBuffer buffer;
+
+  addBursts(buffer, 100, 2, 0.04);
+
+  QVERIFY(buffer.getStats().m_jitter > 0.03);
+  QCOMPARE(buffer.getStats().m_delay, 0.05);
+  QCOMPARE(buffer.getStats().m_maxDepth, 200U);
+}
+
+void MotionJitterBufferTests::popNext_drains()
+{
+  MotionJitterBuffer buffer;
+  MotionBatch::Sample popped;
+
+  addBursts(buffer, 10, 8, 0.01);
+  QVERIFY(!buffer.popDue(0.0, popped));
+
+  for (int i = 0; i < 80; ++i) {
+    QVERIFY(buffer.popNext(0.0, popped));
+    QCOMPARE(popped.m_x, i);
+  }
+  QVERIFY(!buffer.popNext(0.0, popped));
+  QCOMPARE(buffer.getStats().m_depth, 0U);
+}
+
+void MotionJitterBufferTests::clear_keepsStats()
+{
+  MotionJitterBuffer buffer;
+
+  addBursts(buffer, 10, 8, 0.01);
+  const double jitter = buffer.getStats().m_jitter;
+  buffer.clear();
+
+  QVERIFY(buffer.isEmpty());
+  QCOMPARE(buffer.getStats().m_depth, 0U);
+  QCOMPARE(buffer.getStats().m_maxDepth, 80U);
+  QCOMPARE(buffer.getStats().m_jitter, jitter);
+}
+
+QTEST_MAIN(MotionJitterBufferTests)
@@ -0,0 +1,18 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include <QTest>
+
+class MotionJitterBufferTests : public QObject
+{
+  Q_OBJECT
+private Q_SLOTS:
+  void add_steadyIsDueOnArrival();
+  void add_burstsArePaced();
+  void add_delayIsCapped();
+  void popNext_drains();
+  void clear_keepsStats();
+};
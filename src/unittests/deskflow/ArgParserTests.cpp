@@ -184,6 +184,18 @@ void ArgParserTests::server_setConfigFile()
   QCOMPARE(serverArgs.m_configFile, "mock_configFile");
 }
 
+void ArgParserTests::server_setFastMotion()
+{
+  deskflow::ServerArgs serverArgs;
+  const int argc = 2;
+  std::array<const char *, argc> kFastCmd = {"stub", "--fast-motion"};
+
+  QVERIFY(!serverArgs.m_fastMotion);
+  m_parser.parseServerArgs(serverArgs, argc, kFastCmd.data());
+
+  QVERIFY(serverArgs.m_fastMotion);
+}
+
 void ArgParserTests::server_unexpectedParam()
 {
   deskflow::ServerArgs serverArgs;
@@ -247,6 +259,28 @@ void ArgParserTests::client_setInvertScroll()
   QCOMPARE(clientArgs.m_clientScrollDirection, deskflow::ClientScrollDirection::Inverted);
 }
 
+void ArgParserTests::client_setSmoothMotion()
+{
+  deskflow::ClientArgs clientArgs;
+  const int argc = 2;
+  std::array<const char *, argc> kSmoothCmd = {"stub", "--smooth-motion"};
+
+  m_parser.parseClientArgs(clientArgs, argc, kSmoothCmd.data());
+
+  QVERIFY(clientArgs.m_smoothMotion);
+}
+
+void ArgParserTests::client_setFastMotion()
+{
+  deskflow::ClientArgs clientArgs;
+  const int argc = 2;
+  std::array<const char *, argc> kFastCmd = {"stub", "--fast-motion"};
+
+  m_parser.parseClientArgs(clientArgs, argc, kFastCmd.data());
+
+  QVERIFY(clientArgs.m_fastMotion);
+}
+
 void ArgParserTests::client_commonArgs()
 {
   deskflow::ClientArgs clientArgs;
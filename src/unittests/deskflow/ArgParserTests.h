@@ -24,11 +24,14 @@ private Q_SLOTS:
   void serverArgs();
   void server_setAddress();
   void server_setConfigFile();
+  void server_setFastMotion();
   void server_unexpectedParam();
   void clientArgs();
   void client_yScroll();
   void client_setLangSync();
   void client_setInvertScroll();
+  void client_setSmoothMotion();
+  void client_setFastMotion();
   void client_commonArgs();
   void client_setAddress();
   void client_badArgs();
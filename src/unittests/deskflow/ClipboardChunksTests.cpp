@@ -9,6 +9,106 @@
 
 #include "deskflow/ClipboardChunk.h"
 #include "deskflow/ProtocolTypes.h"
+#include "io/IStream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+//! Records the messages written to it and reads back from \c m_input
+class TestStream : public deskflow::IStream
+{
+public:
+  void close() override
+  {
+    // do nothing
+  }
+
+  uint32_t read(void *buffer, uint32_t n) override
+  {
+    n = std::min(n, static_cast<uint32_t>(m_input.size()));
+    memcpy(buffer, m_input.data(), n);
+    m_input.erase(0, n);
+    return n;
+  }
+
+  void write(const void *buffer, uint32_t n) override
+  {
+    m_messages.emplace_back(static_cast<const char *>(buffer), n);
+  }
+
+  void writeBulk(const void *buffer, uint32_t n) override
+  {
+    m_messages.emplace_back(static_cast<const char *>(buffer), n);
+    ++m_bulkMessages;
+  }
+
+  void flush() override
+  {
+    // do nothing
+  }
+
+  void shutdownInput() override
+  {
+    // do nothing
+  }
+
+  void shutdownOutput() override
+  {
+    // do nothing
+  }
+
+  void *getEventTarget() const override
+  {
+    return const_cast<TestStream *>(this);
+  }
+
+  bool isReady() const override
+  {
+    return !m_input.empty();
+  }
+
+  uint32_t getSize() const override
+  {
+    return static_cast<uint32_t>(m_input.size());
+  }
+
+  std::vector<std::string> m_messages;
+  int m_bulkMessages = 0;
+  std::string m_input;
+};
+
+//! Sends \p chunk to \p stream and deletes it
+void sendChunk(TestStream &stream, ClipboardChunk *chunk)
+{
+  ClipboardChunk::send(&stream, chunk);
+  delete chunk;
+}
+
+//! Reads back each message written to \p stream, returning the last state
+TransferState receiveAll(TestStream &stream, ClipboardTransfer &transfer, size_t maxSize = SIZE_MAX)
+{
+  TransferState state = TransferState::Error;
+  for (const auto &message : stream.m_messages) {
+    stream.m_input = message.substr(4);
+    ClipboardID id;
+    uint32_t sequence;
+    state = ClipboardChunk::assemble(&stream, transfer, id, sequence, maxSize);
+  }
+  stream.m_messages.clear();
+  return state;
+}
+
+} // namespace
+
+void ClipboardChunksTests::initTestCase()
+{
+  m_arch.init();
+  m_log.setFilter(LogLevel::Info);
+}
 
 void ClipboardChunksTests::startFormatData()
 {
@@ -70,4 +170,172 @@ void ClipboardChunksTests::endFormatData()
   delete chunk;
 }
 
+void ClipboardChunksTests::sendDataChunk_slices()
+{
+  ClipboardID id = 1;
+  uint32_t sequence = 2;
+  std::string mockData(40 * 1024, '\0');
+  for (size_t i = 0; i < mockData.size(); ++i) {
+    mockData[i] = static_cast<char>(i * 7);
+  }
+  ClipboardChunk *chunk = ClipboardChunk::data(id, sequence, mockData);
+  TestStream stream;
+  ClipboardChunk::send(&stream, chunk);
+  delete chunk;
+
+  // one big chunk goes out as a few small bulk messages
+  QCOMPARE(stream.m_messages.size(), 3u);
+  QCOMPARE(stream.m_bulkMessages, 3);
+
+  // that add up to the same data
+  ClipboardTransfer transfer;
+  transfer.m_expectedSize = mockData.size();
+  for (const auto &message : stream.m_messages) {
+    QVERIFY(message.size() <= 16 * 1024 + 32);
+    QCOMPARE(message.substr(0, 4), std::string("DCLP"));
+    stream.m_input = message.substr(4);
+    ClipboardID receivedId;
+    uint32_t receivedSequence;
+    QCOMPARE(
+        ClipboardChunk::assemble(&stream, transfer, receivedId, receivedSequence), TransferState::InProgress
+    );
+    QCOMPARE(receivedId, id);
+    QCOMPARE(receivedSequence, sequence);
+  }
+  QCOMPARE(transfer.m_data, mockData);
+}
+
+void ClipboardChunksTests::compressedChunk_roundTrip()
+{
+  ClipboardID id = 0;
+  uint32_t sequence = 3;
+  std::string mockData;
+  for (int i = 0; mockData.size() < 40 * 1024; ++i) {
+    mockData += "line " + std::to_string(i) + " of some clipboard text\n";
+  }
+
+  TestStream stream;
+  sendChunk(stream, ClipboardChunk::start(id, sequence, std::to_string(mockData.size())));
+  size_t wireSize = 0;
+  for (size_t offset = 0; offset < mockData.size(); offset += s_clipboardCompressBlockSize) {
+    const auto block = std::string_view(mockData).substr(offset, s_clipboardCompressBlockSize);
+    std::string compressed;
+    QVERIFY(ClipboardChunk::compress(block, compressed));
+    sendChunk(stream, ClipboardChunk::compressed(id, sequence, compressed));
+    wireSize += stream.m_messages.back().size();
+    QCOMPARE(stream.m_messages.back()[9], ChunkType::DataCompressedChunk);
+  }
+  sendChunk(stream, ClipboardChunk::end(id, sequence));
+
+  // one message a block, together much smaller than the text
+  QCOMPARE(stream.m_messages.size(), 5u);
+  QVERIFY(wireSize < mockData.size() / 3);
+
+  ClipboardTransfer transfer;
+  QCOMPARE(receiveAll(stream, transfer), TransferState::Finished);
+  QCOMPARE(transfer.m_data, mockData);
+}
+
+void ClipboardChunksTests::compressedChunk_incompressible()
+{
+  std::string mockData(4 * 1024, '\0');
+  uint32_t value = 1;
+  for (auto &c : mockData) {
+    value = value * 1103515245 + 12345;
+    c = static_cast<char>(value >> 24);
+  }
+
+  std::string compressed("unchanged");
+  QVERIFY(!ClipboardChunk::compress(mockData, compressed));
+  QCOMPARE(compressed, std::string("unchanged"));
+}
+
+void ClipboardChunksTests::assemble_overLimit()
+{
+  ClipboardID id = 0;
+  uint32_t sequence = 4;
+  std::string mockData(2048, 'a');
+
+  TestStream stream;
+  sendChunk(stream, ClipboardChunk::start(id, sequence, std::to_string(mockData.size())));
+  sendChunk(stream, ClipboardChunk::data(id, sequence, mockData));
+  sendChunk(stream, ClipboardChunk::end(id, sequence));
+
+  // every message of the transfer is dropped, and nothing is kept
+  ClipboardTransfer transfer;
+  QCOMPARE(receiveAll(stream, transfer, 1024), TransferState::Error);
+  QVERIFY(transfer.m_data.empty());
+
+  // the next transfer within the limit is received
+  sendChunk(stream, ClipboardChunk::start(id, sequence, "3"));
+  sendChunk(stream, ClipboardChunk::data(id, sequence, "abc"));
+  sendChunk(stream, ClipboardChunk::end(id, sequence));
+  QCOMPARE(receiveAll(stream, transfer, 1024), TransferState::Finished);
+  QCOMPARE(transfer.m_data, std::string("abc"));
+}
+
+void ClipboardChunksTests::assemble_compressedOverSize()
+{
+  ClipboardID id = 0;
+  uint32_t sequence = 5;
+  std::string compressed;
+  QVERIFY(ClipboardChunk::compress(std::string(s_clipboardCompressBlockSize, 'a'), compressed));
+
+  // a small transfer can't be made to hold a large block
+  TestStream stream;
+  sendChunk(stream, ClipboardChunk::start(id, sequence, "100"));
+  sendChunk(stream, ClipboardChunk::compressed(id, sequence, compressed));
+  ClipboardTransfer transfer;
+  QCOMPARE(receiveAll(stream, transfer), TransferState::Error);
+  QVERIFY(transfer.m_data.empty());
+
+  // nor can a block say it's smaller than it is
+  compressed[3] = 100;
+  compressed[2] = 0;
+  sendChunk(stream, ClipboardChunk::start(id, sequence, "1000"));
+  sendChunk(stream, ClipboardChunk::compressed(id, sequence, compressed));
+  QCOMPARE(receiveAll(stream, transfer), TransferState::Error);
+  QVERIFY(transfer.m_data.empty());
+}
+
+void ClipboardChunksTests::assemble_dataOverSize()
+{
+  ClipboardID id = 0;
+  uint32_t sequence = 6;
+
+  // a transfer can't send more data than its first chunk said
+  TestStream stream;
+  sendChunk(stream, ClipboardChunk::start(id, sequence, "3"));
+  sendChunk(stream, ClipboardChunk::data(id, sequence, "abc"));
+  sendChunk(stream, ClipboardChunk::data(id, sequence, "def"));
+  sendChunk(stream, ClipboardChunk::end(id, sequence));
+  ClipboardTransfer transfer;
+  QCOMPARE(receiveAll(stream, transfer), TransferState::Error);
+  QVERIFY(transfer.m_data.empty());
+}
+
+void ClipboardChunksTests::assemble_transfersAreSeparate()
+{
+  ClipboardID id = 0;
+  uint32_t sequence = 7;
+
+  // one receiver dropping a transfer over its limit
+  TestStream dropped;
+  sendChunk(dropped, ClipboardChunk::start(id, sequence, "2048"));
+  ClipboardTransfer droppedTransfer;
+  QCOMPARE(receiveAll(dropped, droppedTransfer, 1024), TransferState::Error);
+
+  // doesn't drop another's
+  TestStream received;
+  sendChunk(received, ClipboardChunk::start(id, sequence, "3"));
+  ClipboardTransfer receivedTransfer;
+  QCOMPARE(receiveAll(received, receivedTransfer), TransferState::Started);
+  sendChunk(dropped, ClipboardChunk::data(id, sequence, std::string(2048, 'a')));
+  QCOMPARE(receiveAll(dropped, droppedTransfer, 1024), TransferState::Error);
+  sendChunk(received, ClipboardChunk::data(id, sequence, "abc"));
+  sendChunk(received, ClipboardChunk::end(id, sequence));
+  QCOMPARE(receiveAll(received, receivedTransfer), TransferState::Finished);
+  QCOMPARE(receivedTransfer.m_data, std::string("abc"));
+}
+
 QTEST_MAIN(ClipboardChunksTests)
@@ -4,6 +4,9 @@
  * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
  */
 
+#include "arch/Arch.h"
+#include "base/Log.h"
+
 #include <QTest>
 
 class ClipboardChunksTests : public QObject
@@ -11,7 +14,19 @@ class ClipboardChunksTests : public QObject
   Q_OBJECT
 private Q_SLOTS:
   // Test are run in order top to bottom
+  void initTestCase();
   void startFormatData();
   void formatDataChunk();
   void endFormatData();
+  void sendDataChunk_slices();
+  void compressedChunk_roundTrip();
+  void compressedChunk_incompressible();
+  void assemble_overLimit();
+  void assemble_compressedOverSize();
+  void assemble_dataOverSize();
+  void assemble_transfersAreSeparate();
+
+private:
+  Arch m_arch;
+  Log m_log;
 };
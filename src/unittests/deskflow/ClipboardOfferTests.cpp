@@ -0,0 +1,90 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include "ClipboardOfferTests.h"
+
+#include "deskflow/Clipboard.h"
+#include "deskflow/ClipboardOffer.h"
+
+#include <string>
+
+namespace {
+
+std::string marshall(const std::string &text, const std::string &html = "")
+{
+  Clipboard clipboard;
+  clipboard.open(0);
+  clipboard.add(IClipboard::Format::Text, text);
+  if (!html.empty()) {
+    clipboard.add(IClipboard::Format::HTML, html);
+  }
+  clipboard.close();
+  return clipboard.marshall();
+}
+
+} // namespace
+
+void ClipboardOfferTests::fromData_listsFormats()
+{
+  const std::string data = marshall("Hello World", "<b>Hello</b> World");
+  const auto offer = ClipboardOffer::fromData(data);
+
+  QCOMPARE(offer.getItems().size(), 2u);
+  QCOMPARE(offer.getItems()[0].m_format, IClipboard::Format::Text);
+  QCOMPARE(offer.getItems()[0].m_size, 11u);
+  QCOMPARE(offer.getItems()[1].m_format, IClipboard::Format::HTML);
+  QCOMPARE(offer.getItems()[1].m_size, 18u);
+  QCOMPARE(offer.getSize(), data.size());
+  QVERIFY(offer.getDigest() == ClipboardOffer::hash(data));
+}
+
+void ClipboardOfferTests::encode_roundTrips()
+{
+  const auto offer = ClipboardOffer::fromData(marshall("Hello World"));
+  const std::vector<uint32_t> expected = {static_cast<uint32_t>(IClipboard::Format::Text), 11};
+  QCOMPARE(offer.encode(), expected);
+
+  ClipboardOffer decoded;
+  QVERIFY(ClipboardOffer::decode(offer.getDigest(), offer.encode(), decoded));
+  QVERIFY(decoded.getDigest() == offer.getDigest());
+  QCOMPARE(decoded.getSize(), offer.getSize());
+  QVERIFY(decoded.getFormats() == std::vector<IClipboard::Format>{IClipboard::Format::Text});
+}
+
+void ClipboardOfferTests::decode_rejectsOddList()
+{
+  ClipboardOffer offer;
+  QVERIFY(!ClipboardOffer::decode({}, {0, 11, 1}, offer));
+}
+
+void ClipboardOfferTests::decode_skipsUnknownFormats()
+{
+  ClipboardOffer offer;
+  QVERIFY(ClipboardOffer::decode({}, {0, 11, 99, 5}, offer));
+  QCOMPARE(offer.getItems().size(), 1u);
+  QCOMPARE(offer.getItems()[0].m_format, IClipboard::Format::Text);
+
+  // the data still has the formats left out, for the size limit
+  QCOMPARE(offer.getSize(), 4u + 8u + 11u + 8u + 5u);
+}
+
+void ClipboardOfferTests::matches_onlySameData()
+{
+  const std::string data = marshall("Hello World");
+  const auto offer = ClipboardOffer::fromData(data);
+
+  QVERIFY(offer.matches(data));
+  QVERIFY(!offer.matches(marshall("Hello Worle")));
+  QVERIFY(!offer.matches(marshall("Hello")));
+  QVERIFY(!offer.matches(""));
+
+  // the digest is truncated SHA-256, as the protocol reference's example
+  // has it
+  const ClipboardOffer::Digest expected = {0x3cef6306, 0x1cf007c7, 0x6f5e2eee, 0xfad41980};
+  QVERIFY(ClipboardOffer::hash(data) == expected);
+}
+
+QTEST_MAIN(ClipboardOfferTests)
@@ -0,0 +1,18 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include <QTest>
+
+class ClipboardOfferTests : public QObject
+{
+  Q_OBJECT
+private Q_SLOTS:
+  void fromData_listsFormats();
+  void encode_roundTrips();
+  void decode_rejectsOddList();
+  void decode_skipsUnknownFormats();
+  void matches_onlySameData();
+};
@@ -0,0 +1,109 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include "FastChannelTests.h"
+
+#include "deskflow/FastChannel.h"
+
+#include <string>
+
+namespace {
+
+std::span<const uint8_t> bytes(const std::string &data)
+{
+  return {reinterpret_cast<const uint8_t *>(data.data()), data.size()};
+}
+
+std::string text(std::span<const uint8_t> data)
+{
+  return {reinterpret_cast<const char *>(data.data()), data.size()};
+}
+
+// a datagram with any sequence number
+std::string datagram(uint32_t token, uint32_t sequence, const std::string &message)
+{
+  std::string out;
+  for (const uint32_t value : {token, sequence}) {
+    out.push_back(static_cast<char>(value >> 24));
+    out.push_back(static_cast<char>(value >> 16));
+    out.push_back(static_cast<char>(value >> 8));
+    out.push_back(static_cast<char>(value));
+  }
+  return out + message;
+}
+
+} // namespace
+
+void FastChannelTests::frame_roundTrips()
+{
+  FastChannel sender(0x12345678);
+  FastChannel receiver(0x12345678);
+
+  const std::string message("DMWM\x00\x01\x00\x02", 8);
+  const std::string framed = sender.frame(bytes(message));
+  QCOMPARE(framed, datagram(0x12345678, 1, message));
+
+  std::span<const uint8_t> received;
+  QVERIFY(receiver.accept(bytes(framed), received));
+  QCOMPARE(text(received), message);
+  QCOMPARE(sender.frame(bytes(message)), datagram(0x12345678, 2, message));
+}
+
+void FastChannelTests::accept_dropsOlder()
+{
+  FastChannel receiver(7);
+  std::span<const uint8_t> message;
+
+  // a gap is fine, a lost datagram only loses itself
+  QVERIFY(receiver.accept(bytes(datagram(7, 1, "DMMB")), message));
+  QVERIFY(receiver.accept(bytes(datagram(7, 3, "DMMB")), message));
+
+  // but a late one, or a duplicate, would undo a newer one
+  QVERIFY(!receiver.accept(bytes(datagram(7, 2, "DMMB")), message));
+  QVERIFY(!receiver.accept(bytes(datagram(7, 3, "DMMB")), message));
+  QCOMPARE(receiver.getDropped(), 2u);
+  QVERIFY(receiver.accept(bytes(datagram(7, 4, "DMMB")), message));
+}
+
+void FastChannelTests::accept_followsWraparound()
+{
+  FastChannel receiver(7);
+  std::span<const uint8_t> message;
+
+  QVERIFY(receiver.accept(bytes(datagram(7, 0x7ffffff0, "DMMB")), message));
+  QVERIFY(receiver.accept(bytes(datagram(7, 0xbffffff0, "DMMB")), message));
+  QVERIFY(receiver.accept(bytes(datagram(7, 0xfffffffe, "DMMB")), message));
+  QVERIFY(receiver.accept(bytes(datagram(7, 1, "DMMB")), message));
+  QVERIFY(!receiver.accept(bytes(datagram(7, 0xffffffff, "DMMB")), message));
+}
+
+void FastChannelTests::accept_rejectsOtherChannels()
+{
+  FastChannel receiver(7);
+  std::span<const uint8_t> message;
+
+  QVERIFY(!receiver.accept(bytes(datagram(8, 1, "DMMB")), message));
+  QVERIFY(!receiver.accept(bytes("short"), message));
+  QVERIFY(!receiver.accept(bytes(FastChannel::hello(7)), message));
+  QCOMPARE(receiver.getDropped(), 0u);
+  QVERIFY(receiver.accept(bytes(datagram(7, 1, "DMMB")), message));
+}
+
+void FastChannelTests::hello_isRecognized()
+{
+  const std::string hello = FastChannel::hello(0xcafef00d);
+  QCOMPARE(hello.size(), static_cast<size_t>(FastChannel::kHeaderSize));
+  QVERIFY(FastChannel::isHello(bytes(hello)));
+  QVERIFY(!FastChannel::isHello(bytes(datagram(0xcafef00d, 1, "DMMB"))));
+
+  uint32_t token;
+  uint32_t sequence;
+  QVERIFY(FastChannel::parseHeader(bytes(hello), token, sequence));
+  QCOMPARE(token, 0xcafef00du);
+  QCOMPARE(sequence, 0u);
+}
+
+QTEST_MAIN(FastChannelTests)
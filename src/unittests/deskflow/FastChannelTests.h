@@ -0,0 +1,18 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include <QTest>
+
+class FastChannelTests : public QObject
+{
+  Q_OBJECT
+private Q_SLOTS:
+  void frame_roundTrips();
+  void accept_dropsOlder();
+  void accept_followsWraparound();
+  void accept_rejectsOtherChannels();
+  void hello_isRecognized();
+};
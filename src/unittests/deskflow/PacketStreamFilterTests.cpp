@@ -0,0 +1,298 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include "PacketStreamFilterTests.h"
+
+#include "base/EventQueue.h"
+#include "deskflow/PacketStreamFilter.h"
+#include "deskflow/ProtocolMessages.h"
+#include "io/IStream.h"
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <vector>
+
+namespace {
+
+//! Records what's written to it, one string per write, and reads back m_input
+class TestStream : public deskflow::IStream
+{
+public:
+  void close() override
+  {
+    // do nothing
+  }
+
+  uint32_t read(void *buffer, uint32_t n) override
+  {
+    n = std::min(n, static_cast<uint32_t>(m_input.size()));
+    m_input.copy(static_cast<char *>(buffer), n);
+    m_input.erase(0, n);
+    return n;
+  }
+
+  void write(const void *buffer, uint32_t n) override
+  {
+    m_writes.emplace_back(static_cast<const char *>(buffer), n);
+  }
+
+  void writeBulk(const void *buffer, uint32_t n) override
+  {
+    m_writes.emplace_back(static_cast<const char *>(buffer), n);
+    ++m_bulkWrites;
+  }
+
+  void cork() override
+  {
+    ++m_corked;
+  }
+
+  void uncork() override
+  {
+    --m_corked;
+  }
+
+  void flush() override
+  {
+    // do nothing
+  }
+
+  void shutdownInput() override
+  {
+    // do nothing
+  }
+
+  void shutdownOutput() override
+  {
+    // do nothing
+  }
+
+  void *getEventTarget() const override
+  {
+    return const_cast<TestStream *>(this);
+  }
+
+  bool isReady() const override
+  {
+    return false;
+  }
+
+  uint32_t getSize() const override
+  {
+    return 0;
+  }
+
+  std::string m_input;
+  std::vector<std::string> m_writes;
+  int m_bulkWrites = 0;
+  int m_corked = 0;
+};
+
+std::string packet(const std::string &payload)
+{
+  const auto size = static_cast<uint32_t>(payload.size());
+  std::string packet{
+      static_cast<char>(size >> 24), static_cast<char>(size >> 16), static_cast<char>(size >> 8),
+      static_cast<char>(size)
+  };
+  return packet + payload;
+}
+
+// a burst of mouse motion
+std::string motion()
+{
+  std::string burst;
+  for (int16_t i = 0; i < 1000; ++i) {
+    const auto message = MsgDMouseMove::encode(i, -i);
+    burst += packet(std::string(message.begin(), message.end()));
+  }
+  return burst;
+}
+
+} // namespace
+
+void PacketStreamFilterTests::initTestCase()
+{
+  m_arch.init();
+  m_log.setFilter(LogLevel::Info);
+}
+
+void PacketStreamFilterTests::writeBulk_keepsPacketsWhole()
+{
+  EventQueue events;
+  TestStream stream;
+  PacketStreamFilter filter(&events, &stream, false);
+
+  // the first packet goes straight down in one write
+  const std::string a(10 * 1024, 'a');
+  const std::string b(10 * 1024, 'b');
+  const std::string c(10 * 1024, 'c');
+  filter.writeBulk(a.data(), static_cast<uint32_t>(a.size()));
+  filter.writeBulk(b.data(), static_cast<uint32_t>(b.size()));
+  filter.writeBulk(c.data(), static_cast<uint32_t>(c.size()));
+  QCOMPARE(stream.m_writes.size(), 1u);
+  QCOMPARE(stream.m_writes[0], packet(a));
+
+  // the rest waits until that's been flushed, then goes down together
+  events.dispatchEvent(Event(EventTypes::StreamOutputFlushed, stream.getEventTarget()));
+  QCOMPARE(stream.m_writes.size(), 3u);
+  QCOMPARE(stream.m_writes[1], packet(b));
+  QCOMPARE(stream.m_writes[2], packet(c));
+  QCOMPARE(stream.m_bulkWrites, 3);
+}
+
+void PacketStreamFilterTests::write_goesAheadOfBulk()
+{
+  EventQueue events;
+  TestStream stream;
+  PacketStreamFilter filter(&events, &stream, false);
+
+  // a big clipboard in small messages
+  const std::string slice(16 * 1024, 'x');
+  for (int i = 0; i < 64; ++i) {
+    filter.writeBulk(slice.data(), static_cast<uint32_t>(slice.size()));
+  }
+  QCOMPARE(stream.m_writes.size(), 1u);
+
+  // a message written now only waits behind what's already gone down
+  const std::string motion = "DMMV";
+  filter.write(motion.data(), static_cast<uint32_t>(motion.size()));
+  QCOMPARE(stream.m_writes.size(), 2u);
+  QCOMPARE(stream.m_writes[1], packet(motion));
+
+  // and the clipboard follows a message at a time
+  while (stream.m_bulkWrites < 64) {
+    const auto writes = stream.m_writes.size();
+    events.dispatchEvent(Event(EventTypes::StreamOutputFlushed, stream.getEventTarget()));
+    QCOMPARE(stream.m_writes.size(), writes + 1);
+    QCOMPARE(stream.m_writes.back(), packet(slice));
+  }
+
+  // nothing more to send
+  events.dispatchEvent(Event(EventTypes::StreamOutputFlushed, stream.getEventTarget()));
+  QCOMPARE(stream.m_bulkWrites, 64);
+}
+
+void PacketStreamFilterTests::write_sendsPacketInOneWrite()
+{
+  EventQueue events;
+  TestStream stream;
+  PacketStreamFilter filter(&events, &stream, false);
+
+  // the length and payload go down together, whatever the size
+  const std::string small = "DMMV1234";
+  const std::string large(64 * 1024, 'x');
+  filter.write(small.data(), static_cast<uint32_t>(small.size()));
+  filter.write(large.data(), static_cast<uint32_t>(large.size()));
+  filter.write(nullptr, 0);
+  filter.writeLatest(small.data(), static_cast<uint32_t>(small.size()));
+  QCOMPARE(stream.m_writes.size(), 4u);
+  QCOMPARE(stream.m_writes[0], packet(small));
+  QCOMPARE(stream.m_writes[1], packet(large));
+  QCOMPARE(stream.m_writes[2], packet(""));
+  QCOMPARE(stream.m_writes[3], packet(small));
+}
+
+void PacketStreamFilterTests::cork_reachesStream()
+{
+  EventQueue events;
+  TestStream stream;
+  PacketStreamFilter filter(&events, &stream, false);
+
+  filter.cork();
+  filter.cork();
+  QCOMPARE(stream.m_corked, 2);
+  filter.uncork();
+  filter.uncork();
+  QCOMPARE(stream.m_corked, 0);
+}
+
+void PacketStreamFilterTests::peekPackets_returnsWholePackets()
+{
+  EventQueue events;
+  TestStream stream;
+  PacketStreamFilter filter(&events, &stream, false);
+
+  // two whole packets and most of a third
+  stream.m_input = packet("DMMV1234") + packet("CNOP") + packet("DKDN123456").substr(0, 13);
+  events.dispatchEvent(Event(EventTypes::StreamInputReady, stream.getEventTarget()));
+
+  std::array<std::span<const uint8_t>, 8> packets;
+  auto toString = [](std::span<const uint8_t> packet) {
+    return std::string(reinterpret_cast<const char *>(packet.data()), packet.size());
+  };
+  QCOMPARE(filter.peekPackets(packets), 2u);
+  QCOMPARE(toString(packets[0]), std::string("DMMV1234"));
+  QCOMPARE(toString(packets[1]), std::string("CNOP"));
+
+  // no more than asked for, and nothing's removed until popped
+  QCOMPARE(filter.peekPackets(std::span(packets).first(1)), 1u);
+  QCOMPARE(toString(packets[0]), std::string("DMMV1234"));
+  filter.popPackets(1);
+  QCOMPARE(filter.peekPackets(packets), 1u);
+  QCOMPARE(toString(packets[0]), std::string("CNOP"));
+
+  // the rest of the third
+  stream.m_input = "6";
+  events.dispatchEvent(Event(EventTypes::StreamInputReady, stream.getEventTarget()));
+  QCOMPARE(filter.peekPackets(packets), 2u);
+  QCOMPARE(toString(packets[1]), std::string("DKDN123456"));
+
+  // what's left can still be read
+  filter.popPackets(1);
+  char code[4];
+  QCOMPARE(filter.read(code, sizeof(code)), 4u);
+  QCOMPARE(std::string(code, 4), std::string("DKDN"));
+  QCOMPARE(filter.peekPackets(packets), 1u);
+  QCOMPARE(toString(packets[0]), std::string("123456"));
+  filter.popPackets(1);
+  QCOMPARE(filter.peekPackets(packets), 0u);
+  QVERIFY(!filter.isReady());
+}
+
+void PacketStreamFilterTests::mouseMove_read_benchmark()
+{
+  EventQueue events;
+  TestStream stream;
+  PacketStreamFilter filter(&events, &stream, false);
+  const auto burst = motion();
+  int16_t x = 0;
+  int16_t y = 0;
+  QBENCHMARK {
+    stream.m_input = burst;
+    events.dispatchEvent(Event(EventTypes::StreamInputReady, stream.getEventTarget()));
+    uint8_t code[4];
+    while (filter.read(code, 4) == 4) {
+      MsgDMouseMove::read(&filter, x, y);
+    }
+  }
+  QCOMPARE(x, 999);
+}
+
+void PacketStreamFilterTests::mouseMove_peekPackets_benchmark()
+{
+  EventQueue events;
+  TestStream stream;
+  PacketStreamFilter filter(&events, &stream, false);
+  const auto burst = motion();
+  int16_t x = 0;
+  int16_t y = 0;
+  std::array<std::span<const uint8_t>, 64> packets;
+  QBENCHMARK {
+    stream.m_input = burst;
+    events.dispatchEvent(Event(EventTypes::StreamInputReady, stream.getEventTarget()));
+    for (auto count = filter.peekPackets(packets); count > 0; count = filter.peekPackets(packets)) {
+      for (uint32_t i = 0; i < count; ++i) {
+        MsgDMouseMove::decode(packets[i].data() + 4, static_cast<uint32_t>(packets[i].size()) - 4, x, y);
+      }
+      filter.popPackets(count);
+    }
+  }
+  QCOMPARE(x, 999);
+}
+
+QTEST_MAIN(PacketStreamFilterTests)
@@ -0,0 +1,28 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include "arch/Arch.h"
+#include "base/Log.h"
+
+#include <QTest>
+
+class PacketStreamFilterTests : public QObject
+{
+  Q_OBJECT
+private Q_SLOTS:
+  void initTestCase();
+  void writeBulk_keepsPacketsWhole();
+  void write_goesAheadOfBulk();
+  void write_sendsPacketInOneWrite();
+  void cork_reachesStream();
+  void peekPackets_returnsWholePackets();
+  void mouseMove_read_benchmark();
+  void mouseMove_peekPackets_benchmark();
+
+private:
+  Arch m_arch;
+  Log m_log;
+};
@@ -0,0 +1,481 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include "ProtocolMessagesTests.h"
+
+#include "deskflow/MessageTable.h"
+#include "deskflow/MotionBatch.h"
+#include "deskflow/ProtocolMessages.h"
+#include "deskflow/ProtocolUtil.h"
+#include "io/IStream.h"
+#include "io/StreamBuffer.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+//! Reads back what's written to it
+class TestStream : public deskflow::IStream
+{
+public:
+  void close() override
+  {
+    // do nothing
+  }
+
+  uint32_t read(void *buffer, uint32_t n) override
+  {
+    n = std::min(n, m_buffer.getSize());
+    if (buffer != nullptr) {
+      memcpy(buffer, m_buffer.peek(n), n);
+    }
+    m_buffer.pop(n);
+    return n;
+  }
+
+  void write(const void *buffer, uint32_t n) override
+  {
+    m_buffer.write(buffer, n);
+  }
+
+  void flush() override
+  {
+    // do nothing
+  }
+
+  void shutdownInput() override
+  {
+    // do nothing
+  }
+
+  void shutdownOutput() override
+  {
+    // do nothing
+  }
+
+  void *getEventTarget() const override
+  {
+    return const_cast<TestStream *>(this);
+  }
+
+  bool isReady() const override
+  {
+    return m_buffer.getSize() > 0;
+  }
+
+  uint32_t getSize() const override
+  {
+    return m_buffer.getSize();
+  }
+
+  std::string getData()
+  {
+    return std::string(static_cast<const char *>(m_buffer.peek(m_buffer.getSize())), m_buffer.getSize());
+  }
+
+  //! Skip a message code
+  void skipCode()
+  {
+    m_buffer.pop(4);
+  }
+
+private:
+  StreamBuffer m_buffer;
+};
+
+// messages per benchmark iteration
+const int s_messages = 1000;
+
+// the codes the client reads once connected, in the order it checks them
+const char *const s_codes[] = {
+    kMsgDMouseMove,
+    kMsgDMouseRelMove,
+    kMsgDMouseMotion,
+    kMsgDMouseWheel,
+    kMsgDKeyDown,
+    kMsgDKeyDownLang,
+    kMsgDKeyUp,
+    kMsgDMouseDown,
+    kMsgDMouseUp,
+    kMsgDKeyRepeat,
+    kMsgCKeepAlive,
+    kMsgCFastChannel,
+    kMsgCNoop,
+    kMsgCEnter,
+    kMsgCLeave,
+    kMsgCClipboard,
+    kMsgCScreenSaver,
+    kMsgQInfo,
+    kMsgCInfoAck,
+    kMsgDClipboard,
+    kMsgCResetOptions,
+};
+
+// a mix of codes like a session sends them, mostly motion
+const char *const s_traffic[] = {
+    kMsgDMouseMove,
+    kMsgDMouseMove,
+    kMsgDMouseMove,
+    kMsgDMouseMove,
+    kMsgDMouseMove,
+    kMsgDMouseMove,
+    kMsgDKeyDownLang,
+    kMsgDKeyUp,
+    kMsgDMouseDown,
+    kMsgDMouseUp,
+    kMsgCKeepAlive,
+    kMsgDMouseRelMove,
+    kMsgCEnter,
+    kMsgCLeave,
+    kMsgCClipboard,
+    kMsgDClipboard,
+};
+
+} // namespace
+
+void ProtocolMessagesTests::initTestCase()
+{
+  m_arch.init();
+  m_log.setFilter(LogLevel::Info);
+}
+
+void ProtocolMessagesTests::write_matchesWritef()
+{
+  TestStream expected;
+  TestStream actual;
+  const std::string lang = "de";
+
+  ProtocolUtil::writef(&expected, kMsgDMouseMove, -2, 300);
+  MsgDMouseMove::write(&actual, -2, 300);
+  ProtocolUtil::writef(&expected, kMsgDMouseRelMove, 5, -7);
+  MsgDMouseRelMove::write(&actual, 5, -7);
+  ProtocolUtil::writef(&expected, kMsgDMouseDown, 3);
+  MsgDMouseDown::write(&actual, 3);
+  ProtocolUtil::writef(&expected, kMsgDMouseWheel, 0, -120);
+  MsgDMouseWheel::write(&actual, 0, -120);
+  ProtocolUtil::writef(&expected, kMsgDKeyDown, 0xefe1, 0x2000, 50);
+  MsgDKeyDown::write(&actual, 0xefe1, 0x2000, 50);
+  ProtocolUtil::writef(&expected, kMsgDKeyDownLang, 'a', 0, 38, &lang);
+  MsgDKeyDownLang::write(&actual, 'a', 0, 38, lang);
+  ProtocolUtil::writef(&expected, kMsgDKeyRepeat, 'a', 0, 4, 38, &lang);
+  MsgDKeyRepeat::write(&actual, 'a', 0, 4, 38, lang);
+  ProtocolUtil::writef(&expected, kMsgCKeepAlive);
+  MsgCKeepAlive::write(&actual);
+  std::vector<uint32_t> options = {0x4d444c54, 1, 0x48425254, 3000};
+  ProtocolUtil::writef(&expected, kMsgDSetOptions, &options);
+  MsgDSetOptions::write(&actual, options);
+  ProtocolUtil::writef(&expected, kMsgDDragInfo, 2, &lang);
+  MsgDDragInfo::write(&actual, 2, lang);
+
+  QCOMPARE(actual.getData(), expected.getData());
+}
+
+void ProtocolMessagesTests::read_matchesReadf()
+{
+  TestStream stream;
+  const std::string lang = "de";
+  ProtocolUtil::writef(&stream, kMsgDMouseMove, -2, 300);
+  ProtocolUtil::writef(&stream, kMsgDKeyRepeat, 0xefe1, 0x2000, 4, 38, &lang);
+
+  int16_t x = 0;
+  int16_t y = 0;
+  stream.skipCode();
+  QVERIFY(MsgDMouseMove::read(&stream, x, y));
+  QCOMPARE(x, -2);
+  QCOMPARE(y, 300);
+
+  uint16_t id = 0;
+  uint16_t mask = 0;
+  uint16_t count = 0;
+  uint16_t button = 0;
+  std::string language;
+  stream.skipCode();
+  QVERIFY(MsgDKeyRepeat::read(&stream, id, mask, count, button, language));
+  QCOMPARE(id, 0xefe1);
+  QCOMPARE(mask, 0x2000);
+  QCOMPARE(count, 4);
+  QCOMPARE(button, 38);
+  QCOMPARE(language, lang);
+
+  std::vector<uint32_t> options = {0x4d444c54, 1, 0x48425254, 3000};
+  std::vector<uint32_t> actual;
+  ProtocolUtil::writef(&stream, kMsgDSetOptions, &options);
+  stream.skipCode();
+  QVERIFY(MsgDSetOptions::read(&stream, actual));
+  QCOMPARE(actual, options);
+  QCOMPARE(stream.getSize(), 0u);
+}
+
+void ProtocolMessagesTests::read_failsAtEnd()
+{
+  // a message with the last byte missing
+  TestStream full;
+  MsgDKeyDownLang::write(&full, 'a', 0, 38, std::string("de"));
+  const auto data = full.getData();
+  TestStream stream;
+  stream.write(data.data() + 4, static_cast<uint32_t>(data.size()) - 5);
+
+  uint16_t id = 0;
+  uint16_t mask = 0;
+  uint16_t button = 0;
+  std::string lang;
+  QVERIFY(!MsgDKeyDownLang::read(&stream, id, mask, button, lang));
+
+  int16_t x = 0;
+  int16_t y = 0;
+  QVERIFY(!MsgDMouseMove::read(&stream, x, y));
+}
+
+void ProtocolMessagesTests::decode_rejectsLongString()
+{
+  const uint32_t size = PROTOCOL_MAX_STRING_LENGTH + 1;
+  const uint8_t data[] = {
+      0, 1, 0, 2, 0, 3, static_cast<uint8_t>(size >> 24), static_cast<uint8_t>(size >> 16),
+      static_cast<uint8_t>(size >> 8), static_cast<uint8_t>(size)
+  };
+
+  uint16_t id = 0;
+  uint16_t mask = 0;
+  uint16_t button = 0;
+  std::string lang;
+  QVERIFY_THROWS_EXCEPTION(BadClientException, MsgDKeyDownLang::decode(data, sizeof(data), id, mask, button, lang));
+
+  // and a string that's cut short
+  QVERIFY(!MsgDKeyDownLang::decode(data, 6, id, mask, button, lang));
+}
+
+void ProtocolMessagesTests::motionBatch_roundTrips()
+{
+  // the example in ProtocolTypes.h
+  MotionBatch batch;
+  batch.add({0, false, 400, 300});
+  batch.add({1000, false, 401, 302});
+  QCOMPARE(batch.getData(), std::string("\x00\xA0\x06\xD8\x04\xD0\x0F\x02\x04", 9));
+
+  // relative moves don't change where absolute ones are counted from
+  const std::vector<MotionBatch::Sample> expected = {
+      {0, false, 400, 300},
+      {1000, false, 401, 302},
+      {125, true, -5, 7},
+      {125, false, 399, 310},
+      {UINT32_MAX, false, INT32_MIN, INT32_MAX},
+      {0, true, INT32_MAX, INT32_MIN},
+  };
+  batch.clear();
+  for (const auto &sample : expected) {
+    batch.add(sample);
+  }
+  QCOMPARE(batch.getCount(), 6u);
+
+  std::vector<MotionBatch::Sample> samples;
+  QVERIFY(MotionBatch::decode(batch.getData(), samples));
+  QCOMPARE(samples.size(), expected.size());
+  for (size_t i = 0; i < samples.size(); ++i) {
+    QCOMPARE(samples[i].m_offset, expected[i].m_offset);
+    QCOMPARE(samples[i].m_relative, expected[i].m_relative);
+    QCOMPARE(samples[i].m_x, expected[i].m_x);
+    QCOMPARE(samples[i].m_y, expected[i].m_y);
+  }
+
+  // and it goes in a message like any other string
+  TestStream stream;
+  MsgDMouseMotion::write(&stream, batch.getData());
+  stream.skipCode();
+  std::string data;
+  QVERIFY(MsgDMouseMotion::read(&stream, data));
+  QCOMPARE(data, batch.getData());
+}
+
+void ProtocolMessagesTests::motionBatch_rejectsPartSample()
+{
+  MotionBatch batch;
+  batch.add({1000, false, 400, 300});
+  const std::string data = batch.getData();
+
+  std::vector<MotionBatch::Sample> samples;
+  for (size_t size = 1; size < data.size(); ++size) {
+    QVERIFY(!MotionBatch::decode(std::string_view(data).substr(0, size), samples));
+  }
+
+  // nor a position that doesn't fit
+  QVERIFY(!MotionBatch::decode(std::string("\x00\x80\x80\x80\x80\x80\x01\x00", 8), samples));
+}
+
+void ProtocolMessagesTests::messageTable_findsEveryCode()
+{
+  MessageTable<const char *> table;
+  for (const auto *code : s_codes) {
+    table.set(messageKey(reinterpret_cast<const uint8_t *>(code)), code);
+  }
+
+  for (const auto *code : s_codes) {
+    QCOMPARE(table.find(reinterpret_cast<const uint8_t *>(code)), code);
+  }
+  QCOMPARE(table.find(reinterpret_cast<const uint8_t *>(kMsgDSetOptions)), nullptr);
+  QCOMPARE(table.find(reinterpret_cast<const uint8_t *>("XXXX")), nullptr);
+
+  // a newer handler replaces the older one
+  table.set(MsgCNoop::kKey, kMsgCClose);
+  QCOMPARE(table.find(reinterpret_cast<const uint8_t *>(kMsgCNoop)), kMsgCClose);
+}
+
+void ProtocolMessagesTests::mouseMove_writef_benchmark()
+{
+  TestStream stream;
+  QBENCHMARK {
+    for (int i = 0; i < s_messages; ++i) {
+      ProtocolUtil::writef(&stream, kMsgDMouseMove, i, -i);
+    }
+    stream.read(nullptr, stream.getSize());
+  }
+}
+
+void ProtocolMessagesTests::mouseMove_write_benchmark()
+{
+  TestStream stream;
+  QBENCHMARK {
+    for (int i = 0; i < s_messages; ++i) {
+      MsgDMouseMove::write(&stream, i, -i);
+    }
+    stream.read(nullptr, stream.getSize());
+  }
+}
+
+void ProtocolMessagesTests::mouseMove_readf_benchmark()
+{
+  TestStream stream;
+  int16_t x = 0;
+  int16_t y = 0;
+  QBENCHMARK {
+    for (int i = 0; i < s_messages; ++i) {
+      MsgDMouseMove::write(&stream, i, -i);
+    }
+    for (int i = 0; i < s_messages; ++i) {
+      stream.skipCode();
+      ProtocolUtil::readf(&stream, kMsgDMouseMove + 4, &x, &y);
+    }
+  }
+  QCOMPARE(y, -(s_messages - 1));
+}
+
+void ProtocolMessagesTests::mouseMove_read_benchmark()
+{
+  TestStream stream;
+  int16_t x = 0;
+  int16_t y = 0;
+  QBENCHMARK {
+    for (int i = 0; i < s_messages; ++i) {
+      MsgDMouseMove::write(&stream, i, -i);
+    }
+    for (int i = 0; i < s_messages; ++i) {
+      stream.skipCode();
+      MsgDMouseMove::read(&stream, x, y);
+    }
+  }
+  QCOMPARE(y, -(s_messages - 1));
+}
+
+void ProtocolMessagesTests::keyDown_writef_benchmark()
+{
+  TestStream stream;
+  const std::string lang = "en";
+  QBENCHMARK {
+    for (int i = 0; i < s_messages; ++i) {
+      ProtocolUtil::writef(&stream, kMsgDKeyDownLang, i, 0, 38, &lang);
+    }
+    stream.read(nullptr, stream.getSize());
+  }
+}
+
+void ProtocolMessagesTests::keyDown_write_benchmark()
+{
+  TestStream stream;
+  const std::string lang = "en";
+  QBENCHMARK {
+    for (int i = 0; i < s_messages; ++i) {
+      MsgDKeyDownLang::write(&stream, i, 0, 38, lang);
+    }
+    stream.read(nullptr, stream.getSize());
+  }
+}
+
+void ProtocolMessagesTests::keyDown_readf_benchmark()
+{
+  TestStream stream;
+  uint16_t id = 0;
+  uint16_t mask = 0;
+  uint16_t button = 0;
+  std::string lang;
+  QBENCHMARK {
+    for (int i = 0; i < s_messages; ++i) {
+      MsgDKeyDownLang::write(&stream, i, 0, 38, std::string("en"));
+    }
+    for (int i = 0; i < s_messages; ++i) {
+      stream.skipCode();
+      ProtocolUtil::readf(&stream, kMsgDKeyDownLang + 4, &id, &mask, &button, &lang);
+    }
+  }
+  QCOMPARE(id, s_messages - 1);
+}
+
+void ProtocolMessagesTests::keyDown_read_benchmark()
+{
+  TestStream stream;
+  uint16_t id = 0;
+  uint16_t mask = 0;
+  uint16_t button = 0;
+  std::string lang;
+  QBENCHMARK {
+    for (int i = 0; i < s_messages; ++i) {
+      MsgDKeyDownLang::write(&stream, i, 0, 38, std::string("en"));
+    }
+    for (int i = 0; i < s_messages; ++i) {
+      stream.skipCode();
+      MsgDKeyDownLang::read(&stream, id, mask, button, lang);
+    }
+  }
+  QCOMPARE(id, s_messages - 1);
+}
+
+void ProtocolMessagesTests::dispatch_memcmp_benchmark()
+{
+  size_t found = 0;
+  QBENCHMARK {
+    for (int i = 0; i < s_messages; ++i) {
+      const auto *code = s_traffic[i % std::size(s_traffic)];
+      for (const auto *candidate : s_codes) {
+        if (memcmp(code, candidate, 4) == 0) {
+          ++found;
+          break;
+        }
+      }
+    }
+  }
+  QVERIFY(found > 0);
+}
+
+void ProtocolMessagesTests::dispatch_table_benchmark()
+{
+  MessageTable<const char *> table;
+  for (const auto *code : s_codes) {
+    table.set(messageKey(reinterpret_cast<const uint8_t *>(code)), code);
+  }
+
+  size_t found = 0;
+  QBENCHMARK {
+    for (int i = 0; i < s_messages; ++i) {
+      const auto *code = s_traffic[i % std::size(s_traffic)];
+      if (table.find(reinterpret_cast<const uint8_t *>(code)) != nullptr) {
+        ++found;
+      }
+    }
+  }
+  QVERIFY(found > 0);
+}
+
+QTEST_MAIN(ProtocolMessagesTests)
@@ -0,0 +1,38 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include "arch/Arch.h"
+#include "base/Log.h"
+
+#include <QTest>
+
+class ProtocolMessagesTests : public QObject
+{
+  Q_OBJECT
+private Q_SLOTS:
+  void initTestCase();
+  void write_matchesWritef();
+  void read_matchesReadf();
+  void read_failsAtEnd();
+  void decode_rejectsLongString();
+  void motionBatch_roundTrips();
+  void motionBatch_rejectsPartSample();
+  void messageTable_findsEveryCode();
+  void mouseMove_writef_benchmark();
+  void mouseMove_write_benchmark();
+  void mouseMove_readf_benchmark();
+  void mouseMove_read_benchmark();
+  void keyDown_writef_benchmark();
+  void keyDown_write_benchmark();
+  void keyDown_readf_benchmark();
+  void keyDown_read_benchmark();
+  void dispatch_memcmp_benchmark();
+  void dispatch_table_benchmark();
+
+private:
+  Arch m_arch;
+  Log m_log;
+};
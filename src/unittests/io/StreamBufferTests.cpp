@@ -0,0 +1,178 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include "StreamBufferTests.h"
+
+#include "io/StreamBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+std::vector<uint8_t> makeData(size_t size, uint8_t seed = 0)
+{
+  std::vector<uint8_t> data(size);
+  for (size_t i = 0; i < size; ++i) {
+    data[i] = static_cast<uint8_t>(i * 7 + seed);
+  }
+  return data;
+}
+
+// leaves the buffer holding bytes that wrap around the end of its ring
+std::vector<uint8_t> fillWrapped(StreamBuffer &buffer)
+{
+  const auto discarded = makeData(3000);
+  buffer.write(discarded.data(), static_cast<uint32_t>(discarded.size()));
+  buffer.pop(2000);
+
+  auto data = makeData(3000, 1);
+  buffer.write(data.data(), static_cast<uint32_t>(data.size()));
+  data.insert(data.begin(), discarded.begin() + 2000, discarded.end());
+  return data;
+}
+
+// the way a big message arrives from a socket and is then parsed
+void transfer(StreamBuffer &buffer, const std::vector<uint8_t> &data)
+{
+  static const uint32_t kReadSize = 4096;
+  const size_t size = data.size();
+
+  for (size_t i = 0; i < size; i += kReadSize) {
+    const auto n = static_cast<uint32_t>(std::min<size_t>(kReadSize, size - i));
+    buffer.write(data.data() + i, n);
+  }
+  if (memcmp(buffer.peek(buffer.getSize()), data.data(), size) != 0) {
+    QFAIL("data mismatch");
+  }
+  buffer.pop(buffer.getSize());
+}
+
+} // namespace
+
+void StreamBufferTests::write_readsBackInOrder()
+{
+  StreamBuffer buffer;
+  const auto data = makeData(10000);
+  buffer.write(data.data(), 6000);
+  buffer.write(data.data() + 6000, 4000);
+  QCOMPARE(buffer.getSize(), 10000u);
+
+  std::vector<uint8_t> read(data.size());
+  buffer.read(read.data(), 100);
+  buffer.read(read.data() + 100, 9900);
+  QCOMPARE(buffer.getSize(), 0u);
+  QVERIFY(read == data);
+}
+
+void StreamBufferTests::peek_joinsWrappedData()
+{
+  StreamBuffer buffer;
+  const auto data = fillWrapped(buffer);
+
+  const auto *peeked = static_cast<const uint8_t *>(buffer.peek(buffer.getSize()));
+  QVERIFY(memcmp(peeked, data.data(), data.size()) == 0);
+  QCOMPARE(buffer.getSize(), static_cast<uint32_t>(data.size()));
+}
+
+void StreamBufferTests::getReadViews_wrapped()
+{
+  StreamBuffer buffer;
+  const auto data = fillWrapped(buffer);
+
+  const auto views = buffer.getReadViews();
+  QVERIFY(!views[0].empty());
+  QVERIFY(!views[1].empty());
+  QCOMPARE(views[0].size() + views[1].size(), data.size());
+  QVERIFY(memcmp(views[0].data(), data.data(), views[0].size()) == 0);
+  QVERIFY(memcmp(views[1].data(), data.data() + views[0].size(), views[1].size()) == 0);
+}
+
+void StreamBufferTests::reserve_commit()
+{
+  StreamBuffer buffer;
+  const auto data = fillWrapped(buffer);
+  const auto more = makeData(5000, 2);
+
+  // space for at least as much as was asked for, wrapping if need be
+  auto views = buffer.reserve(static_cast<uint32_t>(more.size()));
+  QVERIFY(views[0].size() + views[1].size() >= more.size());
+  const auto first = std::min(views[0].size(), more.size());
+  memcpy(views[0].data(), more.data(), first);
+  memcpy(views[1].data(), more.data() + first, more.size() - first);
+  buffer.commit(static_cast<uint32_t>(more.size()));
+
+  std::vector<uint8_t> read(data.size() + more.size());
+  buffer.read(read.data(), static_cast<uint32_t>(read.size()));
+  QVERIFY(memcmp(read.data(), data.data(), data.size()) == 0);
+  QVERIFY(memcmp(read.data() + data.size(), more.data(), more.size()) == 0);
+}
+
+void StreamBufferTests::pop_all()
+{
+  StreamBuffer buffer;
+  const auto data = makeData(1024 * 1024);
+  buffer.write(data.data(), static_cast<uint32_t>(data.size()));
+  buffer.pop(buffer.getSize() + 1);
+  QCOMPARE(buffer.getSize(), 0u);
+  QVERIFY(buffer.getReadViews()[0].empty());
+
+  // still usable afterwards
+  buffer.write(data.data(), 10);
+  QCOMPARE(buffer.getSize(), 10u);
+  QVERIFY(memcmp(buffer.peek(10), data.data(), 10) == 0);
+}
+
+void StreamBufferTests::popBack_wrapped()
+{
+  StreamBuffer buffer;
+  auto data = fillWrapped(buffer);
+
+  // replace the end, which is in the wrapped part
+  const auto views = buffer.getReadViews();
+  const auto n = static_cast<uint32_t>(views[1].size() + 10);
+  buffer.popBack(n);
+  QCOMPARE(buffer.getSize(), static_cast<uint32_t>(data.size() - n));
+
+  const std::vector<uint8_t> end(n, 0xab);
+  buffer.write(end.data(), n);
+  std::copy(end.begin(), end.end(), data.end() - n);
+  QCOMPARE(buffer.getSize(), static_cast<uint32_t>(data.size()));
+  QVERIFY(memcmp(buffer.peek(buffer.getSize()), data.data(), data.size()) == 0);
+}
+
+void StreamBufferTests::peek_1MB_benchmark()
+{
+  const auto data = makeData(1024 * 1024);
+  StreamBuffer buffer;
+  QBENCHMARK {
+    transfer(buffer, data);
+  }
+}
+
+void StreamBufferTests::peek_16MB_benchmark()
+{
+  const auto data = makeData(16 * 1024 * 1024);
+  StreamBuffer buffer;
+  QBENCHMARK {
+    transfer(buffer, data);
+  }
+}
+
+void StreamBufferTests::stream_benchmark()
+{
+  // small messages passing through, as with mouse motion
+  StreamBuffer buffer;
+  const auto data = makeData(16);
+  uint8_t read[16];
+  QBENCHMARK {
+    buffer.write(data.data(), sizeof(read));
+    buffer.read(read, sizeof(read));
+  }
+}
+
+QTEST_MAIN(StreamBufferTests)
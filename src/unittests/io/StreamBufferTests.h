@@ -0,0 +1,22 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include <QTest>
+
+class StreamBufferTests : public QObject
+{
+  Q_OBJECT
+private Q_SLOTS:
+  void write_readsBackInOrder();
+  void peek_joinsWrappedData();
+  void getReadViews_wrapped();
+  void reserve_commit();
+  void pop_all();
+  void popBack_wrapped();
+  void peek_1MB_benchmark();
+  void peek_16MB_benchmark();
+  void stream_benchmark();
+};
@@ -25,8 +25,10 @@ public:
   MOCK_METHOD(void, addHandler, (EventTypes, void *, const EventHandler &), (override));
   MOCK_METHOD(void, addEvent, (const Event &), (override));
   MOCK_METHOD(void, removeHandler, (EventTypes, void *), (override));
+  MOCK_METHOD(void, setCoalescer, (EventTypes, const EventCoalescer &), (override));
   MOCK_METHOD(bool, dispatchEvent, (const Event &), (override));
   MOCK_METHOD(void, deleteTimer, (EventQueueTimer *), (override));
+  MOCK_METHOD(void, resetTimer, (EventQueueTimer *, double), (override));
   MOCK_METHOD(void *, getSystemTarget, (), (override));
   MOCK_METHOD(void, waitForReady, (), (const, override));
 };
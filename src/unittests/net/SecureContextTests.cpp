@@ -0,0 +1,121 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include "SecureContextTests.h"
+
+#include "net/SecureContext.h"
+#include "net/SecureUtils.h"
+
+#include <QDir>
+#include <QFile>
+
+namespace {
+
+// runs a handshake in memory and reads what the server sends after it,
+// which includes its session tickets.  returns true if the session resumed.
+bool connect(SecureContext &client, SecureContext &server, bool &resumed)
+{
+  SSL *clientSsl = client.newSsl();
+  SSL *serverSsl = server.newSsl();
+  if (clientSsl == nullptr || serverSsl == nullptr) {
+    SSL_free(clientSsl);
+    SSL_free(serverSsl);
+    return false;
+  }
+
+  BIO *clientBio = nullptr;
+  BIO *serverBio = nullptr;
+  BIO_new_bio_pair(&clientBio, 0, &serverBio, 0);
+  SSL_set_bio(clientSsl, clientBio, clientBio);
+  SSL_set_bio(serverSsl, serverBio, serverBio);
+  SSL_set_connect_state(clientSsl);
+  SSL_set_accept_state(serverSsl);
+
+  bool connected = false;
+  for (int i = 0; i < 10 && !connected; ++i) {
+    const int clientResult = SSL_do_handshake(clientSsl);
+    const int serverResult = SSL_do_handshake(serverSsl);
+    connected = (clientResult == 1 && serverResult == 1);
+  }
+
+  if (connected) {
+    const char hello = 'h';
+    char read = 0;
+    size_t n = 0;
+    connected = SSL_write_ex(serverSsl, &hello, 1, &n) == 1 && SSL_read_ex(clientSsl, &read, 1, &n) == 1;
+    resumed = (SSL_session_reused(clientSsl) == 1 && SSL_session_reused(serverSsl) == 1);
+  }
+
+  SSL_shutdown(clientSsl);
+  SSL_shutdown(serverSsl);
+  SSL_free(clientSsl);
+  SSL_free(serverSsl);
+  return connected;
+}
+
+} // namespace
+
+void SecureContextTests::initTestCase()
+{
+  m_arch.init();
+  m_log.setFilter(LogLevel::Debug2);
+
+  QDir dir;
+  QVERIFY(dir.mkpath("tmp/test"));
+  deskflow::generatePemSelfSignedCert(m_certFile.toStdString());
+}
+
+void SecureContextTests::cleanupTestCase()
+{
+  QFile::remove(m_certFile);
+}
+
+void SecureContextTests::loadCertificates_missingFile()
+{
+  SecureContext context(true, SecurityLevel::Encrypted);
+
+  QVERIFY(!context.loadCertificates(""));
+  QVERIFY(!context.loadCertificates("tmp/test/missing.pem"));
+  QVERIFY(context.loadCertificates(m_certFile.toStdString()));
+}
+
+void SecureContextTests::newSsl_resumesSession()
+{
+  SecureContext server(true, SecurityLevel::Encrypted);
+  SecureContext client(false, SecurityLevel::Encrypted);
+  QVERIFY(server.loadCertificates(m_certFile.toStdString()));
+
+  bool resumed = true;
+  QVERIFY(connect(client, server, resumed));
+  QVERIFY(!resumed);
+
+  // a reconnecting client skips the full handshake
+  QVERIFY(connect(client, server, resumed));
+  QVERIFY(resumed);
+
+  // but not with a server that didn't issue its ticket
+  SecureContext otherServer(true, SecurityLevel::Encrypted);
+  QVERIFY(otherServer.loadCertificates(m_certFile.toStdString()));
+  QVERIFY(connect(client, otherServer, resumed));
+  QVERIFY(!resumed);
+}
+
+void SecureContextTests::newSsl_resumesPeerAuthSession()
+{
+  SecureContext server(true, SecurityLevel::PeerAuth);
+  SecureContext client(false, SecurityLevel::PeerAuth);
+  QVERIFY(server.loadCertificates(m_certFile.toStdString()));
+  QVERIFY(client.loadCertificates(m_certFile.toStdString()));
+
+  bool resumed = true;
+  QVERIFY(connect(client, server, resumed));
+  QVERIFY(!resumed);
+
+  QVERIFY(connect(client, server, resumed));
+  QVERIFY(resumed);
+}
+
+QTEST_MAIN(SecureContextTests)
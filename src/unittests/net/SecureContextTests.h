@@ -0,0 +1,26 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include "arch/Arch.h"
+#include "base/Log.h"
+
+#include <QTest>
+
+class SecureContextTests : public QObject
+{
+  Q_OBJECT
+private Q_SLOTS:
+  void initTestCase();
+  void cleanupTestCase();
+  void loadCertificates_missingFile();
+  void newSsl_resumesSession();
+  void newSsl_resumesPeerAuthSession();
+
+private:
+  Arch m_arch;
+  Log m_log;
+  inline static const QString m_certFile = QStringLiteral("tmp/test/tls.pem");
+};
@@ -0,0 +1,250 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include "SocketMultiplexerTests.h"
+
+#include "base/Stopwatch.h"
+#include "net/ISocket.h"
+#include "net/ISocketMultiplexerJob.h"
+#include "net/SocketMultiplexer.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace {
+
+class TestSocket : public ISocket
+{
+public:
+  TestSocket() : m_socket(ARCH->newSocket(IArchNetwork::AddressFamily::INet, IArchNetwork::SocketType::DataGram))
+  {
+    // do nothing
+  }
+  TestSocket(TestSocket const &) = delete;
+  TestSocket &operator=(TestSocket const &) = delete;
+  ~TestSocket() override
+  {
+    ARCH->closeSocket(m_socket);
+  }
+
+  void bind(const NetworkAddress &) override
+  {
+    // do nothing
+  }
+
+  void close() override
+  {
+    // do nothing
+  }
+
+  void *getEventTarget() const override
+  {
+    return const_cast<TestSocket *>(this);
+  }
+
+  // an unbound datagram socket is always writable and never readable
+  ArchSocket m_socket;
+};
+
+class TestJob : public ISocketMultiplexerJob
+{
+public:
+  using Run = std::function<ISocketMultiplexerJob *(TestJob *)>;
+
+  TestJob(ArchSocket socket, bool readable, bool writable, const Run &run = {})
+      : m_socket(ARCH->copySocket(socket)),
+        m_readable(readable),
+        m_writable(writable),
+        m_run(run)
+  {
+    // do nothing
+  }
+  TestJob(TestJob const &) = delete;
+  TestJob &operator=(TestJob const &) = delete;
+  ~TestJob() override
+  {
+    ARCH->closeSocket(m_socket);
+    if (m_deleted != nullptr) {
+      *m_deleted = true;
+    }
+  }
+
+  ISocketMultiplexerJob *run(bool, bool, bool) override
+  {
+    ++*m_runs;
+    return m_run ? m_run(this) : this;
+  }
+
+  ArchSocket getSocket() const override
+  {
+    return m_socket;
+  }
+
+  bool isReadable() const override
+  {
+    return m_readable;
+  }
+
+  bool isWritable() const override
+  {
+    return m_writable;
+  }
+
+  bool setInterest(bool readable, bool writable)
+  {
+    const bool readableChanged = (m_readable.exchange(readable) != readable);
+    const bool writableChanged = (m_writable.exchange(writable) != writable);
+    return readableChanged || writableChanged;
+  }
+
+  std::shared_ptr<std::atomic<int>> m_runs = std::make_shared<std::atomic<int>>(0);
+  std::shared_ptr<std::atomic<bool>> m_deleted;
+
+private:
+  ArchSocket m_socket;
+  std::atomic<bool> m_readable;
+  std::atomic<bool> m_writable;
+  Run m_run;
+};
+
+bool waitFor(const std::function<bool()> &condition, double timeout = 5.0)
+{
+  Stopwatch timer;
+  while (!condition()) {
+    if (timer.getTime() > timeout) {
+      return false;
+    }
+    Arch::sleep(0.001);
+  }
+  return true;
+}
+
+} // namespace
+
+void SocketMultiplexerTests::initTestCase()
+{
+  m_arch.init();
+  m_log.setFilter(LogLevel::Debug2);
+}
+
+void SocketMultiplexerTests::addSocket_runsOnlyReadyJobs()
+{
+  SocketMultiplexer multiplexer;
+
+  // lots of sockets that never become ready
+  std::vector<std::unique_ptr<TestSocket>> idleSockets(100);
+  std::vector<std::shared_ptr<std::atomic<int>>> idleRuns;
+  for (auto &socket : idleSockets) {
+    socket = std::make_unique<TestSocket>();
+    auto *job = new TestJob(socket->m_socket, true, false);
+    idleRuns.push_back(job->m_runs);
+    multiplexer.addSocket(socket.get(), job);
+  }
+
+  // and one that's ready until its job has run a few times
+  TestSocket socket;
+  auto *job = new TestJob(socket.m_socket, false, true, [](TestJob *job) {
+    return (*job->m_runs < 3) ? job : nullptr;
+  });
+  auto runs = job->m_runs;
+  multiplexer.addSocket(&socket, job);
+
+  QVERIFY(waitFor([&runs] { return *runs == 3; }));
+  Arch::sleep(0.05);
+  QCOMPARE(runs->load(), 3);
+  for (const auto &idle : idleRuns) {
+    QCOMPARE(idle->load(), 0);
+  }
+
+  for (auto &idle : idleSockets) {
+    multiplexer.removeSocket(idle.get());
+  }
+}
+
+void SocketMultiplexerTests::run_changesInterest()
+{
+  SocketMultiplexer multiplexer;
+  TestSocket socket;
+
+  // a writable job replaced by one that only reads
+  auto *readJob = new TestJob(socket.m_socket, true, false);
+  auto readRuns = readJob->m_runs;
+  auto *writeJob = new TestJob(socket.m_socket, false, true, [readJob](TestJob *) { return readJob; });
+  auto writeRuns = writeJob->m_runs;
+  auto writeDeleted = std::make_shared<std::atomic<bool>>(false);
+  writeJob->m_deleted = writeDeleted;
+  multiplexer.addSocket(&socket, writeJob);
+
+  QVERIFY(waitFor([&writeDeleted] { return writeDeleted->load(); }));
+  Arch::sleep(0.05);
+  QCOMPARE(writeRuns->load(), 1);
+  QCOMPARE(readRuns->load(), 0);
+
+  // and back to writable
+  auto *newWriteJob = new TestJob(socket.m_socket, false, true);
+  auto newWriteRuns = newWriteJob->m_runs;
+  multiplexer.addSocket(&socket, newWriteJob);
+  QVERIFY(waitFor([&newWriteRuns] { return *newWriteRuns > 0; }));
+
+  multiplexer.removeSocket(&socket);
+}
+
+void SocketMultiplexerTests::removeSocket_stopsJob()
+{
+  SocketMultiplexer multiplexer;
+  TestSocket socket;
+
+  // a job that is always ready
+  auto *job = new TestJob(socket.m_socket, false, true);
+  auto runs = job->m_runs;
+  auto deleted = std::make_shared<std::atomic<bool>>(false);
+  job->m_deleted = deleted;
+  multiplexer.addSocket(&socket, job);
+  QVERIFY(waitFor([&runs] { return *runs > 10; }));
+
+  // once removed the job won't run again and is soon deleted
+  multiplexer.removeSocket(&socket);
+  const int count = *runs;
+  QVERIFY(waitFor([&deleted] { return deleted->load(); }));
+  QCOMPARE(runs->load(), count);
+}
+
+void SocketMultiplexerTests::updateJob_changesInterest()
+{
+  SocketMultiplexer multiplexer;
+  TestSocket socket;
+
+  // a job that loses interest each time it runs
+  auto *job = new TestJob(socket.m_socket, false, false, [&multiplexer](TestJob *job) {
+    if (job->setInterest(false, false)) {
+      multiplexer.updateJob(job);
+    }
+    return job;
+  });
+  auto runs = job->m_runs;
+  auto deleted = std::make_shared<std::atomic<bool>>(false);
+  job->m_deleted = deleted;
+  multiplexer.addSocket(&socket, job);
+  Arch::sleep(0.05);
+  QCOMPARE(runs->load(), 0);
+
+  // the same job is run again each time it's interested
+  for (int i = 1; i <= 3; ++i) {
+    if (job->setInterest(false, true)) {
+      multiplexer.updateJob(job);
+    }
+    QVERIFY(waitFor([&runs, i] { return *runs == i; }));
+  }
+  Arch::sleep(0.05);
+  QCOMPARE(runs->load(), 3);
+  QVERIFY(!deleted->load());
+
+  multiplexer.removeSocket(&socket);
+}
+
+QTEST_MAIN(SocketMultiplexerTests)
@@ -0,0 +1,25 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include "arch/Arch.h"
+#include "base/Log.h"
+
+#include <QTest>
+
+class SocketMultiplexerTests : public QObject
+{
+  Q_OBJECT
+private Q_SLOTS:
+  void initTestCase();
+  void addSocket_runsOnlyReadyJobs();
+  void run_changesInterest();
+  void removeSocket_stopsJob();
+  void updateJob_changesInterest();
+
+private:
+  Arch m_arch;
+  Log m_log;
+};
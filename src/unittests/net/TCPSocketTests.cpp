@@ -0,0 +1,275 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include "TCPSocketTests.h"
+
+#include "base/EventQueue.h"
+#include "base/FunctionJob.h"
+#include "base/Stopwatch.h"
+#include "mt/Lock.h"
+#include "mt/Thread.h"
+#include "net/NetworkAddress.h"
+#include "net/SocketException.h"
+#include "net/SocketMultiplexer.h"
+#include "net/TCPListenSocket.h"
+#include "net/TCPSocket.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+class TestTCPSocket : public TCPSocket
+{
+public:
+  using TCPSocket::TCPSocket;
+
+  bool isConnectedLocked()
+  {
+    Lock lock(&getMutex());
+    return isConnected();
+  }
+
+  uint32_t getOutputSize()
+  {
+    Lock lock(&getMutex());
+    return m_outputBuffer.getSize();
+  }
+};
+
+bool waitFor(const std::function<bool()> &condition, double timeout = 5.0)
+{
+  Stopwatch timer;
+  while (!condition()) {
+    if (timer.getTime() > timeout) {
+      return false;
+    }
+    Arch::sleep(0.001);
+  }
+  return true;
+}
+
+//! A client socket connected to a server socket over the loopback interface
+class Loopback
+{
+public:
+  Loopback()
+  {
+    m_events.waitForReady();
+
+    std::atomic<bool> connecting = false;
+    m_events.addHandler(EventTypes::ListenSocketConnecting, &m_listener, [&connecting](const auto &) {
+      connecting = true;
+    });
+
+    // try a few ports in case one is taken
+    std::mt19937 random{std::random_device{}()};
+    NetworkAddress address;
+    for (int i = 0; i < 10; ++i) {
+      address = NetworkAddress("127.0.0.1", std::uniform_int_distribution<int>(30000, 60000)(random));
+      address.resolve();
+      try {
+        m_listener.bind(address);
+        break;
+      } catch (const SocketAddressInUseException &) {
+        // try another
+      }
+    }
+
+    m_client.connect(address);
+    if (waitFor([&connecting] { return connecting.load(); })) {
+      m_server = m_listener.accept();
+    }
+    m_events.removeHandler(EventTypes::ListenSocketConnecting, &m_listener);
+    waitFor([this] { return m_client.isConnectedLocked(); });
+  }
+  Loopback(Loopback const &) = delete;
+  Loopback &operator=(Loopback const &) = delete;
+  ~Loopback()
+  {
+    m_server.reset();
+    m_client.close();
+    m_events.addEvent(Event(EventTypes::Quit));
+    m_loop.wait();
+  }
+
+  bool isConnected()
+  {
+    return m_server != nullptr && m_client.isConnectedLocked();
+  }
+
+  //! Read \p n bytes from the server end, waiting for them to arrive
+  bool read(void *buffer, uint32_t n)
+  {
+    auto *bytes = static_cast<uint8_t *>(buffer);
+    Stopwatch timer;
+    while (n > 0) {
+      const uint32_t got = m_server->read(bytes, n);
+      if (got == 0) {
+        if (timer.getTime() > 5.0) {
+          return false;
+        }
+        std::this_thread::yield();
+      }
+      bytes += got;
+      n -= got;
+    }
+    return true;
+  }
+
+  EventQueue m_events;
+  Thread m_loop{new FunctionJob([](void *events) { static_cast<EventQueue *>(events)->loop(); }, &m_events)};
+  SocketMultiplexer m_multiplexer;
+  TCPListenSocket m_listener{&m_events, &m_multiplexer, IArchNetwork::AddressFamily::INet};
+  TestTCPSocket m_client{&m_events, &m_multiplexer};
+  std::unique_ptr<IDataSocket> m_server;
+};
+
+} // namespace
+
+void TCPSocketTests::initTestCase()
+{
+  m_arch.init();
+  m_log.setFilter(LogLevel::Info);
+}
+
+void TCPSocketTests::write_sendsWhenIdle()
+{
+  Loopback loopback;
+  QVERIFY(loopback.isConnected());
+
+  // nothing is queued so the socket takes the message straight away
+  const std::string message = "hello, world";
+  loopback.m_client.write(message.data(), static_cast<uint32_t>(message.size()));
+  QCOMPARE(loopback.m_client.getOutputSize(), 0u);
+
+  std::string received(message.size(), '\0');
+  QVERIFY(loopback.read(received.data(), static_cast<uint32_t>(received.size())));
+  QCOMPARE(received, message);
+}
+
+void TCPSocketTests::write_queuesRemainder()
+{
+  Loopback loopback;
+  QVERIFY(loopback.isConnected());
+
+  // more than the socket buffers can hold while the server isn't reading
+  std::vector<uint8_t> data(16 * 1024 * 1024);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<uint8_t>(i * 7);
+  }
+  loopback.m_client.write(data.data(), static_cast<uint32_t>(data.size()));
+  QVERIFY(loopback.m_client.getOutputSize() > 0);
+  QVERIFY(loopback.m_client.getOutputSize() < data.size());
+
+  // what was queued follows what was sent
+  std::vector<uint8_t> received(data.size());
+  QVERIFY(loopback.read(received.data(), static_cast<uint32_t>(received.size())));
+  QVERIFY(received == data);
+  QVERIFY(waitFor([&loopback] { return loopback.m_client.getOutputSize() == 0; }));
+}
+
+void TCPSocketTests::replaceLatest_overwritesQueued()
+{
+  Loopback loopback;
+  QVERIFY(loopback.isConnected());
+
+  // nothing queued so nothing to replace
+  const std::string first = "DMMV1111";
+  loopback.m_client.writeLatest(first.data(), static_cast<uint32_t>(first.size()));
+  QVERIFY(!loopback.m_client.replaceLatest(first.data(), static_cast<uint32_t>(first.size())));
+
+  // queued behind more than the socket buffers can hold, latest wins,
+  // whatever its size
+  std::vector<uint8_t> data(16 * 1024 * 1024);
+  loopback.m_client.write(data.data(), static_cast<uint32_t>(data.size()));
+  const std::string second = "DMMV2222";
+  const std::string longer = "DMMB22223333";
+  const std::string third = "DMMV3333";
+  loopback.m_client.writeLatest(second.data(), static_cast<uint32_t>(second.size()));
+  QVERIFY(loopback.m_client.replaceLatest(longer.data(), static_cast<uint32_t>(longer.size())));
+  QVERIFY(loopback.m_client.replaceLatest(third.data(), static_cast<uint32_t>(third.size())));
+
+  // not once something else has been written after it
+  const std::string fourth = "DKDN";
+  loopback.m_client.write(fourth.data(), static_cast<uint32_t>(fourth.size()));
+  QVERIFY(!loopback.m_client.replaceLatest(second.data(), static_cast<uint32_t>(second.size())));
+
+  const std::string expected = first + std::string(data.size(), '\0') + third + fourth;
+  std::string received(expected.size(), '\0');
+  QVERIFY(loopback.read(received.data(), static_cast<uint32_t>(received.size())));
+  QVERIFY(received == expected);
+}
+
+void TCPSocketTests::cork_sendsTogether()
+{
+  Loopback loopback;
+  QVERIFY(loopback.isConnected());
+
+  // corked messages are held back, even when nothing else is queued
+  const std::string enter = "CINN";
+  const std::string latest = "DMMV1111";
+  const std::string replaced = "DMMV2222";
+  loopback.m_client.cork();
+  loopback.m_client.cork();
+  loopback.m_client.write(enter.data(), static_cast<uint32_t>(enter.size()));
+  loopback.m_client.writeLatest(latest.data(), static_cast<uint32_t>(latest.size()));
+  QVERIFY(loopback.m_client.replaceLatest(replaced.data(), static_cast<uint32_t>(replaced.size())));
+  QCOMPARE(loopback.m_client.getOutputSize(), 12u);
+
+  // until the outermost cork ends, then they go out together
+  loopback.m_client.uncork();
+  QCOMPARE(loopback.m_client.getOutputSize(), 12u);
+  loopback.m_client.uncork();
+  QCOMPARE(loopback.m_client.getOutputSize(), 0u);
+
+  const std::string expected = enter + replaced;
+  std::string received(expected.size(), '\0');
+  QVERIFY(loopback.read(received.data(), static_cast<uint32_t>(received.size())));
+  QCOMPARE(received, expected);
+
+  // and a write on its own isn't held back afterwards
+  loopback.m_client.write(enter.data(), static_cast<uint32_t>(enter.size()));
+  QCOMPARE(loopback.m_client.getOutputSize(), 0u);
+}
+
+void TCPSocketTests::write_benchmark()
+{
+  Loopback loopback;
+  QVERIFY(loopback.isConnected());
+
+  // time from writing a mouse motion sized message to the server having it
+  const uint8_t message[16] = {'D', 'M', 'M', 'V'};
+  uint8_t received[sizeof(message)];
+  QBENCHMARK {
+    loopback.m_client.write(message, sizeof(message));
+    if (!loopback.read(received, sizeof(received))) {
+      QFAIL("message not received");
+    }
+  }
+}
+
+void TCPSocketTests::write_16MB_benchmark()
+{
+  Loopback loopback;
+  QVERIFY(loopback.isConnected());
+
+  // a big clipboard going through both sockets' buffers
+  std::vector<uint8_t> data(16 * 1024 * 1024);
+  std::vector<uint8_t> received(data.size());
+  QBENCHMARK {
+    loopback.m_client.write(data.data(), static_cast<uint32_t>(data.size()));
+    if (!loopback.read(received.data(), static_cast<uint32_t>(received.size()))) {
+      QFAIL("data not received");
+    }
+  }
+}
+
+QTEST_MAIN(TCPSocketTests)
@@ -0,0 +1,27 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include "arch/Arch.h"
+#include "base/Log.h"
+
+#include <QTest>
+
+class TCPSocketTests : public QObject
+{
+  Q_OBJECT
+private Q_SLOTS:
+  void initTestCase();
+  void write_sendsWhenIdle();
+  void write_queuesRemainder();
+  void replaceLatest_overwritesQueued();
+  void cork_sendsTogether();
+  void write_benchmark();
+  void write_16MB_benchmark();
+
+private:
+  Arch m_arch;
+  Log m_log;
+};
@@ -0,0 +1,135 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include "UDPSocketTests.h"
+
+#include "base/EventQueue.h"
+#include "base/FunctionJob.h"
+#include "base/Stopwatch.h"
+#include "mt/Thread.h"
+#include "net/NetworkAddress.h"
+#include "net/SocketException.h"
+#include "net/SocketMultiplexer.h"
+#include "net/UDPSocket.h"
+
+#include <atomic>
+#include <functional>
+#include <random>
+#include <string>
+
+namespace {
+
+bool waitFor(const std::function<bool()> &condition, double timeout = 5.0)
+{
+  Stopwatch timer;
+  while (!condition()) {
+    if (timer.getTime() > timeout) {
+      return false;
+    }
+    Arch::sleep(0.001);
+  }
+  return true;
+}
+
+//! A client socket connected to a bound server socket over the loopback interface
+class Loopback
+{
+public:
+  Loopback()
+  {
+    m_events.waitForReady();
+    m_events.addHandler(EventTypes::DatagramSocketReady, &m_server, [this](const auto &) { ++m_ready; });
+
+    // try a few ports in case one is taken
+    std::mt19937 random{std::random_device{}()};
+    for (int i = 0; i < 10; ++i) {
+      m_address = NetworkAddress("127.0.0.1", std::uniform_int_distribution<int>(30000, 60000)(random));
+      m_address.resolve();
+      try {
+        m_server.bind(m_address);
+        m_bound = true;
+        break;
+      } catch (const SocketAddressInUseException &) {
+        // try another
+      }
+    }
+    m_client.connect(m_address);
+  }
+  Loopback(Loopback const &) = delete;
+  Loopback &operator=(Loopback const &) = delete;
+  ~Loopback()
+  {
+    m_events.removeHandler(EventTypes::DatagramSocketReady, &m_server);
+    m_events.addEvent(Event(EventTypes::Quit));
+    m_loop.wait();
+  }
+
+  EventQueue m_events;
+  Thread m_loop{new FunctionJob([](void *events) { static_cast<EventQueue *>(events)->loop(); }, &m_events)};
+  SocketMultiplexer m_multiplexer;
+  UDPSocket m_server{&m_events, &m_multiplexer, IArchNetwork::AddressFamily::INet};
+  UDPSocket m_client{&m_events, &m_multiplexer, IArchNetwork::AddressFamily::INet};
+  NetworkAddress m_address;
+  bool m_bound = false;
+  std::atomic<int> m_ready = 0;
+};
+
+} // namespace
+
+void UDPSocketTests::initTestCase()
+{
+  m_arch.init();
+  m_log.setFilter(LogLevel::Info);
+}
+
+void UDPSocketTests::send_receivesWithSender()
+{
+  Loopback loopback;
+  QVERIFY(loopback.m_bound);
+
+  const std::string hello = "hello";
+  QVERIFY(loopback.m_client.send(hello.data(), static_cast<uint32_t>(hello.size())));
+  QVERIFY(waitFor([&loopback] { return loopback.m_ready > 0; }));
+
+  char buffer[64];
+  NetworkAddress from;
+  const uint32_t size = loopback.m_server.receive(buffer, sizeof(buffer), &from);
+  QCOMPARE(std::string(buffer, size), hello);
+  QCOMPARE(loopback.m_server.receive(buffer, sizeof(buffer), nullptr), 0u);
+
+  // the reply goes back to the socket it came from
+  const std::string reply = "welcome";
+  QVERIFY(loopback.m_server.sendTo(reply.data(), static_cast<uint32_t>(reply.size()), from));
+  uint32_t replySize = 0;
+  QVERIFY(waitFor([&] { return (replySize = loopback.m_client.receive(buffer, sizeof(buffer), nullptr)) > 0; }));
+  QCOMPARE(std::string(buffer, replySize), reply);
+}
+
+void UDPSocketTests::receive_signalsAgainWhenEmpty()
+{
+  Loopback loopback;
+  QVERIFY(loopback.m_bound);
+
+  // not again while datagrams are left to read
+  const std::string first = "first";
+  const std::string second = "second";
+  QVERIFY(loopback.m_client.send(first.data(), static_cast<uint32_t>(first.size())));
+  QVERIFY(waitFor([&loopback] { return loopback.m_ready > 0; }));
+  QVERIFY(loopback.m_client.send(second.data(), static_cast<uint32_t>(second.size())));
+  Arch::sleep(0.05);
+  QCOMPARE(loopback.m_ready.load(), 1);
+
+  char buffer[64];
+  QCOMPARE(loopback.m_server.receive(buffer, sizeof(buffer), nullptr), 5u);
+  QVERIFY(waitFor([&] { return loopback.m_server.receive(buffer, sizeof(buffer), nullptr) == 6; }));
+  QCOMPARE(loopback.m_server.receive(buffer, sizeof(buffer), nullptr), 0u);
+
+  // but once they've all been read
+  QVERIFY(loopback.m_client.send(first.data(), static_cast<uint32_t>(first.size())));
+  QVERIFY(waitFor([&loopback] { return loopback.m_ready > 1; }));
+}
+
+QTEST_MAIN(UDPSocketTests)
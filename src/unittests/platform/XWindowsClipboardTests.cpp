@@ -9,6 +9,7 @@
 #include "XWindowsClipboardTests.h"
 
 #include "platform/XWindowsClipboard.h"
+#include "platform/XWindowsUtil.h"
 
 class TestXWindowsClipboard : public XWindowsClipboard
 {
@@ -61,17 +62,108 @@ void XWindowsClipboardTests::singleFormat()
 {
   auto &clipboard = getClipboard();
   QVERIFY(clipboard.empty());
-  clipboard.add(XWindowsClipboard::kText, m_testString);
-  QVERIFY(!clipboard.has(XWindowsClipboard::kText));
-  QCOMPARE(clipboard.get(XWindowsClipboard::kText), m_testString);
+  clipboard.add(IClipboard::Format::Text, m_testString);
+  QVERIFY(!clipboard.has(IClipboard::Format::Text));
+  QCOMPARE(clipboard.get(IClipboard::Format::Text), m_testString);
 
-  clipboard.add(XWindowsClipboard::kText, m_testString2);
-  QCOMPARE(clipboard.get(XWindowsClipboard::kText), m_testString2);
+  clipboard.add(IClipboard::Format::Text, m_testString2);
+  QCOMPARE(clipboard.get(IClipboard::Format::Text), m_testString2);
+}
+
+void XWindowsClipboardTests::offer_answersOnceAdded()
+{
+  auto &clipboard = getClipboard();
+  const Window requestor = createRequestor();
+  const Atom target = XInternAtom(m_display, "UTF8_STRING", False);
+  const Atom property = XInternAtom(m_display, "DESKFLOW_TEST", False);
+
+  // a request for an offered format waits for the data
+  QVERIFY(clipboard.open(XWindowsUtil::getCurrentTime(m_display, m_window)));
+  QVERIFY(clipboard.empty());
+  clipboard.offer(IClipboard::Format::Text);
+  clipboard.close();
+  clipboard.addRequest(m_window, requestor, target, CurrentTime, property);
+  QVERIFY(clipboard.takeDataRequest());
+  QVERIFY(!clipboard.takeDataRequest());
+  XSelectionEvent event;
+  QVERIFY(!takeNotify(requestor, event));
+
+  // and keeps waiting when the data is offered again
+  QVERIFY(clipboard.open(XWindowsUtil::getCurrentTime(m_display, m_window)));
+  QVERIFY(clipboard.empty());
+  clipboard.offer(IClipboard::Format::Text);
+  clipboard.close();
+  QVERIFY(clipboard.takeDataRequest());
+  QVERIFY(!takeNotify(requestor, event));
+
+  // the data is sent once it's added
+  QVERIFY(clipboard.open(XWindowsUtil::getCurrentTime(m_display, m_window)));
+  QVERIFY(clipboard.empty());
+  clipboard.add(IClipboard::Format::Text, m_testString);
+  clipboard.close();
+  clipboard.resolveRequests();
+  QVERIFY(takeNotify(requestor, event));
+  QCOMPARE(event.target, target);
+  QCOMPARE(event.property, property);
+  std::string data;
+  Atom type = None;
+  int32_t format = 0;
+  QVERIFY(XWindowsUtil::getWindowProperty(m_display, requestor, property, &data, &type, &format, true));
+  QCOMPARE(type, target);
+  QCOMPARE(data, m_testString);
+
+  XDestroyWindow(m_display, requestor);
+  clipboard.destroyRequest(requestor);
+}
+
+void XWindowsClipboardTests::offer_failsWhenLost()
+{
+  auto &clipboard = getClipboard();
+  const Window requestor = createRequestor();
+  const Atom target = XInternAtom(m_display, "UTF8_STRING", False);
+  const Atom property = XInternAtom(m_display, "DESKFLOW_TEST", False);
+
+  QVERIFY(clipboard.open(XWindowsUtil::getCurrentTime(m_display, m_window)));
+  QVERIFY(clipboard.empty());
+  clipboard.offer(IClipboard::Format::Text);
+  clipboard.close();
+  clipboard.addRequest(m_window, requestor, target, CurrentTime, property);
+  QVERIFY(clipboard.takeDataRequest());
+
+  // the data won't come once another client owns the clipboard, so the
+  // request fails rather than waiting forever
+  clipboard.lost(XWindowsUtil::getCurrentTime(m_display, m_window));
+  XSelectionEvent event;
+  QVERIFY(takeNotify(requestor, event));
+  QCOMPARE(event.target, target);
+  QCOMPARE(event.property, static_cast<Atom>(None));
+  QVERIFY(!clipboard.takeDataRequest());
+
+  XDestroyWindow(m_display, requestor);
+  clipboard.destroyRequest(requestor);
 }
 
 XWindowsClipboard &XWindowsClipboardTests::getClipboard()
 {
   return *m_clipboard;
 }
+
+Window XWindowsClipboardTests::createRequestor()
+{
+  const Window root = XRootWindow(m_display, DefaultScreen(m_display));
+  return XCreateWindow(m_display, root, 0, 0, 1, 1, 0, 0, InputOnly, nullptr, 0, nullptr);
+}
+
+bool XWindowsClipboardTests::takeNotify(Window requestor, XSelectionEvent &event)
+{
+  // the clipboard's notify goes to the requestor's creator, which is us
+  XSync(m_display, False);
+  XEvent xevent;
+  if (!XCheckTypedWindowEvent(m_display, requestor, SelectionNotify, &xevent)) {
+    return false;
+  }
+  event = xevent.xselection;
+  return true;
+}
 #endif
 QTEST_MAIN(XWindowsClipboardTests)
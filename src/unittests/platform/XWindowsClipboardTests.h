@@ -24,6 +24,8 @@ private Q_SLOTS:
   void cleanupTestCase();
   void open();
   void singleFormat();
+  void offer_answersOnceAdded();
+  void offer_failsWhenLost();
 #endif
 private:
   Arch m_arch;
@@ -34,6 +36,8 @@ private:
   Display *m_display;
   Window m_window;
   XWindowsClipboard &getClipboard();
+  Window createRequestor();
+  bool takeNotify(Window requestor, XSelectionEvent &event);
   std::unique_ptr<XWindowsClipboard> m_clipboard;
 #endif
 };
@@ -0,0 +1,119 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include "XWindowsEventQueueBufferTests.h"
+
+#include "base/EventQueue.h"
+#include "base/FunctionJob.h"
+#include "base/Stopwatch.h"
+#include "mt/Thread.h"
+#include "platform/XWindowsEventQueueBuffer.h"
+
+#include <atomic>
+#include <thread>
+
+void XWindowsEventQueueBufferTests::initTestCase()
+{
+  m_arch.init();
+  m_display = XOpenDisplay(nullptr);
+  if (m_display == nullptr) {
+    QSKIP("no X display available");
+  }
+}
+
+void XWindowsEventQueueBufferTests::cleanupTestCase()
+{
+  if (m_display != nullptr) {
+    XCloseDisplay(m_display);
+  }
+}
+
+void XWindowsEventQueueBufferTests::waitForEvent_timesOut()
+{
+  if (m_display == nullptr) {
+    QSKIP("no X display available");
+  }
+
+  EventQueue events;
+  XWindowsEventQueueBuffer buffer(m_display, &events);
+
+  Stopwatch timer;
+  buffer.waitForEvent(0.05);
+  QVERIFY(timer.getTime() >= 0.04);
+  QVERIFY(buffer.isEmpty());
+}
+
+void XWindowsEventQueueBufferTests::addEvent_wakesWaiter()
+{
+  if (m_display == nullptr) {
+    QSKIP("no X display available");
+  }
+
+  struct Wait
+  {
+    XWindowsEventQueueBuffer *m_buffer;
+    double m_woken;
+  };
+
+  EventQueue events;
+  XWindowsEventQueueBuffer buffer(m_display, &events);
+  Wait wait{&buffer, 0.0};
+  Thread waiter(new FunctionJob(
+      [](void *data) {
+        auto *wait = static_cast<Wait *>(data);
+        wait->m_buffer->waitForEvent(5.0);
+        wait->m_woken = Arch::time();
+      },
+      &wait
+  ));
+
+  // give the waiter time to block before waking it
+  Arch::sleep(0.05);
+  const double added = Arch::time();
+  buffer.addEvent(42);
+  waiter.wait();
+
+  // nothing polls, so the waiter wakes right away rather than at the
+  // end of a slice
+  QVERIFY(wait.m_woken - added < 0.01);
+
+  Event event;
+  uint32_t dataID = 0;
+  QCOMPARE(buffer.getEvent(event, dataID), IEventQueueBuffer::Type::User);
+  QCOMPARE(dataID, uint32_t(42));
+  QVERIFY(buffer.isEmpty());
+}
+
+void XWindowsEventQueueBufferTests::addEvent_benchmark()
+{
+  if (m_display == nullptr) {
+    QSKIP("no X display available");
+  }
+
+  EventQueue events;
+  events.adoptBuffer(new XWindowsEventQueueBuffer(m_display, &events));
+  std::atomic<uint32_t> handled = 0;
+  events.addHandler(EventTypes::StreamInputReady, nullptr, [&handled](const auto &) { ++handled; });
+
+  Thread loop(new FunctionJob([](void *events) { static_cast<EventQueue *>(events)->loop(); }, &events));
+  events.waitForReady();
+
+  // time from another thread adding an event to the loop handling it
+  uint32_t added = 0;
+  QBENCHMARK {
+    events.addEvent(Event(EventTypes::StreamInputReady));
+    ++added;
+    while (handled != added) {
+      std::this_thread::yield();
+    }
+  }
+
+  events.addEvent(Event(EventTypes::Quit));
+  loop.wait();
+  QCOMPARE(handled.load(), added);
+}
+
+QTEST_MAIN(XWindowsEventQueueBufferTests)
@@ -0,0 +1,29 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include "arch/Arch.h"
+#include "base/Log.h"
+
+#include <QTest>
+
+#include <X11/Xlib.h>
+
+class XWindowsEventQueueBufferTests : public QObject
+{
+  Q_OBJECT
+private Q_SLOTS:
+  // These tests need an X server, e.g. Xvfb
+  void initTestCase();
+  void cleanupTestCase();
+  void waitForEvent_timesOut();
+  void addEvent_wakesWaiter();
+  void addEvent_benchmark();
+
+private:
+  Arch m_arch;
+  Log m_log;
+  Display *m_display = nullptr;
+};
@@ -0,0 +1,871 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include "ClientProxyTests.h"
+
+#include "base/EventQueue.h"
+#include "base/FunctionJob.h"
+#include "base/Stopwatch.h"
+#include "deskflow/AppUtil.h"
+#include "deskflow/Clipboard.h"
+#include "deskflow/ClipboardOffer.h"
+#include "deskflow/FastChannel.h"
+#include "deskflow/IPlatformScreen.h"
+#include "deskflow/MotionBatch.h"
+#include "deskflow/ProtocolMessages.h"
+#include "deskflow/Screen.h"
+#include "io/IStream.h"
+#include "mt/Thread.h"
+#include "net/NetworkAddress.h"
+#include "net/SocketException.h"
+#include "net/SocketMultiplexer.h"
+#include "net/UDPSocket.h"
+#include "server/ClientProxy1_2.h"
+#include "server/ClientProxy1_3.h"
+#include "server/ClientProxy1_9.h"
+#include "server/FastChannelListener.h"
+#include "server/PrimaryClient.h"
+#include "server/Server.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+//! Records the messages written to it, which are unsent until send()
+class TestStream : public deskflow::IStream
+{
+public:
+  void close() override
+  {
+    // do nothing
+  }
+
+  uint32_t read(void *buffer, uint32_t n) override
+  {
+    n = std::min(n, static_cast<uint32_t>(m_input.size()));
+    if (buffer != nullptr) {
+      std::memcpy(buffer, m_input.data(), n);
+    }
+    m_input.erase(0, n);
+    return n;
+  }
+
+  void write(const void *buffer, uint32_t n) override
+  {
+    m_messages.emplace_back(static_cast<const char *>(buffer), n);
+    m_latest = false;
+  }
+
+  void writeLatest(const void *buffer, uint32_t n) override
+  {
+    write(buffer, n);
+    m_latest = true;
+  }
+
+  bool replaceLatest(const void *buffer, uint32_t n) override
+  {
+    if (!m_latest || m_sent == m_messages.size()) {
+      return false;
+    }
+    m_messages.back().assign(static_cast<const char *>(buffer), n);
+    return true;
+  }
+
+  void cork() override
+  {
+    ++m_corked;
+  }
+
+  void uncork() override
+  {
+    --m_corked;
+  }
+
+  void flush() override
+  {
+    // do nothing
+  }
+
+  void shutdownInput() override
+  {
+    // do nothing
+  }
+
+  void shutdownOutput() override
+  {
+    // do nothing
+  }
+
+  void *getEventTarget() const override
+  {
+    return const_cast<TestStream *>(this);
+  }
+
+  bool isReady() const override
+  {
+    return false;
+  }
+
+  uint32_t getSize() const override
+  {
+    return 0;
+  }
+
+  void send()
+  {
+    m_sent = m_messages.size();
+  }
+
+  void clear()
+  {
+    m_messages.clear();
+    m_sent = 0;
+    m_latest = false;
+  }
+
+  std::vector<std::string> m_messages;
+  int m_corked = 0;
+  std::string m_input;
+
+private:
+  size_t m_sent = 0;
+  bool m_latest = false;
+};
+
+//! A datagram socket that loses every nth datagram sent, or fails to send any
+class LossyDatagramSocket : public IDatagramSocket
+{
+public:
+  explicit LossyDatagramSocket(IDatagramSocket *socket) : m_socket(socket)
+  {
+    // do nothing
+  }
+
+  void bind(const NetworkAddress &address) override
+  {
+    m_socket->bind(address);
+  }
+
+  void close() override
+  {
+    m_socket->close();
+  }
+
+  void *getEventTarget() const override
+  {
+    return m_socket->getEventTarget();
+  }
+
+  void connect(const NetworkAddress &address) override
+  {
+    m_socket->connect(address);
+  }
+
+  bool send(const void *buffer, uint32_t n) override
+  {
+    if (m_fail) {
+      return false;
+    }
+    return isLost() || m_socket->send(buffer, n);
+  }
+
+  bool sendTo(const void *buffer, uint32_t n, const NetworkAddress &address) override
+  {
+    if (m_fail) {
+      return false;
+    }
+    return isLost() || m_socket->sendTo(buffer, n, address);
+  }
+
+  uint32_t receive(void *buffer, uint32_t n, NetworkAddress *from) override
+  {
+    return m_socket->receive(buffer, n, from);
+  }
+
+  uint32_t m_loseEvery = 0;
+  bool m_fail = false;
+  uint32_t m_sent = 0;
+
+private:
+  // a lost datagram was sent as far as the sender can tell
+  bool isLost()
+  {
+    ++m_sent;
+    return m_loseEvery != 0 && m_sent % m_loseEvery == 0;
+  }
+
+  std::unique_ptr<IDatagramSocket> m_socket;
+};
+
+//! Waits up to \p timeout seconds for \p condition
+bool waitFor(const std::function<bool()> &condition, double timeout = 5.0)
+{
+  Stopwatch timer;
+  while (!condition()) {
+    if (timer.getTime() > timeout) {
+      return false;
+    }
+    Arch::sleep(0.001);
+  }
+  return true;
+}
+
+//! Binds \p socket to a free loopback port
+NetworkAddress bindLoopback(IDatagramSocket *socket)
+{
+  std::mt19937 random{std::random_device{}()};
+  NetworkAddress address;
+  for (int i = 0; i < 10; ++i) {
+    address = NetworkAddress("127.0.0.1", std::uniform_int_distribution<int>(30000, 60000)(random));
+    address.resolve();
+    try {
+      socket->bind(address);
+      break;
+    } catch (const SocketAddressInUseException &) {
+      // try another
+    }
+  }
+  return address;
+}
+
+//! An app that only knows the language
+class TestAppUtil : public AppUtil
+{
+public:
+  int run(int, char **) override
+  {
+    return 0;
+  }
+  void startNode() override
+  {
+    // do nothing
+  }
+  std::vector<std::string> getKeyboardLayoutList() override
+  {
+    return {};
+  }
+  std::string getCurrentLanguageCode() override
+  {
+    return "en";
+  }
+};
+
+//! A primary screen that does nothing
+class TestScreen : public IPlatformScreen
+{
+public:
+  explicit TestScreen(IEventQueue *events) : IPlatformScreen(events)
+  {
+    // do nothing
+  }
+
+  // IPlatformScreen overrides
+  void enable() override
+  {
+    // do nothing
+  }
+  void disable() override
+  {
+    // do nothing
+  }
+  void enter() override
+  {
+    // do nothing
+  }
+  bool canLeave() override
+  {
+    return true;
+  }
+  void leave() override
+  {
+    // do nothing
+  }
+  bool setClipboard(ClipboardID, const IClipboard *) override
+  {
+    return true;
+  }
+  void checkClipboards() override
+  {
+    // do nothing
+  }
+  void openScreensaver(bool) override
+  {
+    // do nothing
+  }
+  void closeScreensaver() override
+  {
+    // do nothing
+  }
+  void screensaver(bool) override
+  {
+    // do nothing
+  }
+  void resetOptions() override
+  {
+    // do nothing
+  }
+  void setOptions(const OptionsList &) override
+  {
+    // do nothing
+  }
+  void setSequenceNumber(uint32_t) override
+  {
+    // do nothing
+  }
+  std::string getSecureInputApp() const override
+  {
+    return {};
+  }
+  bool isPrimary() const override
+  {
+    return true;
+  }
+  void handleSystemEvent(const Event &) override
+  {
+    // do nothing
+  }
+
+  // IScreen overrides
+  void *getEventTarget() const override
+  {
+    return const_cast<TestScreen *>(this);
+  }
+  bool getClipboard(ClipboardID, IClipboard *) const override
+  {
+    return false;
+  }
+  void getShape(int32_t &x, int32_t &y, int32_t &width, int32_t &height) const override
+  {
+    x = 0;
+    y = 0;
+    width = 1920;
+    height = 1080;
+  }
+  void getCursorPos(int32_t &x, int32_t &y) const override
+  {
+    x = 960;
+    y = 540;
+  }
+
+  // IPrimaryScreen overrides
+  void reconfigure(uint32_t) override
+  {
+    // do nothing
+  }
+  uint32_t activeSides() override
+  {
+    return 0;
+  }
+  void warpCursor(int32_t, int32_t) override
+  {
+    // do nothing
+  }
+  uint32_t registerHotKey(KeyID, KeyModifierMask) override
+  {
+    return 0;
+  }
+  void unregisterHotKey(uint32_t) override
+  {
+    // do nothing
+  }
+  void fakeInputBegin() override
+  {
+    // do nothing
+  }
+  void fakeInputEnd() override
+  {
+    // do nothing
+  }
+  int32_t getJumpZoneSize() const override
+  {
+    return 1;
+  }
+  bool isAnyMouseButtonDown(uint32_t &) const override
+  {
+    return false;
+  }
+  void getCursorCenter(int32_t &x, int32_t &y) const override
+  {
+    getCursorPos(x, y);
+  }
+
+  // ISecondaryScreen overrides
+  void fakeMouseButton(ButtonID, bool) override
+  {
+    // do nothing
+  }
+  void fakeMouseMove(int32_t, int32_t) override
+  {
+    // do nothing
+  }
+  void fakeMouseRelativeMove(int32_t, int32_t) const override
+  {
+    // do nothing
+  }
+  void fakeMouseWheel(int32_t, int32_t) const override
+  {
+    // do nothing
+  }
+
+  // IKeyState overrides
+  void updateKeyMap() override
+  {
+    // do nothing
+  }
+  void updateKeyState() override
+  {
+    // do nothing
+  }
+  void setHalfDuplexMask(KeyModifierMask) override
+  {
+    // do nothing
+  }
+  void fakeKeyDown(KeyID, KeyModifierMask, KeyButton, const std::string &) override
+  {
+    // do nothing
+  }
+  bool fakeKeyRepeat(KeyID, KeyModifierMask, int32_t, KeyButton, const std::string &) override
+  {
+    return true;
+  }
+  bool fakeKeyUp(KeyButton) override
+  {
+    return true;
+  }
+  void fakeAllKeysUp() override
+  {
+    // do nothing
+  }
+  bool fakeCtrlAltDel() override
+  {
+    return true;
+  }
+  bool isKeyDown(KeyButton) const override
+  {
+    return false;
+  }
+  KeyModifierMask getActiveModifiers() const override
+  {
+    return 0;
+  }
+  KeyModifierMask pollActiveModifiers() const override
+  {
+    return 0;
+  }
+  int32_t pollActiveGroup() const override
+  {
+    return 0;
+  }
+  void pollPressedKeys(KeyButtonSet &) const override
+  {
+    // do nothing
+  }
+};
+
+//! Lets tests hand messages to a proxy
+template <typename Proxy> class TestProxy : public Proxy
+{
+public:
+  using Proxy::Proxy;
+  using Proxy::parseMessage;
+};
+
+//! The code of a message as the parser sees it
+const uint8_t *code(const char *code)
+{
+  return reinterpret_cast<const uint8_t *>(code);
+}
+
+//! A message with a code and two 2 byte integers, such as a mouse move
+std::string message(const char *code, int16_t x, int16_t y)
+{
+  return std::string(code, 4) + static_cast<char>(x >> 8) + static_cast<char>(x) + static_cast<char>(y >> 8) +
+         static_cast<char>(y);
+}
+
+//! The samples in a mouse motion message
+std::vector<MotionBatch::Sample> motion(const std::string &message)
+{
+  std::string data;
+  std::vector<MotionBatch::Sample> samples;
+  if (MsgDMouseMotion::isCode(reinterpret_cast<const uint8_t *>(message.data())) &&
+      MsgDMouseMotion::decode(
+          reinterpret_cast<const uint8_t *>(message.data()) + 4, static_cast<uint32_t>(message.size() - 4), data
+      )) {
+    MotionBatch::decode(data, samples);
+  }
+  return samples;
+}
+
+} // namespace
+
+void ClientProxyTests::initTestCase()
+{
+  m_arch.init();
+  m_log.setFilter(LogLevel::Info);
+}
+
+void ClientProxyTests::mouseMove_replacesQueuedMotion()
+{
+  EventQueue events;
+  auto *stream = new TestStream;
+  ClientProxy1_2 proxy("client", stream, &events);
+  stream->clear();
+
+  // motion while the last is still queued replaces it, latest wins
+  proxy.mouseMove(1, 2);
+  proxy.mouseMove(3, 4);
+  proxy.mouseMove(5, 6);
+  QCOMPARE(stream->m_messages.size(), 1u);
+  QCOMPARE(stream->m_messages[0], message("DMMV", 5, 6));
+}
+
+void ClientProxyTests::mouseRelativeMove_sumsQueuedMotion()
+{
+  EventQueue events;
+  auto *stream = new TestStream;
+  ClientProxy1_2 proxy("client", stream, &events);
+  stream->clear();
+
+  proxy.mouseRelativeMove(1, 1);
+  proxy.mouseRelativeMove(2, -3);
+  proxy.mouseRelativeMove(4, 5);
+  QCOMPARE(stream->m_messages.size(), 1u);
+  QCOMPARE(stream->m_messages[0], message("DMRM", 7, 3));
+
+  // an absolute move doesn't replace a relative one
+  proxy.mouseMove(8, 9);
+  QCOMPARE(stream->m_messages.size(), 2u);
+  QCOMPARE(stream->m_messages[1], message("DMMV", 8, 9));
+
+  // nor is a sum that doesn't fit sent as one
+  proxy.mouseRelativeMove(30000, 0);
+  proxy.mouseRelativeMove(30000, 0);
+  QCOMPARE(stream->m_messages.size(), 4u);
+  QCOMPARE(stream->m_messages[3], message("DMRM", 30000, 0));
+}
+
+void ClientProxyTests::mouseMove_sentMotionIsKept()
+{
+  EventQueue events;
+  auto *stream = new TestStream;
+  ClientProxy1_2 proxy("client", stream, &events);
+  stream->clear();
+
+  proxy.mouseMove(1, 2);
+  stream->send();
+  proxy.mouseMove(3, 4);
+  QCOMPARE(stream->m_messages.size(), 2u);
+  QCOMPARE(stream->m_messages[0], message("DMMV", 1, 2));
+  QCOMPARE(stream->m_messages[1], message("DMMV", 3, 4));
+}
+
+void ClientProxyTests::keyDown_keepsMotionInOrder()
+{
+  EventQueue events;
+  auto *stream = new TestStream;
+  ClientProxy1_2 proxy("client", stream, &events);
+  stream->clear();
+
+  // a click must land where the cursor was moved to before it
+  proxy.mouseMove(1, 2);
+  proxy.mouseDown(kButtonLeft);
+  proxy.mouseMove(3, 4);
+  proxy.mouseMove(5, 6);
+  QCOMPARE(stream->m_messages.size(), 3u);
+  QCOMPARE(stream->m_messages[0], message("DMMV", 1, 2));
+  QCOMPARE(stream->m_messages[1].substr(0, 4), std::string("DMDN"));
+  QCOMPARE(stream->m_messages[2], message("DMMV", 5, 6));
+}
+
+void ClientProxyTests::parseMessage_dispatchesByVersion()
+{
+  EventQueue events;
+  TestProxy<ClientProxy1_2> proxy12("client", new TestStream, &events);
+  TestProxy<ClientProxy1_3> proxy13("client", new TestStream, &events);
+
+  // keep alives came with 1.3, older handlers still apply
+  QVERIFY(!proxy12.parseMessage(code("CALV")));
+  QVERIFY(proxy13.parseMessage(code("CALV")));
+  QVERIFY(proxy12.parseMessage(code("CNOP")));
+  QVERIFY(proxy13.parseMessage(code("CNOP")));
+
+  // messages the client never sends aren't handled
+  QVERIFY(!proxy13.parseMessage(code("DMMV")));
+  QVERIFY(!proxy13.parseMessage(code("XXXX")));
+}
+
+void ClientProxyTests::clientProxy1_9_batchesMotion()
+{
+  EventQueue events;
+  TestAppUtil appUtil;
+  deskflow::Screen screen(new TestScreen(&events), &events);
+  PrimaryClient primaryClient("primary", &screen);
+  deskflow::server::Config config(&events);
+  config.addScreen("primary");
+  Server server(config, &primaryClient, &screen, &events, deskflow::ServerArgs());
+
+  auto *stream = new TestStream;
+  ClientProxy1_9 proxy("client", stream, &server, &events);
+  stream->clear();
+
+  // the motion in one pass of the event loop goes in one message
+  proxy.mouseMove(400, 300);
+  proxy.mouseMove(401, 302);
+  proxy.mouseRelativeMove(-5, 7);
+  QCOMPARE(stream->m_corked, 1);
+  QCOMPARE(stream->m_messages.size(), 1u);
+  auto samples = motion(stream->m_messages[0]);
+  QCOMPARE(samples.size(), 3u);
+  QCOMPARE(samples[1].m_x, 401);
+  QCOMPARE(samples[1].m_y, 302);
+  QVERIFY(samples[2].m_relative);
+  QCOMPARE(samples[2].m_x, -5);
+  QCOMPARE(samples[2].m_y, 7);
+
+  // a click goes after the motion before it, so it lands where it should
+  proxy.mouseDown(kButtonLeft);
+  proxy.mouseMove(402, 303);
+  QCOMPARE(stream->m_messages.size(), 3u);
+  QCOMPARE(stream->m_messages[1].substr(0, 4), std::string("DMDN"));
+  samples = motion(stream->m_messages[2]);
+  QCOMPARE(samples.size(), 1u);
+  QCOMPARE(samples[0].m_x, 402);
+
+  // it all goes out when the event loop gets to the proxy's event
+  events.dispatchEvent(Event(EventTypes::ClientProxyMotionReady, &proxy));
+  QCOMPARE(stream->m_corked, 0);
+
+  // and an event with no batch waiting doesn't uncork again
+  events.dispatchEvent(Event(EventTypes::ClientProxyMotionReady, &proxy));
+  QCOMPARE(stream->m_corked, 0);
+}
+
+void ClientProxyTests::clientProxy1_9_sendsMotionOnFastChannel()
+{
+  EventQueue events;
+  TestAppUtil appUtil;
+  deskflow::Screen screen(new TestScreen(&events), &events);
+  PrimaryClient primaryClient("primary", &screen);
+  deskflow::server::Config config(&events);
+  config.addScreen("primary");
+  Server server(config, &primaryClient, &screen, &events, deskflow::ServerArgs());
+
+  // the listener's socket on a free loopback port
+  SocketMultiplexer multiplexer;
+  auto *socket = new LossyDatagramSocket(new UDPSocket(&events, &multiplexer, IArchNetwork::AddressFamily::INet));
+  const auto address = bindLoopback(socket);
+  FastChannelListener listener(socket, &events);
+
+  // the channel is offered on the connection
+  auto *stream = new TestStream;
+  ClientProxy1_9 proxy("client", stream, &server, &events, &listener, address);
+  QVERIFY(!stream->m_messages.empty());
+  const auto &offer = stream->m_messages.back();
+  uint32_t token = 0;
+  QVERIFY(MsgCFastChannel::isCode(reinterpret_cast<const uint8_t *>(offer.data())));
+  QVERIFY(MsgCFastChannel::decode(reinterpret_cast<const uint8_t *>(offer.data()) + 4, 4, token));
+  stream->clear();
+
+  // the client says hello until the listener answers
+  UDPSocket client(&events, &multiplexer, IArchNetwork::AddressFamily::INet);
+  client.connect(address);
+  const std::string hello = FastChannel::hello(token);
+  std::array<uint8_t, FastChannel::kMaxDatagramSize> buffer;
+  uint32_t size = 0;
+  QVERIFY(waitFor([&] {
+    client.send(hello.data(), static_cast<uint32_t>(hello.size()));
+    events.dispatchEvent(Event(EventTypes::DatagramSocketReady, socket->getEventTarget()));
+    return (size = client.receive(buffer.data(), static_cast<uint32_t>(buffer.size()), nullptr)) > 0;
+  }));
+  QVERIFY(FastChannel::isHello({buffer.data(), size}));
+  while (client.receive(buffer.data(), static_cast<uint32_t>(buffer.size()), nullptr) > 0) {
+    // drop the answers to the other hellos
+  }
+
+  // each pass of the event loop sends a datagram, and nothing goes on the
+  // connection, even with every third datagram lost
+  socket->m_loseEvery = 3;
+  socket->m_sent = 0;
+  for (int32_t i = 0; i < 9; ++i) {
+    proxy.mouseMove(100 + i, 200);
+    QCOMPARE(stream->m_corked, 0);
+    events.dispatchEvent(Event(EventTypes::ClientProxyMotionReady, &proxy));
+  }
+  QVERIFY(stream->m_messages.empty());
+
+  FastChannel receiver(token);
+  std::vector<int32_t> positions;
+  QVERIFY(waitFor([&] {
+    while (const uint32_t n = client.receive(buffer.data(), static_cast<uint32_t>(buffer.size()), nullptr)) {
+      std::span<const uint8_t> message;
+      if (receiver.accept({buffer.data(), n}, message)) {
+        const auto samples = motion(std::string(reinterpret_cast<const char *>(message.data()), message.size()));
+        positions.push_back(samples.empty() ? -1 : samples.back().m_x);
+      }
+    }
+    return positions.size() == 6;
+  }));
+  QCOMPARE(positions, (std::vector<int32_t>{100, 101, 103, 104, 106, 107}));
+
+  // a click goes on the connection, after the position it's at, in case
+  // that datagram was lost, as it was here
+  proxy.mouseDown(kButtonLeft);
+  QCOMPARE(stream->m_messages.size(), 2u);
+  const auto samples = motion(stream->m_messages[0]);
+  QCOMPARE(samples.size(), 1u);
+  QCOMPARE(samples[0].m_x, 108);
+  QCOMPARE(stream->m_messages[1].substr(0, 4), std::string("DMDN"));
+  stream->clear();
+
+  // every scroll goes on the connection, after the position it's at, so
+  // none is lost with the datagrams around it
+  int32_t scrolled = 0;
+  for (int32_t i = 0; i < 9; ++i) {
+    proxy.mouseMove(200 + i, 200);
+    proxy.mouseWheel(0, 120);
+    events.dispatchEvent(Event(EventTypes::ClientProxyMotionReady, &proxy));
+  }
+  QCOMPARE(stream->m_messages.size(), 18u);
+  for (size_t i = 0; i < stream->m_messages.size(); i += 2) {
+    QCOMPARE(motion(stream->m_messages[i])[0].m_x, 200 + static_cast<int32_t>(i / 2));
+    const auto &wheel = stream->m_messages[i + 1];
+    int16_t xDelta = 0;
+    int16_t yDelta = 0;
+    QVERIFY(MsgDMouseWheel::isCode(reinterpret_cast<const uint8_t *>(wheel.data())));
+    QVERIFY(MsgDMouseWheel::decode(
+        reinterpret_cast<const uint8_t *>(wheel.data()) + 4, static_cast<uint32_t>(wheel.size() - 4), xDelta, yDelta
+    ));
+    scrolled += yDelta;
+  }
+  QCOMPARE(scrolled, 9 * 120);
+  stream->clear();
+
+  // the last datagram of a movement is lost, but the position it was at
+  // follows on the connection once the pointer has been still for a moment
+  socket->m_sent = 0;
+  for (int32_t i = 0; i < 3; ++i) {
+    proxy.mouseMove(250 + i, 200);
+    events.dispatchEvent(Event(EventTypes::ClientProxyMotionReady, &proxy));
+  }
+  QVERIFY(stream->m_messages.empty());
+  QVERIFY(waitFor([&] {
+    while (const uint32_t n = client.receive(buffer.data(), static_cast<uint32_t>(buffer.size()), nullptr)) {
+      std::span<const uint8_t> message;
+      if (receiver.accept({buffer.data(), n}, message)) {
+        positions.push_back(motion(std::string(reinterpret_cast<const char *>(message.data()), message.size()))[0].m_x);
+      }
+    }
+    return !positions.empty() && positions.back() == 251;
+  }));
+  QVERIFY(std::ranges::find(positions, 252) == positions.end());
+  {
+    Thread loop(new FunctionJob([](void *queue) { static_cast<EventQueue *>(queue)->loop(); }, &events));
+    events.waitForReady();
+    Arch::sleep(0.2);
+    events.addEvent(Event(EventTypes::Quit));
+    loop.wait();
+  }
+  QCOMPARE(stream->m_messages.size(), 1u);
+  QCOMPARE(motion(stream->m_messages[0])[0].m_x, 252);
+  stream->clear();
+
+  // motion goes back to the connection when datagrams can't be sent
+  socket->m_fail = true;
+  proxy.mouseMove(300, 300);
+  events.dispatchEvent(Event(EventTypes::ClientProxyMotionReady, &proxy));
+  QCOMPARE(stream->m_messages.size(), 1u);
+  QCOMPARE(motion(stream->m_messages[0])[0].m_x, 300);
+  proxy.mouseMove(301, 300);
+  QCOMPARE(stream->m_corked, 1);
+  events.dispatchEvent(Event(EventTypes::ClientProxyMotionReady, &proxy));
+  QCOMPARE(stream->m_corked, 0);
+  QCOMPARE(stream->m_messages.size(), 2u);
+}
+
+void ClientProxyTests::clientProxy1_9_sendsClipboardOnRequest()
+{
+  EventQueue events;
+  TestAppUtil appUtil;
+  deskflow::Screen screen(new TestScreen(&events), &events);
+  PrimaryClient primaryClient("primary", &screen);
+  deskflow::server::Config config(&events);
+  config.addScreen("primary");
+  Server server(config, &primaryClient, &screen, &events, deskflow::ServerArgs());
+
+  auto *stream = new TestStream;
+  ClientProxy1_9 proxy("client", stream, &server, &events);
+  auto receive = [&events, stream](const std::string &message) {
+    stream->m_input += message;
+    events.dispatchEvent(Event(EventTypes::StreamInputReady, stream->getEventTarget()));
+  };
+  auto bytes = [](const auto &message) { return std::string(message.begin(), message.end()); };
+  receive(bytes(MsgDInfo::encode(0, 0, 1920, 1080, 0, 960, 540)));
+  stream->clear();
+
+  // a clipboard change only offers it
+  Clipboard clipboard;
+  clipboard.open(0);
+  clipboard.add(IClipboard::Format::Text, std::string(4096, 'x'));
+  clipboard.close();
+  proxy.setClipboard(kClipboardClipboard, &clipboard);
+  QCOMPARE(stream->m_messages.size(), 1u);
+  const auto &message = stream->m_messages[0];
+  uint8_t id = 0;
+  uint32_t seq = 0;
+  ClipboardOffer::Digest digest;
+  std::vector<uint32_t> formats;
+  QVERIFY(MsgDClipboardOffer::isCode(reinterpret_cast<const uint8_t *>(message.data())));
+  QVERIFY(MsgDClipboardOffer::decode(
+      reinterpret_cast<const uint8_t *>(message.data()) + 4, static_cast<uint32_t>(message.size() - 4), id, seq,
+      digest[0], digest[1], digest[2], digest[3], formats
+  ));
+  QCOMPARE(id, kClipboardClipboard);
+  ClipboardOffer offer;
+  QVERIFY(ClipboardOffer::decode(digest, formats, offer));
+  QVERIFY(offer.matches(clipboard.marshall()));
+  stream->clear();
+
+  // an older offer isn't sent, the current one is, as the data always was
+  receive(bytes(MsgQClipboard::encode(kClipboardClipboard, seq - 1)));
+  receive(bytes(MsgQClipboard::encode(kClipboardClipboard, seq)));
+  const uint32_t offered = seq;
+
+  // the chunks go out as the event loop gets to them
+  events.addEvent(Event(EventTypes::Quit));
+  Thread loop(new FunctionJob([](void *queue) { static_cast<EventQueue *>(queue)->loop(); }, &events));
+  loop.wait();
+
+  QVERIFY(stream->m_messages.size() >= 3u);
+  std::string data;
+  uint32_t starts = 0;
+  for (const auto &chunk : stream->m_messages) {
+    QVERIFY(MsgDClipboard::isCode(reinterpret_cast<const uint8_t *>(chunk.data())));
+    uint8_t mark = 0;
+    std::string chunkData;
+    QVERIFY(MsgDClipboard::decode(
+        reinterpret_cast<const uint8_t *>(chunk.data()) + 4, static_cast<uint32_t>(chunk.size() - 4), id, seq, mark,
+        chunkData
+    ));
+    QCOMPARE(seq, offered);
+    if (mark == ChunkType::DataStart) {
+      ++starts;
+    } else if (mark == ChunkType::DataChunk) {
+      data += chunkData;
+    }
+  }
+  QCOMPARE(starts, 1u);
+  QCOMPARE(data, clipboard.marshall());
+}
+
+QTEST_MAIN(ClientProxyTests)
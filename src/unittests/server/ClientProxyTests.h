@@ -0,0 +1,29 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include "arch/Arch.h"
+#include "base/Log.h"
+
+#include <QTest>
+
+class ClientProxyTests : public QObject
+{
+  Q_OBJECT
+private Q_SLOTS:
+  void initTestCase();
+  void mouseMove_replacesQueuedMotion();
+  void mouseRelativeMove_sumsQueuedMotion();
+  void mouseMove_sentMotionIsKept();
+  void keyDown_keepsMotionInOrder();
+  void parseMessage_dispatchesByVersion();
+  void clientProxy1_9_batchesMotion();
+  void clientProxy1_9_sendsMotionOnFastChannel();
+  void clientProxy1_9_sendsClipboardOnRequest();
+
+private:
+  Arch m_arch;
+  Log m_log;
+};
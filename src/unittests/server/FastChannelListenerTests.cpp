@@ -0,0 +1,96 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include "FastChannelListenerTests.h"
+
+#include "base/EventQueue.h"
+#include "base/Stopwatch.h"
+#include "deskflow/FastChannel.h"
+#include "net/NetworkAddress.h"
+#include "net/SocketException.h"
+#include "net/SocketMultiplexer.h"
+#include "net/UDPSocket.h"
+#include "server/FastChannelListener.h"
+
+#include <array>
+#include <functional>
+#include <random>
+#include <string>
+
+namespace {
+
+//! Waits up to \p timeout seconds for \p condition
+bool waitFor(const std::function<bool()> &condition, double timeout = 5.0)
+{
+  Stopwatch timer;
+  while (!condition()) {
+    if (timer.getTime() > timeout) {
+      return false;
+    }
+    Arch::sleep(0.001);
+  }
+  return true;
+}
+
+//! Binds \p socket to a free loopback port
+NetworkAddress bindLoopback(IDatagramSocket *socket)
+{
+  std::mt19937 random{std::random_device{}()};
+  NetworkAddress address;
+  for (int i = 0; i < 10; ++i) {
+    address = NetworkAddress("127.0.0.1", std::uniform_int_distribution<int>(30000, 60000)(random));
+    address.resolve();
+    try {
+      socket->bind(address);
+      break;
+    } catch (const SocketAddressInUseException &) {
+      // try another
+    }
+  }
+  return address;
+}
+
+} // namespace
+
+void FastChannelListenerTests::initTestCase()
+{
+  m_arch.init();
+  m_log.setFilter(LogLevel::Info);
+}
+
+void FastChannelListenerTests::open_answersOnlyThePeer()
+{
+  EventQueue events;
+  SocketMultiplexer multiplexer;
+  auto *socket = new UDPSocket(&events, &multiplexer, IArchNetwork::AddressFamily::INet);
+  const auto address = bindLoopback(socket);
+  FastChannelListener listener(socket, &events);
+
+  UDPSocket client(&events, &multiplexer, IArchNetwork::AddressFamily::INet);
+  client.connect(address);
+  std::array<uint8_t, FastChannel::kMaxDatagramSize> buffer;
+  int hellos = 0;
+  const auto sayHello = [&](uint32_t token) {
+    const std::string hello = FastChannel::hello(token);
+    client.send(hello.data(), static_cast<uint32_t>(hello.size()));
+    events.dispatchEvent(Event(EventTypes::DatagramSocketReady, socket->getEventTarget()));
+    return client.receive(buffer.data(), static_cast<uint32_t>(buffer.size()), nullptr) > 0;
+  };
+
+  // a hello with the right token from another host isn't answered
+  NetworkAddress other("127.0.0.2", address.getPort());
+  other.resolve();
+  const uint32_t elsewhere = listener.open(other, [&](const NetworkAddress &) { ++hellos; });
+  QVERIFY(!waitFor([&] { return sayHello(elsewhere); }, 0.5));
+  QCOMPARE(hellos, 0);
+
+  // but it is from the host the client connected from
+  const uint32_t token = listener.open(address, [&](const NetworkAddress &) { ++hellos; });
+  QVERIFY(waitFor([&] { return sayHello(token); }));
+  QVERIFY(hellos > 0);
+}
+
+QTEST_MAIN(FastChannelListenerTests)
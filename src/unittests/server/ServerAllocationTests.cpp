@@ -0,0 +1,327 @@
+/*
+ * Deskflow -- mouse and keyboard sharing utility
+ * SPDX-FileCopyrightText: (C) 2025 Deskflow Developers
+ * SPDX-License-Identifier: GPL-2.0-only WITH LicenseRef-OpenSSL-Exception
+ */
+
+#include "ServerAllocationTests.h"
+
+#include "base/EventQueue.h"
+#include "base/FunctionJob.h"
+#include "deskflow/AppUtil.h"
+#include "deskflow/IPlatformScreen.h"
+#include "deskflow/Screen.h"
+#include "mt/Thread.h"
+#include "server/PrimaryClient.h"
+#include "server/Server.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+// count every allocation made through operator new.  it's replaced for
+// the whole binary, so only tests that count allocations belong here.
+static std::atomic<size_t> s_allocations = 0;
+
+void *operator new(size_t size)
+{
+  ++s_allocations;
+  if (void *p = std::malloc(size == 0 ? 1 : size); p != nullptr) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+  std::free(p);
+}
+
+class TestAppUtil : public AppUtil
+{
+public:
+  int run(int, char **) override
+  {
+    return 0;
+  }
+  void startNode() override
+  {
+    // do nothing
+  }
+  std::vector<std::string> getKeyboardLayoutList() override
+  {
+    return {};
+  }
+  std::string getCurrentLanguageCode() override
+  {
+    // the server asks for this on every key press
+    ++m_keyPresses;
+    return "en";
+  }
+
+  std::atomic<int> m_keyPresses = 0;
+};
+
+// a primary screen that does nothing
+class TestScreen : public IPlatformScreen
+{
+public:
+  explicit TestScreen(IEventQueue *events) : IPlatformScreen(events)
+  {
+    // do nothing
+  }
+
+  // IPlatformScreen overrides
+  void enable() override
+  {
+    // do nothing
+  }
+  void disable() override
+  {
+    // do nothing
+  }
+  void enter() override
+  {
+    // do nothing
+  }
+  bool canLeave() override
+  {
+    return true;
+  }
+  void leave() override
+  {
+    // do nothing
+  }
+  bool setClipboard(ClipboardID, const IClipboard *) override
+  {
+    return true;
+  }
+  void checkClipboards() override
+  {
+    // do nothing
+  }
+  void openScreensaver(bool) override
+  {
+    // do nothing
+  }
+  void closeScreensaver() override
+  {
+    // do nothing
+  }
+  void screensaver(bool) override
+  {
+    // do nothing
+  }
+  void resetOptions() override
+  {
+    // do nothing
+  }
+  void setOptions(const OptionsList &) override
+  {
+    // do nothing
+  }
+  void setSequenceNumber(uint32_t) override
+  {
+    // do nothing
+  }
+  std::string getSecureInputApp() const override
+  {
+    return {};
+  }
+  bool isPrimary() const override
+  {
+    return true;
+  }
+  void handleSystemEvent(const Event &) override
+  {
+    // do nothing
+  }
+
+  // IScreen overrides
+  void *getEventTarget() const override
+  {
+    return const_cast<TestScreen *>(this);
+  }
+  bool getClipboard(ClipboardID, IClipboard *) const override
+  {
+    return false;
+  }
+  void getShape(int32_t &x, int32_t &y, int32_t &width, int32_t &height) const override
+  {
+    x = 0;
+    y = 0;
+    width = 1920;
+    height = 1080;
+  }
+  void getCursorPos(int32_t &x, int32_t &y) const override
+  {
+    x = 960;
+    y = 540;
+  }
+
+  // IPrimaryScreen overrides
+  void reconfigure(uint32_t) override
+  {
+    // do nothing
+  }
+  uint32_t activeSides() override
+  {
+    return 0;
+  }
+  void warpCursor(int32_t, int32_t) override
+  {
+    // do nothing
+  }
+  uint32_t registerHotKey(KeyID, KeyModifierMask) override
+  {
+    return 0;
+  }
+  void unregisterHotKey(uint32_t) override
+  {
+    // do nothing
+  }
+  void fakeInputBegin() override
+  {
+    // do nothing
+  }
+  void fakeInputEnd() override
+  {
+    // do nothing
+  }
+  int32_t getJumpZoneSize() const override
+  {
+    return 1;
+  }
+  bool isAnyMouseButtonDown(uint32_t &) const override
+  {
+    return false;
+  }
+  void getCursorCenter(int32_t &x, int32_t &y) const override
+  {
+    getCursorPos(x, y);
+  }
+
+  // ISecondaryScreen overrides
+  void fakeMouseButton(ButtonID, bool) override
+  {
+    // do nothing
+  }
+  void fakeMouseMove(int32_t, int32_t) override
+  {
+    // do nothing
+  }
+  void fakeMouseRelativeMove(int32_t, int32_t) const override
+  {
+    // do nothing
+  }
+  void fakeMouseWheel(int32_t, int32_t) const override
+  {
+    // do nothing
+  }
+
+  // IKeyState overrides
+  void updateKeyMap() override
+  {
+    // do nothing
+  }
+  void updateKeyState() override
+  {
+    // do nothing
+  }
+  void setHalfDuplexMask(KeyModifierMask) override
+  {
+    // do nothing
+  }
+  void fakeKeyDown(KeyID, KeyModifierMask, KeyButton, const std::string &) override
+  {
+    // do nothing
+  }
+  bool fakeKeyRepeat(KeyID, KeyModifierMask, int32_t, KeyButton, const std::string &) override
+  {
+    return true;
+  }
+  bool fakeKeyUp(KeyButton) override
+  {
+    return true;
+  }
+  void fakeAllKeysUp() override
+  {
+    // do nothing
+  }
+  bool fakeCtrlAltDel() override
+  {
+    return true;
+  }
+  bool isKeyDown(KeyButton) const override
+  {
+    return false;
+  }
+  KeyModifierMask getActiveModifiers() const override
+  {
+    return 0;
+  }
+  KeyModifierMask pollActiveModifiers() const override
+  {
+    return 0;
+  }
+  int32_t pollActiveGroup() const override
+  {
+    return 0;
+  }
+  void pollPressedKeys(KeyButtonSet &) const override
+  {
+    // do nothing
+  }
+};
+
+void ServerAllocationTests::initTestCase()
+{
+  m_arch.init();
+  m_log.setFilter(LogLevel::Info);
+}
+
+void ServerAllocationTests::onKeyDown_doesNotAllocate()
+{
+  EventQueue events;
+  TestAppUtil appUtil;
+  deskflow::Screen screen(new TestScreen(&events), &events);
+  PrimaryClient primaryClient("primary", &screen);
+  deskflow::server::Config config(&events);
+  config.addScreen("primary");
+
+  Server server(config, &primaryClient, &screen, &events, deskflow::ServerArgs());
+
+  Thread loop(new FunctionJob([](void *queue) { static_cast<EventQueue *>(queue)->loop(); }, &events));
+  events.waitForReady();
+
+  // the same event the primary screen's key state sends for a key press
+  const IKeyState::KeyInfo info{'a', 0, 38, 1, nullptr, {}};
+  auto pressKey = [&events, &primaryClient, &info, &appUtil] {
+    const int keyPresses = appUtil.m_keyPresses;
+    events.addEvent(Event(EventTypes::KeyStateKeyDown, primaryClient.getEventTarget(), info));
+    while (appUtil.m_keyPresses == keyPresses) {
+      std::this_thread::yield();
+    }
+  };
+
+  // the first press also flushes out anything the server queued while
+  // starting up
+  pressKey();
+
+  const size_t allocations = s_allocations;
+  pressKey();
+  const size_t keyDownAllocations = s_allocations - allocations;
+
+  events.addEvent(Event(EventTypes::Quit));
+  loop.wait();
+
+  QCOMPARE(keyDownAllocations, size_t(0));
+}
+
+QTEST_MAIN(ServerAllocationTests)